@@ -3,12 +3,15 @@
 #include <cstdio>
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+#include <exception>
 #ifdef WIN32
 #include <io.h>
 #endif
 
 #include <fstream>
 #include "utils.h"
+#include "logwriter.h"
 #include <codecvt>
 #include <fstream>
 
@@ -51,6 +54,7 @@ void Log::setDefaultDestination(logType newDestination)
 void Log::setWhere(logType where)
 {
 	log() << std::flush;
+	LogWriter::writer()->flush();
 
 	if(where == _where)
 		return;
@@ -80,6 +84,34 @@ void Log::init(std::ostream* nullStream)
 {
 	_where			= _default;
 	_nullStream		= nullStream;
+
+	//With badbit set every operator<< on it returns right away, so nothing gets formatted just to be thrown away
+	_nullStream->setstate(std::ios_base::badbit);
+
+	redirectStdOut();
+	flushWhenGoingDown();
+}
+
+void Log::flushWhenGoingDown()
+{
+	static bool installed = false;
+
+	if(installed)
+		return;
+
+	installed = true;
+
+	//Registered after LogWriter::writer() was created by redirectStdOut, so this runs before the writer is destroyed.
+	//The buffers of the threads are gone by then, but they pushed what they had when they were destroyed.
+	std::atexit([]() { LogWriter::writer()->flush(); });
+
+	static std::terminate_handler previousTerminate = std::set_terminate([]()
+	{
+		Log::flush();
+
+		if(previousTerminate)	previousTerminate();
+		else					std::abort();
+	});
 }
 
 void Log::redirectStdOut()
@@ -116,6 +148,8 @@ void Log::redirectStdOut()
 	}
 
 	_logError = logError::noProblem;
+
+	LogWriter::writer()->setDestination(_where == logType::file ? static_cast<std::ostream*>(&_logFile) : _where == logType::cout ? &std::cout : nullptr);
 }
 
 Json::Value	Log::createLogCfgMsg()
@@ -134,7 +168,7 @@ void Log::parseLogCfgMsg(const Json::Value & json)
 
 const char * Log::getTimestamp()
 {
-	static char buf[13];
+	thread_local char buf[13];
 	static auto startTime = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now());
 
 	std::chrono::milliseconds duration = std::chrono::time_point_cast<std::chrono::milliseconds>(std::chrono::system_clock::now()) - startTime;
@@ -156,24 +190,39 @@ const char * Log::getTimestamp()
 
 std::ostream & Log::log(bool addTimestamp)
 {
-	switch(_where)
-	{
-	case logType::null:
-	{
+	return stream(addTimestamp, false);
+}
+
+std::ostream & Log::error(bool addTimestamp)
+{
+	return stream(addTimestamp, true);
+}
+
+std::ostream & Log::stream(bool addTimestamp, bool urgent)
+{
+	if(_where == logType::null)
 		return *_nullStream;
-	}
-	case logType::file:
-	{
-		if (addTimestamp) _logFile << Log::getTimestamp() << ": ";
-		return _logFile;
-	}
-	case logType::cout:
-	default:
+
+	//Each thread streams into its own buffer, which is handed to the LogWriter thread when flushed
+	thread_local LogStreamBuf	buffer;
+	thread_local std::ostream	stream(&buffer);
+
+	if(urgent)
+		buffer.setUrgent();
+
+	if (addTimestamp)
 	{
-		if (addTimestamp) std::cout << ( _engineNo < 0 ? std::string("Desktop:\t") : "Engine#" + std::to_string(_engineNo) + ":\t");
-		return std::cout;
-	}
+		if(_where == logType::file)	stream << Log::getTimestamp() << ": ";
+		else						stream << ( _engineNo < 0 ? std::string("Desktop:\t") : "Engine#" + std::to_string(_engineNo) + ":\t");
 	}
+
+	return stream;
+}
+
+void Log::flush()
+{
+	log(false) << std::flush;
+	LogWriter::writer()->flush();
 }
 
 std::ostream & operator<<(std::ostream & os, const std::wstring & wStr)
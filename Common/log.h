@@ -16,11 +16,17 @@ DECLARE_ENUM(logError, noProblem, fileNotOpen, filePathNotSet);
 /// In both cases a setting can be turned on to write it all to files, then a file for Desktop is created and one for each running engine. 
 /// They will all have the exact same timestamp in the filename to easily group them.
 /// For almost all messages a timestamp and identifier is added. But because the output from R (and some other places) comes in in pieces we omit that there.
+/// Every thread gets its own stream from log(), what is streamed into it is passed on to a LogWriter thread each time it is flushed (for instance by std::endl).
+/// So logging never waits for the file or console, but a message without a flush at the end only shows up once that thread flushes again.
+/// What was logged is also written out at exit and when std::terminate is called, but not from signal handlers since waiting on the writer is not async-signal-safe.
 /// 
 class Log
 {
 public:
 	static std::ostream & log(bool addTimestamp = true);
+	static std::ostream & error(bool addTimestamp = true);	///< Like log() but the message is written before the std::endl that ends it returns, use it for what comes right before things go wrong
+	static void			flush();				///< Waits until everything logged so far, by this and other threads, is written
+	static bool			active() { return _where != logType::null; }
 
 	static std::string	logFileNameBase;
 
@@ -42,6 +48,8 @@ public:
 private:
 						Log() { }
 	static void			redirectStdOut();
+	static std::ostream & stream(bool addTimestamp, bool urgent);
+	static void			flushWhenGoingDown();
 	static const char * getTimestamp();
 
 	static logType		_default;
@@ -0,0 +1,165 @@
+#include "logwriter.h"
+#include <iostream>
+
+LogWriter * LogWriter::writer()
+{
+	static LogWriter writer;
+	return &writer;
+}
+
+LogWriter::LogWriter()
+	: _slots(new Slot[_capacity]), _out(&std::cout)
+{
+	for(size_t i=0; i<_capacity; i++)
+		_slots[i].sequence.store(i, std::memory_order_relaxed);
+
+	_thread = std::thread(&LogWriter::run, this);
+}
+
+LogWriter::~LogWriter()
+{
+	_running = false;
+	_signal.fetch_add(1, std::memory_order_release);
+	_signal.notify_one();
+
+	if(_thread.joinable())
+		_thread.join();
+}
+
+bool LogWriter::push(std::string && text)
+{
+	Slot	*	slot;
+	size_t		pos = _enqueuePos.load(std::memory_order_relaxed);
+
+	for(;;)
+	{
+		slot				= &_slots[pos & _mask];
+		size_t		seq		= slot->sequence.load(std::memory_order_acquire);
+		intptr_t	diff	= intptr_t(seq) - intptr_t(pos);
+
+		if(diff == 0)
+		{
+			if(_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if(diff < 0)
+		{
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+		else
+			pos = _enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	slot->text = std::move(text);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+
+	_published.fetch_add(1, std::memory_order_release);
+	_signal.fetch_add(1, std::memory_order_release);
+	_signal.notify_one();
+
+	return true;
+}
+
+bool LogWriter::pop(std::string & text)
+{
+	Slot & slot = _slots[_dequeuePos & _mask];
+
+	if(slot.sequence.load(std::memory_order_acquire) != _dequeuePos + 1)
+		return false;
+
+	text.swap(slot.text);
+	slot.text.clear();
+	slot.sequence.store(_dequeuePos + _capacity, std::memory_order_release);
+	_dequeuePos++;
+
+	return true;
+}
+
+void LogWriter::flush()
+{
+	if(std::this_thread::get_id() == _thread.get_id())
+		return;
+
+	const size_t target = _published.load(std::memory_order_acquire);
+
+	for(size_t written = _written.load(std::memory_order_acquire); written < target; written = _written.load(std::memory_order_acquire))
+		_written.wait(written);
+}
+
+void LogWriter::run()
+{
+	std::string text;
+
+	for(;;)
+	{
+		const size_t signal = _signal.load(std::memory_order_acquire);
+
+		while(pop(text))
+		{
+			std::ostream * out = _out.load();
+
+			if(out)
+				out->write(text.data(), text.size());
+
+			_written.fetch_add(1, std::memory_order_release);
+			_written.notify_all();
+		}
+
+		std::ostream * out = _out.load();
+
+		if(out)
+		{
+			size_t dropped = _dropped.load(std::memory_order_relaxed);
+
+			if(dropped != _reportedDropped)
+			{
+				*out << "LogWriter dropped " << (dropped - _reportedDropped) << " log messages because they came in faster than they could be written." << std::endl;
+				_reportedDropped = dropped;
+			}
+
+			out->flush();
+		}
+
+		if(!_running)
+			return;
+
+		_signal.wait(signal);
+	}
+}
+
+int LogStreamBuf::sync()
+{
+	if(!_buffer.empty())
+	{
+		LogWriter::writer()->push(std::move(_buffer));
+		_buffer.clear();
+	}
+
+	if(_urgent)
+	{
+		_urgent = false;
+		LogWriter::writer()->flush();
+	}
+
+	return 0;
+}
+
+LogStreamBuf::int_type LogStreamBuf::overflow(int_type ch)
+{
+	if(!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		_buffer.push_back(traits_type::to_char_type(ch));
+		pushIfBig();
+	}
+
+	return traits_type::not_eof(ch);
+}
+
+std::streamsize LogStreamBuf::xsputn(const char * s, std::streamsize n)
+{
+	_buffer.append(s, size_t(n));
+	pushIfBig();
+
+	return n;
+}
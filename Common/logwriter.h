@@ -0,0 +1,86 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <atomic>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <thread>
+
+///
+/// Writes the output of Log on a thread of its own, so that the thread doing the logging never waits for a file or console.
+/// Finished lines are handed over through a bounded lock-free queue (Vyukov's multi-producer design, with a single consumer here).
+/// When the queue is full lines are dropped instead of blocking the caller, how many is counted and reported in the log itself.
+///
+class LogWriter
+{
+public:
+	static LogWriter *	writer();
+
+	///Hands a finished piece of log to the writer thread, returns false if it had to be dropped because the queue was full.
+	bool				push(std::string && text);
+
+	///Blocks until everything pushed before this call has been written to the destination.
+	void				flush();
+
+	///Where the text is written to, std::cout until Log sets it and nullptr drops it. Call flush() first if the previous destination should get everything pushed so far.
+	void				setDestination(std::ostream * out)	{ _out = out; }
+	std::ostream	*	destination()	const				{ return _out; }
+
+	size_t				dropped()	const					{ return _dropped; }
+
+						~LogWriter();
+
+private:
+						LogWriter();
+
+	bool				pop(std::string & text);
+	void				run();
+
+	struct Slot
+	{
+		std::atomic<size_t>	sequence;
+		std::string			text;
+	};
+
+	static constexpr size_t		_capacity	= 8192,				///< Must be a power of two
+								_mask		= _capacity - 1;
+
+	std::unique_ptr<Slot[]>		_slots;
+	std::atomic<size_t>			_enqueuePos	= 0,
+								_published	= 0,				///< Number of slots filled completely, flush() waits for _written to reach it
+								_written	= 0,
+								_signal		= 0,				///< Bumped to wake up the writer thread
+								_dropped	= 0;
+	size_t						_dequeuePos	= 0,				///< Only touched by the writer thread
+								_reportedDropped = 0;
+	std::atomic<std::ostream*>	_out		= nullptr;
+	std::atomic<bool>			_running	= true;
+	std::thread					_thread;
+};
+
+///
+/// The streambuf behind the std::ostream Log::log() returns, there is one per thread.
+/// It collects what is streamed into it and pushes it to the LogWriter whenever the stream is flushed (std::endl does that) or it grows too big.
+/// After setUrgent() the next flush also waits until the LogWriter wrote it, for messages that must not get lost if the process goes down right after.
+///
+class LogStreamBuf : public std::streambuf
+{
+public:
+						~LogStreamBuf() override { sync(); }
+
+	void				setUrgent()	{ _urgent = true; }
+
+protected:
+	int					sync()									override;
+	int_type			overflow(int_type ch)					override;
+	std::streamsize		xsputn(const char * s, std::streamsize n)	override;
+
+private:
+	void				pushIfBig()	{ if(_buffer.size() > 65536) sync(); }
+
+	std::string			_buffer;
+	bool				_urgent = false;
+};
+
+#endif // LOGWRITER_H
@@ -1,5 +1,6 @@
 #include "r_functionwhitelist.h"
 #include "stringutils.h"
+#include <algorithm>
 
 	//The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a vector of attack and that doesn't refer to an R-datatype.
 const std::set<std::string> R_FunctionWhiteList::functionWhiteList {
@@ -262,76 +263,217 @@ std::string R_FunctionWhiteList::returnOrderedWhiteList()
 	return out.str();
 }
 
-const std::string	R_FunctionWhiteList::functionStartDelimit("(?:[;\\s\\(\"\\[\\+\\-\\=\\*\\%\\/\\{\\|&!]|^)"); //These should be all possible non-funtion-name-characters that could be right in front of any function-name in R.
-const std::string	R_FunctionWhiteList::functionNameStart("(?:\\.?[[:alpha:]])");
-const std::string	R_FunctionWhiteList::functionNameBody("(?:\\w|\\.|::)+");
-const std::regex	R_FunctionWhiteList::functionNameMatcher(functionStartDelimit + "(" + functionNameStart + functionNameBody + ")(?=[\\t \\r]*\\()");
-
-std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(std::string const & script)
+namespace
 {
-	std::set<std::string> blackListedFunctionsFound;
+	//std::regex used the classic locale for these, so anything outside of ASCII is never part of a name or whitespace
+	bool isAlpha(char c)	{ return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+	bool isWord(char c)		{ return isAlpha(c) || (c >= '0' && c <= '9') || c == '_'; }
+	bool isSpace(char c)	{ return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r'; }
 
-	auto foundFunctionsBegin	= std::sregex_iterator(script.begin(), script.end(), functionNameMatcher);
-	auto foundFunctionsEnd		= std::sregex_iterator();
+	///These should be all possible non-function-name-characters that could be right in front of any function-name in R.
+	bool precedesFunction(char c)
+	{
+		switch(c)
+		{
+		case ';': case '(': case '"': case '[': case '+': case '-': case '=': case '*': case '%': case '/': case '{': case '|': case '&': case '!':
+			return true;
+		default:
+			return isSpace(c);
+		}
+	}
 
-	for(auto foundFunctionIter = foundFunctionsBegin; foundFunctionIter != foundFunctionsEnd; foundFunctionIter++ )
+	///Where a name like "\.?[[:alpha:]](?:\w|\.|::)+" that starts at start ends, or start itself if no name starts there.
+	size_t nameEnd(const std::string & script, size_t start)
 	{
-		std::string foundFunction((*foundFunctionIter)[1].str());
-		bool whiteListed = functionWhiteList.count(foundFunction) > 0;
+		size_t pos = start;
 
-		if(!whiteListed && blackListedFunctionsFound.count(foundFunction) == 0)
-			blackListedFunctionsFound.insert(foundFunction);
+		if(pos < script.size() && script[pos] == '.')
+			pos++;
+
+		if(pos >= script.size() || !isAlpha(script[pos]))
+			return start;
+
+		const size_t body = ++pos;
+
+		while(pos < script.size())
+			if(isWord(script[pos]) || script[pos] == '.')							pos++;
+			else if(script[pos] == ':' && pos + 1 < script.size() && script[pos + 1] == ':')	pos += 2;
+			else																	break;
+
+		return pos > body ? pos : start;
 	}
 
+	size_t skipSpace(const std::string & script, size_t pos)
+	{
+		while(pos < script.size() && isSpace(script[pos]))
+			pos++;
+		return pos;
+	}
 
-	return blackListedFunctionsFound;
-}
+	///Where "<-", "<<-" or "=" at pos ends, or npos if there is no assignment there.
+	size_t assignmentEnd(const std::string & script, size_t pos)
+	{
+		if(script.compare(pos, 2, "<-")		== 0)	return pos + 2;
+		if(script.compare(pos, 3, "<<-")	== 0)	return pos + 3;
+		if(pos < script.size() && script[pos] == '=')	return pos + 1;
+		return std::string::npos;
+	}
 
-const std::string	R_FunctionWhiteList::operatorsR("`(?:\\+|-|\\*|/|%(?:/|\\*|in)?%|\\^|<=?|>=?|==?|!=?|<?<-|->>?|\\|\\|?|&&?|:|\\$)`");
+	///Where "->" or "->>" at pos ends, or npos.
+	size_t rightAssignmentEnd(const std::string & script, size_t pos)
+	{
+		if(script.compare(pos, 2, "->") != 0)
+			return std::string::npos;
 
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedRightMatcher(	"(" +				functionNameStart + functionNameBody +	")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedLeftMatcher(	"(?:->>?)\\s*(" +	functionNameStart + functionNameBody +	")");
-const std::regex	R_FunctionWhiteList::assignmentOperatorRightMatcher(	"(" +				operatorsR +							")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentOperatorLeftMatcher(		"(?:->>?)\\s*(" +	operatorsR +							")");
+		return pos + (script.compare(pos, 3, "->>") == 0 ? 3 : 2);
+	}
 
-std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(std::string const & script)
+	///Where a backticked R operator, like "`+`" or "`%in%`", at pos ends, or npos.
+	size_t backtickedOperatorEnd(const std::string & script, size_t pos)
+	{
+		static const std::set<std::string> operatorsR { "+", "-", "*", "/", "%%", "%/%", "%*%", "%in%", "^", "<", "<=", ">", ">=", "=", "==", "!", "!=", "<-", "<<-", "->", "->>", "|", "||", "&", "&&", ":", "$" };
+		static const size_t longestOperator = 4;
+
+		if(pos >= script.size() || script[pos] != '`')
+			return std::string::npos;
+
+		size_t close = script.find('`', pos + 1);
+
+		if(close == std::string::npos || close - pos - 1 > longestOperator || !operatorsR.count(script.substr(pos + 1, close - pos - 1)))
+			return std::string::npos;
+
+		return close + 1;
+	}
+}
+
+R_FunctionWhiteList::ScanResult R_FunctionWhiteList::scanScript(const std::string & script)
 {
-	//Log::log() << "findIllegalFunctionsAliases with " << script << std::endl;
+	const size_t	npos	= std::string::npos;
+	ScanResult		found;
 
-	std::set<std::string> illegalAliasesFound;
+	//Each kind of match continues searching after the end of its previous match, so that we find exactly what the regexes used to find.
+	size_t	nextFunction		= 0,
+			nextOperatorLeft	= 0,
+			nextOperatorRight	= 0,
+			nextNameLeft		= 0,
+			nextNameRight		= 0;
 
-	auto aliasSearcher = [&illegalAliasesFound, &script](std::regex aliasAssignmentMatcher, bool (*lambdaMatchChecker)(std::string) )
+	for(size_t i=0; i<script.size(); i++)
 	{
-		auto foundAliasesBegin	= std::sregex_iterator(script.begin(), script.end(), aliasAssignmentMatcher);
-		auto foundAliasesEnd	= std::sregex_iterator();
+		//Function calls: "name(", right after one of the characters that can precede a function or at the very start
+		if(i >= nextFunction)
+		{
+			size_t start = precedesFunction(script[i]) ? i + 1 : i == 0 ? 0 : npos;
+
+			if(start != npos)
+			{
+				size_t end		= nameEnd(script, start),
+					   paren	= end;
+
+				while(paren < script.size() && (script[paren] == ' ' || script[paren] == '\t' || script[paren] == '\r'))
+					paren++;
+
+				if(end > start && paren < script.size() && script[paren] == '(')
+				{
+					found.functions.insert(script.substr(start, end - start));
+					nextFunction = end;
+				}
+			}
+		}
 
-		for(auto foundAliasesIter = foundAliasesBegin; foundAliasesIter != foundAliasesEnd; foundAliasesIter++ )
+		//Assignments to the right: "... -> name" or "... -> `+`"
+		if(i >= std::min(nextOperatorLeft, nextNameLeft))
 		{
-			std::string foundAlias((*foundAliasesIter)[1].str());
-			bool allowed = (*lambdaMatchChecker)(foundAlias);
+			size_t arrow = rightAssignmentEnd(script, i);
+
+			if(arrow != npos)
+			{
+				size_t	start	= skipSpace(script, arrow),
+						end;
+
+				if(i >= nextOperatorLeft && (end = backtickedOperatorEnd(script, start)) != npos)
+				{
+					found.operatorAliases.insert(script.substr(start, end - start));
+					nextOperatorLeft = end;
+				}
+
+				if(i >= nextNameLeft && (end = nameEnd(script, start)) > start)
+				{
+					found.nameAssignments.insert(script.substr(start, end - start));
+					nextNameLeft = end;
+				}
+			}
+		}
 
-			//Log::log() << "I found alias assignment: " << foundAlias << " which is " << (allowed ? "allowed" : "not allowed") << ".." << std::endl;
+		//Assignments to the left: "`+` <- ..."
+		if(i >= nextOperatorRight && script[i] == '`')
+		{
+			size_t	end			= backtickedOperatorEnd(script, i),
+					assignment	= end == npos ? npos : assignmentEnd(script, skipSpace(script, end));
+
+			if(assignment != npos)
+			{
+				found.operatorAliases.insert(script.substr(i, end - i));
+				nextOperatorRight = assignment;
+			}
+		}
 
-			if(!allowed)
-				illegalAliasesFound.insert(foundAlias);
+		//And "name <- ...", where the name may start halfway something else, like "data$mean <- ..."
+		if(i >= nextNameRight)
+		{
+			size_t end = nameEnd(script, i);
+
+			if(end > i)
+			{
+				size_t assignment = assignmentEnd(script, skipSpace(script, end));
+
+				if(assignment != npos)
+				{
+					found.nameAssignments.insert(script.substr(i, end - i));
+					nextNameRight = assignment;
+				}
+				else
+					nextNameRight = end; //Any name starting before end also ends there and isn't assigned to either, skipping them keeps this linear
+			}
 		}
-	};
+	}
 
-	aliasSearcher(assignmentOperatorLeftMatcher,		[](std::string alias) { return false; }); //operators are never allowed
-	aliasSearcher(assignmentOperatorRightMatcher,		[](std::string alias) { return false; });
-	aliasSearcher(assignmentWhiteListedLeftMatcher,		[](std::string alias) { return functionWhiteList.count(alias) == 0; }); //only allowed when the token being assigned to is not in whitelist
-	aliasSearcher(assignmentWhiteListedRightMatcher,	[](std::string alias) { return functionWhiteList.count(alias) == 0; });
+	return found;
+}
 
-	//Log::log() << std::flush;
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(std::string const & script)
+{
+	std::set<std::string> blackListedFunctionsFound;
 
-	return illegalAliasesFound;
+	for(const std::string & foundFunction : scanScript(script).functions)
+		if(functionWhiteList.count(foundFunction) == 0)
+			blackListedFunctionsFound.insert(foundFunction);
+
+	return blackListedFunctionsFound;
 }
 
-void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(std::string const & script)
 {
-    std::string commentFree = stringUtils::stripRComments(script);
+	ScanResult				found				= scanScript(script);
+	std::set<std::string>	illegalAliasesFound	= found.operatorAliases; //operators are never allowed
 
-	static std::string errorMsg;
+	for(const std::string & alias : found.nameAssignments)
+		if(functionWhiteList.count(alias) > 0) //only allowed when the token being assigned to is not in whitelist
+			illegalAliasesFound.insert(alias);
+
+	return illegalAliasesFound;
+}
+
+std::unordered_map<std::string, std::string>	R_FunctionWhiteList::verdictCache;
+std::deque<std::string>							R_FunctionWhiteList::verdictCacheOrder;
+size_t											R_FunctionWhiteList::verdictCacheBytes		= 0;
+std::mutex										R_FunctionWhiteList::verdictCacheLock;
+const size_t									R_FunctionWhiteList::verdictCacheMaxEntries	= 64,
+												R_FunctionWhiteList::verdictCacheMaxBytes	= 4 * 1024 * 1024;
+
+std::string R_FunctionWhiteList::verdict(const std::string & script)
+{
+	std::string commentFree = stringUtils::stripRComments(script);
 
 	std::set<std::string> blackListedFunctions = findIllegalFunctions(commentFree);
 
@@ -342,9 +484,8 @@ void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 		ssm << "Non-whitelisted function" << (moreThanOne ? "s" : "") << " used:" << (moreThanOne ? "\n" : " ");
 		for(auto & black : blackListedFunctions)
 			ssm << black << "\n";
-		errorMsg = ssm.str();
 
-		throw filterException(errorMsg);
+		return ssm.str();
 	}
 
 	std::set<std::string> illegalAliasesFound = findIllegalFunctionsAliases(commentFree);
@@ -356,8 +497,53 @@ void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 		ssm << "Illegal assignment to " << (moreThanOne ? "operators or whitelisted functions" : "an operator or whitelisted function") << " used:" << (moreThanOne ? "\n" : " ");
 		for(auto & alias : illegalAliasesFound)
 			ssm << alias << "\n";
-		errorMsg = ssm.str();
 
-		throw filterException(errorMsg);
+		return ssm.str();
 	}
+
+	return "";
+}
+
+void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
+{
+	std::string errorMsg;
+	bool		cached = false;
+
+	{
+		std::lock_guard<std::mutex> lock(verdictCacheLock);
+
+		auto cachedVerdict = verdictCache.find(script);
+		if(cachedVerdict != verdictCache.end())
+		{
+			errorMsg	= cachedVerdict->second;
+			cached		= true;
+		}
+	}
+
+	if(!cached)
+	{
+		errorMsg = verdict(script);
+
+		if(script.size() <= verdictCacheMaxBytes)
+		{
+			std::lock_guard<std::mutex> lock(verdictCacheLock);
+
+			if(verdictCache.count(script) == 0)
+			{
+				while(verdictCacheOrder.size() >= verdictCacheMaxEntries || (verdictCacheOrder.size() && verdictCacheBytes + script.size() > verdictCacheMaxBytes))
+				{
+					verdictCacheBytes -= verdictCacheOrder.front().size();
+					verdictCache.erase(verdictCacheOrder.front());
+					verdictCacheOrder.pop_front();
+				}
+
+				verdictCache[script] = errorMsg;
+				verdictCacheOrder.push_back(script);
+				verdictCacheBytes += script.size();
+			}
+		}
+	}
+
+	if(errorMsg != "")
+		throw filterException(errorMsg);
 }
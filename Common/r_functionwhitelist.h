@@ -2,8 +2,11 @@
 #define R_FUNCTIONWHITELIST_H
 
 #include <set>
-#include <regex>
+#include <deque>
+#include <mutex>
 #include <sstream>
+#include <stdexcept>
+#include <unordered_map>
 
 ///New exception to give feedback about possibly failing filters and such
 class filterException : public std::logic_error
@@ -24,8 +27,26 @@ class R_FunctionWhiteList
 private:
 	///The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a attack-vector (which doesn't refer to an R-datatype).
 	static const std::set<std::string> functionWhiteList;
-	static const std::string functionPrecedingCharacter, functionStartDelimit, functionNameStart, functionNameBody, operatorsR;
-	static const std::regex functionNameMatcher, functionNamePrecederMatcher, assignmentWhiteListedRightMatcher, assignmentWhiteListedLeftMatcher, assignmentOperatorRightMatcher, assignmentOperatorLeftMatcher;
+
+	///What was found in a script by scanScript, a single pass that replaces the regexes this class used before.
+	struct ScanResult
+	{
+		std::set<std::string>	functions,			///< Everything that is called as a function, whitelisted or not
+								operatorAliases,	///< Backticked operators that are assigned to, like "`+` <- ..."
+								nameAssignments;	///< Names that are assigned to, like "mean <- ..." or "... -> mean"
+	};
+
+	static ScanResult scanScript(const std::string & commentFree);
+
+	///Scripts that were checked already, with the message of the filterException they cause or "" when safe. Filters get checked on every evaluation so this saves redoing it.
+	static std::unordered_map<std::string, std::string>	verdictCache;
+	static std::deque<std::string>						verdictCacheOrder;
+	static size_t										verdictCacheBytes;
+	static std::mutex									verdictCacheLock;
+	static const size_t									verdictCacheMaxEntries,
+														verdictCacheMaxBytes;
+
+	static std::string verdict(const std::string & script);
 
 public:
 	///throws a filterexception if the script is not legal for some reason
@@ -27,6 +27,7 @@
 #include <cmath>
 #include "columnutils.h"
 #include "log.h"
+#include "json/json.h"
 
 using namespace boost::interprocess;
 using namespace boost;
@@ -38,6 +39,8 @@ int Column::count = 0;
 
 Column &Column::operator=(const Column &column)
 {
+	_fingerprintValid = false;
+
 	if (&column != this)
 	{
 		this->_name = column._name;
@@ -52,6 +55,8 @@ Column &Column::operator=(const Column &column)
 
 Labels &Column::labels()
 {
+	_fingerprintValid = false; //Whoever asks for the labels like this might change them
+
 	return _labels;
 }
 
@@ -74,12 +79,11 @@ void Column::_convertVectorIntToDouble(vector<int> &intValues, vector<double> &d
 
 }
 
-bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
+bool Column::_resetEmptyValuesForNominal(const ColumnEmptyValues & original, ColumnEmptyValues & result)
 {
 	bool hasChanged = false;
-	std::map<int, string> emptyValuesMapOrg = emptyValuesMap;
 	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
+	bool hasEmptyValues = !original.empty();
 	bool changeToNominalText = false;
 	Ints::iterator ints = AsInts.begin();
 	Ints::iterator end = AsInts.end();
@@ -91,10 +95,9 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 		int intValue = *ints;
 		if (intValue == std::numeric_limits<int>::lowest() && hasEmptyValues)
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
+			if (original.has(row))
 			{
-				string orgValue = search->second;
+				const string & orgValue = original.at(row);
 				if (!ColumnUtils::isEmptyValue(orgValue))
 				{
 					// This value is not empty anymore
@@ -103,7 +106,6 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 						*ints = intValue;
 						uniqueValues.insert(intValue);
 						hasChanged = true;
-						emptyValuesMap.erase(search);
 					}
 					else
 					{
@@ -113,6 +115,8 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 						break;
 					}
 				}
+				else
+					result.insert(row, orgValue);
 			}
 		}
 		else if (intValue != std::numeric_limits<int>::lowest() && ColumnUtils::isEmptyValue(intValue))
@@ -123,7 +127,7 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 			hasChanged = true;
 			std::ostringstream strs;
 			strs << intValue;
-			emptyValuesMap.insert(make_pair(row, strs.str()));
+			result.insert(row, strs.str());
 		}
 		row++;
 	}
@@ -131,9 +135,8 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 	if (changeToNominalText)
 	{
 		setColumnType(columnType::nominalText);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(emptyValuesMapOrg.begin(), emptyValuesMapOrg.end());
-		hasChanged = _resetEmptyValuesForNominalText(emptyValuesMap, false);
+		result.clear();
+		hasChanged = _resetEmptyValuesForNominalText(original, result, false);
 	}
 	else if (hasChanged)
 		_labels.syncInts(uniqueValues);
@@ -141,11 +144,11 @@ bool Column::_resetEmptyValuesForNominal(std::map<int, string> &emptyValuesMap)
 	return hasChanged;
 }
 
-bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
+bool Column::_resetEmptyValuesForScale(const ColumnEmptyValues & original, ColumnEmptyValues & result)
 {
 	bool hasChanged = false;
 	int row = 0;
-	bool hasEmptyValues = !emptyValuesMap.empty();
+	bool hasEmptyValues = !original.empty();
 	bool changeToNominalText = false;
 	Doubles::iterator doubles = AsDoubles.begin();
 	Doubles::iterator end = AsDoubles.end();
@@ -155,10 +158,9 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 		double doubleValue = *doubles;
 		if (std::isnan(doubleValue) && hasEmptyValues)
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
+			if (original.has(row))
 			{
-				string orgValue = search->second;
+				const string & orgValue = original.at(row);
 				if (!ColumnUtils::isEmptyValue(orgValue))
 				{
 					// This value is not empty anymore
@@ -173,6 +175,8 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 						break;
 					}
 				}
+				else
+					result.insert(row, orgValue);
 			}
 		}
 		else if (!std::isnan(doubleValue) && ColumnUtils::isEmptyValue(doubleValue))
@@ -180,13 +184,16 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 			// This value is now considered as empty
 			*doubles = NAN;
 			hasChanged = true;
-			emptyValuesMap.insert(make_pair(row, Utils::doubleToString(doubleValue)));
+			result.insert(row, Utils::doubleToString(doubleValue));
 		}
 		row++;
 	}
 
 	if (changeToNominalText)
 	{
+		// The rows from where we stopped onwards still need their original values
+		original.forEach([&](size_t orgRow, const string & orgValue) { if (int(orgRow) >= row) result.insert(orgRow, orgValue); });
+
 		// Cannot use _resetEmptyValuesForNominalText since the AsInts are not set.
 		// So use setColumnAsNominalText
 		vector<string> values;
@@ -195,18 +202,7 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 		{
 			double doubleValue = *doubles;
 			if (std::isnan(doubleValue))
-			{
-				auto search = emptyValuesMap.find(row);
-				if (search != emptyValuesMap.end())
-				{
-					string orgValue = search->second;
-					values.push_back(orgValue);
-				}
-				else
-				{
-					values.push_back("");
-				}
-			}
+				values.push_back(result.at(row)); //at gives "" if there is no original value
 			else
 			{
 				std::ostringstream strValue;
@@ -215,9 +211,7 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 			}
 			row++;
 		}
-		map<int, string> newEmptyValues = setColumnAsNominalText(values);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(newEmptyValues.begin(), newEmptyValues.end());
+		result = setColumnAsNominalText(values);
 		hasChanged = true;
 	}
 
@@ -225,11 +219,11 @@ bool Column::_resetEmptyValuesForScale(std::map<int, string> &emptyValuesMap)
 }
 
 //This function is pretty hard to read...
-bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesMap, bool tryToConvert)
+bool Column::_resetEmptyValuesForNominalText(const ColumnEmptyValues & original, ColumnEmptyValues & result, bool tryToConvert)
 {
 	bool				hasChanged		= false;
 	int					row				= 0;
-	bool				hasEmptyValues	= !emptyValuesMap.empty();
+	bool				hasEmptyValues	= !original.empty();
 	Ints::iterator		ints			= AsInts.begin();
 	Ints::iterator		end				= AsInts.end();
 	vector<string>		values;
@@ -246,10 +240,10 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 
 		if (key == std::numeric_limits<int>::lowest() && hasEmptyValues)
 		{
-			auto search = emptyValuesMap.find(row);
-			if (search != emptyValuesMap.end())
+			if (original.has(row))
 			{
-				string orgValue = search->second;
+				const string &	orgValue	= original.at(row);
+				bool			keepIt		= true;
 				values.push_back(orgValue);
 
 				if (!ColumnUtils::isEmptyValue(orgValue))
@@ -278,7 +272,7 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 									uniqueIntValues.insert(intValue);
 									intLabels.insert(make_pair(intValue, orgValue));
 								}
-								emptyValuesMap.erase(search);
+								keepIt = false;
 							}
 							else
 							{
@@ -298,7 +292,7 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 							if (ColumnUtils::getDoubleValue(orgValue, doubleValue))
 							{
 								doubleValues.push_back(doubleValue);
-								emptyValuesMap.erase(search);
+								keepIt = false;
 							}
 							else
 							{
@@ -307,8 +301,11 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 						}
 					}
 				}
+
+				if (keepIt)
+					result.insert(row, orgValue);
 			}
-			else //if we couldnt find the "row" in the emptyValuesMap?
+			else //if we couldnt find the "row" in the original empty values?
 			{
 				values.push_back("");
 
@@ -334,12 +331,12 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 				if (canBeConvertedToIntegers)
 				{
 					intValues.push_back(std::numeric_limits<int>::lowest());
-					emptyValuesMap.insert(make_pair(row, orgValue));
+					result.insert(row, orgValue);
 				}
 				else if (canBeConvertedToDoubles)
 				{
 					doubleValues.push_back(NAN);
-					emptyValuesMap.insert(make_pair(row, orgValue));
+					result.insert(row, orgValue);
 				}
 			}
 			else
@@ -419,25 +416,48 @@ bool Column::_resetEmptyValuesForNominalText(std::map<int, string> &emptyValuesM
 		hasChanged = true;
 	}
 	else if (hasChanged)
-	{
-		map<int, string> newEmptyValues = setColumnAsNominalText(values);
-		emptyValuesMap.clear();
-		emptyValuesMap.insert(newEmptyValues.begin(), newEmptyValues.end());
-	}
+		result = setColumnAsNominalText(values);
 
 	return hasChanged;
 
 }
 
-bool Column::resetEmptyValues(std::map<int, string> &emptyValuesMap)
+///Re-evaluates which values are empty according to ColumnUtils::getEmptyValues(), emptyValues is replaced by the original values of the rows that are empty now.
+bool Column::resetEmptyValues(ColumnEmptyValues & emptyValues)
 {
+	_fingerprintValid = false;
+
+	if (_columnType == columnType::nominal || _columnType == columnType::ordinal)
+	{
+		// Nominal columns only change if one of their (integer) labels became empty or one of the originals did not, checking that doesn't require going through all rows.
+		bool somethingMightChange = emptyValues.anyOriginal([](const string & orgValue) { return !ColumnUtils::isEmptyValue(orgValue); });
+
+		if (!somethingMightChange)
+			for (int intValue : _labels.getIntValues())
+				if (ColumnUtils::isEmptyValue(intValue))
+				{
+					somethingMightChange = true;
+					break;
+				}
+
+		if (!somethingMightChange)
+			return false;
+	}
+
+	ColumnEmptyValues	result;
+	bool				hasChanged;
+
 	switch(_columnType)
 	{
 	case columnType::ordinal:
-	case columnType::nominal:	return _resetEmptyValuesForNominal(emptyValuesMap);
-	case columnType::scale:		return _resetEmptyValuesForScale(emptyValuesMap);
-	default:					return _resetEmptyValuesForNominalText(emptyValuesMap);
+	case columnType::nominal:	hasChanged = _resetEmptyValuesForNominal(		emptyValues, result);	break;
+	case columnType::scale:		hasChanged = _resetEmptyValuesForScale(			emptyValues, result);	break;
+	default:					hasChanged = _resetEmptyValuesForNominalText(	emptyValues, result);	break;
 	}
+
+	emptyValues = std::move(result);
+
+	return hasChanged;
 }
 
 void Column::setSharedMemory(managed_shared_memory *mem)
@@ -588,24 +608,235 @@ columnTypeChangeResult Column::_changeColumnToScale()
 
 columnTypeChangeResult Column::changeColumnType(enum columnType newColumnType)
 {
+	_fingerprintValid = false;
+
 	if (newColumnType == _columnType)		return columnTypeChangeResult::changed;
 	if (newColumnType == columnType::scale)	return _changeColumnToScale();
 											return _changeColumnToNominalOrOrdinal(newColumnType);
 }
 
-bool Column::overwriteDataWithScale(std::vector<double> scalarData)
+bool Column::overwriteDataWithScale(const std::vector<double> & scalarData)
+{
+	return overwriteDataWithScale(scalarData.data(), scalarData.size()).changed();
+}
+
+ColumnChanges Column::overwriteDataWithScale(const double * scalarData, size_t length)
+{
+	ColumnChanges changes;
+
+	changes.type	= _columnType != columnType::scale;
+
+	_labelsChanged(_labelsByKey(), LabelsByKey(), changes);
+	_labels.clear();
+	_overwriteDoubles(scalarData, length, changes);
+
+	setColumnType(columnType::scale);
+
+	return changes;
+}
+
+ColumnChanges Column::overwriteDataWithNominalOrOrdinal(const int * intData, size_t length, const std::map<int, std::string> & levels, bool isOrdinal)
+{
+	_fingerprintValid = false;
+
+	ColumnChanges		changes;
+	std::map<int, int>	levelInts;
+	std::set<int>		uniqueValues;
+	const LabelsByKey	labelsBefore = _labelsByKey();
+
+	changes.type = _columnType != (isOrdinal ? columnType::ordinal : columnType::nominal);
+
+	for(const auto & keyval : levels)
+	{
+		size_t convertedChars;
+
+		try
+		{
+			int asInt = std::stoi(keyval.second, &convertedChars);
+
+			if(convertedChars == keyval.second.size()) //It was a number!
+				levelInts[keyval.first] = asInt;
+		}
+		catch(std::invalid_argument &)	{}
+		catch(std::out_of_range &)		{}
+	}
+
+	bool levelsAreInts = levelInts.size() == levels.size();
+
+	_overwriteInts(intData, length, levelsAreInts ? &levelInts : nullptr, uniqueValues, changes);
+
+	if(levelsAreInts)
+		_labels.syncInts(uniqueValues);
+	else
+	{
+		std::map<int, std::string> labels = levels;
+
+		for(int value : uniqueValues)
+			if(labels.count(value) == 0)
+			{
+				Log::log() << "Setting column '" << name() << "' data to " << (isOrdinal ? "ordinal" : "nominal") << " but it was missing a label for value " << value << ", adding it as label." << std::endl;
+				labels[value] = std::to_string(value);
+			}
+
+		_labels.syncInts(labels);
+	}
+
+	_labelsChanged(labelsBefore, _labelsByKey(), changes);
+
+	setColumnType(isOrdinal ? columnType::ordinal : columnType::nominal);
+
+	return changes;
+}
+
+ColumnChanges Column::overwriteDataWithNominalText(const std::vector<std::string> & nominalData)
+{
+	_fingerprintValid = false;
+
+	ColumnChanges changes;
+
+	if(nominalData.size() > rowCount())	_setColumnAsNominalText(std::vector<std::string>(nominalData.begin(), nominalData.begin() + rowCount()),	std::map<std::string, std::string>(), changes);
+	else								_setColumnAsNominalText(nominalData,																		std::map<std::string, std::string>(), changes);
+
+	return changes;
+}
+
+void Column::_overwriteDoubles(const double * values, size_t length, ColumnChanges & changes)
+{
+	_fingerprintValid = false;
+
+	size_t row = 0;
+
+	for(BlockEntry & entry : _blocks)
+	{
+		DataBlock	*	block		= entry.second.get();
+		const size_t	blockRows	= std::min(size_t(block->rowCount()), _rowCount - row);
+
+		for(size_t i=0; i<blockRows; i++, row++)
+		{
+			double		value	= row < length ? values[row] : static_cast<double>(std::nanf(""));
+			double	&	old		= block->Data[i].d;
+
+			//nan != nan, so two missing values are only equal when checked like this
+			if(std::isnan(old) != std::isnan(value) || (!std::isnan(value) && old != value))
+				changes.rowChanged(row);
+
+			old = value;
+		}
+
+		if(row == _rowCount)
+			break;
+	}
+}
+
+void Column::_overwriteInts(const int * values, size_t length, const std::map<int, int> * recode, std::set<int> & uniqueValues, ColumnChanges & changes)
 {
-	labels().clear();
+	_fingerprintValid = false;
+
+	const int	missing		= std::numeric_limits<int>::lowest();
+	size_t		row			= 0;
+	int			lastUnique	= missing;
+
+	for(BlockEntry & entry : _blocks)
+	{
+		DataBlock	*	block		= entry.second.get();
+		const size_t	blockRows	= std::min(size_t(block->rowCount()), _rowCount - row);
 
-	size_t setVals = scalarData.size();
+		for(size_t i=0; i<blockRows; i++, row++)
+		{
+			int		value	= row < length ? values[row] : missing;
+			int	&	old		= block->Data[i].i;
 
-	if(scalarData.size() != rowCount())
-		scalarData.resize(rowCount());
+			if(recode && value != missing)
+			{
+				auto recoded = recode->find(value);
+				if(recoded != recode->end())
+					value = recoded->second;
+			}
+
+			if(value != missing && value != lastUnique)
+			{
+				uniqueValues.insert(value);
+				lastUnique = value;
+			}
 
-	for(size_t setThis = setVals; setThis<scalarData.size(); setThis++)
-		scalarData[setThis] = static_cast<double>(std::nanf(""));
+			if(old != value)
+				changes.rowChanged(row);
 
-	return setColumnAsScale(scalarData);
+			old = value;
+		}
+
+		if(row == _rowCount)
+			break;
+	}
+}
+
+Column::LabelsByKey Column::_labelsByKey() const
+{
+	LabelsByKey byKey;
+
+	for(const Label & label : _labels)
+		byKey[label.value()] = { label.hasIntValue(), label.text() };
+
+	return byKey;
+}
+
+void Column::_labelsChanged(const LabelsByKey & before, const LabelsByKey & after, ColumnChanges & changes)
+{
+	for(const auto & keyLabel : before)
+	{
+		auto stillThere = after.find(keyLabel.first);
+		if(stillThere == after.end() || stillThere->second != keyLabel.second)
+			changes.labels.insert(keyLabel.first);
+	}
+
+	for(const auto & keyLabel : after)
+		if(before.count(keyLabel.first) == 0)
+			changes.labels.insert(keyLabel.first);
+}
+
+Json::Value ColumnChanges::toJson(size_t maxRuns) const
+{
+	Json::Value json(Json::objectValue), labelsJson(Json::arrayValue);
+
+	json["rows"]	= Json::UInt64(rows.rows);
+	json["type"]	= type;
+
+	if(!allRows && rows.runs.size() <= maxRuns)
+	{
+		Json::Value runsJson(Json::arrayValue);
+
+		for(const ChangedRows::Run & run : rows.runs)
+		{
+			runsJson.append(Json::UInt64(run.first));
+			runsJson.append(Json::UInt64(run.count));
+		}
+
+		json["runs"] = runsJson;
+	}
+
+	for(int key : labels)
+		labelsJson.append(key);
+
+	json["labels"] = labelsJson;
+
+	return json;
+}
+
+ColumnChanges ColumnChanges::fromJson(const Json::Value & json)
+{
+	ColumnChanges changes;
+
+	changes.type		= json.get("type", false).asBool();
+	changes.allRows		= !json.isMember("runs");
+	changes.rows.rows	= json.get("rows", 0).asUInt64();
+
+	for(Json::ArrayIndex i=0; i + 1 < json["runs"].size(); i+=2)
+		changes.rows.runs.push_back({ json["runs"][i].asUInt64(), json["runs"][i + 1].asUInt64() });
+
+	for(const Json::Value & key : json["labels"])
+		changes.labels.insert(key.asInt());
+
+	return changes;
 }
 
 bool Column::overwriteDataWithOrdinal(std::vector<int> ordinalData, std::map<int, std::string> levels)
@@ -662,17 +893,13 @@ bool Column::overwriteDataWithNominal(std::vector<int> nominalData)
 
 bool Column::overwriteDataWithNominal(std::vector<std::string> nominalData)
 {
-	if(nominalData.size() != rowCount())
-		nominalData.resize(rowCount());
-
-	bool changedSomething = false;
-	setColumnAsNominalText(nominalData, &changedSomething);
-
-	return changedSomething;
+	return overwriteDataWithNominalText(nominalData).changed();
 }
 
 void Column::setDefaultValues(enum columnType columnType)
 {
+	_fingerprintValid = false;
+
 	if(columnType == columnType::unknown)
 		columnType = _columnType;
 
@@ -700,6 +927,8 @@ bool Column::setColumnAsNominalOrOrdinal(const std::vector<int> &values, bool is
 
 bool Column::setColumnAsNominalOrOrdinal(const vector<int> &values, map<int, string> uniqueValues, bool is_ordinal)
 {
+	_fingerprintValid = false;
+
 	std::set<int> uniqueValuesData(values.begin(), values.end());
 	uniqueValuesData.erase(std::numeric_limits<int>::lowest());
 	
@@ -725,6 +954,8 @@ bool Column::setColumnAsNominalOrOrdinal(const vector<int> &values, map<int, str
 
 bool Column::_setColumnAsNominalOrOrdinal(const vector<int> &values, bool is_ordinal)
 {
+	_fingerprintValid = false;
+
 	Ints::iterator	intInputItr			= AsInts.begin();
 	size_t			nb_values			= 0;
 	bool			changedSomething	= false;
@@ -760,6 +991,8 @@ bool Column::_setColumnAsNominalOrOrdinal(const vector<int> &values, bool is_ord
 
 bool Column::setColumnAsScale(const std::vector<double> &values)
 {
+	_fingerprintValid = false;
+
 	bool changedSomething = false;
 	//_labels.clear(); //Don't clear the labels otherwise they will be lost if we do something like ordinal -> scale -> ordinal
 	Doubles::iterator doubleInputItr = AsDoubles.begin();
@@ -793,17 +1026,27 @@ bool Column::setColumnAsScale(const std::vector<double> &values)
 	return changedSomething;
 }
 
-std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething)
+ColumnEmptyValues Column::setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething)
 {
 	return setColumnAsNominalText(values, std::map<std::string, std::string>(), changedSomething);
 }
 
-std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, bool * changedSomething)
+ColumnEmptyValues Column::setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, bool * changedSomething)
 {
+	ColumnChanges		changes;
+	ColumnEmptyValues	emptyValues = _setColumnAsNominalText(values, labels, changes);
+
 	if(changedSomething != nullptr)
-		*changedSomething = false;
+		*changedSomething = changes.changed();
+
+	return emptyValues;
+}
+
+ColumnEmptyValues Column::_setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string>&labels, ColumnChanges & changes)
+{
+	_fingerprintValid = false;
 
-	std::map<int, std::string>	emptyValuesMap;
+	ColumnEmptyValues			emptyValues;
 	std::set<std::string>		cases(values.begin(), values.end());
 	std::vector<std::string>	sortedCases(cases.begin(), cases.end());
 
@@ -811,49 +1054,56 @@ std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std:
 
 	sortedCases.erase(std::remove_if(sortedCases.begin(),	sortedCases.end(), [](std::string x){	return ColumnUtils::isEmptyValue(x);}), sortedCases.end());
 
-	std::map<std::string, int> map = _labels.syncStrings(sortedCases, labels, changedSomething);
+	changes.type = _columnType != columnType::nominalText;
+
+	const LabelsByKey			labelsBefore	= _labelsByKey();
+	std::map<std::string, int>	map				= _labels.syncStrings(sortedCases, labels, nullptr);
+
+	_labelsChanged(labelsBefore, _labelsByKey(), changes);
 
 	auto	intInputItr = AsInts.begin();
-	int		nb_values	= 0;
+	size_t	nb_values	= 0;
 
 	for(const std::string &value : values)
 	{
 		if(intInputItr == AsInts.end())
 			throw std::runtime_error("Column::setColumnAsNominalText ran out of Ints in assigning..");
 
+		int key = std::numeric_limits<int>::lowest();
+
 		if (ColumnUtils::isEmptyValue(value))
 		{
-			if(changedSomething != nullptr && *intInputItr != std::numeric_limits<int>::lowest())
-				*changedSomething = true;
-
-			*intInputItr = std::numeric_limits<int>::lowest();
 			if (!value.empty())
-				emptyValuesMap.insert(make_pair(nb_values, value));
+				emptyValues.insert(nb_values, value);
 		}
 		else
 		{
-			if (map.find(value) == map.end())
+			auto found = map.find(value);
+
+			if (found == map.end())
 			{
 				std::string allLabels;
 				for (auto const& imap: map)
 					allLabels += imap.first + ", ";
 				throw std::runtime_error("Error when reading column " + name() + ": cannot convert value " + value + " to Nominal Text (all labels: " + allLabels + ")");
 			}
-			
-			if(changedSomething != nullptr && *intInputItr != map[value])
-				*changedSomething = true;
 
-			*intInputItr = map[value];
+			key = found->second;
 		}
 
+		if(*intInputItr != key)
+			changes.rowChanged(nb_values);
+
+		*intInputItr = key;
+
 		intInputItr++;
 		nb_values++;
 	}
 
 	while (nb_values < _rowCount)
 	{
-		if(changedSomething != nullptr && *intInputItr != std::numeric_limits<int>::lowest())
-			*changedSomething = true;
+		if(*intInputItr != std::numeric_limits<int>::lowest())
+			changes.rowChanged(nb_values);
 
 		*intInputItr = std::numeric_limits<int>::lowest();
 		intInputItr++;
@@ -862,7 +1112,7 @@ std::map<int, std::string> Column::setColumnAsNominalText(const std::vector<std:
 
 	setColumnType(columnType::nominalText);
 
-	return emptyValuesMap;
+	return emptyValues;
 }
 
 string Column::_getLabelFromKey(int key) const
@@ -904,6 +1154,8 @@ void Column::setName(string name)
 
 void Column::setValue(int row, int value)
 {
+	_fingerprintValid = false;
+
 	BlockMap::iterator itr = _blocks.upper_bound(row);
 
 	if (itr == _blocks.end())
@@ -921,6 +1173,8 @@ void Column::setValue(int row, int value)
 
 void Column::setValue(int row, double value)
 {
+	_fingerprintValid = false;
+
 	BlockMap::iterator itr = _blocks.upper_bound(row);
 
 	if (itr == _blocks.end())
@@ -936,6 +1190,71 @@ void Column::setValue(int row, double value)
 	block->Data[blockIndex].d = value;
 }
 
+void Column::setValues(size_t firstRow, const std::vector<double> & values)
+{
+	for(size_t i=0; i<values.size() && firstRow + i < _rowCount; i++)
+		setValue(int(firstRow + i), values[i]);
+}
+
+bool Column::setValues(size_t firstRow, const std::vector<int> & values)
+{
+	std::set<int>	known	= _labels.getIntValues();
+	bool			added	= false;
+
+	for(size_t i=0; i<values.size() && firstRow + i < _rowCount; i++)
+	{
+		int value = values[i];
+
+		if(value != std::numeric_limits<int>::lowest() && known.insert(value).second)
+		{
+			_labels.add(value);
+			added = true;
+		}
+
+		setValue(int(firstRow + i), value);
+	}
+
+	return added;
+}
+
+bool Column::setValues(size_t firstRow, const std::vector<std::string> & values)
+{
+	std::map<std::string, int>	keys;
+	int							maxKey	= 0;
+	bool						added	= false;
+
+	for(size_t l=0; l<_labels.size(); l++)
+	{
+		int key = _labels[l].value();
+
+		keys[_labels.getValueFromRow(l)]	= key;
+		maxKey								= std::max(maxKey, key);
+	}
+
+	for(size_t i=0; i<values.size() && firstRow + i < _rowCount; i++)
+	{
+		const std::string	&	value	= values[i];
+		int						key		= std::numeric_limits<int>::lowest();
+
+		if(!ColumnUtils::isEmptyValue(value))
+		{
+			auto found = keys.find(value);
+
+			if(found != keys.end())
+				key = found->second;
+			else
+			{
+				key = keys[value] = _labels.add(++maxKey, value, true);
+				added = true;
+			}
+		}
+
+		setValue(int(firstRow + i), key);
+	}
+
+	return added;
+}
+
 bool Column::isValueEqual(int row, double value)
 {
 	if (row >= _rowCount)
@@ -1005,7 +1324,7 @@ bool Column::isValueEqual(int row, const string &value)
 		default:
 		{
 			int key = AsInts[row];
-			return key == std::numeric_limits<int>::lowest() ? ColumnUtils::isEmptyValue(value) : (value.substr(0, 128) == _labels.getValueFromKey(key));
+			return key == std::numeric_limits<int>::lowest() ? ColumnUtils::isEmptyValue(value) : (value == _labels.getValueFromKey(key));
 		}
 	}
 
@@ -1068,6 +1387,8 @@ string Column::operator [](int row)
 
 void Column::append(int rows)
 {
+	_fingerprintValid = false;
+
 	if (rows == 0)
 		return;
 
@@ -1129,6 +1450,8 @@ void Column::append(int rows)
 
 void Column::truncate(int rows)
 {
+	_fingerprintValid = false;
+
 	if (rows <= 0) return;
 
 	BlockMap::reverse_iterator itr = _blocks.rbegin();
@@ -1170,11 +1493,15 @@ void Column::truncate(int rows)
 
 void Column::setColumnType(enum columnType columnType)
 {
+	_fingerprintValid = false;
+
 	_columnType = columnType;
 }
 
 void Column::_setRowCount(int rowCount)
 {
+	_fingerprintValid = false;
+
 	if (rowCount > this->rowCount())
 		append(rowCount - this->rowCount());
 	else if (rowCount < this->rowCount())
@@ -1387,4 +1714,36 @@ bool Column::isColumnDifferentFromStringValues(std::vector<std::string> strVals)
 	return false;
 }
 
+uint64_t Column::valuesFingerprint()
+{
+	if(_fingerprintValid)
+		return _fingerprint;
+
+	columnType	type	= getColumnType();
+	size_t		rows	= rowCount();
+	uint64_t	hash	= ColumnUtils::hashBytes(&type, sizeof(columnType));
+				hash	= ColumnUtils::hashBytes(&rows, sizeof(size_t), hash);
+
+	if(type == columnType::scale)
+		for(double value : AsDoubles)
+			hash = ColumnUtils::hashBytes(&value, sizeof(double), hash);
+	else
+	{
+		for(int value : AsInts)
+			hash = ColumnUtils::hashBytes(&value, sizeof(int), hash);
+
+		for(const Label & label : _labels)
+		{
+			int			key		= label.value();
+			std::string	orgVal	= _labels.getValueFromKey(key);
+
+			hash = ColumnUtils::hashBytes(&key,				sizeof(int),	hash);
+			hash = ColumnUtils::hashBytes(orgVal.data(),	orgVal.size(),	hash);
+		}
+	}
+
+	_fingerprint		= hash;
+	_fingerprintValid	= true;
 
+	return hash;
+}
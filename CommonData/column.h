@@ -27,9 +27,54 @@
 
 #include "datablock.h"
 #include "labels.h"
+#include "columnemptyvalues.h"
 
 #include "columntype.h"
 
+namespace Json { class Value; }
+
+///
+/// Which rows changed, as runs of consecutive rows, so that models can tell their views about exactly those instead of resetting.
+struct ChangedRows
+{
+	struct Run
+	{
+		size_t	first,
+				count;
+	};
+
+	std::vector<Run>	runs;
+	size_t				rows		= 0;
+
+	bool	changed()	const	{ return rows > 0; }
+
+	void	rowChanged(size_t row)
+	{
+		if(runs.size() && runs.back().first + runs.back().count == row)	runs.back().count++;
+		else															runs.push_back({ row, 1 });
+		rows++;
+	}
+
+	///When notifying per run costs more than simply starting over, like when the rows alternate or most of them changed
+	bool	tooScattered(size_t totalRows, size_t maxRuns = 256) const { return runs.size() > maxRuns || rows * 2 > totalRows; }
+};
+
+///
+/// What overwriting the data of a column changed, so that anything depending on the column only needs to be redone when something actually did, and views only need to redraw those rows and labels.
+struct ColumnChanges
+{
+	ChangedRows		rows;
+	std::set<int>	labels;				///< Keys of the labels that were added, removed, renamed or renumbered
+	bool			type		= false,
+					allRows		= false;	///< Which rows changed is not known, like when the runs were too many to send along
+
+	bool			changed()	const	{ return rows.changed() || allRows || labels.size() || type; }
+	void			rowChanged(size_t row)	{ rows.rowChanged(row); }
+
+	///Sends at most maxRuns runs, any more and the receiver gets allRows instead
+	Json::Value				toJson(size_t maxRuns = 256)	const;
+	static ColumnChanges	fromJson(const Json::Value & json);
+};
 
 ///
 /// This class contains the actual data for a column, stored as either as int (IntsStruct) or double (DoublesStruct)
@@ -59,10 +104,10 @@ public:
 	///ColumnType is set up to be used as bitflags in places such as assignedVariablesModel and such
 	//enum ColumnType { unknown = 0, nominal = 1, nominalText = 2, ordinal = 4, scale = 8 };
 
-	bool resetEmptyValues(std::map<int, std::string>& emptyValuesMap);
+	bool resetEmptyValues(ColumnEmptyValues & emptyValues);
 
 
-	bool overwriteDataWithScale(std::vector<double> scalarData);
+	bool overwriteDataWithScale(const std::vector<double> & scalarData);
 	bool overwriteDataWithOrdinal(std::vector<int> ordinalData, std::map<int, std::string> levels);
 	bool overwriteDataWithNominal(std::vector<int> nominalData, std::map<int, std::string> levels);
 	bool overwriteDataWithOrdinal(std::vector<int> ordinalData);
@@ -70,6 +115,11 @@ public:
 	bool overwriteDataWithNominal(std::vector<std::string> nominalData);
 	void setDefaultValues(columnType columnType = columnType::unknown);
 
+	///These write straight from the buffers of R into the blocks of the column, comparing each value with what was there. Rows past length become missing.
+	ColumnChanges	overwriteDataWithScale(				const double	* scalarData,	size_t length);
+	ColumnChanges	overwriteDataWithNominalOrOrdinal(	const int		* intData,		size_t length, const std::map<int, std::string> & levels, bool isOrdinal); ///< Levels that are all integers are stored as those integers, like the importers would
+	ColumnChanges	overwriteDataWithNominalText(		const std::vector<std::string> & nominalData);
+
 	typedef struct IntsStruct
 	{
 		friend class Column;
@@ -162,6 +212,11 @@ public:
 	void setValue(int row, int value);
 	void setValue(int row, double value);
 
+	///These write values into the rows from firstRow on, which must exist already, so that rows can be appended without rewriting the ones before them.
+	void setValues(size_t firstRow, const std::vector<double>		& values);
+	bool setValues(size_t firstRow, const std::vector<int>			& values);	///< Nominal or ordinal, values without a label get one, returns whether any were added
+	bool setValues(size_t firstRow, const std::vector<std::string>	& values);	///< NominalText, texts without a label get one, returns whether any were added
+
 	bool isValueEqual(int row, int value);
 	bool isValueEqual(int row, double value);
 	bool isValueEqual(int row, const std::string &value);
@@ -202,8 +257,8 @@ public:
 
 	bool						setColumnAsScale(const std::vector<double> &values);
 
-	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values,	const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
-	std::map<int, std::string>	setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething = NULL);
+	ColumnEmptyValues			setColumnAsNominalText(const std::vector<std::string> &values,	const std::map<std::string, std::string> &labels, bool * changedSomething = NULL);
+	ColumnEmptyValues			setColumnAsNominalText(const std::vector<std::string> &values, bool * changedSomething = NULL);
 
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,		std::map<int, std::string> uniqueValues,	bool is_ordinal = false);
 	bool						setColumnAsNominalOrOrdinal(const std::vector<int> &values,													bool is_ordinal = false);
@@ -216,9 +271,22 @@ public:
 
 	bool isColumnDifferentFromStringValues(std::vector<std::string> strVals);
 
+	///Hash over the type, the values and, for non-scale columns, the original label values. Cheap way to see whether anything changed since the last time it was taken.
+	///It is kept until something changes the column, so asking again for an unchanged column costs nothing.
+	uint64_t valuesFingerprint();
+
 private:	
 
 	bool		_setColumnAsNominalOrOrdinal(const std::vector<int> &values, bool is_ordinal = false);
+	ColumnEmptyValues	_setColumnAsNominalText(const std::vector<std::string> &values, const std::map<std::string, std::string> &labels, ColumnChanges & changes);
+
+	void		_overwriteDoubles(	const double	* values, size_t length,															ColumnChanges & changes);
+	void		_overwriteInts(		const int		* values, size_t length, const std::map<int, int> * recode, std::set<int> & uniqueValues,	ColumnChanges & changes);
+
+	typedef std::map<int, std::pair<bool, std::string>> LabelsByKey; ///< Whether it has an int value and the text, per label key
+
+	LabelsByKey	_labelsByKey() const;
+	static void	_labelsChanged(const LabelsByKey & before, const LabelsByKey & after, ColumnChanges & changes);
 
 	void		_setRowCount(int rowCount);
 	std::string	_getLabelFromKey(int key) const;
@@ -226,9 +294,9 @@ private:
 
 	void		_convertVectorIntToDouble(std::vector<int> &intValues, std::vector<double> &doubleValues);
 
-	bool		_resetEmptyValuesForNominal(std::map<int, std::string> &emptyValuesMap);
-	bool		_resetEmptyValuesForScale(std::map<int, std::string> &emptyValuesMap);
-	bool		_resetEmptyValuesForNominalText(std::map<int, std::string> &emptyValuesMap, bool tryToConvert = true);
+	bool		_resetEmptyValuesForNominal(		const ColumnEmptyValues & original, ColumnEmptyValues & result);
+	bool		_resetEmptyValuesForScale(			const ColumnEmptyValues & original, ColumnEmptyValues & result);
+	bool		_resetEmptyValuesForNominalText(	const ColumnEmptyValues & original, ColumnEmptyValues & result, bool tryToConvert = true);
 
 	columnTypeChangeResult	_changeColumnToNominalOrOrdinal(enum columnType newColumnType);
 	columnTypeChangeResult	_changeColumnToScale();
@@ -243,6 +311,9 @@ private:
 	BlockMap		_blocks;
 	Labels			_labels;
 
+	uint64_t		_fingerprint		= 0;
+	bool			_fingerprintValid	= false;	///< Every method that changes values, labels, type or rowcount clears this
+
 	int				_id;
 	static int		count;
 };
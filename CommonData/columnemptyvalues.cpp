@@ -0,0 +1,191 @@
+#include "columnemptyvalues.h"
+#include "json/json.h"
+#include <algorithm>
+
+const std::string & ColumnEmptyValues::at(size_t row) const
+{
+	static const std::string nothing;
+
+	return has(row) ? _strings[_tokens[rank(row)]] : nothing;
+}
+
+void ColumnEmptyValues::insert(size_t row, const std::string & original)
+{
+	insertToken(row, intern(original));
+}
+
+void ColumnEmptyValues::insertRun(size_t firstRow, size_t rowCount, const std::string & original)
+{
+	uint32_t id = intern(original);
+
+	for(size_t row = firstRow; row < firstRow + rowCount; row++)
+		insertToken(row, id);
+}
+
+void ColumnEmptyValues::insertToken(size_t row, uint32_t id)
+{
+	if(has(row))
+	{
+		_tokens[rank(row)] = id;
+		return;
+	}
+
+	size_t word = row / 64;
+
+	if(_bits.size() <= word)
+		_bits.resize(word + 1, 0);
+
+	size_t pos = row >= _endRow ? _tokens.size() : rank(row);
+
+	_tokens.insert(_tokens.begin() + pos, id);
+	_bits[word] |= uint64_t(1) << (row % 64);
+	_endRow = std::max(_endRow, row + 1);
+
+	invalidateRanksAfter(word);
+}
+
+void ColumnEmptyValues::erase(size_t row)
+{
+	if(!has(row))
+		return;
+
+	size_t word = row / 64;
+
+	_tokens.erase(_tokens.begin() + rank(row));
+	_bits[word] &= ~(uint64_t(1) << (row % 64));
+
+	invalidateRanksAfter(word);
+
+	if(row + 1 == _endRow)
+	{
+		_endRow = 0;
+		for(size_t w = word + 1; w > 0; w--)
+			if(_bits[w - 1])
+			{
+				_endRow = (w - 1) * 64 + (64 - std::countl_zero(_bits[w - 1]));
+				break;
+			}
+	}
+}
+
+void ColumnEmptyValues::clear()
+{
+	_bits		.clear();
+	_tokens		.clear();
+	_strings	.clear();
+	_stringIds	.clear();
+	_ranks		.clear();
+	_ranksValid	= 0;
+	_endRow		= 0;
+}
+
+uint32_t ColumnEmptyValues::intern(const std::string & original)
+{
+	auto found = _stringIds.find(original);
+
+	if(found != _stringIds.end())
+		return found->second;
+
+	uint32_t id = _strings.size();
+	_strings.push_back(original);
+	_stringIds[original] = id;
+
+	return id;
+}
+
+size_t ColumnEmptyValues::rank(size_t row) const
+{
+	size_t word = row / 64;
+
+	if(_ranks.size() < _bits.size())
+		_ranks.resize(_bits.size());
+
+	for(; _ranksValid <= word; _ranksValid++)
+		_ranks[_ranksValid] = _ranksValid == 0 ? 0 : _ranks[_ranksValid - 1] + std::popcount(_bits[_ranksValid - 1]);
+
+	return _ranks[word] + std::popcount(_bits[word] & ((uint64_t(1) << (row % 64)) - 1));
+}
+
+void ColumnEmptyValues::invalidateRanksAfter(size_t word)
+{
+	//The rank of a word only depends on the words before it
+	_ranksValid = std::min(_ranksValid, word + 1);
+}
+
+size_t ColumnEmptyValues::bytesUsed() const
+{
+	size_t total = sizeof(ColumnEmptyValues) + _bits.capacity() * sizeof(uint64_t) + _tokens.capacity() * sizeof(uint32_t) + _ranks.capacity() * sizeof(uint32_t);
+
+	for(const std::string & str : _strings)
+		total += sizeof(std::string) + str.capacity() + sizeof(std::pair<std::string, uint32_t>) + str.capacity(); //Once in _strings and once in _stringIds
+
+	return total;
+}
+
+bool ColumnEmptyValues::operator==(const ColumnEmptyValues & other) const
+{
+	if(size() != other.size())
+		return false;
+
+	std::vector<std::pair<size_t, const std::string *>> mine;
+	mine.reserve(size());
+	forEach([&](size_t row, const std::string & original) { mine.push_back({row, &original}); });
+
+	size_t	i		= 0;
+	bool	same	= true;
+	other.forEach([&](size_t row, const std::string & original) { same = same && mine[i].first == row && *mine[i].second == original; i++; });
+
+	return same;
+}
+
+Json::Value ColumnEmptyValues::toJson() const
+{
+	Json::Value	json		= Json::objectValue,
+				originals	= Json::arrayValue,
+				runs		= Json::arrayValue;
+
+	for (const std::string & original : _strings)
+		originals.append(original);
+
+	forEachRun([&](size_t firstRow, size_t rowCount, uint32_t original)
+	{
+		runs.append(Json::UInt(firstRow));
+		runs.append(Json::UInt(rowCount));
+		runs.append(Json::UInt(original));
+	});
+
+	json["originals"]	= originals;
+	json["runs"]		= runs;
+
+	return json;
+}
+
+ColumnEmptyValues ColumnEmptyValues::fromJson(const Json::Value & json)
+{
+	ColumnEmptyValues	emptyValues;
+	const Json::Value &	originals	= json["originals"],
+					&	runs		= json["runs"];
+
+	for (Json::ArrayIndex i = 0; i + 2 < runs.size(); i += 3)
+		if (runs[i + 2].asUInt() < originals.size())
+			emptyValues.insertRun(runs[i].asUInt(), runs[i + 1].asUInt(), originals[runs[i + 2].asUInt()].asString());
+
+	return emptyValues;
+}
+
+ColumnEmptyValues ColumnEmptyValues::fromLegacyJson(const Json::Value & json)
+{
+	std::vector<std::pair<size_t, std::string>> rows;
+
+	for (Json::Value::const_iterator row = json.begin(); row != json.end(); ++row)
+		rows.push_back(std::make_pair(std::stoul(row.key().asString()), (*row).asString()));
+
+	// The keys are sorted as strings ("10" before "2"), sorting them as rows makes every insert an append
+	std::sort(rows.begin(), rows.end(), [](const auto & l, const auto & r) { return l.first < r.first; });
+
+	ColumnEmptyValues emptyValues;
+	for (const auto & row : rows)
+		emptyValues.insert(row.first, row.second);
+
+	return emptyValues;
+}
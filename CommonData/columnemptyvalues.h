@@ -0,0 +1,112 @@
+#ifndef COLUMNEMPTYVALUES_H
+#define COLUMNEMPTYVALUES_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <bit>
+#include <unordered_map>
+
+namespace Json { class Value; }
+
+///
+/// Remembers, for a single column, what the original text was of the values that were turned into missing values.
+/// This is needed to get them back when the user changes which values are considered empty.
+///
+/// A bitmap marks the rows that have an original value, and for each of those rows (in row order) an index into a table of interned strings is kept.
+/// Most of those originals are one of only a handful of tokens ("NA", ".", "-99" etc), so this stays small even when a column is mostly empty.
+/// Rows are best added in increasing order, that is just an append, adding or removing one in between means shifting the ones after it.
+class ColumnEmptyValues
+{
+public:
+	bool					empty()					const	{ return _tokens.empty();	}
+	size_t					size()					const	{ return _tokens.size();	}
+	size_t					internedCount()			const	{ return _strings.size();	}
+
+	bool					has(size_t row)			const	{ return row / 64 < _bits.size() && (_bits[row / 64] >> (row % 64)) & 1; }
+	///Original value at row or an empty string if there is none
+	const std::string	&	at(size_t row)			const;
+
+	void					insert(size_t row, const std::string & original);
+	void					insertRun(size_t firstRow, size_t rowCount, const std::string & original);
+	void					erase(size_t row);
+	void					clear();
+
+	///Calls visit(row, original) for each stored row in increasing order
+	template<typename Visitor>
+	void					forEach(Visitor visit)	const
+	{
+		forEachToken([&](size_t row, uint32_t token) { visit(row, _strings[token]); });
+	}
+
+	///Calls visit(firstRow, rowCount, internedIndex) for each stretch of consecutive rows sharing the same original, in increasing order
+	template<typename Visitor>
+	void					forEachRun(Visitor visit)	const
+	{
+		size_t	first	= 0,
+				count	= 0;
+		uint32_t	id	= 0;
+
+		forEachToken([&](size_t row, uint32_t token)
+		{
+			if(count && row == first + count && token == id)
+				count++;
+			else
+			{
+				if(count) visit(first, count, id);
+				first	= row;
+				count	= 1;
+				id		= token;
+			}
+		});
+
+		if(count) visit(first, count, id);
+	}
+
+	const std::vector<std::string>	&	interned()	const	{ return _strings; }
+	///True if pred is true for any of the interned originals, which is usually a lot less work than going through all rows
+	template<typename Predicate>
+	bool					anyOriginal(Predicate pred)	const
+	{
+		for(const std::string & original : _strings)
+			if(pred(original))
+				return true;
+		return false;
+	}
+
+	size_t					bytesUsed()				const;
+
+	Json::Value				toJson()				const;				///< { "originals": [...], "runs": [firstRow, rowCount, index in originals, ...] } as data archives have it since 1.1.0
+	static ColumnEmptyValues	fromJson(		const Json::Value & json);
+	static ColumnEmptyValues	fromLegacyJson(	const Json::Value & json);
+
+	bool					operator==(const ColumnEmptyValues & other) const;
+	bool					operator!=(const ColumnEmptyValues & other) const { return !(*this == other); }
+
+private:
+	template<typename Visitor>
+	void					forEachToken(Visitor visit)	const
+	{
+		size_t token = 0;
+
+		for(size_t word = 0; word < _bits.size(); word++)
+			for(uint64_t bits = _bits[word]; bits; bits &= bits - 1)
+				visit(word * 64 + std::countr_zero(bits), _tokens[token++]);
+	}
+
+	uint32_t				intern(const std::string & original);
+	void					insertToken(size_t row, uint32_t id);
+	size_t					rank(size_t row)		const;
+	void					invalidateRanksAfter(size_t word);
+
+	std::vector<uint64_t>						_bits;
+	std::vector<uint32_t>						_tokens;			///< One per set bit, in row order, indexes _strings
+	std::vector<std::string>					_strings;
+	std::unordered_map<std::string, uint32_t>	_stringIds;
+	size_t										_endRow			= 0;				///< One past the highest stored row, anything at or beyond it is an append
+
+	mutable std::vector<uint32_t>				_ranks;				///< Number of set bits in all words before this one, valid up to _ranksValid
+	mutable size_t								_ranksValid		= 0;
+};
+
+#endif // COLUMNEMPTYVALUES_H
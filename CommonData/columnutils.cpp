@@ -201,3 +201,31 @@ void ColumnUtils::convertEscapedUnicodeToUTF8(std::string& inputStr)
 		begin = inputStr.begin() + pos;
 	}
 }
+
+uint64_t ColumnUtils::hashBytes(const void * data, size_t size, uint64_t hash)
+{
+	const unsigned char * bytes = static_cast<const unsigned char *>(data);
+
+	for(size_t i=0; i<size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+uint64_t ColumnUtils::fingerprint(const std::vector<std::string> & values)
+{
+	size_t		count	= values.size();
+	uint64_t	hash	= hashBytes(&count, sizeof(size_t));
+
+	for(const std::string & value : values)
+	{
+		size_t len = value.size(); //Including the length makes sure {"ab", "c"} and {"a", "bc"} differ
+		hash = hashBytes(&len,			sizeof(size_t),	hash);
+		hash = hashBytes(value.data(),	len,			hash);
+	}
+
+	return hash;
+}
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
 
 
 class ColumnUtils
@@ -28,6 +29,12 @@ public:
 	static bool			convertValueToDoubleForImport(	const std::string &strValue, double &doubleValue);
 	static void			convertEscapedUnicodeToUTF8(	std::string &inputStr);
 
+	///64-bit FNV-1a, used to fingerprint columns so that a sync can skip the ones that didn't change. Pass the previous result as hash to continue hashing.
+	static uint64_t		hashBytes(						const void * data, size_t size, uint64_t hash = fnvOffsetBasis);
+	static uint64_t		fingerprint(					const std::vector<std::string> & values);
+
+	static const uint64_t fnvOffsetBasis = 14695981039346656037ULL;
+
 private:
 	static std::string _deEuropeaniseForImport(			const std::string &value);
 	static std::string _convertEscapedUnicodeToUTF8(	std::string hex);
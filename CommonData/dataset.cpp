@@ -76,36 +76,50 @@ string DataSet::toString()
 	return ss.str();
 }
 
-std::map<string, std::map<int, string> > DataSet::resetEmptyValues(const std::map<std::string, std::map<int, std::string> >& emptyValuesPerColumnMap)
+///Updates the empty values of each column in place and returns the names of the columns that changed
+///Only columns that have originals afterwards get an entry, so that a dataset with many columns but few missing values doesn't carry an empty one for each
+std::vector<string> DataSet::resetEmptyValues(emptyValsType & emptyValuesPerColumn)
 {
-	std::map<string, std::map<int, string> > colChanged;
+	std::vector<string> colChanged;
 
 	for (Column& col : _columns)
 	{
-		std::map<int, string> emptyValuesMap;
-
-		if (emptyValuesPerColumnMap.count(col.name()))
-			emptyValuesMap = emptyValuesPerColumnMap.at(col.name());
-
-		if (col.resetEmptyValues(emptyValuesMap))
-			colChanged[col.name()] = emptyValuesMap;
+		auto	found	= emptyValuesPerColumn.find(col.name());
+		bool	changed;
+
+		if (found != emptyValuesPerColumn.end())
+		{
+			changed = col.resetEmptyValues(found->second);
+
+			if (found->second.empty())
+				emptyValuesPerColumn.erase(found);
+		}
+		else
+		{
+			ColumnEmptyValues emptyValues;
+			changed = col.resetEmptyValues(emptyValues);
+
+			if (!emptyValues.empty())
+				emptyValuesPerColumn[col.name()] = std::move(emptyValues);
+		}
+
+		if (changed)
+			colChanged.push_back(col.name());
 	}
 
 	return colChanged;
 }
 
-bool DataSet::setFilterVector(std::vector<bool> filterResult)
+ChangedRows DataSet::setFilterVector(const std::vector<bool> & filterResult)
 {
-	bool changed = false;
-
+	ChangedRows changed;
 
-	for(size_t i=0; i<filterResult.size(); i++)
-	{
+	for(size_t i=0; i<filterResult.size() && i<_filterVector.size(); i++)
 		if(_filterVector[i] != filterResult[i])
-			changed = true;
-
-		_filterVector[i] = filterResult[i];
-	}
+		{
+			_filterVector[i] = filterResult[i];
+			changed.rowChanged(i);
+		}
 
 	_filteredRowCount = 0;
 
@@ -116,6 +130,12 @@ bool DataSet::setFilterVector(std::vector<bool> filterResult)
 	return changed;
 }
 
+void DataSet::visitLabelTexts(const LabelStrings::TextVisitor & visit)
+{
+	for(Column & col : _columns)
+		col.labels().visitTexts(visit);
+}
+
 bool DataSet::allColumnsPassFilter() const
 {
 	for(const Column & col : _columns)
@@ -25,16 +25,14 @@
 typedef boost::interprocess::allocator<bool, boost::interprocess::managed_shared_memory::segment_manager> BoolAllocator;
 typedef boost::container::vector<bool, BoolAllocator> BoolVector;
 
-
 ///
 /// The interface class for storing the dataset used in JASP as a collection of Columns with Labels
 /// Doesn't do a lot and could probably be merged with Columns
 ///
 class DataSet
 {
-	typedef std::map<std::string, std::map<int, std::string>> emptyValsType;
-
 public:
+	typedef std::map<std::string, ColumnEmptyValues> emptyValsType;
 
 	DataSet(boost::interprocess::managed_shared_memory *mem) : _columns(mem), _filterVector(mem->get_segment_manager()), _mem(mem) { }
 	~DataSet() {}
@@ -58,13 +56,14 @@ public:
 	void setSharedMemory(boost::interprocess::managed_shared_memory *mem);
 
 	std::string toString();
-	std::map<std::string, std::map<int, std::string> > resetEmptyValues(const emptyValsType& emptyValuesMap);
+	std::vector<std::string>	resetEmptyValues(emptyValsType & emptyValuesPerColumn);
 
-	bool				setFilterVector(std::vector<bool> filterResult);
+	ChangedRows			setFilterVector(const std::vector<bool> & filterResult);
 	BoolVector	&		filterVector()				{ return _filterVector; }
 	int					filteredRowCount()	const	{ return _filteredRowCount; }
 
 	bool allColumnsPassFilter()				const;
+	void visitLabelTexts(const LabelStrings::TextVisitor & visit);	///< For LabelStrings::compact
 
 	size_t						getMaximumColumnWidthInCharacters(size_t columnIndex) const;
 	std::vector<std::string> 	getColumnNames() { return _columns.getColumnNames();};
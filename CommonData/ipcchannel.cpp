@@ -234,7 +234,7 @@ void IPCChannel::catchAndRepeat(const std::string & taskDescription, std::functi
 		}
 		catch(std::exception e)
 		{
-			Log::log() << "Had exception: " << e.what() << std::endl;
+			Log::error() << "Had exception: " << e.what() << std::endl;
 			Log::log() << "Will sleep for " << sleep << "ms and try again." << std::endl;
 
 			Utils::sleep(sleep);
@@ -356,7 +356,7 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 	}
 	catch (std::exception & e)
 	{
-		Log::log() << "IPCChannel::send encountered an exception: " << e.what() << std::endl;
+		Log::error() << "IPCChannel::send encountered an exception: " << e.what() << std::endl;
 		throw e; //no need to unlock because this will crash stuff
 	}
 
@@ -395,7 +395,7 @@ bool IPCChannel::receive(string &data, int timeout)
 		}
 		catch(std::exception & e)
 		{
-			Log::log() << "IPCChannel::receive encountered an exception: " << e.what() << std::endl;
+			Log::error() << "IPCChannel::receive encountered an exception: " << e.what() << std::endl;
 			throw e;
 		}
 
@@ -16,21 +16,30 @@
 //
 
 #include "label.h"
+#include "labelstrings.h"
 
-#include <sstream>
-#include <cstring>
+#include <stdexcept>
 
-void Label::_setLabel(const std::string &label) {
-    _stringLength = label.length();
-    if (sizeof(_stringValue) < label.length())
-        _stringLength = sizeof(_stringValue);
+void Label::_storeText(const std::string & text, size_t & offset, unsigned int & length)
+{
+	if(text.empty())
+	{
+		offset = length = 0;
+		return;
+	}
 
-    std::memcpy(_stringValue, label.c_str(), _stringLength);
+	LabelStrings * strings = LabelStrings::labelStrings();
+
+	if(!strings)
+		throw std::runtime_error("Label text cannot be stored because there is no dataset in shared memory.");
+
+	offset = strings->add(text);
+	length = static_cast<unsigned int>(text.size());
 }
 
 Label::Label(const std::string &label, int value, bool filterAllows, bool isText)
 {
-    _setLabel(label);
+	setLabel(label);
 	_hasIntValue = !isText;
 	_intValue = value;
 	_filterAllow = filterAllows;
@@ -43,14 +52,22 @@ Label::Label(int value)
 
 Label::Label()
 {
-	_hasIntValue = false;
-	_intValue = -1;
-	_stringLength = 0;
 }
 
 std::string Label::text() const
 {
-	return std::string(_stringValue, _stringLength);
+	if(_textLength == 0)
+		return "";
+
+	return LabelStrings::labelStrings() ? LabelStrings::labelStrings()->text(_textOffset, _textLength) : "";
+}
+
+std::string Label::originalText() const
+{
+	if(_orgTextLength == 0)
+		return "";
+
+	return LabelStrings::labelStrings() ? LabelStrings::labelStrings()->text(_orgTextOffset, _orgTextLength) : "";
 }
 
 bool Label::hasIntValue() const
@@ -63,34 +80,23 @@ int Label::value() const
 	return _intValue;
 }
 
-void Label::setLabel(const std::string &label) {
-	_setLabel(label);
+void Label::setLabel(const std::string &label)
+{
+	_storeText(label, _textOffset, _textLength);
+}
+
+void Label::setOriginalText(const std::string & text)
+{
+	_storeText(text, _orgTextOffset, _orgTextLength);
+	_hasOrgText = true;
 }
 
 void Label::setValue(int value, bool labelIsInt)
 {
 	if (labelIsInt)
 	{
-		std::stringstream ss;
-		ss << value;
-		std::string asString = ss.str();
-
-		std::memcpy(_stringValue, asString.c_str(), asString.length());
-		_stringLength = asString.length();
-
+		setLabel(std::to_string(value));
 		_hasIntValue = true;
 	}
 	_intValue = value;
 }
-
-Label &Label::operator=(const Label &label)
-{
-	this->_hasIntValue	= label._hasIntValue;
-	this->_intValue		= label._intValue;
-	this->_filterAllow	= label._filterAllow;
-
-	std::memcpy(_stringValue, label._stringValue, label._stringLength);
-	_stringLength = label._stringLength;
-
-	return *this;
-}
@@ -19,22 +19,25 @@
 #define LABEL_H
 
 #include <string>
+#include "labelstrings.h"
 
 ///
 /// Label is a class that stores the value of a column if it is not a Scale (a Nominal Int, Nominal Text, or Ordinal).
 /// The value is either an integer or a string.
 ///
-/// If it is an integer, the _intValue is this value, and _stringValue is at first the corresponding string.
-/// _stringValue can be then changed in the Variable tab in JASP.
+/// If it is an integer, the _intValue is this value, and the text is at first the corresponding string.
+/// The text can be then changed in the Variable tab in JASP.
 ///
 /// If the value is a string, _intValue is the key that maps the label with the AsInts property of the column object.
-/// _stringValue is then the value, that can be changed in the Variable tab in JASP. If changed the original value
-/// is saved in the _orgStringValues static property of the Labels class.
+/// The text is then the value, that can be changed in the Variable tab in JASP. If changed the original value
+/// is kept as originalText.
+///
+/// The texts themselves are stored in LabelStrings, a Label only knows their offset and length.
+/// That keeps it small and of fixed size whatever the length of the text, and a copy stays valid as long as the dataset exists.
 ///
 class Label
 {
 public:
-	static const int MAX_LABEL_LENGTH = 128;
 	Label(const std::string &label, int value, bool filterAllows, bool isText = true);
 	Label(int value);
 	Label();
@@ -42,23 +45,29 @@ public:
 	std::string text() const;
 	bool hasIntValue() const;
 	int value() const;
-    void setLabel(const std::string &label);
+	void setLabel(const std::string &label);
 	void setValue(int value, bool labelIsInt = true);
-	Label& operator=(const Label &label);
+
+	bool		hasOriginalText()	const { return _hasOrgText; }
+	std::string	originalText()		const;
+	void		setOriginalText(const std::string & text);
 
 	bool filterAllows() const { return _filterAllow; }
 	void setFilterAllows(bool allowFilter) { _filterAllow = allowFilter; }
 
-private:
+	void visitTexts(const LabelStrings::TextVisitor & visit) { visit(_textOffset, _textLength); visit(_orgTextOffset, _orgTextLength); }
 
-	bool _hasIntValue;
-	int _intValue;
-	char _stringValue[MAX_LABEL_LENGTH];
-	int  _stringLength;
-
-    void _setLabel(const std::string &label);
+private:
+	static void		_storeText(const std::string & text, size_t & offset, unsigned int & length);
 
-	bool _filterAllow = true;
+	size_t			_textOffset		= 0,
+					_orgTextOffset	= 0;
+	int				_intValue		= -1;
+	unsigned int	_textLength		= 0,
+					_orgTextLength	= 0;
+	bool			_hasIntValue	= false,
+					_hasOrgText		= false,
+					_filterAllow	= true;
 };
 
 #endif // LABEL_H
@@ -28,15 +28,9 @@ const char * labelNotFound::what() const noexcept
 	return std::runtime_error::what();
 }
 
-map<int, map<int, string> > Labels::_orgStringValues;
-int Labels::_counter = 0;
-
-typedef unsigned int uint;
-
 Labels::Labels(boost::interprocess::managed_shared_memory *mem)
 	: _labels(mem->get_segment_manager())
 {
-	 _id = ++Labels::_counter;
 	_mem = mem;
 }
 
@@ -85,26 +79,18 @@ void Labels::removeValues(std::set<int> valuesToRemove)
 std::map<string, int> Labels::_resetLabelValues(int& maxValue)
 {
 	std::map<string, int> result;
-	map<int, string> &orgStringValues = getOrgStringValues();
-	map<int, string> newOrgStringValues;
 	int labelValue = 1;
 	for (Label& label : _labels)
 	{
-		int oldLabelValue = label.value();
-		std::string labelText = label.text();
+		std::string labelText = label.hasOriginalText() ? label.originalText() : label.text();
 
-		if (orgStringValues.find(oldLabelValue) != orgStringValues.end())
-			labelText = newOrgStringValues[labelValue] = orgStringValues[oldLabelValue];
-
-		if (oldLabelValue != labelValue)
+		if (label.value() != labelValue)
 			label.setValue(labelValue, false);
 
 		result[labelText] = labelValue;
 		labelValue++;
 	}
 
-	orgStringValues.clear();
-	orgStringValues.insert(newOrgStringValues.begin(), newOrgStringValues.end());
 	maxValue = labelValue - 1;
 
 	return result;
@@ -164,21 +150,7 @@ bool Labels::syncInts(const std::set<int> &values)
 
 std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &new_values, const std::map<std::string, std::string> &new_labels, bool *changedSomething)
 {
-	std::vector<std::pair<std::string,std::string> > valuesToAdd;
-	std::map<std::string, std::vector<unsigned int> > mapValuesToAdd;
-	unsigned int valuesToAddIndex = 0;
-
-	for (const std::string& newValue : new_values)
-	{
-		std::string shortValue	= newValue.length() > Label::MAX_LABEL_LENGTH ? newValue.substr(0, Label::MAX_LABEL_LENGTH) : newValue;
-		valuesToAdd.push_back(make_pair(newValue, shortValue));
-		auto elt = mapValuesToAdd.find(shortValue);
-		if (elt != mapValuesToAdd.end())
-			elt->second.push_back(valuesToAddIndex);
-		else
-			mapValuesToAdd[shortValue] = { valuesToAddIndex };
-		valuesToAddIndex++;
-	}
+	std::set<std::string> valuesToAdd(new_values.begin(), new_values.end());
 	
 	std::set<int>				valuesToRemove;
 	std::map<std::string, int>	result;
@@ -192,18 +164,17 @@ std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &n
 		if (labelValue > maxLabelKey)
 			maxLabelKey = labelValue;
 
-		auto elt = mapValuesToAdd.find(labelText);
-		if (elt != mapValuesToAdd.end())
+		auto elt = valuesToAdd.find(labelText);
+		if (elt != valuesToAdd.end())
 		{
-			for (uint i : elt->second)
-				result[valuesToAdd[i].first] = labelValue;
-			mapValuesToAdd.erase(elt);
+			result[labelText] = labelValue;
+			valuesToAdd.erase(elt);
 		}
 		else
 			valuesToRemove.insert(labelValue);
 	}
 
-	if(changedSomething != nullptr && (valuesToRemove.size() > 0 || mapValuesToAdd.size() > 0))
+	if(changedSomething != nullptr && (valuesToRemove.size() > 0 || valuesToAdd.size() > 0))
 		*changedSomething = true;
 
 	if (valuesToRemove.size() > 0)
@@ -212,17 +183,14 @@ std::map<std::string, int> Labels::syncStrings(const std::vector<std::string> &n
 		result = _resetLabelValues(maxLabelKey);
 	}
 	
-	for (auto elt : valuesToAdd)
-	{
-		const std::string& newLabel = elt.first;
-		const std::string& shortLabel = elt.second;
-		if (mapValuesToAdd.find(shortLabel) != mapValuesToAdd.end())
+	for (const std::string & newLabel : new_values)
+		if (valuesToAdd.count(newLabel))
 		{
 			maxLabelKey++;
-			add(maxLabelKey, shortLabel, true);
+			add(maxLabelKey, newLabel, true);
 			result[newLabel] = maxLabelKey;
+			valuesToAdd.erase(newLabel);
 		}
-	}
 
 	for (Label& label : _labels)
 	{
@@ -252,14 +220,27 @@ std::set<int> Labels::getIntValues()
 	return result;
 }
 
-map<int, string> &Labels::getOrgStringValues() const
+map<int, string> Labels::getOrgStringValues() const
 {
-	return Labels::_orgStringValues[_id];
+	map<int, string> orgStringValues;
+
+	for (const Label & label : _labels)
+		if (label.hasOriginalText())
+			orgStringValues[label.value()] = label.originalText();
+
+	return orgStringValues;
 }
 
 void Labels::setOrgStringValues(int key, std::string value)
 {
-	getOrgStringValues()[key] = value;
+	for (Label & label : _labels)
+		if (label.value() == key)
+		{
+			label.setOriginalText(value);
+			return;
+		}
+
+	Log::log() << "Cannot set original value '" << value << "' because there is no label for key " << key << std::endl;
 }
 
 const Label &Labels::getLabelObjectFromKey(int index) const
@@ -296,6 +277,10 @@ bool Labels::setLabelFromRow(int row, const string &display)
 
 		_setNewStringForLabel(label, display);
 	}
+	catch(boost::interprocess::bad_alloc &)
+	{
+		throw; //A new text might not fit in the segment, whoever called this can enlarge it and try again
+	}
 	catch(...)
 	{
 		return false;
@@ -303,6 +288,12 @@ bool Labels::setLabelFromRow(int row, const string &display)
 	return true;
 }
 
+void Labels::visitTexts(const LabelStrings::TextVisitor & visit)
+{
+	for(Label & label : _labels)
+		label.visitTexts(visit);
+}
+
 void Labels::log()
 {
 	Log::log() << "Labels: " << std::endl;
@@ -313,16 +304,8 @@ void Labels::log()
 
 void Labels::_setNewStringForLabel(Label &label, const string &display)
 {
-	int label_value = label.value();
-	string label_string = label.text();
-
-	if (!label.hasIntValue())
-	{
-		map<int, string> &orgStringValues = getOrgStringValues();
-
-		if (orgStringValues.find(label_value) == orgStringValues.end())
-			orgStringValues[label_value] = label_string;
-	}
+	if (!label.hasIntValue() && !label.hasOriginalText())
+		label.setOriginalText(label.text());
 
 	label.setLabel(display);
 }
@@ -335,11 +318,8 @@ string Labels::_getValueFromLabel(const Label &label) const
 
 string Labels::_getOrgValueFromLabel(const Label &label) const
 {
-	map<int, string> &orgStringValues	= getOrgStringValues();
-	map<int, string>::const_iterator it = orgStringValues.find(label.value());
-
-	if (it == orgStringValues.end())	return label.value() == std::numeric_limits<int>::lowest() ? "" : label.text(); //If missing value show nothing, not a label
-	else								return it->second;
+	if (!label.hasOriginalText())	return label.value() == std::numeric_limits<int>::lowest() ? "" : label.text(); //If missing value show nothing, not a label
+	else							return label.originalText();
 }
 
 string Labels::getValueFromKey(int key) const
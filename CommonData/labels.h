@@ -63,6 +63,7 @@ public:
 	std::map<std::string, int>	syncStrings(const std::vector<std::string>	& new_values, const std::map<std::string, std::string> &new_labels, bool *changedSomething);
 
 	void	set(std::vector<Label> &labels);
+	void	visitTexts(const LabelStrings::TextVisitor & visit);
 	size_t	size() const;
 
 	Labels	& operator=(const Labels& labels);
@@ -74,7 +75,7 @@ public:
 	const_iterator begin() const;
 	const_iterator end() const;
 
-	std::map<int, std::string> &getOrgStringValues() const;
+	std::map<int, std::string> getOrgStringValues() const;
 	void setOrgStringValues(int key, std::string value);
 
 	// Get Value or Label from the key given by the AsInts struncture of Column
@@ -84,8 +85,8 @@ public:
 	// These 3 methods are used by the Variable Page to get/set the value & label of a Variable
 	// (confusing is that a Variable is a Label object). The row means here the row of the
 	// Variable in the table (as displayed to the user).
-	// getValueFromRow will maybe need the _orgStringValues if the value is a string and has been
-	// changed by the user: the original value is then stored in _orgStringValues
+	// getValueFromRow will maybe need the original text if the value is a string and has been
+	// changed by the user: the original value is then stored in the Label as well
 	std::string getLabelFromRow(int) const;
 	std::string getValueFromRow(int) const;
 	bool setLabelFromRow(int row, const std::string &display);
@@ -101,12 +102,6 @@ private:
 	boost::interprocess::managed_shared_memory * _mem = nullptr;
 
 	LabelVector		_labels;
-	int				_id;
-	static int		_counter;
-	// Original string values: used only when value is a string and when the label has been changed
-	// This map is not in the shared memory (it's only used by the Desktop): this allows this map to grow
-	// without risking to fill up the shared memory.
-	static std::map<int, std::map<int, std::string> > _orgStringValues;
 };
 
 namespace boost
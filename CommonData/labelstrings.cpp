@@ -0,0 +1,257 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "labelstrings.h"
+
+#include <cstring>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+using namespace boost;
+
+LabelStrings * LabelStrings::_labelStrings = nullptr;
+
+LabelStrings::LabelStrings(SegmentManager * segment)
+	: _segment(segment), _index(segment)
+{
+	for(size_t chunk=0; chunk<_maxChunks; chunk++)
+		_chunks[chunk] = nullptr;
+}
+
+LabelStrings::~LabelStrings()
+{
+	for(size_t chunk=0; chunk<_maxChunks; chunk++)
+		if(_chunks[chunk])
+			_segment->deallocate(_chunks[chunk].get());
+
+	if(_labelStrings == this)
+		_labelStrings = nullptr;
+}
+
+size_t LabelStrings::chunkOf(size_t offset)
+{
+	size_t	chunk		= 0,
+			doubling	= offset / _firstChunkSize + 1;
+
+	while(doubling >>= 1)
+		chunk++;
+
+	return chunk;
+}
+
+unsigned int LabelStrings::hashOf(const char * chars, size_t length)
+{
+	//FNV-1a
+	unsigned int hash = 2166136261u;
+
+	for(size_t i=0; i<length; i++)
+	{
+		hash ^= static_cast<unsigned char>(chars[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+const char * LabelStrings::chars(size_t offset, size_t length) const
+{
+	size_t chunk = chunkOf(offset);
+
+	if(chunk >= _maxChunks || !_chunks[chunk] || offset + length > chunkStart(chunk) + chunkSize(chunk) || offset + length > _charsUsed)
+		return nullptr;
+
+	return _chunks[chunk].get() + (offset - chunkStart(chunk));
+}
+
+std::string LabelStrings::text(size_t offset, size_t length) const
+{
+	if(length == 0)
+		return "";
+
+	const char * start = chars(offset, length);
+
+	return start ? std::string(start, length) : "";
+}
+
+size_t LabelStrings::findSlot(const Slot * slots, size_t slotCount, const char * chars, size_t length, unsigned int hash) const
+{
+	//slotCount is always a power of two and the index is never full, so this always ends
+	for(size_t slot = hash & (slotCount - 1); ; slot = (slot + 1) & (slotCount - 1))
+	{
+		const Slot & here = slots[slot];
+
+		if(here.length == 0)
+			return slot;
+
+		if(here.hash == hash && here.length == length && std::memcmp(this->chars(here.offset, here.length), chars, length) == 0)
+			return slot;
+	}
+}
+
+void LabelStrings::growIndex()
+{
+	Slots grown(std::max(size_t(64), _index.size() * 2), Slot(), _index.get_stored_allocator());
+
+	//Every string in the index is distinct, so this only finds an empty slot for them, comparing the characters keeps those that share hash and length apart
+	for(const Slot & slot : _index)
+		if(slot.length != 0)
+			grown[findSlot(grown.data(), grown.size(), chars(slot.offset, slot.length), slot.length, slot.hash)] = slot;
+
+	_index.swap(grown);
+}
+
+size_t LabelStrings::add(const std::string & text)
+{
+	if(text.empty())
+		return 0;
+
+	if(text.size() > std::numeric_limits<unsigned int>::max())
+		throw std::runtime_error("A label of " + std::to_string(text.size()) + " characters is too long to store.");
+
+	interprocess::scoped_lock<interprocess::interprocess_mutex> lock(_lock);
+
+	//Everything that can throw bad_alloc happens before anything is changed, so that adding can simply be tried again after the segment was enlarged
+	if((_count + 1) * 10 > _index.size() * 7)
+		growIndex();
+
+	const unsigned int	hash	= hashOf(text.data(), text.size());
+	const size_t		slot	= findSlot(_index.data(), _index.size(), text.data(), text.size(), hash);
+
+	if(_index[slot].length != 0)
+		return _index[slot].offset;
+
+	//A string never spans two chunks, if it doesn't fit in the rest of this one it goes to the first that is big enough
+	size_t offset	= _charsUsed,
+		   chunk	= chunkOf(offset);
+
+	while(chunk < _maxChunks && offset + text.size() > chunkStart(chunk) + chunkSize(chunk))
+		offset = chunkStart(++chunk);
+
+	if(chunk >= _maxChunks)
+		throw std::runtime_error("There is no room left to store label texts.");
+
+	if(!_chunks[chunk])
+	{
+		_chunks[chunk]	 = static_cast<char*>(_segment->allocate(chunkSize(chunk)));
+		_chunkBytes		+= chunkSize(chunk);
+	}
+
+	std::memcpy(_chunks[chunk].get() + (offset - chunkStart(chunk)), text.data(), text.size());
+
+	_charsUsed				= offset + text.size();
+	_index[slot].offset		= offset;
+	_index[slot].hash		= hash;
+	_index[slot].length		= static_cast<unsigned int>(text.size());
+	_count++;
+
+	return offset;
+}
+
+bool LabelStrings::worthCompacting() const
+{
+	//Waiting until the pool doubled keeps the cost of compacting proportional to what was added in between
+	return _charsUsed > std::max(_compactFrom, 2 * _charsKept);
+}
+
+void LabelStrings::compact(const TextWalker & walkAll)
+{
+	interprocess::scoped_lock<interprocess::interprocess_mutex> lock(_lock);
+
+	std::map<size_t, unsigned int> kept;
+
+	walkAll([&](size_t & offset, unsigned int & length)
+	{
+		if(length == 0)
+			return;
+
+		if(!chars(offset, length) || (kept.count(offset) && kept[offset] != length))
+			throw std::runtime_error("A label text at " + std::to_string(offset) + " of " + std::to_string(length) + " characters is not in the pool, so it cannot be compacted.");
+
+		kept[offset] = length;
+	});
+
+	//Packed in order of their offsets as add() would, so that every string ends up at or before where it was and can be moved without overwriting one that wasn't moved yet
+	std::map<size_t, size_t>	moved;
+	size_t						charsUsed	= 0;
+
+	for(const auto & offsetLength : kept)
+	{
+		size_t	offset	= charsUsed,
+				chunk	= chunkOf(offset);
+
+		while(offset + offsetLength.second > chunkStart(chunk) + chunkSize(chunk))
+			offset = chunkStart(++chunk);
+
+		moved[offsetLength.first]	= offset;
+		charsUsed					= offset + offsetLength.second;
+	}
+
+	//A string can land in a chunk that a longer one skipped before, anything that can throw bad_alloc happens before a single character is moved
+	for(const auto & oldNew : moved)
+		if(!_chunks[chunkOf(oldNew.second)])
+		{
+			_chunks[chunkOf(oldNew.second)]	 = static_cast<char*>(_segment->allocate(chunkSize(chunkOf(oldNew.second))));
+			_chunkBytes						+= chunkSize(chunkOf(oldNew.second));
+		}
+
+	for(const auto & oldNew : moved)
+	{
+		const size_t length = kept[oldNew.first],
+					 chunk	= chunkOf(oldNew.second);
+
+		std::memmove(_chunks[chunk].get() + (oldNew.second - chunkStart(chunk)), chars(oldNew.first, length), length);
+	}
+
+	for(size_t chunk = charsUsed == 0 ? 0 : chunkOf(charsUsed - 1) + 1; chunk<_maxChunks; chunk++)
+		if(_chunks[chunk])
+		{
+			_segment->deallocate(_chunks[chunk].get());
+			_chunks[chunk]	 = nullptr;
+			_chunkBytes		-= chunkSize(chunk);
+		}
+
+	_charsUsed	= charsUsed;
+	_charsKept	= charsUsed;
+	_count		= kept.size();
+
+	//The index keeps its size, it only gets emptier
+	for(Slot & slot : _index)
+		slot = Slot();
+
+	for(const auto & oldNew : moved)
+	{
+		Slot slot;
+		slot.offset	= oldNew.second;
+		slot.length	= kept[oldNew.first];
+		slot.hash	= hashOf(chars(slot.offset, slot.length), slot.length);
+
+		_index[findSlot(_index.data(), _index.size(), chars(slot.offset, slot.length), slot.length, slot.hash)] = slot;
+	}
+
+	walkAll([&](size_t & offset, unsigned int & length)
+	{
+		if(length != 0)
+			offset = moved.at(offset);
+	});
+}
+
+size_t LabelStrings::bytesUsed() const
+{
+	return sizeof(LabelStrings) + _chunkBytes + _index.capacity() * sizeof(Slot);
+}
@@ -0,0 +1,102 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef LABELSTRINGS_H
+#define LABELSTRINGS_H
+
+#include <string>
+#include <functional>
+
+#include <boost/container/vector.hpp>
+#include <boost/interprocess/managed_shared_memory.hpp>
+#include <boost/interprocess/offset_ptr.hpp>
+#include <boost/interprocess/sync/interprocess_mutex.hpp>
+
+///
+/// The texts of all Labels in the dataset, each distinct string stored once in shared memory, so that a Label only needs to know where its text starts and how long it is.
+/// Adding a string that is already there returns the same offset, so a value that occurs in many columns or is both label and original value costs nothing extra.
+///
+/// The characters live in chunks that double in size and are not moved by adding or enlarging the segment.
+/// That way an offset stays valid in copies of a Label outside of shared memory (the undo journal keeps those) and after the segment was enlarged,
+/// and the engines can read texts without locking while the Desktop adds some. Only adding takes the lock.
+///
+/// Strings nobody uses anymore, because their labels were renamed or removed, stay until compact() is called.
+/// That only keeps what is reachable from every Label in use, shared memory and copies alike, and moves it to the front.
+/// DataSetPackage does that with the engines paused once worthCompacting(), when the pool doubled since last time.
+///
+/// There is one per segment, SharedMemory creates it together with the DataSet and makes it available through labelStrings().
+///
+class LabelStrings
+{
+public:
+	typedef boost::interprocess::managed_shared_memory::segment_manager SegmentManager;
+	typedef std::function<void(size_t & offset, unsigned int & length)>	TextVisitor;
+	typedef std::function<void(const TextVisitor & visit)>					TextWalker;		///< Must pass every text in use to visit, each exactly once
+
+								LabelStrings(SegmentManager * segment);
+								~LabelStrings();
+
+	size_t						add(const std::string & text);							///< Returns the offset of text, it is only stored if it wasn't there yet
+	std::string					text(size_t offset, size_t length)	const;
+	const char				*	chars(size_t offset, size_t length)	const;				///< nullptr if offset and length do not point into this pool
+
+	bool						worthCompacting()	const;
+	void						compact(const TextWalker & walkAll);						///< Forgets all strings walkAll does not reach and gives the others new offsets, nothing may read texts meanwhile
+
+	size_t						count()			const { return _count;		}			///< How many distinct strings are stored
+	size_t						charsUsed()		const { return _charsUsed;	}
+	size_t						bytesUsed()		const;									///< What the chunks and the index take from the segment
+
+	static LabelStrings		*	labelStrings()							{ return _labelStrings; }
+	static void					setLabelStrings(LabelStrings * strings)	{ _labelStrings = strings; }
+
+private:
+	struct Slot
+	{
+		size_t			offset	= 0;
+		unsigned int	length	= 0,	///< 0 means empty, the empty string is never stored
+						hash	= 0;
+	};
+
+	typedef boost::interprocess::allocator<Slot, SegmentManager>	SlotAllocator;
+	typedef boost::container::vector<Slot, SlotAllocator>			Slots;
+
+	static const size_t		_firstChunkSize	= 4096,
+							_maxChunks		= 44,
+							_compactFrom	= 1024 * 1024;	///< Below this many characters compacting isn't worth pausing the engines for
+
+	static size_t			chunkOf(	size_t offset);
+	static size_t			chunkStart(	size_t chunk)	{ return _firstChunkSize * ((size_t(1) << chunk) - 1);	}
+	static size_t			chunkSize(	size_t chunk)	{ return _firstChunkSize << chunk;						}
+	static unsigned int		hashOf(const char * chars, size_t length);
+
+	void					growIndex();
+	size_t					findSlot(const Slot * slots, size_t slotCount, const char * chars, size_t length, unsigned int hash) const;
+
+	boost::interprocess::offset_ptr<SegmentManager>			_segment;
+	boost::interprocess::offset_ptr<char>					_chunks[_maxChunks];
+	Slots													_index;
+	size_t													_count		= 0,
+															_charsUsed	= 0,	///< Offset of the first free character, including whatever was skipped at the end of chunks
+															_chunkBytes	= 0,
+															_charsKept	= 0;	///< What _charsUsed was right after the last compaction
+	boost::interprocess::interprocess_mutex					_lock;
+
+	static LabelStrings	*	_labelStrings;
+};
+
+#endif // LABELSTRINGS_H
@@ -16,6 +16,7 @@
 //
 
 #include "sharedmemory.h"
+#include "labelstrings.h"
 
 #include "processinfo.h"
 #include "tempfiles.h"
@@ -59,6 +60,10 @@ DataSet *SharedMemory::createDataSet()
 		Log::log() << "Created shared mem with name " << _memoryName << std::endl;
 	}
 
+	//The texts of the labels of a previous dataset aren't needed anymore
+	_memory->destroy<LabelStrings>(interprocess::unique_instance);
+	LabelStrings::setLabelStrings(_memory->construct<LabelStrings>(interprocess::unique_instance)(_memory->get_segment_manager()));
+
 	DataSet * data = _memory->construct<DataSet>(interprocess::unique_instance)(_memory);
 	Log::log() << "(Re)created dataset in shared mem with name " << _memoryName << std::endl;
 	return data;
@@ -82,10 +87,11 @@ DataSet *SharedMemory::retrieveDataSet(unsigned long parentPID)
 		}
 
 		data = _memory->find<DataSet>(interprocess::unique_instance).first;
+		LabelStrings::setLabelStrings(_memory->find<LabelStrings>(interprocess::unique_instance).first);
 	}
 	catch (const interprocess::interprocess_exception& e)
 	{
-		Log::log() << "Error when retrieving the data set: " << e.what() << std::endl;
+		Log::error() << "Error when retrieving the data set: " << e.what() << std::endl;
 		data = nullptr;
 	}
 
@@ -126,6 +132,7 @@ void SharedMemory::unloadDataSet(bool owner)
 		return;
 	}
 	Log::log() << "SharedMemory::unloadDataSet " << _memoryName << ( _memory ? "" : " but it wasn't loaded.") << std::endl;
+	LabelStrings::setLabelStrings(nullptr);
 	delete _memory;
 	_memory = nullptr;
 }
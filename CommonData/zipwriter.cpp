@@ -0,0 +1,560 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "zipwriter.h"
+#include "columnutils.h"
+#include "log.h"
+
+#include <zlib.h>
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <future>
+#include <thread>
+#include <ctime>
+
+static const uint32_t	localHeaderSignature	= 0x04034b50,
+						centralHeaderSignature	= 0x02014b50,
+						endSignature			= 0x06054b50,
+						zip64EndSignature		= 0x06064b50,
+						zip64LocatorSignature	= 0x07064b50,
+						maxUint32				= 0xFFFFFFFF;
+static const uint16_t	zip64ExtraId			= 0x0001,
+						hashExtraId				= 0x6a73,	///< Not one of the ids the zip specification reserves, readers skip extra fields they don't know
+						methodStore				= 0,
+						methodDeflate			= 8,
+						flagUtf8Path			= 1 << 11,
+						madeByUnix				= (3 << 8) | 45;
+static const size_t		blockSize				= 1 << 20,	///< Large entries are hashed and deflated per block, on as many threads as prepare gets
+						dictionarySize			= 1 << 15;	///< What deflate can look back at, so a block is deflated as if it followed the one before it
+
+static void put16(std::string & out, uint16_t value) { for(int i=0; i<2; i++) out.push_back(char((value >> (8 * i)) & 0xFF)); }
+static void put32(std::string & out, uint32_t value) { for(int i=0; i<4; i++) out.push_back(char((value >> (8 * i)) & 0xFF)); }
+static void put64(std::string & out, uint64_t value) { for(int i=0; i<8; i++) out.push_back(char((value >> (8 * i)) & 0xFF)); }
+
+static uint64_t get(const std::string & in, size_t at, int bytes)
+{
+	if(at + bytes > in.size())
+		throw std::runtime_error("Zip record is cut short");
+
+	uint64_t value = 0;
+	for(int i=0; i<bytes; i++)
+		value |= uint64_t(static_cast<unsigned char>(in[at + i])) << (8 * i);
+
+	return value;
+}
+
+///The paths JASP passes around are UTF-8, which std::filesystem only assumes for a u8string, on Windows a std::string would be taken to be in the local code page
+static std::filesystem::path utf8Path(const std::string & path)
+{
+	return std::filesystem::path(std::u8string(path.begin(), path.end()));
+}
+
+///Calls segment for every part of the pieces that lies in bytes [from, to) of the contents they make up together
+template<typename SEGMENT>
+static void forEachSegment(const std::vector<ZipWriter::Piece> & pieces, uint64_t from, uint64_t to, SEGMENT segment)
+{
+	uint64_t start = 0;
+
+	for(const auto & [data, size] : pieces)
+	{
+		const uint64_t end = start + size;
+
+		if(end > from && start < to)
+		{
+			const uint64_t first = std::max(from, start);
+			segment(data + (first - start), size_t(std::min(to, end) - first));
+		}
+
+		if((start = end) >= to)
+			return;
+	}
+}
+
+static void gather(const std::vector<ZipWriter::Piece> & pieces, uint64_t from, uint64_t to, std::string & out)
+{
+	out.clear();
+	out.reserve(to - from);
+	forEachSegment(pieces, from, to, [&](const char * data, size_t size) { out.append(data, size); });
+}
+
+///Runs block(b) for every block, spread over the threads like ReadStatImportDataSet::tryNominalMinusText spreads its columns
+template<typename BLOCK>
+static void forEachBlock(size_t blocks, size_t threads, BLOCK block)
+{
+	threads = std::min<size_t>(blocks, threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+
+	if(threads <= 1)
+	{
+		for(size_t b=0; b<blocks; b++)
+			block(b);
+		return;
+	}
+
+	std::vector<std::future<void>> workers;
+
+	for(size_t t=0; t<threads; t++)
+		workers.push_back(std::async(std::launch::async, [&, t]()
+		{
+			for(size_t b=t; b<blocks; b+=threads)
+				block(b);
+		}));
+
+	for(auto & worker : workers)
+		worker.get();
+}
+
+///A raw deflate of bytes [from, to), primed with the bytes before it. All but the last end in a sync flush, so that the blocks concatenated are one deflate stream, like pigz does it.
+static std::string deflateBlock(const std::vector<ZipWriter::Piece> & pieces, uint64_t from, uint64_t to, bool last)
+{
+	const uint64_t	start	= from > dictionarySize ? from - dictionarySize : 0;
+	std::string		input;
+
+	gather(pieces, start, to, input);
+
+	z_stream stream = {};
+
+	if(deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw std::runtime_error("Cannot initialise deflate");
+
+	if(from > start)
+		deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(input.data()), uInt(from - start));
+
+	std::string output(deflateBound(&stream, uLong(to - from)) + 64, '\0');
+
+	stream.next_in		= reinterpret_cast<Bytef*>(input.data() + (from - start));
+	stream.avail_in		= uInt(to - from);
+	stream.next_out		= reinterpret_cast<Bytef*>(output.data());
+	stream.avail_out	= uInt(output.size());
+
+	const int result = deflate(&stream, last ? Z_FINISH : Z_SYNC_FLUSH);
+
+	output.resize(stream.total_out);
+	const bool complete = stream.avail_in == 0 && stream.avail_out > 0 && result == (last ? Z_STREAM_END : Z_OK);
+	deflateEnd(&stream);
+
+	if(!complete)
+		throw std::runtime_error("Deflating failed");
+
+	return output;
+}
+
+ZipWriter::ZipWriter(const std::string & path, const std::string & previousPath)
+	: _path(path)
+{
+	_out.open(utf8Path(path), std::ios::binary | std::ios::trunc);
+
+	if(!_out)
+		throw std::runtime_error("File could not be opened.");
+
+	std::time_t	now		= std::time(nullptr);
+	std::tm		local	= *std::localtime(&now);
+
+	_dosTime = uint16_t((local.tm_hour << 11) | (local.tm_min << 5) | (local.tm_sec / 2));
+	_dosDate = uint16_t(((std::max(local.tm_year, 80) - 80) << 9) | ((local.tm_mon + 1) << 5) | local.tm_mday);
+
+	_readPrevious(previousPath);
+}
+
+ZipWriter::~ZipWriter()
+{
+	//Without close the archive is incomplete, which is what it should be when saving it threw
+}
+
+ZipWriter::Entry ZipWriter::prepare(const std::string & path, const std::vector<Piece> & pieces, bool deflate, size_t threads) const
+{
+	Entry entry;
+	entry.path = path;
+
+	for(const Piece & piece : pieces)
+		entry.size += piece.second;
+
+	const size_t			blocks		= std::max<size_t>(1, (entry.size + blockSize - 1) / blockSize);
+	auto					blockStart	= [&](size_t b) { return std::min<uint64_t>(entry.size, uint64_t(b) * blockSize); };
+	std::vector<uint64_t>	hashes(blocks);
+	std::vector<uint32_t>	crcs(blocks);
+
+	forEachBlock(blocks, threads, [&](size_t b)
+	{
+		uint64_t	hash	= ColumnUtils::fnvOffsetBasis;
+		uLong		crc		= crc32(0L, Z_NULL, 0);
+
+		forEachSegment(pieces, blockStart(b), blockStart(b + 1), [&](const char * data, size_t size)
+		{
+			hash	= ColumnUtils::hashBytes(data, size, hash);
+			crc		= crc32(crc, reinterpret_cast<const Bytef*>(data), uInt(size));
+		});
+
+		hashes[b]	= hash;
+		crcs[b]		= uint32_t(crc);
+	});
+
+	entry.hash	= ColumnUtils::hashBytes(&entry.size,		sizeof(uint64_t));
+	entry.hash	= ColumnUtils::hashBytes(hashes.data(),		hashes.size() * sizeof(uint64_t), entry.hash);
+	entry.crc	= crcs[0];
+
+	for(size_t b=1; b<blocks; b++)
+		entry.crc = uint32_t(crc32_combine(entry.crc, crcs[b], z_off_t(blockStart(b + 1) - blockStart(b))));
+
+	auto previous = _previousRecords.find(path);
+
+	if(previous != _previousRecords.end() && previous->second.hashed && previous->second.hash == entry.hash && previous->second.size == entry.size && previous->second.crc == entry.crc)
+	{
+		entry.fromPrevious	= true;
+		entry.deflated		= previous->second.method == methodDeflate;
+		return entry;
+	}
+
+	if(deflate)
+	{
+		std::vector<std::string>	deflated(blocks);
+		size_t						deflatedSize = 0;
+
+		forEachBlock(blocks, threads, [&](size_t b) { deflated[b] = deflateBlock(pieces, blockStart(b), blockStart(b + 1), b + 1 == blocks); });
+
+		for(const std::string & block : deflated)
+			deflatedSize += block.size();
+
+		//Contents that do not get smaller, because they were compressed already, are stored instead
+		if(deflatedSize < entry.size)
+		{
+			entry.deflated = true;
+			entry.data.reserve(deflatedSize);
+
+			for(std::string & block : deflated)
+			{
+				entry.data += block;
+				std::string().swap(block);
+			}
+
+			return entry;
+		}
+	}
+
+	gather(pieces, 0, entry.size, entry.data);
+
+	return entry;
+}
+
+void ZipWriter::write(const Entry & entry)
+{
+	Record record;
+	record.path		= entry.path;
+	record.crc		= entry.crc;
+	record.size		= entry.size;
+	record.hash		= entry.hash;
+	record.hashed	= true;
+	record.offset	= _offset;
+
+	if(!entry.fromPrevious)
+	{
+		record.method			= entry.deflated ? methodDeflate : methodStore;
+		record.compressedSize	= entry.data.size();
+
+		_writeLocalHeader(record);
+		_write(entry.data.data(), entry.data.size());
+	}
+	else
+	{
+		const Record & previous	= _previousRecords.at(entry.path);
+		record.method			= previous.method;
+		record.compressedSize	= previous.compressedSize;
+
+		std::string localHeader(30, '\0');
+		_previous.seekg(std::streamoff(previous.offset));
+		_previous.read(localHeader.data(), localHeader.size());
+
+		if(!_previous || get(localHeader, 0, 4) != localHeaderSignature)
+			throw std::runtime_error("Entry '" + entry.path + "' of the previous archive cannot be read");
+
+		_previous.seekg(std::streamoff(previous.offset + localHeader.size() + get(localHeader, 26, 2) + get(localHeader, 28, 2)));
+		_writeLocalHeader(record);
+
+		std::vector<char> buffer(blockSize);
+
+		for(uint64_t left = record.compressedSize; left > 0;)
+		{
+			const size_t size = size_t(std::min<uint64_t>(left, buffer.size()));
+
+			if(!_previous.read(buffer.data(), size))
+				throw std::runtime_error("Entry '" + entry.path + "' of the previous archive cannot be read");
+
+			_write(buffer.data(), size);
+			left -= size;
+		}
+
+		_entriesCopied++;
+	}
+
+	_records.push_back(record);
+}
+
+void ZipWriter::close()
+{
+	if(_closed)
+		return;
+
+	_closed = true;
+
+	const uint64_t centralOffset = _offset;
+
+	for(const Record & record : _records)
+	{
+		const bool	sizes64		= record.size >= maxUint32 || record.compressedSize >= maxUint32,
+					offset64	= record.offset >= maxUint32;
+		std::string	extra,
+					header;
+
+		if(sizes64 || offset64)
+		{
+			put16(extra, zip64ExtraId);
+			put16(extra, (sizes64 ? 16 : 0) + (offset64 ? 8 : 0));
+
+			if(sizes64)
+			{
+				put64(extra, record.size);
+				put64(extra, record.compressedSize);
+			}
+
+			if(offset64)
+				put64(extra, record.offset);
+		}
+
+		put16(extra, hashExtraId);
+		put16(extra, sizeof(uint64_t));
+		put64(extra, record.hash);
+
+		put32(header, centralHeaderSignature);
+		put16(header, madeByUnix);
+		put16(header, sizes64 || offset64 ? 45 : 20);
+		put16(header, flagUtf8Path);
+		put16(header, record.method);
+		put16(header, _dosTime);
+		put16(header, _dosDate);
+		put32(header, record.crc);
+		put32(header, sizes64	? maxUint32 : uint32_t(record.compressedSize));
+		put32(header, sizes64	? maxUint32 : uint32_t(record.size));
+		put16(header, uint16_t(record.path.size()));
+		put16(header, uint16_t(extra.size()));
+		put16(header, 0);						//comment
+		put16(header, 0);						//disk
+		put16(header, 0);						//internal attributes
+		put32(header, 0100644u << 16);			//a regular file that is rw-r--r--, basically chmod
+		put32(header, offset64	? maxUint32 : uint32_t(record.offset));
+
+		header += record.path;
+		header += extra;
+
+		_write(header.data(), header.size());
+	}
+
+	const uint64_t	centralSize	= _offset - centralOffset,
+					count		= _records.size();
+	std::string		end;
+
+	if(count >= 0xFFFF || centralSize >= maxUint32 || centralOffset >= maxUint32)
+	{
+		const uint64_t zip64End = _offset;
+
+		put32(end, zip64EndSignature);
+		put64(end, 44);							//size of the rest of this record
+		put16(end, madeByUnix);
+		put16(end, 45);
+		put32(end, 0);
+		put32(end, 0);
+		put64(end, count);
+		put64(end, count);
+		put64(end, centralSize);
+		put64(end, centralOffset);
+
+		put32(end, zip64LocatorSignature);
+		put32(end, 0);
+		put64(end, zip64End);
+		put32(end, 1);
+	}
+
+	put32(end, endSignature);
+	put16(end, 0);
+	put16(end, 0);
+	put16(end, uint16_t(std::min<uint64_t>(count, 0xFFFF)));
+	put16(end, uint16_t(std::min<uint64_t>(count, 0xFFFF)));
+	put32(end, uint32_t(std::min<uint64_t>(centralSize,		maxUint32)));
+	put32(end, uint32_t(std::min<uint64_t>(centralOffset,	maxUint32)));
+	put16(end, 0);								//comment
+
+	_write(end.data(), end.size());
+
+	_out.close();
+	_previous.close();
+
+	if(_out.fail())
+		throw std::runtime_error("File could not be closed.");
+}
+
+void ZipWriter::_writeLocalHeader(const Record & record)
+{
+	const bool	zip64 = record.size >= maxUint32 || record.compressedSize >= maxUint32;
+	std::string	header;
+
+	put32(header, localHeaderSignature);
+	put16(header, zip64 ? 45 : 20);
+	put16(header, flagUtf8Path);
+	put16(header, record.method);
+	put16(header, _dosTime);
+	put16(header, _dosDate);
+	put32(header, record.crc);
+	put32(header, zip64 ? maxUint32 : uint32_t(record.compressedSize));
+	put32(header, zip64 ? maxUint32 : uint32_t(record.size));
+	put16(header, uint16_t(record.path.size()));
+	put16(header, zip64 ? 20 : 0);
+
+	header += record.path;
+
+	if(zip64)
+	{
+		put16(header, zip64ExtraId);
+		put16(header, 16);
+		put64(header, record.size);
+		put64(header, record.compressedSize);
+	}
+
+	_write(header.data(), header.size());
+}
+
+void ZipWriter::_write(const void * data, size_t size)
+{
+	if(size > 0 && !_out.write(static_cast<const char*>(data), std::streamsize(size)))
+		throw std::runtime_error("Writing '" + _path + "' failed");
+
+	_offset += size;
+}
+
+///Reads the central directory of the archive this one replaces, so that prepare knows which entries are unchanged. Anything unexpected means nothing gets copied from it.
+void ZipWriter::_readPrevious(const std::string & previousPath)
+{
+	std::error_code error;
+
+	if(previousPath.empty() || !std::filesystem::exists(utf8Path(previousPath), error))
+		return;
+
+	try
+	{
+		_previous.open(utf8Path(previousPath), std::ios::binary);
+		_previous.seekg(0, std::ios::end);
+
+		const uint64_t	fileSize	= uint64_t(_previous.tellg()),
+						tailSize	= std::min<uint64_t>(fileSize, 22 + 0xFFFF + 20);
+		std::string		tail(tailSize, '\0');
+
+		_previous.seekg(std::streamoff(fileSize - tailSize));
+
+		if(!_previous.read(tail.data(), tail.size()))
+			throw std::runtime_error("Cannot read the end");
+
+		size_t endAt = std::string::npos;
+		for(size_t at = tail.size() >= 22 ? tail.size() - 22 : std::string::npos; at != std::string::npos && endAt == std::string::npos; at = at > 0 ? at - 1 : std::string::npos)
+			if(get(tail, at, 4) == endSignature)
+				endAt = at;
+
+		if(endAt == std::string::npos)
+			throw std::runtime_error("Not a zip");
+
+		uint64_t	count			= get(tail, endAt + 10, 2),
+					centralSize		= get(tail, endAt + 12, 4),
+					centralOffset	= get(tail, endAt + 16, 4);
+
+		if(endAt >= 20 && get(tail, endAt - 20, 4) == zip64LocatorSignature)
+		{
+			std::string zip64End(56, '\0');
+			_previous.seekg(std::streamoff(get(tail, endAt - 12, 8)));
+
+			if(!_previous.read(zip64End.data(), zip64End.size()) || get(zip64End, 0, 4) != zip64EndSignature)
+				throw std::runtime_error("Bad zip64 end of central directory");
+
+			count			= get(zip64End, 32, 8);
+			centralSize		= get(zip64End, 40, 8);
+			centralOffset	= get(zip64End, 48, 8);
+		}
+
+		if(centralOffset + centralSize > fileSize)
+			throw std::runtime_error("Central directory out of bounds");
+
+		std::string central(centralSize, '\0');
+		_previous.seekg(std::streamoff(centralOffset));
+
+		if(!_previous.read(central.data(), central.size()))
+			throw std::runtime_error("Cannot read the central directory");
+
+		size_t at = 0;
+		for(uint64_t i=0; i<count; i++)
+		{
+			if(get(central, at, 4) != centralHeaderSignature)
+				throw std::runtime_error("Bad central directory header");
+
+			Record		record;
+			const size_t	nameLength		= get(central, at + 28, 2),
+							extraLength		= get(central, at + 30, 2),
+							commentLength	= get(central, at + 32, 2),
+							extraStart		= at + 46 + nameLength,
+							extraEnd		= extraStart + extraLength;
+
+			record.method			= uint16_t(get(central, at + 10, 2));
+			record.crc				= uint32_t(get(central, at + 16, 4));
+			record.compressedSize	= get(central, at + 20, 4);
+			record.size				= get(central, at + 24, 4);
+			record.offset			= get(central, at + 42, 4);
+
+			if(extraEnd > central.size())
+				throw std::runtime_error("Central directory header cut short");
+
+			record.path = central.substr(at + 46, nameLength);
+
+			for(size_t extra = extraStart; extra + 4 <= extraEnd; extra += 4 + get(central, extra + 2, 2))
+			{
+				const uint64_t	id		= get(central, extra, 2);
+				size_t			field	= extra + 4;
+
+				if(id == zip64ExtraId)
+				{
+					if(record.size				== maxUint32)	{ record.size			= get(central, field, 8); field += 8; }
+					if(record.compressedSize	== maxUint32)	{ record.compressedSize	= get(central, field, 8); field += 8; }
+					if(record.offset			== maxUint32)	{ record.offset			= get(central, field, 8); field += 8; }
+				}
+				else if(id == hashExtraId && get(central, extra + 2, 2) == sizeof(uint64_t))
+				{
+					record.hash		= get(central, field, 8);
+					record.hashed	= true;
+				}
+			}
+
+			if(record.offset + record.compressedSize > centralOffset)
+				throw std::runtime_error("Entry out of bounds");
+
+			if(record.method == methodStore || record.method == methodDeflate)
+				_previousRecords[record.path] = record;
+
+			at = extraEnd + commentLength;
+		}
+	}
+	catch(std::exception & e)
+	{
+		Log::log() << "Entries cannot be copied from previous archive '" << previousPath << "' because: " << e.what() << std::endl;
+
+		_previousRecords.clear();
+		_previous.close();
+	}
+}
@@ -0,0 +1,94 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef ZIPWRITER_H
+#define ZIPWRITER_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <cstdint>
+
+/**
+ * @brief The ZipWriter class - Writes zip archives, such as .jasp files, of which the entries are deflated beforehand.
+ *
+ * libarchive only takes the contents of an entry uncompressed and deflates them itself while writing, on that one thread.
+ * Here an entry is prepared first, which can happen on any thread and deflates blocks of a large entry on several threads at once, and is then written as is.
+ *
+ * The hash of the contents of every entry is recorded in the central directory, in an extra field that other zip readers skip.
+ * When the archive being replaced is passed along, an entry whose contents hash the same as there is copied from it without deflating it again.
+ */
+class ZipWriter
+{
+public:
+	///A part of the contents of an entry, an entry can consist of several so that for instance the columns of data.bin need not be concatenated first
+	typedef std::pair<const char *, size_t> Piece;
+
+	///An entry as prepare made it, ready to be written
+	struct Entry
+	{
+		std::string		path,
+						data;					///< The raw deflate of the contents, or the contents themselves if they are stored
+		bool			deflated		= false,
+						fromPrevious	= false;	///< Unchanged since the previous archive, so write copies it from there and data is empty
+		uint32_t		crc				= 0;
+		uint64_t		size			= 0,	///< Of the contents, before deflating
+						hash			= 0;
+	};
+
+							ZipWriter(const std::string & path, const std::string & previousPath = ""); ///< Throws if path cannot be opened, a previousPath that is missing or isn't a zip written by ZipWriter just means nothing is copied
+							~ZipWriter();
+
+	Entry					prepare(const std::string & path, const std::vector<Piece> & pieces, bool deflate = true, size_t threads = 1) const; ///< Thread-safe, hashes the contents and, unless the previous archive has the same, deflates or stores them. threads is how many deflate the blocks of this entry, 0 means as many as the hardware has
+	Entry					prepare(const std::string & path, const std::string & contents, bool deflate = true) const { return prepare(path, {{contents.data(), contents.size()}}, deflate); }
+	void					write(const Entry & entry); ///< In the order the entries should be in the archive, throws when writing fails
+	void					close(); ///< Writes the central directory, the archive is incomplete until then
+
+	size_t					entriesCopied()		const { return _entriesCopied; }
+
+private:
+	///What the central directory holds about an entry
+	struct Record
+	{
+		std::string		path;
+		uint16_t		method			= 0;
+		uint32_t		crc				= 0;
+		uint64_t		compressedSize	= 0,
+						size			= 0,
+						hash			= 0,
+						offset			= 0;
+		bool			hashed			= false;
+	};
+
+	void					_readPrevious(const std::string & previousPath);
+	void					_writeLocalHeader(const Record & record);
+	void					_write(const void * data, size_t size);
+
+	std::ofstream					_out;
+	std::ifstream					_previous;
+	std::map<std::string, Record>	_previousRecords;
+	std::vector<Record>				_records;
+	std::string						_path;
+	uint64_t						_offset			= 0;
+	uint16_t						_dosTime		= 0,
+									_dosDate		= 0;
+	size_t							_entriesCopied	= 0;
+	bool							_closed			= false;
+};
+
+#endif // ZIPWRITER_H
@@ -29,6 +29,7 @@
 
 #include "utils.h"
 #include "tempfiles.h"
+#include "utilities/imagecache.h"
 #include "log.h"
 
 #include "knownissues.h"
@@ -194,6 +195,7 @@ void Analyses::clear()
 	_orderedIds.clear();
 
 	_nextId = 0;
+	_restoration = Restoration();
 	endResetModel();
 	emit countChanged();
 }
@@ -278,6 +280,7 @@ void Analyses::removeAnalysis(Analysis *analysis)
 
 	beginRemoveRows(QModelIndex(), indexAnalysis, indexAnalysis);
 	analysis->remove();
+	ImageCache::cache()->forgetAnalysis(id);
 	_analysisMap.erase(id);
 	_orderedIds.erase(_orderedIds.begin() + indexAnalysis);
 	for (int requestId : toRemove)
@@ -384,79 +387,224 @@ void Analyses::setAnalysesUserData(Json::Value userData)
 	}
 }
 
-void Analyses::loadAnalysesFromDatasetPackage(bool & errorFound, stringstream & errorMsg, RibbonModel * ribbonModel)
+///How long a slice of restoring analyses may keep the UI waiting
+static const double restoreSliceMs = 10;
+
+static double msBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+	return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+void Analyses::loadAnalysesFromDatasetPackage(RibbonModel * ribbonModel, bool progressive)
 {
-	if (DataSetPackage::pkg()->hasAnalyses())
+	_restoration				= Restoration();
+	_restoration.ribbonModel	= ribbonModel;
+	_restoration.progressive	= progressive;
+	_restoration.started		= std::chrono::steady_clock::now();
+
+	if (!DataSetPackage::pkg()->hasAnalyses())
+	{
+		emit analysesRestored(false, "");
+		return;
+	}
+
+	Json::Value analysesData = DataSetPackage::pkg()->analysesData();
+	if (analysesData.isNull())
 	{
-		int				corruptAnalyses = 0;
-		stringstream	corruptionStrings;
+		emit analysesRestored(true, tr("An error has been detected and analyses could not be loaded."));
+		return;
+	}
 
-		Json::Value analysesData = DataSetPackage::pkg()->analysesData();
-		if (analysesData.isNull())
+	Json::Value analysesDataList = analysesData;
+	if (!analysesData.isArray())
+	{
+		analysesDataList = analysesData.get("analyses", Json::arrayValue);
+		Json::Value meta = analysesData.get("meta",		Json::nullValue);
+
+		if (!meta.isNull())
 		{
-			errorFound = true;
-			errorMsg << "An error has been detected and analyses could not be loaded.";
+			QString results = tq(analysesData["meta"].toStyledString());
+			resultsMetaChanged(results);
+			emit setResultsMeta(results);
 		}
-		else
-		{
-			Json::Value analysesDataList = analysesData;
-			if (!analysesData.isArray())
-			{
-				analysesDataList = analysesData.get("analyses", Json::arrayValue);
-				Json::Value meta = analysesData.get("meta",		Json::nullValue);
-
-				if (!meta.isNull())
-				{
-					QString results = tq(analysesData["meta"].toStyledString());
-					resultsMetaChanged(results);
-					emit setResultsMeta(results);
-				}
-			}
+	}
 
-			JASPTIMER_START(Analyses::loadAnalysesFromDatasetPackage for analysisData : analysesDataList);
+	//Analyses the user adds while the rest is being restored shouldn't take the id of one that is still to come
+	for (const Json::Value & analysisData : analysesDataList)
+		if(_nextId <= analysisData["id"].asUInt())
+			_nextId = analysisData["id"].asUInt() + 1;
 
-			Log::log() << "Loading analyses from jasp-file, entering loop." << std::endl;
-			
-			//There is no point trying to show progress here because qml is not updated while this function runs...
-			for (Json::Value & analysisData : analysesDataList)
-			{
-				try
-				{
-					createFromJaspFileEntry(analysisData, ribbonModel);
-				}
-				catch (Modules::ModuleException modProb)
-				{
-					//Maybe show a nicer messagebox?
-					errorFound = true;
-					corruptionStrings << "\n" << (++corruptAnalyses) << ": " << modProb.what();
-					
-					Log::log() << "Caught module exception: " << modProb.what() << std::endl;
-				}
-				catch (runtime_error & e)
-				{
-					errorFound = true;
-					corruptionStrings << "\n" << (++corruptAnalyses) << ": " << e.what();
-					
-					Log::log() << "Caught runtime_error exception: " << e.what() << std::endl;
-				}
-				catch (exception & e)
-				{
-					errorFound = true;
-					corruptionStrings << "\n" << (++corruptAnalyses) << ": " << e.what();
-					
-					Log::log() << "Caught exception: " << e.what() << std::endl;
-				}
-			}
+	_restoration.analysesData	= analysesDataList;
+	_restoration.active			= true;
 
-			JASPTIMER_STOP(Analyses::loadAnalysesFromDatasetPackage for analysisData : analysesDataList);
-		}
+	Log::log() << "Restoring " << analysesDataList.size() << " analyses from jasp-file" << (progressive ? ", a slice at a time." : ".") << std::endl;
+
+	if(progressive)	scheduleRestoring();
+	else			finishRestoring();
+}
+
+void Analyses::restoreNextAnalysis()
+{
+	JASPTIMER_SCOPE(Analyses::restoreNextAnalysis);
+
+	Json::Value & analysisData = _restoration.analysesData[_restoration.next++];
 
-		if (corruptAnalyses == 1)			errorMsg << "An error was detected in an analysis. This analysis has been removed for the following reason:\n" << corruptionStrings.str();
-		else if (corruptAnalyses > 1)		errorMsg << "Errors were detected in " << corruptAnalyses << " analyses. These analyses have been removed for the following reasons:\n" << corruptionStrings.str();
-		else								Log::log() << "Loading analyses seems to have worked out fine." << std::endl;
+	auto corrupted = [&](const std::string & what)
+	{
+		_restoration.corruptionStrings += "\n" + std::to_string(++_restoration.corruptAnalyses) + ": " + what;
+	};
+
+	try
+	{
+		createFromJaspFileEntry(analysisData, _restoration.ribbonModel);
 	}
-	
+	catch (Modules::ModuleException modProb)
+	{
+		//Maybe show a nicer messagebox?
+		corrupted(modProb.what());
+
+		Log::log() << "Caught module exception: " << modProb.what() << std::endl;
+	}
+	catch (runtime_error & e)
+	{
+		corrupted(e.what());
+
+		Log::log() << "Caught runtime_error exception: " << e.what() << std::endl;
+	}
+	catch (exception & e)
+	{
+		corrupted(e.what());
+
+		Log::log() << "Caught exception: " << e.what() << std::endl;
+	}
+}
+
+void Analyses::scheduleRestoring()
+{
+	if(_restoration.scheduled)
+		return;
+
+	_restoration.scheduled		= true;
+	_restoration.scheduledAt	= std::chrono::steady_clock::now();
+
+	QTimer::singleShot(0, this, &Analyses::restoreSomeAnalyses);
+}
+
+void Analyses::restoreSomeAnalyses()
+{
+	if(!_restoration.scheduled) //Cleared meanwhile
+		return;
+
+	const Restoration::timePoint sliceStart = std::chrono::steady_clock::now();
+
+	_restoration.scheduled		= false;
+	_restoration.longestWaitMs	= std::max(_restoration.longestWaitMs, msBetween(_restoration.scheduledAt, sliceStart));
+	_restoration.slices++;
+
+	auto sliceLeft = [&]() { return msBetween(sliceStart, std::chrono::steady_clock::now()) < restoreSliceMs; };
+
+	if(_restoration.active)
+	{
+		while(_restoration.next < _restoration.analysesData.size() && sliceLeft())
+			restoreNextAnalysis();
+
+		_restoration.longestSliceMs = std::max(_restoration.longestSliceMs, msBetween(sliceStart, std::chrono::steady_clock::now()));
+
+		if(_restoration.next >= _restoration.analysesData.size())
+			finishedRestoring();
+	}
+	else
+		//All analyses are there, so now the forms nobody asked for yet can be built, those get created asynchronously so this doesn't take long
+		while(_restoration.postponedForms.size() && sliceLeft())
+			createPostponedForm(_restoration.postponedForms.front().first);
+
+	if(_restoration.active || _restoration.postponedForms.size())
+		scheduleRestoring();
+}
+
+void Analyses::finishRestoring()
+{
+	if(!_restoration.active)
+		return;
+
+	while(_restoration.next < _restoration.analysesData.size())
+		restoreNextAnalysis();
+
+	finishedRestoring();
+
+	if(_restoration.postponedForms.size())
+		scheduleRestoring();
+}
+
+void Analyses::finishedRestoring()
+{
+	_restoration.active = false;
+
+	const Restoration & r = _restoration;
 
+	Log::log()	<< "Restored " << r.analysesData.size() << " analyses in " << msBetween(r.started, std::chrono::steady_clock::now()) << "ms";
+
+	if(r.progressive)
+		Log::log(false)	<< " over " << r.slices << " slices, the longest slice blocked the UI for " << r.longestSliceMs << "ms and the longest wait for the next one was "
+						<< r.longestWaitMs << "ms. The forms of " << r.postponedForms.size() << " analyses are built afterwards";
+
+	Log::log(false) << "." << std::endl;
+
+	std::stringstream errorMsg;
+
+	if (r.corruptAnalyses == 1)			errorMsg << "An error was detected in an analysis. This analysis has been removed for the following reason:\n" << r.corruptionStrings;
+	else if (r.corruptAnalyses > 1)		errorMsg << "Errors were detected in " << r.corruptAnalyses << " analyses. These analyses have been removed for the following reasons:\n" << r.corruptionStrings;
+	else								Log::log() << "Loading analyses seems to have worked out fine." << std::endl;
+
+	_restoration.analysesData = Json::arrayValue;
+
+	emit analysesRestored(r.corruptAnalyses > 0, tq(errorMsg.str()));
+}
+
+bool Analyses::postponeForm(Analysis * analysis, QQuickItem * parentItem)
+{
+	if(!_restoration.active || !_restoration.progressive || !parentItem || isCurrent(analysis))
+		return false;
+
+	for(auto & idParent : _restoration.postponedForms)
+		if(idParent.first == analysis->id())
+		{
+			idParent.second = parentItem;
+			return true;
+		}
+
+	_restoration.postponedForms.push_back({ analysis->id(), parentItem });
+
+	return true;
+}
+
+bool Analyses::formsPending() const
+{
+	if(_restoration.postponedForms.size())
+		return true;
+
+	bool creating = false;
+	applyToAll([&](Analysis * analysis) { creating = creating || analysis->creatingForm(); });
+
+	return creating;
+}
+
+void Analyses::createPostponedForm(size_t id)
+{
+	for(auto it = _restoration.postponedForms.begin(); it != _restoration.postponedForms.end(); it++)
+		if(it->first == id)
+		{
+			QPointer<QQuickItem>	parentItem	= it->second;
+			Analysis			*	analysis	= get(id);
+
+			_restoration.postponedForms.erase(it);
+
+			//The form might have been started already, because the analysis was selected for instance, and another createForm would start it over
+			if(analysis && parentItem && !analysis->form() && !analysis->creatingForm())
+				analysis->createForm(parentItem);
+
+			return;
+		}
 }
 
 void Analyses::applyToSome(std::function<bool(Analysis *analysis)> applyThis)
@@ -480,6 +628,24 @@ void Analyses::applyToAll(std::function<void(Analysis *analysis)> applyThis) con
 			applyThis(_analysisMap.at(id));
 }
 
+bool Analyses::inView(const Analysis * analysis) const
+{
+	return analysis && _analysesInView.count(analysis->id());
+}
+
+bool Analyses::isCurrent(const Analysis * analysis) const
+{
+	return analysis && _currentAnalysisIndex > -1 && _currentAnalysisIndex < int(_orderedIds.size()) && _orderedIds[_currentAnalysisIndex] == analysis->id();
+}
+
+void Analyses::setAnalysesInView(QVariantList ids)
+{
+	_analysesInView.clear();
+
+	for(const QVariant & id : ids)
+		_analysesInView.insert(id.toULongLong());
+}
+
 QVariant Analyses::data(const QModelIndex &index, int role)	const
 {
 	if(index.row() < 0 || index.row() > rowCount())
@@ -573,7 +739,10 @@ void Analyses::setCurrentAnalysisIndex(int currentAnalysisIndex)
 	emit currentAnalysisIndexChanged(_currentAnalysisIndex);
 
 	if(_currentAnalysisIndex > -1 && _currentAnalysisIndex < _orderedIds.size())
+	{
+		createPostponedForm(_orderedIds[_currentAnalysisIndex]); //Someone wants to see it so it shouldn't wait any longer
 		setVisible(true);
+	}
 	else
 		emit analysesUnselected();
 }
@@ -27,7 +27,10 @@
 #include <QString>
 #include <QMap>
 #include <QAbstractListModel>
+#include <QPointer>
 #include <sstream>
+#include <chrono>
+#include <deque>
 
 class RibbonModel;
 
@@ -77,7 +80,15 @@ public:
 	bool			allFresh()		const;
 	bool			allFinished()	const;
 	void			setAnalysesUserData(Json::Value userData);
-	void			loadAnalysesFromDatasetPackage(bool & errorFound, std::stringstream & errorMsg, RibbonModel * ribbonModel);
+
+	///Restores the analyses of the loaded jasp-file and emits analysesRestored once they are all there.
+	///If progressive it does so a few at a time from the event loop, so that the UI keeps responding and each analysis is shown with its stored results as soon as it is there.
+	///Their forms then wait until they get selected, or until all analyses are restored, see postponeForm.
+	void			loadAnalysesFromDatasetPackage(RibbonModel * ribbonModel, bool progressive = true);
+	bool			restoring()																	const			{ return _restoration.active;	}
+	void			finishRestoring(); ///< Restores whatever is left right away, for when something needs all analyses, like saving
+	bool			postponeForm(Analysis * analysis, QQuickItem * parentItem);
+	bool			formsPending()																const;			///< Some forms are still postponed or being created
 
 	///Applies function to some or all analyses, if applyThis returns false it stops processing.
 	void		applyToSome(std::function<bool(Analysis *analysis)> applyThis);
@@ -86,6 +97,9 @@ public:
 	void		applyToAll(std::function<void(Analysis *analysis)> applyThis);
 	void		applyToAll(std::function<void(Analysis *analysis)> applyThis) const;
 
+	bool		inView(		const Analysis * analysis) const;	///< (Partly) visible in the results
+	bool		isCurrent(	const Analysis * analysis) const;	///< The one whose form is open
+
 	int			count() const	{ assert(_analysisMap.size() == _orderedIds.size()); return _analysisMap.size(); }
 
 	Json::Value asJson() const;
@@ -119,6 +133,7 @@ public slots:
 	void rCodeReturned(QString result, int requestId, bool hasError);
 	void setCurrentFormHeight(double currentFormHeight);
 	void setVisible(bool visible);
+	void setAnalysesInView(QVariantList ids);
 	void setMoving(bool moving);
 	void removeAnalysesOfDynamicModule(Modules::DynamicModule * module);
 	void refreshAnalysesOfDynamicModule(Modules::DynamicModule * module);
@@ -165,6 +180,7 @@ signals:
 	bool developerMode();
 	void setResultsMeta(QString json);
 	void moveAnalyses(quint64 fromId, quint64 toId);
+	void analysesRestored(bool errorFound, QString errorMsg);
 
 	ComputedColumn *	requestComputedColumnCreation(const std::string& columnName, Analysis *source);
 	void				requestColumnCreation(const std::string& columnName, Analysis *source, columnType type);
@@ -174,11 +190,16 @@ signals:
 
 private slots:
 	void sendRScriptHandler(QString script, QString controlName, bool whiteListedVersion, QString module);
+	void restoreSomeAnalyses();
 
 private:
 	void bindAnalysisHandler(Analysis* analysis);
 	void storeAnalysis(Analysis* analysis, size_t id, bool notifyAll);	
 	void _makeBackwardCompatible(RibbonModel* ribbonModel, Version& version, Json::Value& analysisData);
+	void restoreNextAnalysis();
+	void finishedRestoring();
+	void scheduleRestoring();
+	void createPostponedForm(size_t id);
 
 
 private:
@@ -190,6 +211,7 @@ private:
 	std::map<size_t, Analysis*>		_analysisMap;
 	std::vector<size_t>				_orderedIds;
 	std::vector<size_t>				_orderedIdsBeforeMoving;
+	std::set<size_t>				_analysesInView;
 
 	size_t							_nextId					= 0;
 	int								_currentAnalysisIndex	= -1;
@@ -201,6 +223,30 @@ private:
 	static int								_scriptRequestID;
 	QMap<int, QPair<Analysis*, QString> >	_scriptIDMap;
 
+	///Where loadAnalysesFromDatasetPackage is while it restores the analyses a slice at a time, and how long those slices took
+	struct Restoration
+	{
+		typedef std::chrono::steady_clock::time_point					timePoint;
+		typedef std::deque<std::pair<size_t, QPointer<QQuickItem>>>		formQueue;
+
+		bool					active				= false,
+								progressive			= false,
+								scheduled			= false;
+		RibbonModel			*	ribbonModel			= nullptr;
+		Json::Value				analysesData		= Json::arrayValue;
+		Json::ArrayIndex		next				= 0;
+		int						corruptAnalyses		= 0;
+		std::string				corruptionStrings;
+		timePoint				started,
+								scheduledAt;
+		size_t					slices				= 0;
+		double					longestSliceMs		= 0,	///< The longest the UI was blocked by a slice
+								longestWaitMs		= 0;	///< The longest the event loop took to get back to the next slice, which is time the UI got to update
+		formQueue				postponedForms;				///< Analysis ids with the item their form should go in
+	};
+
+	Restoration								_restoration;
+
 };
 
 #endif // ANALYSES_H
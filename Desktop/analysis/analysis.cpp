@@ -28,6 +28,7 @@
 #include "utilities/settings.h"
 #include "gui/preferencesmodel.h"
 #include "utilities/reporter.h"
+#include "utilities/imagecache.h"
 #include "results/resultsjsinterface.h"
 
 Analysis::Analysis(size_t id, Modules::AnalysisEntry * analysisEntry, std::string title, std::string moduleVersion, Json::Value *data) :
@@ -187,6 +188,8 @@ void Analysis::remove()
 
 void Analysis::setResults(const Json::Value & results, Status status, const Json::Value & progress)
 {
+	ImageCache::cache()->forgetAnalysis(_id); //The engine might have written the plots again
+
 	_results		= results;
 	_progress		= progress;
 	_resultsMeta	= _results.get(".meta", Json::arrayValue);
@@ -218,6 +221,7 @@ void Analysis::run()
 void Analysis::refresh()
 {
 	TempFiles::deleteAll(int(_id));
+	ImageCache::cache()->forgetAnalysis(_id);
 	run();
 
 	emit refreshTableViewModels();
@@ -236,6 +240,8 @@ void Analysis::imageSaved(const Json::Value & results)
 	setStatus(Analysis::Complete);
 
 	emit imageSavedSignal(this);
+
+	rewriteImagesIfRequestedMeanwhile();
 }
 
 void Analysis::editImage(const Json::Value &options)
@@ -249,6 +255,8 @@ void Analysis::imageEdited(const Json::Value & results)
 	std::string name = _imgOptions.get("name", "").asString();
 	_imgResults = results;
 
+	ImageCache::cache()->forgetAnalysis(_id);
+
 	if (name != "")
 	{
 		setEditOptionsOfPlot(name, results["editOptions"]);
@@ -264,6 +272,8 @@ void Analysis::imageEdited(const Json::Value & results)
 	//Maybe this is the wrong request, because it took a while and the user kept changing stuff in the ploteditor
 	if(_imgOptions.isMember("request") && _imgResults.isMember("request") && _imgOptions["request"].asInt() != _imgResults["request"].asInt())
 		editImage(_imgOptions);
+	else
+		rewriteImagesIfRequestedMeanwhile();
 }
 
 bool Analysis::updatePlotSize(const std::string & plotName, int width, int height, Json::Value & root)
@@ -294,15 +304,33 @@ bool Analysis::updatePlotSize(const std::string & plotName, int width, int heigh
 
 void Analysis::rewriteImages()
 {
+	//What is being rendered right now uses the old settings, instead of interrupting it the images are rewritten once more when it is done
+	if(isRunningImg())
+	{
+		_rewriteImagesAgain = true;
+		return;
+	}
+
 	setStatus(Analysis::RewriteImgs);
 }
 
+void Analysis::rewriteImagesIfRequestedMeanwhile()
+{
+	if(_rewriteImagesAgain && status() == Analysis::Complete)
+	{
+		_rewriteImagesAgain = false;
+		rewriteImages();
+	}
+}
+
 void Analysis::imagesRewritten(const Json::Value & results)
 {
 	setResults(results, Analysis::Complete);
 	emit resultsChangedSignal(this);
 	emit imageChanged();
 
+	rewriteImagesIfRequestedMeanwhile();
+
 }
 
 Analysis::Status Analysis::parseStatus(std::string name)
@@ -323,8 +351,16 @@ Analysis::Status Analysis::parseStatus(std::string name)
 
 void Analysis::createForm(QQuickItem* parentItem)
 {
+	_lastQmlFormPath = qmlFormPath(false, true); //dont leave this uninitialized
+
+	if(!_analysisForm && !creatingForm() && Analyses::analyses()->postponeForm(this, parentItem))
+		return; //While a jasp-file is being restored forms wait until they are needed
+
 	AnalysisBase::createForm(parentItem);
+}
 
+void Analysis::formCreated()
+{
 	if (_analysisForm)
 	{
 		connect(this,					&Analysis::rSourceChanged,			_analysisForm,	&AnalysisForm::rSourceChanged				);
@@ -339,8 +375,6 @@ void Analysis::createForm(QQuickItem* parentItem)
 
 		emit analysisInitialized();
 	}
-
-	_lastQmlFormPath = qmlFormPath(false, true); //dont leave this uninitialized
 }
 
 Analysis::Status Analysis::analysisResultsStatusToAnalysisStatus(analysisResultStatus result)
@@ -442,6 +476,8 @@ void Analysis::setStatus(Analysis::Status status)
 	if(_status == Analysis::Complete)									storeUserDataEtc();
 	if( status == Analysis::Complete && _status == Analysis::Running)	fitOldUserDataEtc();
 
+	if (status == Analysis::Running)									_rewriteImagesAgain = false; //A run renders everything anew anyway
+
 	if (status == Analysis::Running && needsRefresh())
 	{
 		bool neededRefresh = needsRefresh();
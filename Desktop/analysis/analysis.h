@@ -201,6 +201,7 @@ protected:
 	void					addOwnComputedColumn(	const std::string & col)	{ _computedColumns.push_back(col); }
 	void					removeOwnComputedColumn(const std::string & col)	{ _computedColumns.removeAll(col); }
 	void					watchQmlForm();
+	void					formCreated()												override;
 
 private:
 	void					processResultsForDependenciesToBeShown();
@@ -215,10 +216,12 @@ private:
 	void					initAnalysis();
 	void					setAnalysisForm(AnalysisForm	* analysisForm);
 	bool					readyToCreateForm() const;
+	void					rewriteImagesIfRequestedMeanwhile();
 
 protected:
 	Status						_status				= Empty;
 	bool						_refreshBlocked		= false;
+	bool						_rewriteImagesAgain	= false;	///< Plot settings changed while images were being rendered
 	Json::Value					_results			= Json::nullValue,
 								_resultsMeta		= Json::nullValue,
 								_imgResults			= Json::nullValue,
@@ -10,6 +10,9 @@ Rectangle
 
 	property int leftHandSpace: 0 //Used to allow splithandler to move out of the screen on the left a bit.
 
+	Shortcut { onActivated: dataSetModel.undo();	sequences: [StandardKey.Undo];	enabled: rootDataset.visible && dataSetModel.undoEnabled; }
+	Shortcut { onActivated: dataSetModel.redo();	sequences: [StandardKey.Redo];	enabled: rootDataset.visible && dataSetModel.redoEnabled; }
+
     SplitView
     {
 		id:					splitViewData
@@ -370,6 +370,31 @@ For a local or toy database this is probably overkill, but use your own judgemen
                 }
             }
 
+            Item
+            {
+                anchors.left:		parent.left;
+                anchors.right:		parent.right;
+                height:				syncColumnInput.height
+                enabled:			fileMenuModel.database.interval > 0
+
+                Text
+                {
+                    id:						syncColumnLabel
+                    text:					qsTr("Append only rows beyond (id/timestamp column): ")
+                    anchors.verticalCenter: parent.verticalCenter
+                }
+
+                PrefsTextInput
+                {
+                    id:					syncColumnInput
+                    text:				fileMenuModel.database.syncColumn
+                    onEditingFinished:	fileMenuModel.database.syncColumn = text
+
+                    x:					syncColumnLabel.width + jaspTheme.generalAnchorMargin
+                    width:				parent.width - x
+                }
+            }
+
 
 			Rectangle
 			{
@@ -289,11 +289,38 @@ ScrollView
 				defaultValue:		Math.max(preferencesModel.maxEnginesAdmin, 4)
 				stepSize:			1
 
-				KeyNavigation.tab:	showEnginesWindow
+				KeyNavigation.tab:	engineMemoryBudget
 				activeFocusOnTab:			true
 				text:				qsTr("Maximum number of engines: ")
 			}
 
+			SpinBox
+			{
+				id:					engineMemoryBudget
+				value:				preferencesModel.engineMemoryBudget
+				onValueChanged:		if(value != "") preferencesModel.engineMemoryBudget = value
+				from:				0
+				to:					1048576
+				defaultValue:		0
+				stepSize:			256
+
+				KeyNavigation.tab:	preemptBackgroundRuns
+				activeFocusOnTab:	true
+				text:				qsTr("Memory budget for all engines together (MB, 0 is half of the machine): ")
+				toolTip:			qsTr("When the engines use more than this, idle engines are asked to clean up their memory or are restarted, and no extra engines are started.")
+			}
+
+			CheckBox
+			{
+				id:					preemptBackgroundRuns
+				label:				qsTr("Interrupt analyses out of view for the one being edited")
+				checked:			preferencesModel.preemptBackgroundRuns
+				onCheckedChanged:	preferencesModel.preemptBackgroundRuns = checked
+				toolTip:			qsTr("When the analysis you are working on has to wait for an analysis you cannot see, that one is stopped and run again afterwards.")
+
+				KeyNavigation.tab:	showEnginesWindow
+			}
+
 			RoundedButton
 			{
 				id:					showEnginesWindow
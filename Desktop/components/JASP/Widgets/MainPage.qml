@@ -278,6 +278,7 @@ Item
 			{
 				target:		resultsJsInterface
 				function onRunJavaScriptSignal(js)			{ resultsView.runJavaScript(js); }
+				function onResultsCallsSignal(calls)		{ resultsJsInterfaceInterface.resultsCalls(calls); }
 				function onScrollAtAllChanged(scrollAtAll)	{ resultsView.runJavaScript("window.setScrollAtAll("+(scrollAtAll ? "true" : "false")+")"); }
 
 				function onExportToPDF(pdfPath)
@@ -317,6 +318,8 @@ Item
 
 				property bool reportingVisible: preferencesModel.reportingMode
 
+				signal resultsCalls(string calls) // A JSON array, see ResultsJsInterface::flushResultsCalls
+
 				onReportingVisibleChanged: mainWindow.reloadResults()
 
 				// Yeah I know this "resultsJsInterfaceInterface" looks a bit stupid but this honestly seems like the best way to make the current resultsJsInterface functions available to javascript without rewriting (more of) the structure of Desktop right now.
@@ -343,6 +346,7 @@ Item
 				function duplicateAnalysis(id)						{ resultsJsInterface.duplicateAnalysis(id)						}
 				function showDependenciesInAnalysis(id, optName)	{ resultsJsInterface.showDependenciesInAnalysis(id, optName)	}
 				function showRSyntaxInResults(show)					{ resultsJsInterface.showRSyntaxInResults(show)					}
+				function resultsChannelReady()						{ resultsJsInterface.resultsChannelReady()						}
 
 				function showAnalysesMenu(options)
 				{
@@ -1,5 +1,6 @@
 import QtQuick			2.11
 import QtQuick.Controls	2.4
+import JASP.Controls
 
 
 Item
@@ -93,4 +94,15 @@ Item
 			}
 		}
 	}
+
+	RoundedButton
+	{
+		id:							cancelButton
+		text:						qsTr("Cancel")
+		visible:					mainWindow.progressCancellable
+		onClicked:					mainWindow.cancelProgress()
+		anchors.top:				progressBarHolder.bottom
+		anchors.topMargin:			jaspTheme.generalAnchorMargin
+		anchors.horizontalCenter:	progressBarHolder.horizontalCenter
+	}
 }
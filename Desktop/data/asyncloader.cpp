@@ -85,7 +85,8 @@ void AsyncLoader::free(DataSet *dataSet)
 
 void AsyncLoader::loadTask(FileEvent *event)
 {
-	_currentEvent = event;
+	_currentEvent		= event;
+	_cancelRequested	= false;
 
 	if (event->isOnlineNode())
 		QMetaObject::invokeMethod(_odm, "beginDownloadFile", Qt::AutoConnection, Q_ARG(QString, event->path()), Q_ARG(QString, "asyncloader"));
@@ -170,6 +171,10 @@ void AsyncLoader::saveTask(FileEvent *event)
 
 void AsyncLoader::progressHandler(int progress)
 {
+	//Only opening a file can be stopped halfway, the failed load gets cleaned up by MainWindow. A sync or a save would leave things in an inbetween state.
+	if (_cancelRequested && _currentEvent->operation() == FileEvent::FileOpen)
+		throw LoadCancelled();
+
 	emit this->progress(_currentEvent->getProgressMsg(), progress);
 }
 
@@ -265,6 +270,14 @@ void AsyncLoader::loadPackage(QString id)
 			if (dataNode != nullptr)
 				_odm->deleteActionDataNode(id);
 		}
+		catch (LoadCancelled & e)
+		{
+			Log::log() << "Loading of '" << fq(_currentEvent->path()) << "' was cancelled." << std::endl;
+
+			if (dataNode != nullptr)
+				_odm->deleteActionDataNode(id);
+			_currentEvent->setCancelled();
+		}
 		catch (runtime_error & e)
 		{
 			Log::log() << "Runtime Exception in loadPackage: " << e.what() << std::endl;
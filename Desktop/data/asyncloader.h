@@ -22,6 +22,7 @@
 #include <QObject>
 #include <QMutex>
 #include <QTimer>
+#include <atomic>
 
 #include "dataset.h"
 #include "datasetloader.h"
@@ -30,10 +31,18 @@
 
 #include "osf/onlinedatamanager.h"
 
+///
+/// Thrown from the progress callback of a load once cancel() was called, so that the importer stops at the next point where it reports progress
+class LoadCancelled : public std::runtime_error
+{
+public:
+	LoadCancelled() : std::runtime_error("Loading was cancelled.") {}
+};
+
 ///
 /// Used to run importers and exporters in a different thread from the main event loop.
 /// This way we can keep the interface responsive but it is important to make sure the right kind of qt connections are used.
-/// And no direct calls to the other threads...
+/// And no direct calls to the other threads... Except for cancel(), which is meant to be called directly because this thread is busy loading.
 class AsyncLoader : public QObject
 {
 	Q_OBJECT
@@ -44,6 +53,7 @@ public:
 	void io(FileEvent *event);
 	void free(DataSet *dataSet);
 	void setOnlineDataManager(OnlineDataManager *odm);
+	void cancel() { _cancelRequested = true; } ///< Asks the load that is running to stop, can be called from any thread
 
 signals:
 	void beginLoad(FileEvent*);
@@ -70,6 +80,7 @@ private:
 	DataSetLoader			_loader;
 	FileEvent			*	_currentEvent	= nullptr;
 	OnlineDataManager	*	_odm			= nullptr;
+	std::atomic<bool>		_cancelRequested = false;
 };
 
 #endif // ASYNCLOADER_H
@@ -0,0 +1,79 @@
+#ifndef BOUNDEDQUEUE_H
+#define BOUNDEDQUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <algorithm>
+
+///
+/// Connects the stages of a loading pipeline running on different threads.
+/// A producer blocks while the queue is full, so a fast stage cannot run ahead of a slow one and fill up memory with its results.
+/// Closing the queue wakes up everyone waiting on it, that is how a stage that stops early (failure or cancellation) lets the others know.
+template<typename T>
+class BoundedQueue
+{
+public:
+	///Closes the queue when it goes out of scope, so that the threads on the other side never wait for something that isn't coming (because of an exception for instance)
+	struct Closer
+	{
+		BoundedQueue & queue;
+		~Closer() { queue.close(); }
+	};
+
+	explicit BoundedQueue(size_t capacity) : _capacity(std::max<size_t>(capacity, 1)) {}
+
+	///Blocks while the queue is full, returns false if the queue was closed before item could be added
+	bool push(T && item)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_notFull.wait(lock, [&]() { return _closed || _items.size() < _capacity; });
+
+		if(_closed)
+			return false;
+
+		_items.push_back(std::move(item));
+		lock.unlock();
+		_notEmpty.notify_one();
+
+		return true;
+	}
+
+	///Blocks while the queue is empty, returns false once it is closed and nothing is left in it
+	bool pop(T & item)
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_notEmpty.wait(lock, [&]() { return _closed || _items.size() > 0; });
+
+		if(_items.empty())
+			return false;
+
+		item = std::move(_items.front());
+		_items.pop_front();
+		lock.unlock();
+		_notFull.notify_one();
+
+		return true;
+	}
+
+	void close()
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_closed = true;
+		}
+
+		_notFull.notify_all();
+		_notEmpty.notify_all();
+	}
+
+private:
+	const size_t			_capacity;
+	std::deque<T>			_items;
+	bool					_closed = false;
+	std::mutex				_mutex;
+	std::condition_variable	_notFull,
+							_notEmpty;
+};
+
+#endif // BOUNDEDQUEUE_H
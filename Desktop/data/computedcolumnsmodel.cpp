@@ -204,7 +204,7 @@ void ComputedColumnsModel::revertToDefaultInvalidatedColumns()
 			DataSetPackage::pkg()->columnSetDefaultValues(col->name());
 }
 
-void ComputedColumnsModel::computeColumnSucceeded(QString columnNameQ, QString warningQ, bool dataChanged)
+void ComputedColumnsModel::computeColumnSucceeded(QString columnNameQ, QString warningQ, const ColumnChanges & changes)
 {
 	std::string columnName	= columnNameQ.toStdString(),
 				warning		= warningQ.toStdString();
@@ -214,12 +214,13 @@ void ComputedColumnsModel::computeColumnSucceeded(QString columnNameQ, QString w
 	if(computedColumns()->setError(columnName, warning) && shouldNotifyQML)
 		emit computeColumnErrorChanged();
 
-	if(dataChanged)
-			emit refreshColumn(tq(columnName));
+	//The view only needs to redraw the rows and labels that changed, and when nothing did neither the dependent columns nor the analyses need to be redone
+	if(changes.changed())
+		emit refreshColumn(tq(columnName), changes);
 
 	validate(QString::fromStdString(columnName));
 
-	if(dataChanged)
+	if(changes.changed())
 		checkForDependentColumnsToBeSent(columnName);
 }
 
@@ -71,7 +71,7 @@ signals:
 				void	computeColumnRCodeChanged();
 				void	computeColumnErrorChanged();
 				void	computeColumnJsonChanged();
-				void	refreshColumn(QString columnName);
+				void	refreshColumn(QString columnName, ColumnChanges changes);
 				void	computeColumnNameSelectedChanged();
 				void	headerDataChanged(Qt::Orientation orientation, int first, int last);
 				void	sendComputeCode(QString columnName, QString code, columnType columnType);
@@ -83,7 +83,7 @@ signals:
 				void	showThisColumnChanged(QString showThisColumn);
 
 public slots:
-				void				computeColumnSucceeded(QString columnName, QString warning, bool dataChanged);
+				void				computeColumnSucceeded(QString columnName, QString warning, const ColumnChanges & changes);
 				void				computeColumnFailed(QString columnName, QString error);
 				void				checkForDependentColumnsToBeSentSlot(std::string columnName)					{ checkForDependentColumnsToBeSent(columnName, false); }
 				ComputedColumn *	requestComputedColumnCreation(const std::string& columnName, Analysis * analysis);
@@ -2,6 +2,10 @@
 #include "utilities/qutils.h"
 #include <QSqlDatabase>
 #include <QSqlError>
+#include <QSqlDriver>
+#include <QSqlRecord>
+#include <QSqlField>
+#include "importers/database/databaseimportcolumn.h"
 #include "log.h"
 
 Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
@@ -17,6 +21,7 @@ Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
 	out["database"]		= fq(_database);
 	out["hostname"]		= fq(_hostname);
 	out["query"]		= fq(_query);
+	out["syncColumn"]	= fq(_syncColumn);
 	out["port"]			= _port;
 	out["interval"]		= _interval;
 	out["rememberMe"]	= _rememberMe;
@@ -35,6 +40,7 @@ void DatabaseConnectionInfo::fromJson(const Json::Value & json)
 	_database		= tq(				json["database"]	.asString() )	;
 	_hostname		= tq(				json["hostname"]	.asString() )	;
 	_query			= tq(				json["query"]		.asString() )	;
+	_syncColumn		= tq(				json["syncColumn"]	.asString() )	;
 	_port			=					json["port"]		.asUInt()		;
 	_interval		=					json["interval"]	.asInt()		;
 	_rememberMe		=					json["rememberMe"]	.asBool()		;
@@ -93,4 +99,78 @@ QSqlQuery DatabaseConnectionInfo::runQuery() const
 	return query;
 }
 
+QSqlQuery DatabaseConnectionInfo::runQueryAfter(const QVariant & lastSyncValue) const
+{
+	if(!QSqlDatabase::database().isOpen())
+		throw std::runtime_error(fq(QObject::tr("JASP thinks it's connected to the database but the QSqlDatabase isn't opened...")));
+
+	QString syncColumn	= QSqlDatabase::database().driver()->escapeIdentifier(_syncColumn, QSqlDriver::FieldName),
+			userQuery	= _query.trimmed();
+
+	while(userQuery.endsWith(';'))
+		userQuery.chop(1);
+
+	//If we know the last value as a number but the database stores the column as text it would compare "9" > "10", so then we let it compare numbers as well
+	bool numericValue = lastSyncValue.typeId() == QMetaType::Double || lastSyncValue.typeId() == QMetaType::Int;
+
+	if(numericValue)
+	{
+		QSqlQuery probe;
+
+		if(probe.exec(QString("SELECT * FROM (%1) jaspSync WHERE 1=0").arg(userQuery)))
+		{
+			QSqlRecord	record	= probe.record();
+			int			field	= record.indexOf(_syncColumn);
+
+			if(field >= 0 && DatabaseImportColumn::storageForType(record.field(field).metaType()) == DatabaseImportColumn::storageType::strings)
+				syncColumn = QString("CAST(%1 AS DECIMAL(31,10))").arg(syncColumn);
+		}
+	}
+
+	QSqlQuery query;
+	query.setForwardOnly(true);
+
+	if(!query.prepare(QString("SELECT * FROM (%1) jaspSync WHERE %2 > :lastSyncValue ORDER BY %2").arg(userQuery, syncColumn)))
+		throw std::runtime_error(fq(QObject::tr("Preparing incremental query failed with: '%1'").arg(query.lastError().text())));
+
+	query.bindValue(":lastSyncValue", lastSyncValue);
+
+	if(!query.exec())
+		throw std::runtime_error(fq(QObject::tr("Incremental query failed with: '%1'").arg(query.lastError().text())));
 
+	if(!query.isActive())
+		throw std::runtime_error(fq(QObject::tr("No active result found, maybe there is something wrong with your query?")));
+
+	return query;
+}
+
+QVariant DatabaseConnectionInfo::lastSyncValueOf(const QStringList & values)
+{
+	QString	maxText;
+	double	maxNumber	= 0;
+	bool	numeric		= true,
+			any			= false;
+
+	for(const QString & s : values)
+	{
+		if(s.isEmpty())
+			continue;
+
+		if(s > maxText)
+			maxText = s;
+
+		if(numeric)
+		{
+			bool	isNumber;
+			double	number		= s.toDouble(&isNumber);
+
+			numeric		= isNumber;
+			maxNumber	= !any || number > maxNumber ? number : maxNumber;
+		}
+
+		any = true;
+	}
+
+	//Timestamps arrive as text, for those (in ISO format) the lexicographic maximum is the latest one
+	return !any ? QVariant() : numeric ? QVariant(maxNumber) : QVariant(maxText);
+}
@@ -3,6 +3,7 @@
 
 #include "utilenums.h"
 #include <QString>
+#include <QStringList>
 #include <json/json.h>
 #include <QSqlQuery>
 
@@ -21,6 +22,10 @@ public:
 	
 	QString		lastError() const;
 	QSqlQuery	runQuery()	const;
+	QSqlQuery	runQueryAfter(const QVariant & lastSyncValue)	const; ///< Only fetches the rows of _query where _syncColumn > lastSyncValue
+	bool		syncIncrementally()								const	{ return !_syncColumn.isEmpty(); }
+
+	static QVariant	lastSyncValueOf(const QStringList & values); ///< The maximum of values, numerically if all of them are numbers (so "10" comes after "9") and as text otherwise
 	
 	
 	DbType  _dbType			= DbType::NOTCHOSEN;
@@ -28,7 +33,8 @@ public:
 			_password		= "",
 			_database		= "",
 			_hostname		= "",
-			_query			= "";
+			_query			= "",
+			_syncColumn		= ""; ///< Optional monotonically increasing column (id or timestamp), if set synching only appends the rows beyond its last known value
 	int		_port			= 0,
 			_interval		= 0;
 	bool	_rememberMe		= false,
@@ -0,0 +1,214 @@
+#include "dataeditjournal.h"
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+
+template<typename T> static bool sameValue(T l, T r)							{ return l == r; }
+template<>			 bool sameValue<double>(double l, double r)					{ return (std::isnan(l) && std::isnan(r)) || l == r; }
+
+template<typename T, typename Iterator>
+static std::vector<DataEditJournal::ValueRun<T>> encodeRuns(Iterator begin, Iterator end, size_t rowCount)
+{
+	std::vector<DataEditJournal::ValueRun<T>> runs;
+
+	size_t row = 0;
+	for(Iterator it = begin; it != end && row < rowCount; ++it, ++row)
+		if(runs.size() && sameValue<T>(runs.back().value, *it))	runs.back().rowCount++;
+		else													runs.push_back({ row, 1, *it });
+
+	return runs;
+}
+
+template<typename T>
+static size_t runsBytes(const std::vector<DataEditJournal::ValueRun<T>> & runs)
+{
+	return runs.size() * sizeof(DataEditJournal::ValueRun<T>);
+}
+
+size_t DataEditJournal::Entry::bytes() const
+{
+	size_t total = sizeof(Entry) + column.size() + textBefore.size() + textAfter.size() + labelsBytes(labelsBefore) + labelsBytes(labelsAfter);
+
+	total += runsBytes(stateBefore.ints) + runsBytes(stateBefore.doubles) + labelsBytes(stateBefore.labels);
+
+	return total;
+}
+
+void DataEditJournal::recordLabelText(const std::string & column, size_t labelRow, const std::string & before, const std::string & after)
+{
+	Entry entry;
+	entry.type			= entryType::labelText;
+	entry.column		= column;
+	entry.labelRow		= labelRow;
+	entry.textBefore	= before;
+	entry.textAfter		= after;
+
+	push(std::move(entry));
+}
+
+void DataEditJournal::recordLabelOrder(const std::string & column, std::vector<Label> before, std::vector<Label> after)
+{
+	Entry entry;
+	entry.type			= entryType::labelOrder;
+	entry.column		= column;
+	entry.labelsBefore	= std::move(before);
+	entry.labelsAfter	= std::move(after);
+
+	push(std::move(entry));
+}
+
+void DataEditJournal::recordColumnType(const std::string & column, ColumnState before, columnType after)
+{
+	Entry entry;
+	entry.type			= entryType::columnType;
+	entry.column		= column;
+	entry.stateBefore	= std::move(before);
+	entry.typeAfter		= after;
+
+	push(std::move(entry));
+}
+
+void DataEditJournal::push(Entry && entry)
+{
+	//A new edit makes whatever was undone before unreachable
+	for(const Entry & undone : _redo)
+		_bytes -= undone.bytes();
+	_redo.clear();
+
+	_bytes += entry.bytes();
+	_undo.push_back(std::move(entry));
+
+	shrinkToBudget();
+}
+
+DataEditJournal::Entry DataEditJournal::takeUndo()
+{
+	if(!canUndo())
+		throw std::runtime_error("DataEditJournal::takeUndo called without anything to undo!");
+
+	_redo.push_back(std::move(_undo.back()));
+	_undo.pop_back();
+
+	return _redo.back();
+}
+
+DataEditJournal::Entry DataEditJournal::takeRedo()
+{
+	if(!canRedo())
+		throw std::runtime_error("DataEditJournal::takeRedo called without anything to redo!");
+
+	_undo.push_back(std::move(_redo.back()));
+	_redo.pop_back();
+
+	return _undo.back();
+}
+
+void DataEditJournal::forgetColumn(const std::string & column)
+{
+	//Edits of a column only depend on earlier edits of that same column, so the others can stay
+	auto forget = [&](const Entry & entry)
+	{
+		if(entry.column != column)
+			return false;
+
+		_bytes -= entry.bytes();
+		return true;
+	};
+
+	_undo.erase(std::remove_if(_undo.begin(), _undo.end(), forget), _undo.end());
+	_redo.erase(std::remove_if(_redo.begin(), _redo.end(), forget), _redo.end());
+}
+
+void DataEditJournal::visitLabelTexts(const LabelStrings::TextVisitor & visit)
+{
+	auto visitEntry = [&](Entry & entry)
+	{
+		for(std::vector<Label> * labels : { &entry.labelsBefore, &entry.labelsAfter, &entry.stateBefore.labels })
+			for(Label & label : *labels)
+				label.visitTexts(visit);
+	};
+
+	for(Entry & entry : _undo)	visitEntry(entry);
+	for(Entry & entry : _redo)	visitEntry(entry);
+}
+
+void DataEditJournal::clear()
+{
+	_undo.clear();
+	_redo.clear();
+	_bytes = 0;
+}
+
+void DataEditJournal::setBudget(size_t budget)
+{
+	_budget = budget;
+	shrinkToBudget();
+}
+
+void DataEditJournal::shrinkToBudget()
+{
+	//The latest entry is always kept, even if it is on its own larger than the budget, otherwise the edit the user just made could never be undone
+	while(_bytes > _budget && _undo.size() > 1)
+	{
+		_bytes -= _undo.front().bytes();
+		_undo.pop_front();
+	}
+}
+
+bool DataEditJournal::apply(Column & column, const Entry & entry, bool undo)
+{
+	switch(entry.type)
+	{
+	case entryType::labelText:
+		return column.labels().setLabelFromRow(entry.labelRow, undo ? entry.textBefore : entry.textAfter);
+
+	case entryType::labelOrder:
+	{
+		std::vector<Label> labels = undo ? entry.labelsBefore : entry.labelsAfter;
+		column.labels().set(labels);
+		return true;
+	}
+
+	case entryType::columnType:
+		if(!undo)
+			return column.changeColumnType(entry.typeAfter) == columnTypeChangeResult::changed;
+
+		restoreColumn(column, entry.stateBefore);
+		return true;
+	}
+
+	return false;
+}
+
+DataEditJournal::ColumnState DataEditJournal::captureColumn(Column & column)
+{
+	ColumnState state;
+
+	state.type				= column.getColumnType();
+	state.rowCount			= column.rowCount();
+	state.labels			= std::vector<Label>(column.labels().begin(), column.labels().end()); //Their original texts come along
+
+	if(state.type == columnType::scale)	state.doubles	= encodeRuns<double>(column.AsDoubles.begin(),	column.AsDoubles.end(),	state.rowCount);
+	else								state.ints		= encodeRuns<int>(	column.AsInts.begin(),		column.AsInts.end(),	state.rowCount);
+
+	return state;
+}
+
+void DataEditJournal::restoreColumn(Column & column, const ColumnState & state)
+{
+	if(column.rowCount() != state.rowCount)
+		throw std::runtime_error("DataEditJournal cannot restore column '" + column.name() + "' because its rowcount changed.");
+
+	column.setColumnType(state.type);
+
+	for(const ValueRun<double> & run : state.doubles)
+		for(size_t row=run.firstRow; row<run.firstRow + run.rowCount; row++)
+			column.setValue(int(row), run.value);
+
+	for(const ValueRun<int> & run : state.ints)
+		for(size_t row=run.firstRow; row<run.firstRow + run.rowCount; row++)
+			column.setValue(int(row), run.value);
+
+	std::vector<Label> labels = state.labels;
+	column.labels().set(labels);
+}
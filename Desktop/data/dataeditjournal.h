@@ -0,0 +1,102 @@
+#ifndef DATAEDITJOURNAL_H
+#define DATAEDITJOURNAL_H
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "column.h"
+
+///
+/// Keeps the edits made through the data editor so that they can be undone and redone.
+/// Instead of copying the whole dataset every entry only stores a delta for the single column it touched:
+/// a label text, a label order or, for a change of columntype, the previous values run-length encoded as row ranges.
+/// The total size of the entries is kept under a budget by forgetting the oldest ones.
+/// apply() puts an entry back into or out of its column, DataSetPackage does that inside enlargeDataSetIfNecessary and tells the rest of JASP about it.
+class DataEditJournal
+{
+public:
+	enum class entryType { labelText, labelOrder, columnType };
+
+	template<typename T>
+	struct ValueRun
+	{
+		size_t	firstRow,
+				rowCount;
+		T		value;
+	};
+
+	typedef std::vector<ValueRun<int>>		IntRuns;
+	typedef std::vector<ValueRun<double>>	DoubleRuns;
+
+	///Everything needed to put a column back as it was before its type was changed
+	struct ColumnState
+	{
+		columnType					type		= columnType::unknown;
+		size_t						rowCount	= 0;
+		IntRuns						ints;
+		DoubleRuns					doubles;
+		std::vector<Label>			labels;
+	};
+
+	struct Entry
+	{
+		entryType			type;
+		std::string			column;
+
+		//labelText:
+		size_t				labelRow		= 0;
+		std::string			textBefore,
+							textAfter;
+
+		//labelOrder:
+		std::vector<Label>	labelsBefore,
+							labelsAfter;
+
+		//columnType:
+		ColumnState			stateBefore;
+		columnType			typeAfter		= columnType::unknown;
+
+		size_t				bytes()	const;
+	};
+
+	static const size_t defaultBudget = 64 * 1024 * 1024;
+
+						DataEditJournal(size_t budget = defaultBudget) : _budget(budget) {}
+
+	void				recordLabelText(	const std::string & column, size_t labelRow, const std::string & before, const std::string & after);
+	void				recordLabelOrder(	const std::string & column, std::vector<Label> before, std::vector<Label> after);
+	void				recordColumnType(	const std::string & column, ColumnState before, columnType after);
+
+	bool				canUndo()	const	{ return _undo.size() > 0; }
+	bool				canRedo()	const	{ return _redo.size() > 0; }
+
+	///Moves the most recent entry to the redo stack and returns it, the caller must then revert it in the dataset.
+	Entry				takeUndo();
+	///Moves the most recently undone entry back to the undo stack and returns it, the caller must then reapply it.
+	Entry				takeRedo();
+
+	void				forgetColumn(const std::string & column);
+	void				clear();
+	void				visitLabelTexts(const LabelStrings::TextVisitor & visit);	///< The labels kept here refer to texts in LabelStrings as well, so compacting it must go through them
+
+	size_t				budget()		const	{ return _budget;	}
+	size_t				bytesUsed()		const	{ return _bytes;	}
+	void				setBudget(size_t budget);
+
+	static bool			apply(					Column & column, const Entry & entry, bool undo);	///< Reverts (undo) or reapplies (redo) entry in the column it was recorded for, false if that failed or changed nothing
+	static ColumnState	captureColumn(			Column & column);
+	static void			restoreColumn(			Column & column, const ColumnState & state);
+	static size_t		labelsBytes(const std::vector<Label> & labels) { return labels.size() * sizeof(Label); }
+
+private:
+	void				push(Entry && entry);
+	void				shrinkToBudget();
+
+	std::deque<Entry>	_undo;
+	std::vector<Entry>	_redo;
+	size_t				_budget,
+						_bytes = 0;
+};
+
+#endif // DATAEDITJOURNAL_H
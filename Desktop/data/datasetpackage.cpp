@@ -19,6 +19,7 @@
 #include "log.h"
 #include "utilities/qutils.h"
 #include "sharedmemory.h"
+#include "labelstrings.h"
 #include <QThread>
 #include "engine/enginesync.h"
 #include "jasptheme.h"
@@ -113,9 +114,31 @@ void DataSetPackage::reset()
 	setCurrentFile("");
 
 	resetEmptyValues();
+	resetColumnFingerprints();
 	endLoadingData();
 }
 
+void DataSetPackage::storeColumnFingerprint(const std::string & columnName, uint64_t importFingerprint)
+{
+	int colIndex = getColumnIndex(columnName);
+
+	if(colIndex == -1)	_columnFingerprints.erase(columnName);
+	else				_columnFingerprints[columnName] = std::make_pair(importFingerprint, _dataSet->column(colIndex).valuesFingerprint());
+}
+
+///Only true if the import fingerprint is the same *and* nothing changed the column since then (editing, changing the empty values, etc)
+bool DataSetPackage::columnMatchesFingerprint(const std::string & columnName, uint64_t importFingerprint)
+{
+	int colIndex = getColumnIndex(columnName);
+
+	if(colIndex == -1 || !_columnFingerprints.count(columnName))
+		return false;
+
+	const auto & stored = _columnFingerprints[columnName];
+
+	return stored.first == importFingerprint && stored.second == _dataSet->column(colIndex).valuesFingerprint();
+}
+
 void DataSetPackage::setDataSet(DataSet * dataSet)
 {
 	if(_dataSet == dataSet)
@@ -508,19 +531,21 @@ bool DataSetPackage::setData(const QModelIndex &index, const QVariant &value, in
 
 		default:
 		{
-			QString originalLabel = tq(labels.getLabelFromRow(index.row()));
-			if(labels.setLabelFromRow(index.row(), value.toString().toStdString()))
-			{
-				QModelIndex parent	= index.parent();
-				size_t		row		= index.row(),
-							col		= parent.column();
+			std::string originalLabel	= labels.getLabelFromRow(index.row());
+			bool		changed			= false;
+
+			//The new text might need a bigger segment, which moves the column, so it is fetched inside
+			enlargeDataSetIfNecessary([&](){ changed = _dataSet->column(columnIndex).labels().setLabelFromRow(index.row(), value.toString().toStdString()); }, "setData");
 
-				emit dataChanged(DataSetPackage::index(row, 0, parent), DataSetPackage::index(row, columnCount(parent), parent));	//Emit dataChanged for filter
+			if(changed)
+			{
+				std::string newLabel = _dataSet->column(columnIndex).labels().getLabelFromRow(index.row());
 
-				parent = parentModelForType(parIdxType::data);
-				emit dataChanged(DataSetPackage::index(0, col, parent), DataSetPackage::index(rowCount(), col, parent), { Qt::DisplayRole });
+				_editJournal.recordLabelText(getColumnName(columnIndex), index.row(), originalLabel, newLabel);
+				emit unOrRedoEnabledChanged();
 
-				emit labelChanged(tq(getColumnName(col)), originalLabel, tq(labels.getLabelFromRow(index.row())));
+				emitLabelTextChanged(columnIndex, index.row(), tq(originalLabel), tq(newLabel));
+				compactLabelStrings();
 				return true;
 			}
 			break;
@@ -532,6 +557,130 @@ bool DataSetPackage::setData(const QModelIndex &index, const QVariant &value, in
 	return false;
 }
 
+void DataSetPackage::emitLabelTextChanged(size_t column, size_t labelRow, const QString & originalLabel, const QString & newLabel)
+{
+	QModelIndex parent = parentModelForType(parIdxType::label, column);
+	emit dataChanged(DataSetPackage::index(labelRow, 0, parent), DataSetPackage::index(labelRow, columnCount(parent), parent));	//Emit dataChanged for filter
+
+	parent = parentModelForType(parIdxType::data);
+	emit dataChanged(DataSetPackage::index(0, column, parent), DataSetPackage::index(rowCount(), column, parent), { Qt::DisplayRole });
+
+	emit labelChanged(tq(getColumnName(column)), originalLabel, newLabel);
+}
+
+void DataSetPackage::emitColumnTypeChanged(size_t column)
+{
+	QModelIndex parent = parentModelForType(parIdxType::data);
+
+	emit headerDataChanged(Qt::Orientation::Horizontal, column, column);
+	emit dataChanged(DataSetPackage::index(0, column, parent), DataSetPackage::index(rowCount(), column, parent));
+	emit columnDataTypeChanged(tq(getColumnName(column)));
+}
+
+void DataSetPackage::undo()
+{
+	if(!_dataSet || !_editJournal.canUndo())
+		return;
+
+	applyJournalEntry(_editJournal.takeUndo(), true);
+	emit unOrRedoEnabledChanged();
+	compactLabelStrings();
+}
+
+void DataSetPackage::redo()
+{
+	if(!_dataSet || !_editJournal.canRedo())
+		return;
+
+	applyJournalEntry(_editJournal.takeRedo(), false);
+	emit unOrRedoEnabledChanged();
+	compactLabelStrings();
+}
+
+///Reverts (undo) or reapplies (redo) a single journal entry and only tells the rest of JASP about the column it touched
+void DataSetPackage::applyJournalEntry(const DataEditJournal::Entry & entry, bool undo)
+{
+	int columnIndex = getColumnIndex(entry.column);
+
+	if(columnIndex < 0)
+	{
+		Log::log() << "Cannot " << (undo ? "undo" : "redo") << " an edit of column '" << entry.column << "' because it does not exist anymore, forgetting the edits." << std::endl;
+		_editJournal.clear();
+		return;
+	}
+
+	bool changed = false;
+	enlargeDataSetIfNecessary([&](){ changed = DataEditJournal::apply(_dataSet->column(columnIndex), entry, undo); }, "applyJournalEntry"); //The column is fetched inside because enlarging the dataset moves it
+
+	switch(entry.type)
+	{
+	case DataEditJournal::entryType::labelText:
+		if(changed)
+			emitLabelTextChanged(columnIndex, entry.labelRow, tq(undo ? entry.textAfter : entry.textBefore), tq(undo ? entry.textBefore : entry.textAfter));
+		break;
+
+	case DataEditJournal::entryType::labelOrder:
+		emitLabelsReordered(columnIndex);
+		break;
+
+	case DataEditJournal::entryType::columnType:
+		if(!changed)
+		{
+			Log::log() << "Replaying columntype change of '" << entry.column << "' failed, forgetting the edits of that column." << std::endl;
+			_editJournal.forgetColumn(entry.column);
+		}
+
+		emitColumnTypeChanged(columnIndex);
+		break;
+	}
+}
+
+///Texts of renamed, retyped or synched away labels are only forgotten here, once LabelStrings doubled since the last time.
+///The engines read those texts without locking, so they are paused meanwhile unless they already were.
+void DataSetPackage::compactLabelStrings(bool enginesPaused)
+{
+	LabelStrings * strings = LabelStrings::labelStrings();
+
+	if(!_dataSet || !strings || !strings->worthCompacting())
+		return;
+
+	JASPTIMER_SCOPE(DataSetPackage::compactLabelStrings);
+
+	const size_t charsBefore = strings->charsUsed();
+
+	if(!enginesPaused)
+		enginesPrepareForData();
+
+	try
+	{
+		strings->compact([&](const LabelStrings::TextVisitor & visit)
+		{
+			_dataSet->visitLabelTexts(visit);
+			_editJournal.visitLabelTexts(visit);
+		});
+
+		Log::log() << "DataSetPackage::compactLabelStrings kept " << strings->charsUsed() << " of " << charsBefore << " characters in " << strings->count() << " label texts." << std::endl;
+	}
+	catch(std::exception & e)
+	{
+		Log::log() << "DataSetPackage::compactLabelStrings failed: " << e.what() << std::endl;
+	}
+
+	if(!enginesPaused)
+		enginesReceiveNewData();
+}
+
+void DataSetPackage::forgetEditsOfColumn(const std::string & columnName)
+{
+	bool couldUndo = _editJournal.canUndo(),
+		 couldRedo = _editJournal.canRedo();
+
+	_editJournal.forgetColumn(columnName);
+
+	if(couldUndo != _editJournal.canUndo() || couldRedo != _editJournal.canRedo())
+		emit unOrRedoEnabledChanged();
+}
+
 
 void DataSetPackage::resetFilterAllows(size_t columnIndex)
 {
@@ -853,14 +1002,26 @@ bool DataSetPackage::setColumnType(int columnIndex, columnType newColumnType)
 	if (_dataSet == nullptr)
 		return true;
 
-	columnTypeChangeResult	feedback;
+	columnTypeChangeResult			feedback;
+	bool							sameType	= getColumnType(columnIndex) == newColumnType;
+	DataEditJournal::ColumnState	before;
+
+	if(!sameType)
+		before = DataEditJournal::captureColumn(_dataSet->column(columnIndex));
 
 	enlargeDataSetIfNecessary([&](){ feedback = _dataSet->column(columnIndex).changeColumnType(newColumnType); }, "setColumnType");
 
 	if (feedback == columnTypeChangeResult::changed) //Everything went splendidly
 	{
+		if(!sameType)
+		{
+			_editJournal.recordColumnType(getColumnName(columnIndex), std::move(before), newColumnType);
+			emit unOrRedoEnabledChanged();
+		}
+
 		emit headerDataChanged(Qt::Orientation::Horizontal, columnIndex, columnIndex);
 		emit columnDataTypeChanged(tq(_dataSet->column(columnIndex).name()));
+		compactLabelStrings();
 	}
 	else
 	{
@@ -888,22 +1049,54 @@ bool DataSetPackage::setColumnType(int columnIndex, columnType newColumnType)
 	return feedback == columnTypeChangeResult::changed;
 }
 
-void DataSetPackage::refreshColumn(QString columnName)
+///Only redraws the rows that changed or show a label that did, unless there are so many that redrawing the whole column is cheaper.
+void DataSetPackage::refreshColumn(QString columnName, ColumnChanges changes)
 {
 	if(!_dataSet) return;
 
 	int colIndex = getColumnIndex(columnName);
 
-	if(colIndex >= 0)
+	if(colIndex < 0)
+		return;
+
+	QModelIndex	p		= parentModelForType(parIdxType::data);
+	ChangedRows	redraw	= changes.rows;
+	Column	&	column	= _dataSet->column(colIndex);
+
+	if(!changes.allRows && changes.labels.size() && column.getColumnType() != columnType::scale)
 	{
-		QModelIndex p = parentModelForType(parIdxType::data);
-		emit dataChanged(index(0, colIndex, p), index(rowCount(p), colIndex, p));
-		emit headerDataChanged(Qt::Horizontal, colIndex, colIndex);
+		//A row that kept its key still shows another text when the label of that key changed
+		auto	run	= changes.rows.runs.begin();
+		size_t	row	= 0;
+
+		redraw = ChangedRows();
+
+		for(int key : column.AsInts)
+		{
+			while(run != changes.rows.runs.end() && run->first + run->count <= row)
+				run++;
+
+			if((run != changes.rows.runs.end() && run->first <= row) || changes.labels.count(key))
+				redraw.rowChanged(row);
+
+			row++;
+		}
 	}
+
+	if(changes.allRows || redraw.tooScattered(rowCount()))
+		emit dataChanged(index(0, colIndex, p), index(rowCount(p) - 1, colIndex, p));
+	else
+		for(const ChangedRows::Run & run : redraw.runs)
+			emit dataChanged(index(run.first, colIndex, p), index(run.first + run.count - 1, colIndex, p));
+
+	if(changes.type || changes.labels.size())
+		emit headerDataChanged(Qt::Horizontal, colIndex, colIndex);
 }
 
 void DataSetPackage::columnWasOverwritten(std::string columnName, std::string)
 {
+	forgetEditsOfColumn(columnName);
+
 	for(size_t col=0; col<_dataSet->columns().columnCount(); col++)
 		if(_dataSet->columns()[col].name() == columnName)
 			emit dataChanged(index(0, col, parentModelForType(parIdxType::data)), index(rowCount()-1, col, parentModelForType(parIdxType::data)));
@@ -956,8 +1149,14 @@ void DataSetPackage::endLoadingData()
 	JASPTIMER_SCOPE(DataSetPackage::endLoadingData);
 
 	regenerateInternalPointers();
+
+	//Whatever was loaded or synched replaced the data the journal refers to
+	_editJournal.clear();
+	compactLabelStrings(true);
+
 	endResetModel();
 	enginesReceiveNewData();
+	emit unOrRedoEnabledChanged();
 
 	emit modelInit();
 	emit dataSetChanged();
@@ -990,9 +1189,9 @@ bool DataSetPackage::initColumnAsScale(size_t colNo, std::string newName, const
 	return out;
 }
 
-std::map<int, std::string> DataSetPackage::initColumnAsNominalText(size_t colNo, std::string newName, const std::vector<std::string> & values, const std::map<std::string, std::string> & labels)
+ColumnEmptyValues DataSetPackage::initColumnAsNominalText(size_t colNo, std::string newName, const std::vector<std::string> & values, const std::map<std::string, std::string> & labels)
 {
-	std::map<int, std::string> out;
+	ColumnEmptyValues out;
 
 	enlargeDataSetIfNecessary([&]()
 	{
@@ -1038,6 +1237,29 @@ bool DataSetPackage::initColumnAsNominalOrOrdinal(size_t colNo, std::string newN
 	return out;
 }
 
+void DataSetPackage::setColumnValuesFrom(size_t colNo, size_t firstRow, const std::vector<double> & values)
+{
+	enlargeDataSetIfNecessary([&](){ _dataSet->column(colNo).setValues(firstRow, values); }, "setColumnValuesFrom");
+}
+
+bool DataSetPackage::setColumnValuesFrom(size_t colNo, size_t firstRow, const std::vector<int> & values)
+{
+	bool labelsAdded = false;
+
+	enlargeDataSetIfNecessary([&](){ labelsAdded = _dataSet->column(colNo).setValues(firstRow, values); }, "setColumnValuesFrom");
+
+	return labelsAdded;
+}
+
+bool DataSetPackage::setColumnValuesFrom(size_t colNo, size_t firstRow, const std::vector<std::string> & values)
+{
+	bool labelsAdded = false;
+
+	enlargeDataSetIfNecessary([&](){ labelsAdded = _dataSet->column(colNo).setValues(firstRow, values); }, "setColumnValuesFrom");
+
+	return labelsAdded;
+}
+
 bool DataSetPackage::initColumnAsScale(QVariant colID, std::string newName, const std::vector<double> & values)
 {
 	if(colID.typeId() == QMetaType::Int || colID.typeId() == QMetaType::UInt)
@@ -1049,7 +1271,7 @@ bool DataSetPackage::initColumnAsScale(QVariant colID, std::string newName, cons
 		return initColumnAsScale(colID.toString().toStdString(), newName, values);
 }
 
-std::map<int, std::string> DataSetPackage::initColumnAsNominalText(QVariant colID, std::string newName, const std::vector<std::string> & values, const std::map<std::string, std::string> & labels)
+ColumnEmptyValues DataSetPackage::initColumnAsNominalText(QVariant colID, std::string newName, const std::vector<std::string> & values, const std::map<std::string, std::string> & labels)
 {
 	if(colID.typeId() == QMetaType::Int || colID.typeId() == QMetaType::UInt)
 	{
@@ -1128,6 +1350,15 @@ void DataSetPackage::renameColumn(std::string oldColumnName, std::string newColu
 	{
 		Column & col = _dataSet->column(oldColumnName);
 		col.setName(newColumnName);
+
+		forgetEditsOfColumn(oldColumnName);
+
+		if(_columnFingerprints.count(oldColumnName))
+		{
+			_columnFingerprints[newColumnName] = _columnFingerprints[oldColumnName];
+			_columnFingerprints.erase(oldColumnName);
+		}
+
 		emit columnNamesChanged();
 	}
 	catch(...)
@@ -1252,7 +1483,7 @@ Json::Value DataSetPackage::columnToJsonForJASPFile(size_t columnIndex, Json::Va
 			}
 
 			Json::Value &orgStringValuesMetaData	= columnLabelData["orgStringValues"];
-			std::map<int, std::string> &orgLabels	= labels.getOrgStringValues();
+			std::map<int, std::string> orgLabels	= labels.getOrgStringValues();
 			for (const auto & pair : orgLabels)
 			{
 				Json::Value keyValuePair(Json::arrayValue);
@@ -1390,16 +1621,9 @@ void DataSetPackage::emptyValuesChangedHandler()
 	if (isLoaded())
 	{
 		beginSynchingData();
-		std::map<std::string, std::map<int, std::string> > emptyValuesChanged;
 		std::vector<std::string> colChanged;
 
-		enlargeDataSetIfNecessary([&](){ emptyValuesChanged = _dataSet->resetEmptyValues(emptyValuesMap()); }, "emptyValuesChangedHandler");
-
-		for (auto & it : emptyValuesChanged)
-		{
-			colChanged.push_back(it.first);
-			storeInEmptyValues(it.first, it.second);
-		}
+		enlargeDataSetIfNecessary([&](){ colChanged = _dataSet->resetEmptyValues(_emptyValuesMap); }, "emptyValuesChangedHandler");
 
 		endSynchingDataChangedColumns(colChanged);
 	}
@@ -1409,19 +1633,37 @@ bool DataSetPackage::setFilterData(std::string filter, std::vector<bool> filterR
 {
 	setDataFilter(filter);
 
-	bool someFilterValueChanged = _dataSet ? _dataSet->setFilterVector(filterResult) : false;
+	ChangedRows changed = _dataSet ? _dataSet->setFilterVector(filterResult) : ChangedRows();
 
-	if(someFilterValueChanged) //We could also send exactly those cells that were changed if we were feeling particularly inclined to write the code...
-	{
-		//emit dataChanged(index(0, 0, parentModelForType(parIdxType::filter)),	index(rowCount(), 0,				parentModelForType(parIdxType::filter)));
-		//This actually lets the whole application freeze when a filter is undone... -> emit dataChanged(index(0, 0, parentModelForType(parIdxType::data)),		index(rowCount(), columnCount(),	parentModelForType(parIdxType::data)));
+	if(!changed.changed())
+		return false;
 
+	//A dataChanged over all rows froze the application when a filter was undone, so we only tell about the rows that changed.
+	//Unless there are so many scattered ones that a reset is cheaper for all the views and proxies.
+	if(changed.tooScattered(rowCount()))
+	{
 		beginResetModel();
 		regenerateInternalPointers();
 		endResetModel();
 	}
+	else
+	{
+		const QModelIndex	filterParent	= parentModelForType(parIdxType::filter),
+							dataParent		= parentModelForType(parIdxType::data);
+		const int			lastColumn		= columnCount() - 1;
+
+		for(const ChangedRows::Run & run : changed.runs)
+		{
+			int first	= run.first,
+				last	= run.first + run.count - 1,
+				above	= std::max(0, first - 1); //The lines of the row above depend on whether this one is active
+
+			emit dataChanged(index(first, 0, filterParent),	index(last, 0,			filterParent));
+			emit dataChanged(index(above, 0, dataParent),	index(last, lastColumn,	dataParent), { int(specialRoles::filter), int(specialRoles::lines) });
+		}
+	}
 
-	return someFilterValueChanged;
+	return true;
 }
 
 columnType DataSetPackage::getColumnType(std::string columnName)	const
@@ -1502,6 +1744,9 @@ void DataSetPackage::labelMoveRows(size_t column, std::vector<size_t> rows, bool
 		rowsChanged.insert(row + mod);
 	}
 
+	_editJournal.recordLabelOrder(getColumnName(column), std::vector<Label>(labels.begin(), labels.end()), new_labels);
+	emit unOrRedoEnabledChanged();
+
 	labels.set(new_labels);
 	QModelIndex p = parentModelForType(parIdxType::label, column);
 
@@ -1518,7 +1763,18 @@ void DataSetPackage::labelReverse(size_t column)
 	std::vector<Label> new_labels(labels.begin(), labels.end());
 
 	std::reverse(new_labels.begin(), new_labels.end());
+
+	_editJournal.recordLabelOrder(getColumnName(column), std::vector<Label>(labels.begin(), labels.end()), new_labels);
+	emit unOrRedoEnabledChanged();
+
 	labels.set(new_labels);
+
+	emitLabelsReordered(column);
+}
+
+///Tells the label editor, the analyses and a filter using the column that its labels have another order, the same after a reorder by the user and after undoing or redoing one
+void DataSetPackage::emitLabelsReordered(size_t column)
+{
 	QModelIndex p = parentModelForType(parIdxType::label, column);
 
 	emit dataChanged(index(0, 0, p), index(rowCount(p), columnCount(p), p));
@@ -1567,6 +1823,8 @@ void DataSetPackage::removeColumn(std::string name)
 
 	beginResetModel();
 	_dataSet->columns().removeColumn(name);
+	_columnFingerprints.erase(name);
+	forgetEditsOfColumn(name);
 	regenerateInternalPointers();
 	endResetModel();
 
@@ -29,6 +29,7 @@
 #include <json/json.h>
 #include "computedcolumns.h"
 #include "datasetdefinitions.h"
+#include "dataeditjournal.h"
 #include <QTimer>
 
 class EngineSync;
@@ -64,8 +65,11 @@ class DataSetPackage : public QAbstractItemModel //Not QAbstractTableModel becau
 	Q_PROPERTY(bool			modified				READ isModified				WRITE setModified		NOTIFY isModifiedChanged			)
 	Q_PROPERTY(bool			loaded					READ isLoaded				WRITE setLoaded			NOTIFY loadedChanged				)
 	Q_PROPERTY(QString		currentFile				READ currentFile			WRITE setCurrentFile	NOTIFY currentFileChanged			)
+	Q_PROPERTY(bool			undoEnabled				READ undoEnabled									NOTIFY unOrRedoEnabledChanged		)
+	Q_PROPERTY(bool			redoEnabled				READ redoEnabled									NOTIFY unOrRedoEnabledChanged		)
 
-	typedef std::map<std::string, std::map<int, std::string>>	emptyValsType;
+	typedef DataSet::emptyValsType								emptyValsType; ///< columnname -> original values of the rows that are empty
+	typedef std::map<std::string, std::pair<uint64_t, uint64_t>>	fingerprintsType; ///< columnname -> (fingerprint of imported strings, Column::valuesFingerprint() right after importing them)
 	typedef std::pair<parIdxType, int>							intnlPntPair; //first value is what kind of data the index is for and the int is for parIdxType::label only, to know which column is selected.
 	typedef std::vector<intnlPntPair>							internalPointerType;
 	typedef DataSetPackageSubNodeModel							SubNodeModel;
@@ -134,9 +138,13 @@ public:
 				int					dataRowCount()		const { return rowCount(parentModelForType(parIdxType::data));		}
 				int					dataColumnCount()	const { return columnCount(parentModelForType(parIdxType::data));	}
 
-				void				storeInEmptyValues(std::string columnName, std::map<int, std::string> emptyValues)	{ _emptyValuesMap[columnName] = emptyValues;	}
+				void				storeInEmptyValues(std::string columnName, ColumnEmptyValues emptyValues)			{ _emptyValuesMap[columnName] = std::move(emptyValues);	}
 				void				resetEmptyValues()																	{ _emptyValuesMap.clear();											}
 
+				void				storeColumnFingerprint(const std::string & columnName, uint64_t importFingerprint);
+				bool				columnMatchesFingerprint(const std::string & columnName, uint64_t importFingerprint);
+				void				resetColumnFingerprints()															{ _columnFingerprints.clear();										}
+
 				std::string			id()								const	{ return _id;							}
 				QString				name()								const;
 				QString				folder()							const	{ return _folder;						}
@@ -165,6 +173,9 @@ public:
 				bool				isDatabaseSynching()				const	{ return _databaseIntervalSyncher.isActive();	}
 		const	Version			&	dataArchiveVersion()				const	{ return _dataArchiveVersion;						   }
 				bool				filterShouldRunInit()				const	{ return _filterShouldRunInit;							}
+				bool				undoEnabled()						const	{ return _editJournal.canUndo();						}
+				bool				redoEnabled()						const	{ return _editJournal.canRedo();						}
+				DataEditJournal	&	editJournal()								{ return _editJournal;									}
 		const	std::string		&	filterConstructorJson()				const	{ return _filterConstructorJSON;					    }
 
 
@@ -202,9 +213,14 @@ public:
 				bool						initColumnAsNominalOrOrdinal(	std::string colName,	std::string newName, const std::vector<int>			& values,	bool is_ordinal = false) { return initColumnAsNominalOrOrdinal(_dataSet->getColumnIndex(colName), newName, values, is_ordinal); }
 				bool						initColumnAsNominalOrOrdinal(	QVariant colID,			std::string newName, const std::vector<int>			& values,	bool is_ordinal = false);
 
-				std::map<int, std::string>	initColumnAsNominalText(		size_t colNo,			std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>());
-				std::map<int, std::string>	initColumnAsNominalText(		std::string colName,	std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>())	{ return initColumnAsNominalText(_dataSet->getColumnIndex(colName), newName, values, labels); }
-				std::map<int, std::string>	initColumnAsNominalText(		QVariant colID,			std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>());
+				ColumnEmptyValues			initColumnAsNominalText(		size_t colNo,			std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>());
+				ColumnEmptyValues			initColumnAsNominalText(		std::string colName,	std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>())	{ return initColumnAsNominalText(_dataSet->getColumnIndex(colName), newName, values, labels); }
+				ColumnEmptyValues			initColumnAsNominalText(		QVariant colID,			std::string newName, const std::vector<std::string>	& values,	const std::map<std::string, std::string> & labels = std::map<std::string, std::string>());
+
+				///Write values into the rows of a column from firstRow on, for appending rows without rewriting the column. The int and string versions return whether labels were added.
+				void						setColumnValuesFrom(			size_t colNo,			size_t firstRow,	 const std::vector<double>		& values);
+				bool						setColumnValuesFrom(			size_t colNo,			size_t firstRow,	 const std::vector<int>			& values);
+				bool						setColumnValuesFrom(			size_t colNo,			size_t firstRow,	 const std::vector<std::string>	& values);
 
 				void						columnSetDefaultValues(std::string columnName, columnType colType = columnType::unknown);
 				bool						createColumn(std::string name, columnType colType);
@@ -302,22 +318,31 @@ signals:
 				void				loadedChanged();
 				void				currentFileChanged();
 				void				synchingIntervalPassed();
+				void				unOrRedoEnabledChanged();
 
 public slots:
 				void				refresh() { beginResetModel(); endResetModel(); }
-				void				refreshColumn(QString columnName);
+				void				refreshColumn(QString columnName, ColumnChanges changes);
 				void				columnWasOverwritten(std::string columnName, std::string possibleError);
 				void				notifyColumnFilterStatusChanged(int columnIndex);
 				void				setColumnsUsedInEasyFilter(std::set<std::string> usedColumns);
 				void				emptyValuesChangedHandler();
 				void				setCurrentFile(QString currentFile);
 				void				setFolder(QString folder);
+				void				undo();
+				void				redo();
 
 private:
 				///This function allows you to run some code that changes something in the _dataSet and will try to enlarge it if it fails with an allocation error. Otherwise it might keep going for ever?
 				void				enlargeDataSetIfNecessary(std::function<void()> tryThis, const char * callerText);
 				bool				isThisTheSameThreadAsEngineSync();
 				bool				setAllowFilterOnLabel(const QModelIndex & index, bool newAllowValue);
+				void				applyJournalEntry(const DataEditJournal::Entry & entry, bool undo);
+				void				forgetEditsOfColumn(const std::string & columnName);
+				void				emitLabelTextChanged(size_t column, size_t labelRow, const QString & originalLabel, const QString & newLabel);
+				void				emitLabelsReordered(size_t column);
+				void				emitColumnTypeChanged(size_t column);
+				void				compactLabelStrings(bool enginesPaused = false);
 
 
 private:
@@ -325,6 +350,8 @@ private:
 	DataSet					*	_dataSet					= nullptr;
 	EngineSync				*	_engineSync					= nullptr;
 	emptyValsType				_emptyValuesMap;
+	fingerprintsType			_columnFingerprints;
+	DataEditJournal				_editJournal;
 
 	QString						_currentFile,
 								_folder,
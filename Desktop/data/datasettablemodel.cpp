@@ -27,6 +27,7 @@ DataSetTableModel::DataSetTableModel(bool showInactive)
 	connect(DataSetPackage::pkg(),	&DataSetPackage::columnDataTypeChanged,			this, &DataSetTableModel::columnTypeChanged				);
 	connect(DataSetPackage::pkg(),	&DataSetPackage::labelChanged,					this, &DataSetTableModel::labelChanged					);
 	connect(DataSetPackage::pkg(),	&DataSetPackage::labelsReordered,				this, &DataSetTableModel::labelsReordered				);
+	connect(DataSetPackage::pkg(),	&DataSetPackage::unOrRedoEnabledChanged,		this, &DataSetTableModel::unOrRedoEnabledChanged		);
 	//connect(this,		&DataSetTableModel::dataChanged,				this, &DataSetTableModel::onDataChanged,				Qt::QueuedConnection);
 
 	setFilterRole(int(DataSetPackage::specialRoles::filter));
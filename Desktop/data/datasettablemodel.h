@@ -29,6 +29,8 @@ class DataSetTableModel : public DataSetTableProxy
 	Q_OBJECT
 	Q_PROPERTY(int	columnsFilteredCount	READ columnsFilteredCount							NOTIFY columnsFilteredCountChanged)
 	Q_PROPERTY(bool showInactive			READ showInactive			WRITE setShowInactive	NOTIFY showInactiveChanged)
+	Q_PROPERTY(bool undoEnabled				READ undoEnabled									NOTIFY unOrRedoEnabledChanged)
+	Q_PROPERTY(bool redoEnabled				READ redoEnabled									NOTIFY unOrRedoEnabledChanged)
 
 public:
 	explicit				DataSetTableModel(bool showInactive = true);
@@ -41,6 +43,8 @@ public:
 	Q_INVOKABLE bool		columnUsedInEasyFilter(int column)		const				{ return DataSetPackage::pkg()->isColumnUsedInEasyFilter(column);					}
 	Q_INVOKABLE void		resetAllFilters()											{		 DataSetPackage::pkg()->resetAllFilters();									}
 	Q_INVOKABLE int			setColumnTypeFromQML(int columnIndex, int newColumnType)	{ return DataSetPackage::pkg()->setColumnTypeFromQML(columnIndex, newColumnType);	}
+	Q_INVOKABLE void		undo()														{		 DataSetPackage::pkg()->undo();												}
+	Q_INVOKABLE void		redo()														{		 DataSetPackage::pkg()->redo();												}
 
 	columnType				getColumnType(size_t column)			const				{ return DataSetPackage::pkg()->getColumnType(column);								}
 	std::string				getColumnName(size_t col)				const				{ return DataSetPackage::pkg()->getColumnName(col);									}
@@ -53,6 +57,8 @@ public:
 	bool					synchingData()							const				{ return DataSetPackage::pkg()->synchingData();										}
 
 				bool		showInactive()							const				{ return _showInactive;	}
+				bool		undoEnabled()							const				{ return DataSetPackage::pkg()->undoEnabled();	}
+				bool		redoEnabled()							const				{ return DataSetPackage::pkg()->redoEnabled();	}
 
 signals:
 				void		columnsFilteredCountChanged();
@@ -60,6 +66,7 @@ signals:
 				void		columnTypeChanged(QString colName);
 				void		labelChanged(QString columnName, QString originalLabel, QString newLabel);
 				void		labelsReordered(QString columnName);
+				void		unOrRedoEnabledChanged();
 
 public slots:
 				void		setShowInactive(bool showInactive);
@@ -21,8 +21,6 @@
 
 #include "dataset.h"
 #include <ios>
-#include <archive.h>
-#include <archive_entry.h>
 #include <json/json.h>
 #include <fstream>
 #include "archivereader.h"
@@ -32,11 +30,19 @@
 #include "log.h"
 #include "utilenums.h"
 #include "utilities/qutils.h"
+#include "utilities/imagecache.h"
 #include "data/databaseconnectioninfo.h"
-#include <fstream>
 #include "columnutils.h"
-
-const Version JASPExporter::dataArchiveVersion = Version("1.0.2");
+#include <QFile>
+#include <QThread>
+#include <future>
+#include <thread>
+#include <deque>
+#include <algorithm>
+#include <optional>
+#include <cctype>
+
+const Version JASPExporter::dataArchiveVersion = Version("1.1.0");
 const Version JASPExporter::jaspArchiveVersion = Version("3.1.0");
 
 
@@ -48,269 +54,216 @@ JASPExporter::JASPExporter()
 
 void JASPExporter::saveDataSet(const std::string &path, boost::function<void(int)> progressCallback)
 {
-	struct archive *a;
+	JASPTIMER_SCOPE(JASPExporter::saveDataSet);
 
-	a = archive_write_new();
-	archive_write_set_format_zip(a);
+	//AsyncLoader::saveTask writes to path + ".tmp" and renames that over the file being saved, which is where unchanged entries can be copied from
+	const std::string	tmp			= ".tmp",
+						previous	= path.size() > tmp.size() && path.compare(path.size() - tmp.size(), tmp.size(), tmp) == 0 ? path.substr(0, path.size() - tmp.size()) : "";
 
-    int errorCode =
-#ifdef _WIN32
-            archive_write_open_filename_w(a, tq(path).toStdWString().c_str());
-#else
-            archive_write_open_filename(a, path.c_str());
-#endif
+	ZipWriter zip(path, previous);
 
-	if (errorCode != ARCHIVE_OK)
-		throw std::runtime_error("File could not be opened.");
+	saveDataArchive(zip, progressCallback);
+	saveJASPArchive(zip, progressCallback);
 
-	saveDataArchive(a, progressCallback);
-	saveJASPArchive(a, progressCallback);
+	zip.close();
 
-	errorCode = archive_write_close(a);
-	if (errorCode != ARCHIVE_OK)
-		throw std::runtime_error("File could not be closed.");
-
-	errorCode = archive_write_free(a);
+	Log::log() << "Saved " << path << ", " << zip.entriesCopied() << " unchanged entries were copied from the previous file." << std::endl;
 
 	progressCallback(100);
 }
 
 
-void JASPExporter::saveDataArchive(archive *a, boost::function<void(int)> progressCallback)
+void JASPExporter::saveDataArchive(ZipWriter & zip, boost::function<void(int)> progressCallback)
 {
 	DataSetPackage * package = DataSetPackage::pkg();
 
-	createJARContents(a);
-
-	struct archive_entry *entry;
-
-	int progress,
-		lastProgress = -1;
+	createJARContents(zip);
 
 	Json::Value labelsData	= Json::objectValue,
-				metaData	= Json::objectValue,
-				db			= package->databaseJson();
-
-	Json::Value &dataSet			= metaData["dataSet"];
-	metaData["dataFilePath"]		= package->dataFilePath();
-	metaData["dataFileReadOnly"]	= package->dataFileReadOnly();
-	metaData["dataFileTimestamp"]	= package->dataFileTimestamp();
-	metaData["database"]			= db.isNull() ? db : DatabaseConnectionInfo(db).toJson(true); //Convert again to drop password if not remembering "me"
-	Json::Value emptyValuesJson		= Json::arrayValue;
+				metaData	= Json::objectValue;
 
-	const std::vector<std::string>& emptyValuesVector = ColumnUtils::getEmptyValues();
-	for (const auto & emptyVal : emptyValuesVector)
-		emptyValuesJson.append(emptyVal);
+	//The columns are only copied once, on the thread where they are edited, so that an edit made during saving ends up either entirely in the file or not at all.
+	//That copy is what data.bin is then deflated from, without concatenating the columns first.
+	std::vector<std::vector<int>>		intColumns;
+	std::vector<std::vector<double>>	dblColumns;
+	size_t								dataSize	= 0,
+										columnCount	= 0;
 
-	metaData["emptyValues"]				= emptyValuesJson;
-	metaData["filterData"]				= package->dataFilter();
-	metaData["filterConstructorJSON"]	= package->filterConstructorJson();
-	metaData["computedColumns"]			= ComputedColumns::singleton()->convertToJson();
-	dataSet["rowCount"]					= package->rowCount();
-	dataSet["columnCount"]				= package->columnCount();
+	auto snapshot = [&]()
+	{
+		JASPTIMER_SCOPE(JASPExporter::snapshot);
 
-	dataSet["filterVector"]				= Json::arrayValue;
+		Json::Value db = package->databaseJson();
 
-	for (bool filteredRow : package->filterVector())
-		dataSet["filterVector"].append(filteredRow);
+		Json::Value &dataSet			= metaData["dataSet"];
+		metaData["dataFilePath"]		= package->dataFilePath();
+		metaData["dataFileReadOnly"]	= package->dataFileReadOnly();
+		metaData["dataFileTimestamp"]	= package->dataFileTimestamp();
+		metaData["database"]			= db.isNull() ? db : DatabaseConnectionInfo(db).toJson(true); //Convert again to drop password if not remembering "me"
+		Json::Value emptyValuesJson		= Json::arrayValue;
 
-	dataSet["emptyValuesMap"]			= Json::objectValue;
+		const std::vector<std::string>& emptyValuesVector = ColumnUtils::getEmptyValues();
+		for (const auto & emptyVal : emptyValuesVector)
+			emptyValuesJson.append(emptyVal);
 
-	for (const auto & it : package->emptyValuesMap())
-	{
-		std::string colName		= it.first;
-		auto		map			= it.second;
-		Json::Value mapJson		= Json::objectValue;
+		metaData["emptyValues"]				= emptyValuesJson;
+		metaData["filterData"]				= package->dataFilter();
+		metaData["filterConstructorJSON"]	= package->filterConstructorJson();
+		metaData["computedColumns"]			= ComputedColumns::singleton()->convertToJson();
+		dataSet["rowCount"]					= package->rowCount();
+		dataSet["columnCount"]				= package->columnCount();
 
-		for (const auto & it2 : map)
-			mapJson[std::to_string(it2.first)] = it2.second;
+		dataSet["filterVector"]				= Json::arrayValue;
 
-		dataSet["emptyValuesMap"][colName] = mapJson;
-	}
+		for (bool filteredRow : package->filterVector())
+			dataSet["filterVector"].append(filteredRow);
 
+		//Per column the distinct original values and then [firstRow, rowCount, index in originals] runs, a lot smaller than an object with a key per row like "emptyValuesMap" used to be
+		//JASP before data archive 1.1.0 only reads "emptyValuesMap", the version in the manifest already warns it that it might miss something
+		dataSet["emptyValuesPerColumn"]		= Json::objectValue;
 
-	Json::Value columnsData = Json::arrayValue;
+		for (const auto & [colName, emptyValues] : package->emptyValuesMap())
+			if (!emptyValues.empty())
+				dataSet["emptyValuesPerColumn"][colName] = emptyValues.toJson();
 
-	//Calculate size of data file that'll be added to the archive
-	size_t	dataSize	= 0,
-			columnCount	= package->columnCount();
+		Json::Value columnsData = Json::arrayValue;
 
-	for (size_t i = 0; i < columnCount; i++)
-	{
-		columnsData.append(package->columnToJsonForJASPFile(i, labelsData, dataSize));
+		columnCount = package->columnCount();
+		intColumns.resize(columnCount);
+		dblColumns.resize(columnCount);
 
-		progress = 49 * int(i / columnCount);
-		if (progress != lastProgress)
+		for (size_t i = 0; i < columnCount; i++)
 		{
-			progressCallback(progress);
-			lastProgress = progress;
-		}
-	}
-	dataSet["fields"]		= columnsData;
-
-	//Create new entry for archive
-	std::string metaDataString	= metaData.toStyledString();
-	size_t sizeOfMetaData		= metaDataString.size();
-	entry						= archive_entry_new();
-	std::string dd2				= std::string("metadata.json");
+			columnsData.append(package->columnToJsonForJASPFile(i, labelsData, dataSize));
 
-	archive_entry_set_pathname(entry, dd2.c_str());
-	archive_entry_set_size(entry, int(sizeOfMetaData));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644);  //basically chmod
-	archive_write_header(a, entry);
+			if (package->getColumnType(i) != columnType::scale)	intColumns[i] = package->getColumnDataInts(i);
+			else												dblColumns[i] = package->getColumnDataDbls(i);
+		}
 
-	archive_write_data(a, metaDataString.c_str(), sizeOfMetaData);
+		dataSet["fields"] = columnsData;
+	};
 
-	archive_entry_free(entry);
+	//Saving runs on the AsyncLoader thread, the progressCallback isn't called in there because it throws when the user cancels
+	if (QThread::currentThread() == package->thread())	snapshot();
+	else												QMetaObject::invokeMethod(package, snapshot, Qt::BlockingQueuedConnection);
 
+	progressCallback(49);
 
-	//Create new entry for archive
-	std::string labelDataString = labelsData.toStyledString();
-	size_t		sizeOflabelData = labelDataString.size();
+	//Turning the json into strings and deflating them doesn't depend on anything else, so do that on other threads while data.bin gets deflated
+	std::future<ZipWriter::Entry>	metaDataEntry	= std::async(std::launch::async, [&]() { return zip.prepare("metadata.json",	metaData.toStyledString());		}),
+									labelDataEntry	= std::async(std::launch::async, [&]() { return zip.prepare("xdata.json",		labelsData.toStyledString());	});
 
-	entry = archive_entry_new();
-	std::string dd9 = std::string("xdata.json");
-	archive_entry_set_pathname(entry, dd9.c_str());
-	archive_entry_set_size(entry, int(sizeOflabelData));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644); //basically chmod
-	archive_write_header(a, entry);
+	std::vector<ZipWriter::Piece> dataPieces;
 
-	archive_write_data(a, labelDataString.c_str(), sizeOflabelData);
+	for (size_t i = 0; i < columnCount; i++)
+		if (!dblColumns[i].empty())	dataPieces.push_back({ reinterpret_cast<const char*>(dblColumns[i].data()), dblColumns[i].size() * sizeof(double) });
+		else						dataPieces.push_back({ reinterpret_cast<const char*>(intColumns[i].data()), intColumns[i].size() * sizeof(int) });
 
-	archive_entry_free(entry);
+	//Deflated in blocks on all the threads, or copied from the previous file if the data didn't change
+	ZipWriter::Entry dataEntry = zip.prepare("data.bin", dataPieces, true, 0);
 
+	intColumns.clear();
+	dblColumns.clear();
 
-	//Create new entry for archive NOTE: must be done before data is added
-	entry = archive_entry_new();
-	std::string dd = std::string("data.bin");
-	archive_entry_set_pathname(entry, dd.c_str());
-	archive_entry_set_size(entry, int(dataSize));
-	archive_entry_set_filetype(entry, AE_IFREG);
-	archive_entry_set_perm(entry, 0644);  //basically chmod
-	archive_write_header(a, entry);
+	progressCallback(90);
 
-	//Data data to archive
+	zip.write(metaDataEntry.get());
+	zip.write(labelDataEntry.get());
+	zip.write(dataEntry);
 
-	for (size_t i = 0; i < columnCount; i++)
-	{
-		if (package->getColumnType(i) != columnType::scale)
-			for (const int & value : package->getColumnDataInts(i))
-				archive_write_data(a, reinterpret_cast<const char*>(&value), sizeof(int));
-		else
-			for (const double & value : package->getColumnDataDbls(i))
-				archive_write_data(a, reinterpret_cast<const char*>(&value), sizeof(double));
-
-		progress = 49 + 50 * int(i / columnCount);
-		if (progress != lastProgress)
-		{
-			progressCallback(progress);
-			lastProgress = progress;
-		}
-	}
-
-	archive_entry_free(entry);
-	
 	DataSetPackage::pkg()->waitForExportResultsReady();
 
 	//Create new entry for archive: HTML results
 	QByteArray	html		= package->analysesHTML().toUtf8();
-	size_t		htmlSize	= html.size();
-				entry		= archive_entry_new();
-	
-	archive_entry_set_pathname(	entry,	"index.html");
-	archive_entry_set_size(		entry,	int(htmlSize));
-	archive_entry_set_filetype(	entry,	AE_IFREG);
-	archive_entry_set_perm(		entry,	0644);  //basically chmod
-
-				archive_write_header(   a,  entry);
-	size_t ws = archive_write_data(		a, html.data(), htmlSize);
-
-	if (ws != size_t(htmlSize))
-		throw std::runtime_error("Can't save jasp archive writing ERROR");
-
-	archive_entry_free(entry);
-
+	zip.write(zip.prepare("index.html", { { html.constData(), size_t(html.size()) } }, true, 0));
 }
 
-void JASPExporter::saveJASPArchive(archive *a, boost::function<void(int)>)
+void JASPExporter::saveJASPArchive(ZipWriter & zip, boost::function<void(int)>)
 {
 	if (DataSetPackage::pkg()->hasAnalyses())
 	{
-		struct archive_entry *entry;
-
 		const Json::Value &analysesJson = DataSetPackage::pkg()->analysesData();
 
-		//Create new entry for archive NOTE: must be done before data is added
-		std::string analysesString			= analysesJson.toStyledString();
-		size_t		sizeOfAnalysesString	= analysesString.size();
-					entry					= archive_entry_new();
-					
-		archive_entry_set_pathname(	entry,	"analyses.json");
-		archive_entry_set_size(		entry,	int(sizeOfAnalysesString));
-		archive_entry_set_filetype(	entry,	AE_IFREG);
-		archive_entry_set_perm(		entry,	0644);  //basically chmod
-		archive_write_header(		a,		entry);
-
-		archive_write_data(a, analysesString.c_str(), sizeOfAnalysesString);
-
-		archive_entry_free(entry);
-
-		char imagebuff[8192];
+		zip.write(zip.prepare("analyses.json", analysesJson.toStyledString()));
 
 		Json::Value analysesDataList = analysesJson;
 		if (!analysesDataList.isArray())
 			analysesDataList = analysesJson["analyses"];
 
+		std::vector<std::string> paths;
+
 		for (Json::Value::iterator iter = analysesDataList.begin(); iter != analysesDataList.end(); iter++)
+			for (const std::string & path : TempFiles::retrieveList((*iter)["id"].asInt()))
+				paths.push_back(path);
+
+		//The files are read and deflated on other threads, a few ahead of the one being written, so that the disk and the compression both keep busy without holding every file in memory at once.
+		const size_t											readAhead	= 2 * std::max(1u, std::thread::hardware_concurrency());
+		std::deque<std::future<std::optional<ZipWriter::Entry>>>	reads;
+		size_t													nextRead	= 0;
+
+		auto readFile = [](const std::string & path) -> std::optional<QByteArray>
 		{
-			Json::Value &analysisJson = *iter;
-			std::vector<std::string> paths = TempFiles::retrieveList(analysisJson["id"].asInt());
-			for (size_t j = 0; j < paths.size(); j++)
+			const QString tempFilePath = tq(TempFiles::sessionDirName() + "/" + path);
+
+			//Plots were most likely just shown in the results, so take them from the cache instead of reading them again
+			if (ImageCache::isImage(tempFilePath))
 			{
-				// std::ios::ate seeks to the end of stream immediately after open
-				std::ifstream readTempFile(TempFiles::sessionDirName() + "/" + paths[j], std::ios::ate | std::ios::binary);
+				QByteArray image = ImageCache::cache()->read(tempFilePath);
 
-				if (readTempFile.is_open())
-				{
-					int imageSize = readTempFile.tellg();		// get size from curpos
+				if (!image.isEmpty())
+					return image;
+			}
 
-					entry = archive_entry_new();
-					archive_entry_set_pathname(entry, paths[j].c_str());
-					
-					archive_entry_set_size(		entry,	imageSize);
-					archive_entry_set_filetype(	entry,	AE_IFREG);
-					archive_entry_set_perm(		entry,	0644); // Not sure what this does
-					archive_write_header(		a,		entry);
+			QFile file(tempFilePath);
 
-					int	bytes = 0;
-					readTempFile.seekg(0, std::ios::beg);		// move back to begin
+			if (!file.open(QIODevice::ReadOnly))
+			{
+				Log::log() << "JASP Export: cannot find/open file " << fq(tempFilePath) << std::endl;
+				return std::nullopt;
+			}
 
-					while (!readTempFile.eof())
-					{
-						readTempFile.read(imagebuff, sizeof(imagebuff));
-						bytes = readTempFile.gcount();
+			return file.readAll();
+		};
 
-						archive_write_data(a, imagebuff, size_t(bytes));
-					}
+		auto prepareFile = [&zip, &readFile](const std::string & path) -> std::optional<ZipWriter::Entry>
+		{
+			std::optional<QByteArray> contents = readFile(path);
 
-					archive_entry_free(entry);
+			if (!contents)
+				return std::nullopt;
 
-				}
-				else
-					Log::log() << "JASP Export: cannot find/open file " << (TempFiles::sessionDirName() + "/" + paths[j]);
+			return zip.prepare(path, { { contents->constData(), size_t(contents->size()) } }, !isAlreadyCompressed(path));
+		};
 
-				readTempFile.close();
-			}
+		for (size_t j = 0; j < paths.size(); j++)
+		{
+			for(; nextRead < paths.size() && nextRead < j + readAhead; nextRead++)
+				reads.push_back(std::async(std::launch::async, prepareFile, paths[nextRead]));
+
+			std::optional<ZipWriter::Entry> entry = reads.front().get();
+			reads.pop_front();
+
+			if (entry)
+				zip.write(*entry);
 		}
+
+		ImageCache::cache()->logStatistics();
 	}
 }
 
-void JASPExporter::createJARContents(archive *a)
+bool JASPExporter::isAlreadyCompressed(const std::string & path)
 {
-	struct archive_entry *entry = archive_entry_new();
+	static const std::vector<std::string> extensions = { ".png", ".jpg", ".jpeg", ".gif", ".rds", ".zip" };
+
+	for(const std::string & extension : extensions)
+		if(path.size() >= extension.size() && std::equal(extension.begin(), extension.end(), path.end() - extension.size(), [](char l, char r) { return l == std::tolower(r); }))
+			return true;
 
+	return false;
+}
+
+void JASPExporter::createJARContents(ZipWriter & zip)
+{
 	std::stringstream manifestStream;
 	manifestStream << "Manifest-Version: 1.0" << "\n";
 	manifestStream << "Created-By: " << AppInfo::getShortDesc() << "\n";
@@ -319,20 +272,5 @@ void JASPExporter::createJARContents(archive *a)
 
 	manifestStream.flush();
 
-	const std::string& tmp	= manifestStream.str();
-	size_t manifestSize		= tmp.size();
-	const char* manifest	= tmp.c_str();
-
-	archive_entry_set_pathname(	entry,	"META-INF/MANIFEST.MF");
-	archive_entry_set_size(		entry,	int(manifestSize));
-	archive_entry_set_filetype(	entry,	AE_IFREG);
-	archive_entry_set_perm(		entry,	0644); // Not sure what this does
-	archive_write_header(		a,		entry);
-
-	archive_write_data(a, manifest, manifestSize);
-
-	archive_entry_free(entry);
+	zip.write(zip.prepare("META-INF/MANIFEST.MF", manifestStream.str()));
 }
-
-
-
@@ -19,11 +19,15 @@
 #define JASPEXPORTER_H
 
 #include "exporter.h"
-#include <archive.h>
+#include "zipwriter.h"
 
 ///
 /// To export to *.JASP files
 /// Those are basically zips with some json files in there btw
+///
+/// ZipWriter deflates the entries on other threads while the ones before them are written, and data.bin in blocks on all of them.
+/// An entry with the same contents as in the file being saved over, like a plot that didn't change since the last save, is copied from that file instead.
+/// The entries that are already compressed, like the plots that make up most of a large project, are stored rather than deflated again.
 class JASPExporter: public Exporter
 {
 public:
@@ -34,12 +38,14 @@ public:
 	void saveDataSet(const std::string &path, boost::function<void (int)> progressCallback) override;
 
 private:
-	static void saveDataArchive(archive *a, boost::function<void (int)> progressCallback);
-	static void saveJASPArchive(archive *a, boost::function<void (int)> progressCallback);
+	static void saveDataArchive(ZipWriter & zip, boost::function<void (int)> progressCallback);
+	static void saveJASPArchive(ZipWriter & zip, boost::function<void (int)> progressCallback);
 
-	static void createJARContents(archive *a);
+	static void createJARContents(ZipWriter & zip);
 	static std::string getColumnTypeName(columnType columnType);
 
+	static bool isAlreadyCompressed(const std::string & path);
+
 	JASPTIMER_CLASS(JASPExporter);
 };
 
@@ -104,6 +104,12 @@ void FileEvent::setComplete(bool success, const QString & message)
 	emit completed(this);
 }
 
+void FileEvent::setCancelled()
+{
+	_cancelled = true;
+	setComplete(false, tr("Cancelled by user"));
+}
+
 void FileEvent::chain(FileEvent *event)
 {
 	_chainedTo = event;
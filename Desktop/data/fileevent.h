@@ -45,6 +45,7 @@ public:
 	void				setFileType(	Utils::FileType	type)			{ _type = type; }
 
 	void				setComplete(bool success = true, const QString &message = "");
+	void				setCancelled();
 	void				chain(FileEvent *event);
 
 	void				setReadOnly()		  { _readOnly = true;		}
@@ -54,6 +55,7 @@ public:
 	bool				isReadOnly()	const { return _readOnly;						}
 	bool				isCompleted()	const { return _completed;						}
 	bool				isSuccessful()	const { return _success;						}
+	bool				isCancelled()	const { return _cancelled;						}
 
 	Exporter *			exporter()		const { return _exporter;		}
 	FileMode			operation()		const { return _operation;		}
@@ -85,7 +87,8 @@ private:
 						_message;
 	bool				_readOnly		= false,
 						_completed		= false,
-						_success		= false;
+						_success		= false,
+						_cancelled		= false;
 	FileEvent		*	_chainedTo		= nullptr;
 	Exporter		*	_exporter		= nullptr;
 	Json::Value			_database		= Json::nullValue;
@@ -165,9 +165,16 @@ void FilterModel::rescanRFilterForColumns()
 	_columnsUsedInRFilter = ComputedColumn::findUsedColumnNamesStatic(_rFilter.toStdString());
 }
 
-void FilterModel::computeColumnSucceeded(QString columnName, QString, bool dataChanged)
+void FilterModel::computeColumnSucceeded(QString columnName, QString, const ColumnChanges & changes)
 {
-	if(dataChanged && (_columnsUsedInConstructedFilter.count(columnName.toStdString()) > 0 || _columnsUsedInRFilter.count(columnName.toStdString()) > 0))
+	if(changes.changed() && (_columnsUsedInConstructedFilter.count(columnName.toStdString()) > 0 || _columnsUsedInRFilter.count(columnName.toStdString()) > 0))
+		sendGeneratedAndRFilter();
+}
+
+///The order and texts of labels decide what a filter like `col == "a"` or `col < "b"` lets through, so it is run again when they change, also when that is an undo or redo.
+void FilterModel::labelsOfColumnChanged(QString columnName)
+{
+	if(_columnsUsedInConstructedFilter.count(fq(columnName)) > 0 || _columnsUsedInRFilter.count(fq(columnName)) > 0)
 		sendGeneratedAndRFilter();
 }
 
@@ -57,7 +57,8 @@ public slots:
 	void processFilterErrorMsg(QString filterErrorMsg, int requestId);
 	void rescanRFilterForColumns();
 
-	void computeColumnSucceeded(QString columnName, QString warning, bool dataChanged);
+	void computeColumnSucceeded(QString columnName, QString warning, const ColumnChanges & changes);
+	void labelsOfColumnChanged(QString columnName);
 
 	void dataSetPackageResetDone();
 	void datasetChanged(	QStringList				changedColumns,
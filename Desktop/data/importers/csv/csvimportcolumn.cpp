@@ -1,4 +1,5 @@
 #include "csvimportcolumn.h"
+#include "columnutils.h"
 
 CSVImportColumn::CSVImportColumn(ImportDataSet* importDataSet, std::string name) : ImportColumn(importDataSet, name)
 {
@@ -13,6 +14,11 @@ size_t CSVImportColumn::size() const
 	return _data.size();
 }
 
+uint64_t CSVImportColumn::fingerprint() const
+{
+	return ColumnUtils::fingerprint(_data); //Without the copy allValuesAsStrings() would make
+}
+
 void CSVImportColumn::addValue(const std::string &value)
 {
 	_data.push_back(value);
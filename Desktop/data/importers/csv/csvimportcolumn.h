@@ -13,6 +13,7 @@ public:
 
 	size_t							size()									const	override;
 	std::vector<std::string>		allValuesAsStrings()					const	override { return  _data; }
+	uint64_t						fingerprint()							const	override;
 	void							addValue(const std::string &value);
 	const std::vector<std::string>& getValues()								const;
 
@@ -1,8 +1,11 @@
 #include "databaseimportcolumn.h"
 #include "utilities/qutils.h"
+#include "columnutils.h"
+#include <QLocale>
+#include <cmath>
 
 DatabaseImportColumn::DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type) 
-	: ImportColumn(importDataSet, name), _type(type)
+	: ImportColumn(importDataSet, name), _type(type), _storage(storageForType(type))
 {
 }
 
@@ -10,28 +13,135 @@ DatabaseImportColumn::~DatabaseImportColumn()
 {
 }
 
+DatabaseImportColumn::storageType DatabaseImportColumn::storageForType(QMetaType type)
+{
+	typedef QMetaType::Type MT;
+
+	switch(type.id())
+	{
+	case MT::Short:
+	case MT::UShort:
+	case MT::Int:
+	case MT::UInt:
+	case MT::Long:
+	case MT::ULong:
+	case MT::LongLong:
+	case MT::ULongLong:
+		return storageType::ints;
+
+	case MT::Double:
+	case MT::Float:
+		return storageType::doubles;
+
+	default: //QDate, QDateTime, Char and QString could later get their own handler, dependent on https://github.com/jasp-stats/INTERNAL-jasp/issues/312 and https://github.com/jasp-stats/jasp-issues/issues/606
+		return storageType::strings;
+	}
+}
+
 size_t DatabaseImportColumn::size() const
 {
-	return _data.size();
+	switch(_storage)
+	{
+	case storageType::ints:		return _ints.size();
+	case storageType::doubles:	return _doubles.size();
+	default:					return _strings.size();
+	}
+}
+
+void DatabaseImportColumn::reserve(size_t rows)
+{
+	switch(_storage)
+	{
+	case storageType::ints:		_ints.reserve(rows);	break;
+	case storageType::doubles:	_doubles.reserve(rows);	break;
+	default:					_strings.reserve(rows);	break;
+	}
 }
 
 std::vector<std::string> DatabaseImportColumn::allValuesAsStrings() const 
 { 
 	stringvec strs;
-	strs.reserve(_data.size());
+	strs.reserve(size());
 	
-	for(const QVariant & v : _data)
-		strs.push_back(fq(v.toString()));
+	switch(_storage)
+	{
+	case storageType::ints:
+		for(int i : _ints)
+			strs.push_back(i == std::numeric_limits<int>::lowest() ? "" : std::to_string(i));
+		break;
+
+	case storageType::doubles:
+		for(double d : _doubles)
+			strs.push_back(std::isnan(d) ? "" : fq(QString::number(d, 'g', QLocale::FloatingPointShortest)));
+		break;
+
+	default:
+		strs = _strings;
+		break;
+	}
 	
 	return  strs;
 }
 
+uint64_t DatabaseImportColumn::fingerprint() const
+{
+	//Only ever compared against fingerprints of DatabaseImportColumns, so the typed values can be hashed directly
+	size_t		count	= size();
+	uint64_t	hash	= ColumnUtils::hashBytes(&_storage,	sizeof(storageType));
+				hash	= ColumnUtils::hashBytes(&count,	sizeof(size_t),	hash);
+
+	switch(_storage)
+	{
+	case storageType::ints:		return ColumnUtils::hashBytes(_ints.data(),		_ints.size()	* sizeof(int),		hash);
+	case storageType::doubles:	return ColumnUtils::hashBytes(_doubles.data(),	_doubles.size()	* sizeof(double),	hash);
+	default:					return ColumnUtils::fingerprint(_strings);
+	}
+}
+
 void DatabaseImportColumn::addValue(const QVariant & value)
 {
-	_data.push_back(value);
+	if(_storage == storageType::strings)
+	{
+		_strings.push_back(value.isNull() ? "" : fq(value.toString()));
+		return;
+	}
+
+	if(value.isNull())
+	{
+		if(_storage == storageType::ints)	_ints.push_back(std::numeric_limits<int>::lowest());
+		else								_doubles.push_back(NAN);
+		return;
+	}
+
+	if(_storage == storageType::ints)
+	{
+		bool		ok		= false;
+		qlonglong	asLong	= value.toLongLong(&ok);
+
+		if(ok && asLong > std::numeric_limits<int>::lowest() && asLong <= std::numeric_limits<int>::max())
+		{
+			_ints.push_back(int(asLong));
+			return;
+		}
+
+		//Doesn't fit in an int (or JASP's missing value marker), so this column will have to be scale
+		_convertIntsToDoubles();
+	}
+
+	bool	ok		= false;
+	double	asDbl	= value.toDouble(&ok);
+
+	_doubles.push_back(ok ? asDbl : NAN);
 }
 
-const std::vector<QVariant> &DatabaseImportColumn::getValues() const
+void DatabaseImportColumn::_convertIntsToDoubles()
 {
-	return _data;
+	_doubles.reserve(_ints.capacity());
+
+	for(int i : _ints)
+		_doubles.push_back(i == std::numeric_limits<int>::lowest() ? NAN : double(i));
+
+	_ints.clear();
+	_ints.shrink_to_fit();
+	_storage = storageType::doubles;
 }
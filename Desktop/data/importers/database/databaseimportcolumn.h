@@ -3,25 +3,43 @@
 
 #include "../importcolumn.h"
 #include <QMetaType>
+#include <QVariant>
+
 ///
 /// Storing a column during import from a database
+/// The values are stored typed, as decided by the QMetaType the driver reports for the column, so that ints and doubles do not need to go through strings first.
+/// If an integer column turns out to hold values that do not fit in an int the column is switched to doubles.
 class DatabaseImportColumn : public ImportColumn
 {
 public:
+	enum class						storageType { ints, doubles, strings };
+
 									DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type);
 									~DatabaseImportColumn()	override;
 
 	size_t							size()									const	override;
 	std::vector<std::string>		allValuesAsStrings()					const	override;
+	uint64_t						fingerprint()							const	override;
 	void							addValue(const QVariant & value);
-	const std::vector<QVariant> &	getValues()								const;
-	QMetaType						type()									const { return _type; }
+	void							reserve(size_t rows);
+	QMetaType						type()									const { return _type;		}
+	storageType						storage()								const { return _storage;	}
 
+	const std::vector<int>		&	ints()									const { return _ints;		}
+	const std::vector<double>	&	doubles()								const { return _doubles;	}
+	const std::vector<std::string>&	strings()								const { return _strings;	}
+
+	static storageType				storageForType(QMetaType type);
 
 private:
-	std::vector<QVariant>	_data;
-	QMetaType				_type;
+	void							_convertIntsToDoubles();
 
+private:
+	std::vector<int>			_ints;
+	std::vector<double>			_doubles;
+	std::vector<std::string>	_strings;
+	QMetaType					_type;
+	storageType					_storage;
 };
 
 #endif // CSVIMPORTCOLUMN_H
@@ -3,8 +3,11 @@
 #include <QSqlField>
 #include "database/databaseimportcolumn.h"
 #include "utils.h"
+#include "log.h"
+#include <cmath>
+#include <algorithm>
 
-ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, boost::function<void(int)> progressCallback)
+void DatabaseImporter::_connect(const std::string &locator)
 {
 	// locator is the result of DatabaseConnectionInfo::toJson, so:
 	Json::Value json;
@@ -19,90 +22,221 @@ ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, boost::fu
 										.arg(_info._hostname + ":" + tq(std::to_string(_info._port)))
 										.arg(_info._username)
 										.arg(_info.lastError())));
+}
+
+ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, boost::function<void(int)> progressCallback)
+{
+	_connect(locator);
 	
+	QSqlQuery		query	= _info.runQuery();
+	ImportDataSet * data	= _readQuery(query, progressCallback);
+
+	_info.close();
 	
+	data->buildDictionary(); //Not necessary for reading from database but synching will break otherwise...
 	
-	QSqlQuery	query	= _info.runQuery();
-	float		progDiv	= 100.0f / float(query.size());
-	QSqlRecord  record	= query.record();
+	return data;
+}
+
+ImportDataSet * DatabaseImporter::_readQuery(QSqlQuery & query, boost::function<void(int)> progressCallback)
+{
+	// query.size() is -1 for drivers that do not report it (like SQLite), in that case the columns just grow as we go
+	const int		rowsExpected	= query.size();
+	float			progDiv			= 100.0f / float(rowsExpected);
+	QSqlRecord		record			= query.record();
 	
 	ImportDataSet * data = new ImportDataSet(this);
+	std::vector<DatabaseImportColumn*> cols;
 
 	for(int i=0; i<record.count(); i++)
-		data->addColumn(new DatabaseImportColumn(data, fq(record.fieldName(i)), record.field(i).metaType()));
+	{
+		DatabaseImportColumn * col = new DatabaseImportColumn(data, fq(record.fieldName(i)), record.field(i).metaType());
+
+		if(rowsExpected > 0)
+			col->reserve(rowsExpected);
+
+		data->addColumn(col);
+		cols.push_back(col);
+	}
 												
 	long lastProgress = Utils::currentMillis();	
 		
 	do
 	{
-		if(lastProgress + 1000 < Utils::currentMillis())
+		if(rowsExpected > 0 && lastProgress + 1000 < Utils::currentMillis())
 		{
 			progressCallback(int(progDiv * query.at()));
 			lastProgress = Utils::currentMillis();	
 		}
 
 		if(query.isValid())
-			for(int i=0; i<record.count(); i++)
-				static_cast<DatabaseImportColumn*>(data->getColumn(i))->addValue(query.value(i));
+			for(int i=0; i<int(cols.size()); i++)
+				cols[i]->addValue(query.value(i));
 	}
 	while(query.next());
-
-	_info.close();
-	
-	data->buildDictionary(); //Not necessary for reading from database but synching will break otherwise...
 	
 	return data;
 }
 
 void DatabaseImporter::initColumn(QVariant colId, ImportColumn *importColumn)
 {
-	typedef QMetaType::Type MT;
+	typedef DatabaseImportColumn::storageType ST;
 	
 	DatabaseImportColumn * col = static_cast<DatabaseImportColumn*>(importColumn);
 	
-	switch(col->type().id())
+	switch(col->storage())
 	{
-	default:
-	case MT::QDate:			//These could later get their own handler, dependent on https://github.com/jasp-stats/INTERNAL-jasp/issues/312 and https://github.com/jasp-stats/jasp-issues/issues/606
-	case MT::QDateTime: 
-	case MT::Char:
-	case MT::QString:
+	case ST::strings:	initColumnAsNominalText(		colId, col->name(), col->strings()			);	break;
+	case ST::ints:		initColumnAsNominalOrOrdinal(	colId, col->name(), col->ints(),	true	);	break;
+	case ST::doubles:	initColumnAsScale(				colId, col->name(), col->doubles()			);	break;
+	}
+}
+
+void DatabaseImporter::syncDataSet(const std::string &locator, boost::function<void(int)> progressCallback)
+{
+	_connect(locator);
+
+	const std::string	syncColumn	= fq(_info._syncColumn);
+	const QVariant		lastValue	= _info.syncIncrementally() ? _lastSyncValue(syncColumn) : QVariant();
+
+	if(!lastValue.isValid())
 	{
-		stringvec asStrings;
-		asStrings.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asStrings.push_back(fq(v.toString()));
-		
-		initColumnAsNominalText(colId, col->name(), asStrings);
-		break;
+		if(_info.syncIncrementally())
+			Log::log() << "Cannot sync incrementally on column '" << syncColumn << "' as it has no usable values, doing a full sync instead." << std::endl;
+
+		_info.close();
+		Importer::syncDataSet(locator, progressCallback);
+		return;
 	}
-		
-	case MT::Int:
-	case MT::UInt:
+
+	QSqlQuery		query	= _info.runQueryAfter(lastValue);
+	ImportDataSet * newRows	= _readQuery(query, progressCallback);
+
+	_info.close();
+
+	//Appending only makes sense if the query still returns exactly the columns we have, otherwise let the normal sync figure out what changed
+	std::vector<std::string>	orgColumnNames	= DataSetPackage::pkg()->getColumnNames(false);
+	std::set<std::string>		orgColumns(orgColumnNames.begin(), orgColumnNames.end());
+	bool						sameColumns		= orgColumns.size() == newRows->columnCount();
+
+	for(ImportColumn * col : *newRows)
+		sameColumns = sameColumns && orgColumns.count(col->name());
+
+	if(!sameColumns)
 	{
-		std::vector<int> asInts;
-		asInts.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asInts.push_back(v.toInt());
-		
-		initColumnAsNominalOrOrdinal(colId, col->name(), asInts, true);
-		break;
+		Log::log() << "Columns returned by the query changed, doing a full sync instead of an incremental one." << std::endl;
+
+		delete newRows;
+		Importer::syncDataSet(locator, progressCallback);
+		return;
 	}
-		
-	case MT::Double:
-	case MT::Float:
+
+	const size_t newRowCount = newRows->rowCount();
+
+	if(newRowCount == 0 || !DataSetPackage::pkg()->checkDoSync())
 	{
-		std::vector<double> asDoubles;
-		asDoubles.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asDoubles.push_back(v.toDouble());
-		
-		initColumnAsScale(colId, col->name(), asDoubles);
-		break;
+		delete newRows;
+		return;
+	}
+
+	Log::log() << "Appending " << newRowCount << " rows with " << syncColumn << " > " << fq(lastValue.toString()) << std::endl;
+
+	const size_t oldRowCount = DataSetPackage::pkg()->dataRowCount();
+
+	DataSetPackage::pkg()->beginSynchingData();
+	DataSetPackage::pkg()->setDataSetRowCount(oldRowCount + newRowCount);
+
+	std::vector<std::string>			changedColumns,
+										missingColumns;
+	std::map<std::string, std::string>	changeNameColumns;
+
+	for(ImportColumn * col : *newRows)
+	{
+		_appendToColumn(col->name(), static_cast<DatabaseImportColumn*>(col), oldRowCount);
+		changedColumns.push_back(col->name());
+	}
+
+	delete newRows;
+
+	DataSetPackage::pkg()->endSynchingData(changedColumns, missingColumns, changeNameColumns, true, false);
+}
+
+QVariant DatabaseImporter::_lastSyncValue(const std::string & columnName) const
+{
+	DataSetPackage	* pkg		= DataSetPackage::pkg();
+	int				  colIdx	= pkg->getColumnIndex(columnName);
+
+	if(colIdx < 0 || pkg->dataRowCount() == 0)
+		return QVariant();
+
+	switch(pkg->getColumnType(colIdx))
+	{
+	case columnType::scale:
+	{
+		double	maxVal	= NAN;
+
+		for(double d : pkg->getColumnDataDbls(colIdx))
+			if(!std::isnan(d) && (std::isnan(maxVal) || d > maxVal))
+				maxVal = d;
+
+		return std::isnan(maxVal) ? QVariant() : QVariant(maxVal);
+	}
+
+	case columnType::nominal:
+	case columnType::ordinal:
+	{
+		int		maxVal	= std::numeric_limits<int>::lowest();
+
+		for(int i : pkg->getColumnDataInts(colIdx))
+			maxVal = std::max(maxVal, i);
+
+		return maxVal == std::numeric_limits<int>::lowest() ? QVariant() : QVariant(maxVal);
+	}
+
+	default:
+		return DatabaseConnectionInfo::lastSyncValueOf(pkg->getColumnValuesAsStringList(colIdx));
+	}
+}
+
+void DatabaseImporter::_appendToColumn(const std::string & columnName, DatabaseImportColumn * col, size_t oldRowCount)
+{
+	typedef DatabaseImportColumn::storageType ST;
+
+	DataSetPackage	* pkg		= DataSetPackage::pkg();
+	int				  colIdx	= pkg->getColumnIndex(columnName);
+	columnType		  colType	= pkg->getColumnType(colIdx);
+
+	//When the types line up only the new rows are written, the rows that were already there are left alone
+	if(colType == columnType::scale && col->storage() != ST::strings)
+	{
+		if(col->storage() == ST::doubles)
+			pkg->setColumnValuesFrom(colIdx, oldRowCount, col->doubles());
+		else
+		{
+			std::vector<double> values;
+			values.reserve(col->size());
+
+			for(int i : col->ints())
+				values.push_back(i == std::numeric_limits<int>::lowest() ? NAN : double(i));
+
+			pkg->setColumnValuesFrom(colIdx, oldRowCount, values);
+		}
 	}
-			
+	else if((colType == columnType::nominal || colType == columnType::ordinal) && col->storage() == ST::ints)
+		pkg->setColumnValuesFrom(colIdx, oldRowCount, col->ints());
+
+	else if(colType == columnType::nominalText && col->storage() == ST::strings)
+		pkg->setColumnValuesFrom(colIdx, oldRowCount, col->strings());
+
+	else
+	{
+		//The types do not line up, so we combine everything as strings and let Importer decide what it should be
+		std::vector<std::string>	values		= fq(pkg->getColumnValuesAsStringList(colIdx)),
+									newValues	= col->allValuesAsStrings();
+
+		values.resize(oldRowCount);
+		values.insert(values.end(), newValues.begin(), newValues.end());
+
+		initColumnWithStrings(tq(columnName), columnName, values);
 	}
 }
@@ -4,6 +4,8 @@
 #include "importer.h"
 #include "data/databaseconnectioninfo.h"
 
+class DatabaseImportColumn;
+
 class DatabaseImporter : public Importer
 {
 	Q_DECLARE_TR_FUNCTIONS(DatabaseImporter)
@@ -15,8 +17,16 @@ public:
 	
 	ImportDataSet* loadFile(const std::string &locator, boost::function<void(int)> progressCallback) override;
 	void initColumn(QVariant colId, ImportColumn * importColumn) override;
+	bool decodesColumnsInParallel() const override { return false; } ///< The query already gave typed columns
+	void syncDataSet(const std::string &locator, boost::function<void(int)> progressCallback) override;
 	
 	DatabaseConnectionInfo _info;
+
+private:
+	void			_connect(const std::string &locator);
+	ImportDataSet * _readQuery(QSqlQuery & query, boost::function<void(int)> progressCallback);
+	QVariant		_lastSyncValue(const std::string & columnName) const;
+	void			_appendToColumn(const std::string & columnName, DatabaseImportColumn * col, size_t oldRowCount);
 };
 
 #endif // DATABASEIMPORTER_H
@@ -19,10 +19,15 @@ std::string ImportColumn::name() const
 	return _name;
 }
 
+uint64_t ImportColumn::fingerprint() const
+{
+	return ColumnUtils::fingerprint(allValuesAsStrings());
+}
+
 
-bool ImportColumn::convertVecToInt(const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, std::map<int, std::string> &emptyValuesMap)
+bool ImportColumn::convertVecToInt(const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, ColumnEmptyValues & emptyValues)
 {
-	emptyValuesMap.clear();
+	emptyValues.clear();
 	uniqueValues.clear();
 	intValues.clear();
 	intValues.reserve(values.size());
@@ -36,7 +41,7 @@ bool ImportColumn::convertVecToInt(const std::vector<std::string> &values, std::
 		if (ColumnUtils::convertValueToIntForImport(value, intValue))
 		{
 			if (intValue != std::numeric_limits<int>::lowest())	uniqueValues.insert(intValue);
-			else if (!value.empty())							emptyValuesMap.insert(make_pair(row, value));
+			else if (!value.empty())							emptyValues.insert(row, value);
 
 			intValues.push_back(intValue);
 		}
@@ -49,9 +54,9 @@ bool ImportColumn::convertVecToInt(const std::vector<std::string> &values, std::
 	return true;
 }
 
-bool ImportColumn::convertVecToDouble(const std::vector<std::string> &values, std::vector<double> &doubleValues, std::map<int, std::string> &emptyValuesMap)
+bool ImportColumn::convertVecToDouble(const std::vector<std::string> &values, std::vector<double> &doubleValues, ColumnEmptyValues & emptyValues)
 {
-	emptyValuesMap.clear();
+	emptyValues.clear();
 	doubleValues.clear();
 	doubleValues.reserve(values.size());
 
@@ -65,7 +70,7 @@ bool ImportColumn::convertVecToDouble(const std::vector<std::string> &values, st
 			doubleValues.push_back(doubleValue);
 
 			if (std::isnan(doubleValue) && value != "")
-				emptyValuesMap.insert(std::make_pair(row, value));
+				emptyValues.insert(row, value);
 		}
 		else
 			return false;
@@ -20,11 +20,12 @@ public:
 
 	virtual size_t						size()									const = 0;
 	virtual std::vector<std::string>	allValuesAsStrings()					const = 0;
+	virtual uint64_t					fingerprint()							const;
 			std::string					name()									const;
 			void						changeName(const std::string & name);
 
-	static bool convertVecToInt(	const std::vector<std::string> & values, std::vector<int>		& intValues,	std::set<int> &uniqueValues,	std::map<int, std::string> &emptyValuesMap);
-	static bool convertVecToDouble(	const std::vector<std::string> & values, std::vector<double>	& doubleValues,									std::map<int, std::string> &emptyValuesMap);
+	static bool convertVecToInt(	const std::vector<std::string> & values, std::vector<int>		& intValues,	std::set<int> &uniqueValues,	ColumnEmptyValues & emptyValues);
+	static bool convertVecToDouble(	const std::vector<std::string> & values, std::vector<double>	& doubleValues,									ColumnEmptyValues & emptyValues);
 
 	static bool isStringValueEqual(const std::string &value, Column &col, size_t row);
 
@@ -2,7 +2,13 @@
 #include "utilities/qutils.h"
 #include "utilities/settings.h"
 #include "log.h"
+#include "../boundedqueue.h"
 #include <QVariant>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <memory>
 
 Importer::~Importer() {}
 
@@ -10,7 +16,11 @@ void Importer::loadDataSet(const std::string &locator, boost::function<void(int)
 {
 	DataSetPackage::pkg()->beginLoadingData();
 
-	ImportDataSet *importDataSet = loadFile(locator, progressCallback);
+	auto readStart = std::chrono::steady_clock::now();
+
+	std::unique_ptr<ImportDataSet> importDataSet(loadFile(locator, progressCallback));
+
+	auto readEnd = std::chrono::steady_clock::now();
 
 	int columnCount = importDataSet->columnCount();
 	DataSetPackage::pkg()->createDataSet(); // this is required in case the loading of the data fails so that the created dataset can later be freed
@@ -21,19 +31,92 @@ void Importer::loadDataSet(const std::string &locator, boost::function<void(int)
 
 		DataSetPackage::pkg()->setDataSetSize(columnCount, rowCount);
 
-		int colNo = 0;
-		for (ImportColumn *importColumn : *importDataSet)
+		if(decodesColumnsInParallel())
+			initColumnsPipelined(importDataSet.get(), progressCallback);
+		else
 		{
-			progressCallback(50 + 50 * colNo / columnCount);
-			initColumn(colNo, importColumn);
-			colNo++;
+			int colNo = 0;
+			for (ImportColumn *importColumn : *importDataSet)
+			{
+				progressCallback(50 + 50 * colNo / columnCount);
+				initColumn(colNo, importColumn);
+				storeColumnFingerprint(importColumn->name(), importColumn->fingerprint());
+				colNo++;
+			}
 		}
+
+		auto ms = [](auto duration) { return std::chrono::duration_cast<std::chrono::milliseconds>(duration).count(); };
+
+		Log::log() << "Importer loaded " << columnCount << " columns of " << rowCount << " rows from '" << locator << "', reading took " << ms(readEnd - readStart) << "ms and decoding and storing the columns " << ms(std::chrono::steady_clock::now() - readEnd) << "ms." << std::endl;
 	}
 
-	delete importDataSet;
+	importDataSet.reset();
 	DataSetPackage::pkg()->endLoadingData();
 }
 
+///Decoding a column (working out its type and converting its values) only depends on that column, so that is done on a few threads.
+///Storing it in the dataset must happen on this thread though, so the decoders hand their columns over through a bounded queue that keeps them from running too far ahead.
+void Importer::initColumnsPipelined(ImportDataSet * importDataSet, boost::function<void (int)> progressCallback)
+{
+	JASPTIMER_SCOPE(Importer::initColumnsPipelined);
+
+	struct Decoded
+	{
+		size_t			colNo		= 0;
+		DecodedColumn	column;
+		uint64_t		fingerprint	= 0;
+	};
+
+	const size_t					columnCount	= importDataSet->columnCount(),
+									threshold	= thresholdScale(), //Settings are read here because QSettings shouldnt be used from the decoders
+									threads		= std::min<size_t>(columnCount, std::max(1u, std::thread::hardware_concurrency()));
+	std::atomic<size_t>				nextColumn	= 0,
+									decodedCount= 0;
+	BoundedQueue<Decoded>			decoded(2 * threads);
+	std::vector<std::future<void>>	decoders;
+
+	for(size_t t=0; t<threads; t++)
+		decoders.push_back(std::async(std::launch::async, [&]()
+		{
+			try
+			{
+				//Taking the next column instead of a fixed stripe keeps them arriving roughly in order
+				for(size_t c = nextColumn++; c < columnCount; c = nextColumn++)
+				{
+					ImportColumn *	importColumn	= importDataSet->getColumn(c);
+					Decoded			column			= { c, decodeColumn(importColumn->name(), importColumn->allValuesAsStrings(), threshold), importColumn->fingerprint() };
+
+					decodedCount++;
+
+					if(!decoded.push(std::move(column)))
+						return;
+				}
+			}
+			catch(...)
+			{
+				decoded.close();
+				throw;
+			}
+		}));
+
+	//If storing throws (because the load was cancelled for instance) this closes the queue so the decoders stop, the futures then wait for them
+	BoundedQueue<Decoded>::Closer closer{ decoded };
+
+	Decoded column;
+	for(size_t stored = 0; stored < columnCount && decoded.pop(column); stored++)
+	{
+		progressCallback(50 + (25 * decodedCount) / columnCount + (25 * stored) / columnCount);
+
+		storeDecodedColumn(int(column.colNo), column.column);
+		storeColumnFingerprint(column.column.name, column.fingerprint);
+	}
+
+	decoded.close();
+
+	for(std::future<void> & decoder : decoders)
+		decoder.get(); //Rethrows whatever went wrong in a decoder
+}
+
 void Importer::initColumn(QVariant colId, ImportColumn *importColumn)
 {
 	initColumnWithStrings(colId, importColumn->name(),  importColumn->allValuesAsStrings());
@@ -41,35 +124,61 @@ void Importer::initColumn(QVariant colId, ImportColumn *importColumn)
 
 void Importer::initColumnWithStrings(QVariant colId, std::string newName, const std::vector<std::string> &values)
 {
-	// interpret the column as a datatype
-	std::set<int>				uniqueValues;
-	std::vector<int>			intValues;
-	std::vector<double>			doubleValues;
-	std::map<int, std::string>	emptyValuesMap;
+	DecodedColumn decoded = decodeColumn(newName, values, thresholdScale());
+	storeDecodedColumn(colId, decoded);
+}
 
+size_t Importer::thresholdScale()
+{
 	//If less unique integers than the thresholdScale then we think it must be ordinal: https://github.com/jasp-stats/INTERNAL-jasp/issues/270
 	bool	useCustomThreshold	= Settings::value(Settings::USE_CUSTOM_THRESHOLD_SCALE).toBool();
-	size_t	thresholdScale		= (useCustomThreshold ? Settings::value(Settings::THRESHOLD_SCALE) : Settings::defaultValue(Settings::THRESHOLD_SCALE)).toUInt();
+	return	(useCustomThreshold ? Settings::value(Settings::THRESHOLD_SCALE) : Settings::defaultValue(Settings::THRESHOLD_SCALE)).toUInt();
+}
+
+Importer::DecodedColumn Importer::decodeColumn(const std::string & name, std::vector<std::string> values, size_t thresholdScale)
+{
+	// interpret the column as a datatype
+	DecodedColumn	decoded;
+	std::set<int>	uniqueValues;
+
+	decoded.name				= name;
 
-	bool valuesAreIntegers		= ImportColumn::convertVecToInt(values, intValues, uniqueValues, emptyValuesMap);
+	bool valuesAreIntegers		= ImportColumn::convertVecToInt(values, decoded.ints, uniqueValues, decoded.emptyValues);
 	
 	size_t minIntForThresh		= thresholdScale > 2 ? 2 : 0;
 
 	auto isNominalInt			= [&](){ return valuesAreIntegers && uniqueValues.size() == minIntForThresh; };
 	auto isOrdinal				= [&](){ return valuesAreIntegers && uniqueValues.size() >  minIntForThresh && uniqueValues.size() <= thresholdScale; };
-	auto isScalar				= [&](){ return ImportColumn::convertVecToDouble(values, doubleValues, emptyValuesMap); };
+	auto isScalar				= [&](){ return ImportColumn::convertVecToDouble(values, decoded.doubles, decoded.emptyValues); };
 
-	if		(isOrdinal())					initColumnAsNominalOrOrdinal(	colId,	newName,	intValues,		true	);
-	else if	(isNominalInt())				initColumnAsNominalOrOrdinal(	colId,	newName,	intValues,		false	);
-	else if	(isScalar())					initColumnAsScale(				colId,	newName,	doubleValues	);
-	else				emptyValuesMap =	initColumnAsNominalText(		colId,	newName,	values			);
+	if		(isOrdinal())		decoded.type = columnType::ordinal;
+	else if	(isNominalInt())	decoded.type = columnType::nominal;
+	else if	(isScalar())		decoded.type = columnType::scale;
+	else
+	{
+		decoded.type	= columnType::nominalText;
+		decoded.strings	= std::move(values);
+	}
+
+	return decoded;
+}
+
+void Importer::storeDecodedColumn(QVariant colId, DecodedColumn & decoded)
+{
+	switch(decoded.type)
+	{
+	case columnType::ordinal:
+	case columnType::nominal:		initColumnAsNominalOrOrdinal(	colId,	decoded.name,	decoded.ints,		decoded.type == columnType::ordinal	);	break;
+	case columnType::scale:			initColumnAsScale(				colId,	decoded.name,	decoded.doubles									);	break;
+	default:	decoded.emptyValues =	initColumnAsNominalText(		colId,	decoded.name,	decoded.strings									);	break;
+	}
 
-	storeInEmptyValues(newName, emptyValuesMap);
+	storeInEmptyValues(decoded.name, std::move(decoded.emptyValues));
 }
 
 void Importer::syncDataSet(const std::string &locator, boost::function<void(int)> progress)
 {
-	ImportDataSet *importDataSet	= loadFile(locator, progress);
+	std::unique_ptr<ImportDataSet>	importDataSet(loadFile(locator, progress)); //Also deleted when comparing or syncing throws
 	bool rowCountChanged			= importDataSet->rowCount() != DataSetPackage::pkg()->dataRowCount();
 
 	std::vector<std::pair<std::string, int> >	newColumns;
@@ -78,6 +187,9 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(int)
 	std::vector<std::string>					orgColumnNames(DataSetPackage::pkg()->getColumnNames(false)); //Non-computed
 	std::set<std::string>						missingColumns(orgColumnNames.begin(), orgColumnNames.end());
 
+	std::map<std::string, uint64_t>				syncFingerprints; //import column name -> fingerprint
+	size_t										unchangedByFingerprint = 0;
+
 	int syncColNo		= 0;
 
 	//If the following gives errors trhen it probably should be somewhere else:
@@ -87,7 +199,8 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(int)
 
 	for (ImportColumn *syncColumn : *importDataSet)
 	{
-		std::string syncColumnName = syncColumn->name();
+		std::string syncColumnName			= syncColumn->name();
+		syncFingerprints[syncColumnName]	= syncColumn->fingerprint();
 
 		if (missingColumns.count(syncColumnName) == 0)
 			newColumns.push_back(std::pair<std::string, int>(syncColumnName, syncColNo));
@@ -95,11 +208,16 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(int)
 		{
 			missingColumns.erase(syncColumnName);
 
-			if(DataSetPackage::pkg()->isColumnDifferentFromStringValues(syncColumnName, syncColumn->allValuesAsStrings()))
+			if(DataSetPackage::pkg()->columnMatchesFingerprint(syncColumnName, syncFingerprints[syncColumnName]))
+				unchangedByFingerprint++;
+
+			else if(DataSetPackage::pkg()->isColumnDifferentFromStringValues(syncColumnName, syncColumn->allValuesAsStrings()))
 			{
 				Log::log() << "Something changed in column: " << syncColumnName << std::endl;
 				changedColumns.push_back(std::pair<int, std::string>(syncColNo, syncColumnName));
 			}
+			else //Not fingerprinted before (loaded from a .jasp for instance) but it is the same, so next time we can skip the comparison
+				storeColumnFingerprint(syncColumnName, syncFingerprints[syncColumnName]);
 		}
 
 		syncColNo++;
@@ -112,7 +230,8 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(int)
 				const std::string & newColName	= newColIt->first;
 				ImportColumn *newValues = importDataSet->getColumn(newColName);
 
-				if(!DataSetPackage::pkg()->isColumnDifferentFromStringValues(nameMissing, newValues->allValuesAsStrings()))
+				if(		DataSetPackage::pkg()->columnMatchesFingerprint(nameMissing, syncFingerprints[newColName])
+					|| !DataSetPackage::pkg()->isColumnDifferentFromStringValues(nameMissing, newValues->allValuesAsStrings()))
 				{
 					changeNameColumns[nameMissing] = newColName;
 					newColumns.erase(newColIt);
@@ -123,10 +242,10 @@ void Importer::syncDataSet(const std::string &locator, boost::function<void(int)
 	for (auto changeNameColumnIt : changeNameColumns)
 		missingColumns.erase(changeNameColumnIt.first);
 
-	if (newColumns.size() > 0 || changedColumns.size() > 0 || missingColumns.size() > 0 || changeNameColumns.size() > 0 || rowCountChanged)
-			_syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
+	Log::log() << "Sync of '" << locator << "' found " << changedColumns.size() << " changed, " << missingColumns.size() << " missing, " << newColumns.size() << " new and " << changeNameColumns.size() << " renamed columns, " << unchangedByFingerprint << " columns were skipped because their fingerprint matched." << std::endl;
 
-	delete importDataSet;
+	if (newColumns.size() > 0 || changedColumns.size() > 0 || missingColumns.size() > 0 || changeNameColumns.size() > 0 || rowCountChanged)
+			_syncPackage(importDataSet.get(), newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
 }
 
 void Importer::_syncPackage(
@@ -166,9 +285,11 @@ void Importer::_syncPackage(
 	{
 		Log::log() << "Column changed " << indexColChanged.first << std::endl;
 
-		std::string colName	= indexColChanged.second;
+		std::string		colName		= indexColChanged.second;
+		ImportColumn *	syncColumn	= syncDataSet->getColumn(indexColChanged.first);
 		_changedColumns.push_back(colName);
-		initColumn(tq(colName), syncDataSet->getColumn(indexColChanged.first));
+		initColumn(tq(colName), syncColumn);
+		storeColumnFingerprint(syncColumn->name(), syncColumn->fingerprint());
 	}
 
 	if (newColumns.size() > 0)
@@ -178,7 +299,9 @@ void Importer::_syncPackage(
 			DataSetPackage::pkg()->increaseDataSetColCount(syncDataSet->rowCount());
 			Log::log() << "New column " << it->first << std::endl;
 
-			initColumn(DataSetPackage::pkg()->dataColumnCount() - 1, syncDataSet->getColumn(it->first));
+			ImportColumn * syncColumn = syncDataSet->getColumn(it->first);
+			initColumn(DataSetPackage::pkg()->dataColumnCount() - 1, syncColumn);
+			storeColumnFingerprint(syncColumn->name(), syncColumn->fingerprint());
 		}
 	}
 
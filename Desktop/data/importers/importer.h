@@ -21,7 +21,7 @@ public:
 	Importer() {}
 	virtual ~Importer();
 	void loadDataSet(const std::string &locator, boost::function<void (int)> progressCallback);
-	void syncDataSet(const std::string &locator, boost::function<void (int)> progressCallback);
+	virtual void syncDataSet(const std::string &locator, boost::function<void (int)> progressCallback);
 
 protected:
 	virtual ImportDataSet* loadFile(const std::string &locator, boost::function<void(int)> progressCallback) = 0;
@@ -29,21 +29,42 @@ protected:
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
 	virtual void initColumn(QVariant colId, ImportColumn *importColumn);
 
+	///Whether loadDataSet may decode the columns on several threads, only true if initColumn wasn't overridden to do something else than initColumnWithStrings
+	virtual bool decodesColumnsInParallel() const { return true; }
+
 	void initColumnWithStrings(QVariant colId, std::string newName, const std::vector<std::string> &values);
 
+	///What initColumnWithStrings works out about a column, it doesn't touch DataSetPackage so it can be done on any thread
+	struct DecodedColumn
+	{
+		std::string					name;
+		columnType					type		= columnType::unknown;
+		std::vector<int>			ints;
+		std::vector<double>			doubles;
+		std::vector<std::string>	strings;
+		ColumnEmptyValues			emptyValues;
+	};
+
+	static DecodedColumn		decodeColumn(const std::string & name, std::vector<std::string> values, size_t thresholdScale);
+	void						storeDecodedColumn(QVariant colId, DecodedColumn & decoded);
+	static size_t				thresholdScale();
+
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
 	bool						initColumnAsNominalOrOrdinal(	QVariant colID,			std::string newName, const std::vector<int>			& values, bool is_ordinal = false)	{ return DataSetPackage::pkg()->initColumnAsNominalOrOrdinal(colID, newName, values, is_ordinal);				}
 
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
-	std::map<int, std::string>	initColumnAsNominalText(		QVariant colID,			std::string newName, const std::vector<std::string>	& values)							{ return DataSetPackage::pkg()->initColumnAsNominalText(colID, newName, values);									}
+	ColumnEmptyValues			initColumnAsNominalText(		QVariant colID,			std::string newName, const std::vector<std::string>	& values)							{ return DataSetPackage::pkg()->initColumnAsNominalText(colID, newName, values);									}
 
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
 	bool						initColumnAsScale(				QVariant colID,			std::string newName, const std::vector<double>		& values)							{ return DataSetPackage::pkg()->initColumnAsScale(colID, newName, values);										}
 
-	void						storeInEmptyValues(std::string columnName, std::map<int, std::string> emptyValues)																{ DataSetPackage::pkg()->storeInEmptyValues(columnName, emptyValues);											}
+	void						storeInEmptyValues(std::string columnName, ColumnEmptyValues emptyValues)																		{ DataSetPackage::pkg()->storeInEmptyValues(columnName, std::move(emptyValues));											}
 	void						resetEmptyValues()																																{ DataSetPackage::pkg()->resetEmptyValues();																		}
+	void						storeColumnFingerprint(const std::string & columnName, uint64_t importFingerprint)																{ DataSetPackage::pkg()->storeColumnFingerprint(columnName, importFingerprint);									}
 
 private:
+	void initColumnsPipelined(ImportDataSet * importDataSet, boost::function<void (int)> progressCallback);
+
 	void _syncPackage(
 			ImportDataSet								*	syncDataSet,
 			std::vector<std::pair<std::string, int>>	&	newColumns,
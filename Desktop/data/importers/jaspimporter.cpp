@@ -35,6 +35,9 @@
 
 #include "resultstesting/compareresults.h"
 #include "log.h"
+#include "../boundedqueue.h"
+#include <future>
+#include <cstring>
 
 void JASPImporter::loadDataSet(const std::string &path, boost::function<void(int)> progressCallback)
 {	
@@ -116,26 +119,19 @@ void JASPImporter::loadDataArchive_1_00(const std::string &path, boost::function
 		ColumnUtils::setEmptyValues(emptyValues);
 	}
 
-	Json::Value &emptyValuesMapJson = dataSetDesc["emptyValuesMap"];
+	Json::Value &emptyValuesPerColumnJson	= dataSetDesc["emptyValuesPerColumn"],
+				&emptyValuesMapJson			= dataSetDesc["emptyValuesMap"];
 	packageData->resetEmptyValues();
 
-	if (!emptyValuesMapJson.isNull())
+	if (emptyValuesPerColumnJson.isObject())
+	{
+		for (Json::Value::iterator iter = emptyValuesPerColumnJson.begin(); iter != emptyValuesPerColumnJson.end(); ++iter)
+			packageData->storeInEmptyValues(iter.key().asString(), ColumnEmptyValues::fromJson(*iter));
+	}
+	else if (!emptyValuesMapJson.isNull()) // Data archives before 1.1.0 have an object per column with a key per row
 	{
 		for (Json::Value::iterator iter = emptyValuesMapJson.begin(); iter != emptyValuesMapJson.end(); ++iter)
-		{
-			std::string colName	= iter.key().asString();
-			Json::Value mapJson	= *iter;
-			std::map<int, std::string> map;
-
-			for (Json::Value::iterator iter2 = mapJson.begin(); iter2 != mapJson.end(); ++iter2)
-			{
-				int row					= stoi(iter2.key().asString());
-				Json::Value valueJson	= *iter2;
-				std::string value		= valueJson.asString();
-				map[row]				= value;
-			}
-			packageData->storeInEmptyValues(colName, map);
-		}
+			packageData->storeInEmptyValues(iter.key().asString(), ColumnEmptyValues::fromLegacyJson(*iter));
 	}
 
 	columnCount = dataSetDesc["columnCount"].asInt();
@@ -172,50 +168,84 @@ void JASPImporter::loadDataArchive_1_00(const std::string &path, boost::function
 	if (!dataEntry.exists())
 		throw std::runtime_error("Entry " + entryName + " could not be found.");
 
-	char buff[sizeof(double) > sizeof(int) ? sizeof(double) : sizeof(int)];
+	std::vector<size_t> columnBytes(columnCount);
+	for (int c = 0; c < columnCount; c++)
+		columnBytes[c] = rowCount * (packageData->getColumnType(c) == columnType::scale ? sizeof(double) : sizeof(int));
+
+	//Decompressing data.bin happens on another thread, a few columns ahead of the one being put in the dataset here
+	BoundedQueue<std::string>	columnsRead(4);
+	std::future<void>			reader = std::async(std::launch::async, [&]()
+	{
+		try
+		{
+			for (int c = 0; c < columnCount; c++)
+			{
+				std::string bytes(columnBytes[c], '\0');
+
+				for(size_t read = 0; read < bytes.size();)
+				{
+					int errorCode	= 0,
+						size		= dataEntry.readData(bytes.data() + read, int(std::min<size_t>(bytes.size() - read, 1 << 20)), errorCode);
+
+					if (errorCode != 0 || size <= 0)
+						throw std::runtime_error("Could not read 'data.bin' in JASP archive.");
+
+					read += size;
+				}
+
+				if(!columnsRead.push(std::move(bytes)))
+					return;
+			}
+		}
+		catch(...)
+		{
+			columnsRead.close();
+			throw;
+		}
+	});
+
+	//If anything here throws (a cancelled load for instance) the reader is stopped before the archive goes out of scope
+	BoundedQueue<std::string>::Closer closer{ columnsRead };
 
 	std::vector<double>		dbls(rowCount);
 	std::vector<int>		ints(rowCount);
+	std::string				bytes;
 
 	for (int c = 0; c < columnCount; c++)
 	{
+		if(!columnsRead.pop(bytes))
+			break; //The reader failed, get() below tells us why
+
 		columnType columnType			= packageData->getColumnType(c);
 		bool isScalar					= columnType == columnType::scale;
-		int typeSize					= isScalar ? sizeof(double) : sizeof(int);
 		std::map<int, int>& mapValues	= mapNominalTextValues[packageData->getColumnName(c)];
 
-		for (size_t r = 0; r < rowCount; r++)
+		if (isScalar)
+			std::memcpy(dbls.data(), bytes.data(), bytes.size());
+		else
 		{
-			int errorCode	= 0;
-			int size		= dataEntry.readData(buff, typeSize, errorCode);
-
-			if (errorCode != 0 || size != typeSize)
-				throw std::runtime_error("Could not read 'data.bin' in JASP archive.");
-
-			if (isScalar)
-				dbls[r] = *reinterpret_cast<double*>(buff);
-			else
-			{
-				int value = *reinterpret_cast<int*>(buff);
+			std::memcpy(ints.data(), bytes.data(), bytes.size());
 
-				if (columnType == columnType::nominalText && value != std::numeric_limits<int>::lowest())
-					value = mapValues[value];
-
-				ints[r] = value;
-			}
+			if (columnType == columnType::nominalText)
+				for (int & value : ints)
+					if (value != std::numeric_limits<int>::lowest())
+						value = mapValues[value];
+		}
 
-			progress = 33.0 + ((33.0 * ((c * rowCount) + (r + 1))) / (columnCount * rowCount));
-			if (progress != lastProgress)
-			{
-				progressCallback(progress); // fq(tr("Loading Data Set")),
-				lastProgress = progress;
-			}
+		progress = 33.0 + (33.0 * (c + 1)) / columnCount;
+		if (progress != lastProgress)
+		{
+			progressCallback(progress); // fq(tr("Loading Data Set")),
+			lastProgress = progress;
 		}
 
 		if(isScalar)	packageData->setColumnDataDbls(c, dbls);
 		else			packageData->setColumnDataInts(c, ints);
 	}
 
+	columnsRead.close();
+	reader.get();
+
 	dataEntry.close();
 
 	if(resultXmlCompare::compareResults::theOne()->testMode())
@@ -20,12 +20,13 @@
 */
 
 #include "odsimportcolumn.h"
-#include "odssheetcell.h"
 
 #include "odstypes.h"
 #include "odsimportdataset.h"
 
 #include <set>
+#include <algorithm>
+#include <stdexcept>
 #include "log.h"
 
 using namespace std;
@@ -34,6 +35,7 @@ using namespace ods;
 
 ODSImportColumn::ODSImportColumn(ODSImportDataSet* importDataSet, int columnNumber, string name)
 	: ImportColumn(importDataSet, name)
+	, _odsDataSet(importDataSet)
 	, _columnNumber(columnNumber)
 	, _columnType(columnType::unknown)
 {
@@ -48,7 +50,7 @@ ODSImportColumn::~ODSImportColumn()
 size_t ODSImportColumn::size()
 const
 {
-	return _rows.size();
+	return _rowCount;
 }
 
 std::vector<std::string> ODSImportColumn::allValuesAsStrings() const
@@ -56,46 +58,65 @@ std::vector<std::string> ODSImportColumn::allValuesAsStrings() const
 	return getData();
 }
 
-/**
- * @brief insert Inserts string value for cell, irrespective of type.
- * @param row
- * @param data
- */
-void insert(int row, const std::string& data);
+void ODSImportColumn::createSpace(size_t row)
+{
+	_rowCount = std::max(_rowCount, row + 1);
+}
 
+void ODSImportColumn::setValue(size_t row, const string &data, size_t repeat)
+{
+	//Log::log() << "Inserting " << data << ", row " << row << ", column " << _columnNumber << "." << std::endl;
 
-/**
- * @brief _createSpace Ensures that we have enough elements in _rows.
- * @param row Row number to check for.
- */
-void ODSImportColumn::createSpace(size_t row)
+	if(data.empty())	setValue(row, ODSImportDataSet::StoredValue(),	repeat);
+	else				setValue(row, _odsDataSet->storeValue(data),	repeat);
+}
+
+void ODSImportColumn::setValue(size_t row, ODSImportDataSet::StoredValue value, size_t repeat)
 {
-#ifdef JASP_DEBUG
-	size_t numAdded = 0;
-#endif
+	if(!_runs.empty() && _runs.back().firstRow + _runs.back().rowCount > row)
+		throw std::runtime_error("ODSImportColumn::setValue got row " + std::to_string(row) + " for column " + _colNumberAsExcel(_columnNumber) + " out of order.");
+
+	createSpace(row + repeat - 1);
 
-	while (_rows.size() <= row)
-#ifdef JASP_DEBUG
+	if(value.length == 0 || repeat == 0)
+		return; //Empty rows aren't stored at all
+
+	if(!_runs.empty() && _runValue(_runs.back()) == _odsDataSet->storedValue(value))
 	{
-		numAdded++;
-#endif
-		_rows.push_back(ODSSheetCell());
-#ifdef JASP_DEBUG
+		ValueRun & last = _runs.back();
+
+		if(last.firstRow + last.rowCount == row)
+			last.rowCount += repeat;
+		else
+			_runs.push_back({ row, repeat, last.value });
+
+		return;
 	}
 
-	//if (numAdded != 0) 	Log::log() << "ODSImportColumn::_createSpace(" << row << ") - added " << numAdded << " row" <<((numAdded != 1) ? "s" : "") << "." << std::endl;
-#endif
+	_runs.push_back({ row, repeat, value });
 }
 
-void ODSImportColumn::setValue(int row, const string &data)
+void ODSImportColumn::repeatRow(size_t row, size_t times)
 {
-	//Log::log() << "Inserting " << data << ", row " << row << ", column " << _columnNumber << "." << std::endl;
+	if(times == 0)
+		return;
 
-	// Big enough?
-	createSpace(row);
+	if(!_runs.empty() && _runs.back().firstRow + _runs.back().rowCount == row + 1)
+		_runs.back().rowCount += times;
 
-	ODSSheetCell & cell = _rows.at(row);
-	cell.setValue(data);	
+	createSpace(row + times);
+}
+
+string ODSImportColumn::valueAt(size_t row) const
+{
+	auto run = std::upper_bound(_runs.begin(), _runs.end(), row, [](size_t r, const ValueRun & run) { return r < run.firstRow; });
+
+	if(run == _runs.begin())
+		return "";
+
+	--run;
+
+	return row < run->firstRow + run->rowCount ? string(_runValue(*run)) : "";
 }
 
 /**
@@ -112,12 +133,16 @@ void ODSImportColumn::postLoadProcess()
 
 vector<string> ODSImportColumn::getData() const
 {
-	vector<string> values;
-	for (Cases::const_iterator i = _rows.begin(); i != _rows.end(); ++i)
+	vector<string> values(_rowCount);
+
+	for (const ValueRun & run : _runs)
 	{
-		const string &value = i->valueAsString();
-		values.push_back(value);
+		const std::string_view value = _runValue(run);
+
+		for(size_t row=run.firstRow; row<run.firstRow + run.rowCount; row++)
+			values[row] = value;
 	}
+
 	return values;
 }
 
@@ -24,25 +24,25 @@
 
 #include "../importcolumn.h"
 #include "odsimportdataset.h"
-#include "odssheetcell.h"
 
 #include <set>
+#include <string_view>
 
 
 namespace ods
 {
 class ODSImportDataSet;
 
+/**
+ * Stores the cells of a column as runs of consecutive rows that share a value.
+ * The values themselves are stored in the arena of the ODSImportDataSet, rows not covered by any run are empty.
+ * This means that repeated cells (number-rows-repeated/number-columns-repeated) and sparse regions cost nothing
+ * until getData() materialises them when Importer::initColumn needs them.
+ */
 class ODSImportColumn : public ImportColumn
 {
 public:
 
-	// The empty value for a cell.
-	static const ODSSheetCell EmptySheetCell;
-
-	// The constainer used to hold rows within the column.
-	typedef std::vector<ODSSheetCell>	Cases;
-
 	ODSImportColumn(ODSImportDataSet* importDataSet, int columnNumber, std::string name);
 	virtual ~ODSImportColumn();
 
@@ -64,29 +64,36 @@ public:
 	std::vector<std::string>	allValuesAsStrings()					const	override;
 
 	/**
-	 * @brief hasCall Checks for presence of a cell at row.
-	 * @param row Row check for.
-	 * @return true if value in column.
-	 */
-	inline bool hasCell(size_t row) const
-	{
-		return (_index.find(row) != _index.end());
-	}
-
-	/**
-	 * @brief _createSpace Ensures that we have enough elements in _rows.
+	 * @brief _createSpace Ensures that the column has at least row + 1 rows, the new ones are empty and not stored.
 	 * @param row Row number to check for.
 	 */
 	void createSpace(size_t row);
 
 	/**
-	 * @brief setValue Inserts string value for cell, irrespective of type.
+	 * @brief setValue Inserts string value for cell(s), irrespective of type.
+	 * Rows have to be set in increasing order, which is how the SAX parser encounters them.
 	 * @param row
 	 * @param data
+	 * @param repeat Number of consecutive rows, starting at row, that get this value.
+	 */
+	void setValue(size_t row, const std::string& data, size_t repeat = 1);
+
+	/**
+	 * @brief setValue Same as above for a value that is already in the arena of the dataset, so a cell repeated over columns is stored once.
+	 */
+	void setValue(size_t row, ODSImportDataSet::StoredValue value, size_t repeat = 1);
+
+	/**
+	 * @brief repeatRow Gives the rows following row the same value, for number-rows-repeated.
+	 * @param row The row that is repeated, must be the last row set.
+	 * @param times How many rows to add.
 	 */
-	void setValue(int row, const std::string& data);
+	void repeatRow(size_t row, size_t times);
 
-	const ODSSheetCell &getCell(int row) const { return _rows.at(row); }
+	/**
+	 * @brief valueAt Returns the value at row, empty if nothing was set there.
+	 */
+	std::string valueAt(size_t row) const;
 
 	/**
 	 * @brief postLoadProcess Performs posy load processing.
@@ -105,14 +112,23 @@ public:
 
 	std::vector<std::string> getData() const;
 
+	size_t runCount()	const { return _runs.size();	}
+
 private:
+	///Rows [firstRow, firstRow + rowCount) all have the stored value
+	struct ValueRun
+	{
+		size_t							firstRow,
+										rowCount;
+		ODSImportDataSet::StoredValue	value;
+	};
 
-	// The cells/rows (as read).
-	Cases	_rows;
+	std::string_view	_runValue(const ValueRun & run) const { return _odsDataSet->storedValue(run.value); }
 
-	typedef std::map< int, size_t > CellIndex;
-	CellIndex			_index;		///< cell indexes indexed by row.
-	int					_columnNumber; //<- We know our own column number
+	ODSImportDataSet	*	_odsDataSet;	///< Keeps the values of the runs.
+	std::vector<ValueRun>	_runs;			///< Sorted by firstRow and non-overlapping.
+	size_t					_rowCount = 0;	///< Including trailing empty rows.
+	int						_columnNumber; //<- We know our own column number
 	columnType	_columnType; // Our column type.
 
 	/**
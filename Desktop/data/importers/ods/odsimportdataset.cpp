@@ -23,7 +23,6 @@
 #include "log.h"
 #include "../importdataset.h"
 #include "odsimportcolumn.h"
-#include "../odsimporter.h"
 
 using namespace std;
 using namespace ods;
@@ -33,7 +32,7 @@ const string ODSImportDataSet::manifestPath("META-INF/manifest.xml"); //< manfie
 const QString ODSImportDataSet::contentRegExpression(".*content.*\\.xml");
 
 
-ODSImportDataSet::ODSImportDataSet(ODSImporter* importer) : ImportDataSet(importer)
+ODSImportDataSet::ODSImportDataSet(Importer* importer) : ImportDataSet(importer)
 {
 
 }
@@ -53,6 +52,18 @@ ODSImportColumn & ODSImportDataSet::createColumn(string name)
 }
 
 
+ODSImportDataSet::StoredValue ODSImportDataSet::storeValue(const string & value)
+{
+	if(storedValue(_lastStored) != value)
+	{
+		_lastStored = { _arena.size(), value.size() };
+		_arena.append(value);
+	}
+
+	return _lastStored;
+}
+
+
 /**
  * @brief operator [] Exposes the underlying vector of the ImportDataSet.
  * @param index The bracketed value.
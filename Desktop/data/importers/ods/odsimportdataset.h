@@ -24,12 +24,12 @@
 
 #include "../importdataset.h"
 #include <qstring.h>
+#include <string_view>
 
 
 namespace ods
 {
 
-class ODSImporter;
 class ODSImportColumn;
 
 /*
@@ -39,7 +39,7 @@ class ODSImportDataSet : public ImportDataSet
 {
 public:
 
-	ODSImportDataSet(ODSImporter* importer);
+	ODSImportDataSet(Importer* importer);
 	virtual ~ODSImportDataSet();
 
 	/*
@@ -59,6 +59,23 @@ public:
 
 	ODSImportColumn & createColumn(std::string name);
 
+	/**
+	 * Where a cell value is kept in the arena that all columns share.
+	 * A cell with number-columns-repeated stores its value once and every column it covers only refers to it.
+	 */
+	struct StoredValue
+	{
+		size_t	offset = 0,
+				length = 0;
+	};
+
+	/**
+	 * @brief storeValue Appends value to the shared arena, unless it is the value that was stored last.
+	 */
+	StoredValue			storeValue(const std::string & value);
+	std::string_view	storedValue(const StoredValue & stored)	const { return std::string_view(_arena).substr(stored.offset, stored.length); }
+	size_t				arenaSize()								const { return _arena.size(); }
+
 	/**
 	 * @brief operator [] Exposes the underlying vector of the ImportDataSet.
 	 * @param index The bracketed value.
@@ -78,6 +95,8 @@ public:
 
 private:
 	std::string _contentFilename;
+	std::string	_arena;			///< The distinct values of consecutive cells, back to back.
+	StoredValue	_lastStored;
 };
 
 } // end namespace ods
@@ -161,14 +161,13 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 				_docDepth = table;
 				if (_row > 0 && _lastNotEmptyColumn > -1)
 				{
-					// Repeat the last row
-					for (int i = 1; i < _rowRepeat; i++)
+					// Repeat the last row, this only extends the last run of each column
+					if (_rowRepeat > 1)
 					{
 						for (int j = 0; j < _dataSet->columnCount(); j++)
-						{
-							(*_dataSet)[j].setValue(_row, (*_dataSet)[j].getCell(_row - 1).valueAsString());
-						}
-						_row++;
+							(*_dataSet)[j].repeatRow(_row - 1, _rowRepeat - 1);
+
+						_row += _rowRepeat - 1;
 					}
 				}
 				_row++;
@@ -210,11 +209,13 @@ bool XmlContentsHandler::endElement(const QString &namespaceURI, const QString &
 					{
 						for (int i = _lastNotEmptyColumn + 1; i < _column; i++)
 						{
-							// Set empty values
-							_dataSet->getOrCreate(i).setValue(_row - 1, string());
+							// Empty values aren't stored, the columns only need to know the row exists
+							_dataSet->getOrCreate(i).createSpace(_row - 1);
 						}
+						// Stored once, all repeated columns refer to the same value
+						const ODSImportDataSet::StoredValue value = _dataSet->storeValue(_currentCell.toStdString());
 						for (int i = 0; i < _colRepeat; i++)
-							_dataSet->getOrCreate(_column + i).setValue(_row - 1, _currentCell.toStdString());
+							_dataSet->getOrCreate(_column + i).setValue(_row - 1, value);
 					}
 					_lastNotEmptyColumn = _column + _colRepeat - 1;
 				}
@@ -1,5 +1,5 @@
 //
-//  Taken from github on 3-7-19 from commit 1f7a3bdc3f173b914a942cde12cbb0a67baa60c7 for version 1.0.1
+//  Taken from github for version 1.1.9, the version Tools/CMake/Dependencies.cmake builds
 //  readstat.h - API and internal data structures for ReadStat
 //
 //  Copyright Evan Miller and ReadStat authors (see LICENSE)
@@ -95,7 +95,7 @@ typedef enum readstat_error_e {
     READSTAT_ERROR_NAME_CONTAINS_ILLEGAL_CHARACTER,
     READSTAT_ERROR_NAME_IS_RESERVED_WORD,
     READSTAT_ERROR_NAME_IS_TOO_LONG,
-    READSTAT_ERROR_BAD_TIMESTAMP,
+    READSTAT_ERROR_BAD_TIMESTAMP_STRING,
     READSTAT_ERROR_BAD_FREQUENCY_WEIGHT,
     READSTAT_ERROR_TOO_MANY_MISSING_VALUE_DEFINITIONS,
     READSTAT_ERROR_NOTE_IS_TOO_LONG,
@@ -104,11 +104,23 @@ typedef enum readstat_error_e {
     READSTAT_ERROR_ROW_IS_TOO_WIDE_FOR_PAGE,
     READSTAT_ERROR_TOO_FEW_COLUMNS,
     READSTAT_ERROR_TOO_MANY_COLUMNS,
-    READSTAT_ERROR_NAME_IS_ZERO_LENGTH
+    READSTAT_ERROR_NAME_IS_ZERO_LENGTH,
+    READSTAT_ERROR_BAD_TIMESTAMP_VALUE,
+    READSTAT_ERROR_BAD_MR_STRING
 } readstat_error_t;
 
 const char *readstat_error_message(readstat_error_t error_code);
 
+typedef struct mr_set_s {
+    char type;
+    char *name;
+    char *label;
+    int is_dichotomy;
+    int counted_value;
+    char **subvariables;
+    int num_subvars;
+} mr_set_t;
+
 typedef struct readstat_metadata_s {
     int64_t     row_count;
     int64_t     var_count;
@@ -121,6 +133,8 @@ typedef struct readstat_metadata_s {
     const char *file_label;
     const char *file_encoding;
     unsigned int is64bit:1;
+    size_t multiple_response_sets_length;
+    mr_set_t *mr_sets;
 } readstat_metadata_t;
 
 int readstat_get_row_count(readstat_metadata_t *metadata);
@@ -134,6 +148,7 @@ readstat_endian_t readstat_get_endianness(readstat_metadata_t *metadata);
 const char *readstat_get_table_name(readstat_metadata_t *metadata);
 const char *readstat_get_file_label(readstat_metadata_t *metadata);
 const char *readstat_get_file_encoding(readstat_metadata_t *metadata);
+size_t readstat_get_multiple_response_sets(readstat_metadata_t *metadata, mr_set_t **mr_sets);
 
 typedef struct readstat_value_s {
     union {
@@ -342,6 +357,7 @@ typedef struct readstat_parser_s {
     const char             *input_encoding;
     const char             *output_encoding;
     long                    row_limit;
+    long                    row_offset;
 } readstat_parser_t;
 
 readstat_parser_t *readstat_parser_init(void);
@@ -373,6 +389,7 @@ readstat_error_t readstat_set_file_character_encoding(readstat_parser_t *parser,
 readstat_error_t readstat_set_handler_character_encoding(readstat_parser_t *parser, const char *encoding);
 
 readstat_error_t readstat_set_row_limit(readstat_parser_t *parser, long row_limit);
+readstat_error_t readstat_set_row_offset(readstat_parser_t *parser, long row_offset);
 
 /* Parse binary / portable files */
 readstat_error_t readstat_parse_dta(readstat_parser_t *parser, const char *path, void *user_ctx);
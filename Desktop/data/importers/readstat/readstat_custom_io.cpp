@@ -15,8 +15,6 @@ struct jasp_io_ctx
 	int fd = -1;
 };
 
-jasp_io_ctx * localIoCtx = NULL;
-
 readstat_error_t init_io_handlers(readstat_parser_t * parser)
 {
 	readstat_error_t retval = READSTAT_OK;
@@ -27,17 +25,15 @@ readstat_error_t init_io_handlers(readstat_parser_t * parser)
 	if ((retval = readstat_set_read_handler(	parser, handle_read))	!= READSTAT_OK)	return retval;
 	if ((retval = readstat_set_update_handler(	parser, handle_update))	!= READSTAT_OK)	return retval;
 
-	localIoCtx		= new jasp_io_ctx();
-	retval			= readstat_set_io_ctx(parser, (void*) localIoCtx);
+	retval			= readstat_set_io_ctx(parser, (void*) new jasp_io_ctx()); //One per parser, because ReadStatImportDataSet parses row ranges of a file on several threads at once
 
 	return retval;
 }
 
-void io_cleanup()
+void io_cleanup(readstat_parser_t * parser)
 {
-	if(localIoCtx)
-		delete localIoCtx;
-	localIoCtx = NULL;
+	delete static_cast<jasp_io_ctx*>(parser->io->io_ctx);
+	parser->io->io_ctx = NULL;
 }
 
 int handle_open(const char *path, void * io_ctx)
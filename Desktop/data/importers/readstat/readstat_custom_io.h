@@ -11,7 +11,7 @@ extern "C"
 {
 
 readstat_error_t	init_io_handlers(readstat_parser_t *parser);
-void				io_cleanup();
+void				io_cleanup(readstat_parser_t *parser); ///< Deletes the io context init_io_handlers gave parser, call it before readstat_parser_free
 
 int					handle_open(const char *path,																void *io_ctx);
 int					handle_close(																				void *io_ctx);
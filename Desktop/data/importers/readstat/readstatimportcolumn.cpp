@@ -153,6 +153,10 @@ void ReadStatImportColumn::setType(columnType newType)
 	{
 	case columnType::unknown:
 		_type = newType;
+
+		if(_reserveRows > 0)
+			reserve(_reserveRows);
+
 		addLeadingMissingValues();
 		return;
 
@@ -250,6 +254,23 @@ void ReadStatImportColumn::setType(columnType newType)
 	}
 
 	_type = newType;
+
+	if(_reserveRows > 0)
+		reserve(_reserveRows);
+}
+
+void ReadStatImportColumn::reserve(size_t rows)
+{
+	_reserveRows = rows;
+
+	switch(_type)
+	{
+	case columnType::scale:			_doubles.reserve(rows);	return;
+	case columnType::ordinal:		[[fallthrough]];
+	case columnType::nominal:		_ints.reserve(rows);	return;
+	case columnType::nominalText:	_strings.reserve(rows);	return;
+	default:												return;
+	}
 }
 
 void ReadStatImportColumn::addLeadingMissingValues()
@@ -477,30 +498,55 @@ std::string ReadStatImportColumn::readstatValueToString(const readstat_value_t &
 	return "???";
 }
 
+ReadStatImportValue::ReadStatImportValue(const readstat_value_t & value, readstat_variable_t * variable)
+	: type(				readstat_value_type(value)),
+	  missing(			variable ? readstat_value_is_missing(value, variable) : readstat_value_is_system_missing(value)),
+	  systemMissing(	readstat_value_is_system_missing(value))
+{
+	if(missing)
+	{
+		if(!systemMissing)
+			text = ReadStatImportColumn::readstatValueToString(value);
+		return;
+	}
+
+	switch(type)
+	{
+	case READSTAT_TYPE_STRING:		text	=			readstat_string_value(value);		return;
+	case READSTAT_TYPE_INT8:		number	= int(		readstat_int8_value(value));		return;
+	case READSTAT_TYPE_INT16:		number	= int(		readstat_int16_value(value));		return;
+	case READSTAT_TYPE_INT32:		number	= int(		readstat_int32_value(value));		return;
+	case READSTAT_TYPE_FLOAT:		number	= double(	readstat_float_value(value));		return;
+	case READSTAT_TYPE_DOUBLE:		number	=			readstat_double_value(value);		return;
+	case READSTAT_TYPE_STRING_REF:	throw std::runtime_error("File contains string references and we do not support this.");
+	}
+}
+
 void ReadStatImportColumn::addValue(const readstat_value_t & value)
 {
-	readstat_type_t	type	= readstat_value_type(value);
-	bool			missing	= _readstatVariable ? readstat_value_is_missing(value, _readstatVariable) : readstat_value_is_system_missing(value);
+	addValue(ReadStatImportValue(value, _readstatVariable));
+}
 
-	if (!missing)
-		switch(type)
+void ReadStatImportColumn::addValue(const ReadStatImportValue & value)
+{
+	if (!value.missing)
+		switch(value.type)
 		{
-		case READSTAT_TYPE_STRING:		addValue(			readstat_string_value(value)	);	return;
-		case READSTAT_TYPE_INT8:		addValue(int(		readstat_int8_value(value))		);	return;
-		case READSTAT_TYPE_INT16:		addValue(int(		readstat_int16_value(value))	);	return;
-		case READSTAT_TYPE_INT32:		addValue(int(		readstat_int32_value(value))	);	return;
-		case READSTAT_TYPE_FLOAT:		addValue(double(	readstat_float_value(value))	);	return;
-		case READSTAT_TYPE_DOUBLE:		addValue(			readstat_double_value(value)	);	return;
+		case READSTAT_TYPE_STRING:		addValue(		value.text		);	return;
+		case READSTAT_TYPE_INT8:		[[fallthrough]];
+		case READSTAT_TYPE_INT16:		[[fallthrough]];
+		case READSTAT_TYPE_INT32:		addValue(int(	value.number)	);	return;
+		case READSTAT_TYPE_FLOAT:		[[fallthrough]];
+		case READSTAT_TYPE_DOUBLE:		addValue(		value.number	);	return;
 		case READSTAT_TYPE_STRING_REF:	throw std::runtime_error("File contains string references and we do not support this.");
 		}
 	else
 	{
-		if(!readstat_value_is_system_missing(value))
+		if(!value.systemMissing)
 		{
-			const auto missStr = readstatValueToString(value);
-			if(!_loggedMissing.count(missStr))
-				Log::log() << "Column '" << _name << "' has non-system missing value: '" << readstatValueToString(value) << "' dropping the value." << std::endl;
-			_loggedMissing.insert(missStr);
+			if(!_loggedMissing.count(value.text))
+				Log::log() << "Column '" << _name << "' has non-system missing value: '" << value.text << "' dropping the value." << std::endl;
+			_loggedMissing.insert(value.text);
 		}
 		addMissingValue();
 	}
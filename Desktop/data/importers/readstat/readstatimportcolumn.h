@@ -5,6 +5,20 @@
 #include "readstat.h"
 #include "../importcolumn.h"
 
+///
+/// A copy of a readstat_value_t as the value handler gets it, so that the rows a parser read on another thread can be added to their column afterwards.
+/// The string in a readstat_value_t only lives until the handler returns, so it cannot be kept itself.
+struct ReadStatImportValue
+{
+	ReadStatImportValue(const readstat_value_t & value, readstat_variable_t * variable); ///< Throws for string references, just like ReadStatImportColumn::addValue
+
+	readstat_type_t		type;
+	bool				missing,
+						systemMissing;
+	double				number	= 0;	///< Any of the int and float types fit in a double
+	std::string			text;			///< The string value, or what a user-defined missing value was
+};
+
 ///
 /// Stores relevant information for a column being imported through ReadStat.
 /// Tries to stay true to the datatypes as defined in the sourcefile
@@ -25,6 +39,7 @@ public:
 	const std::string &			labelsID()								const				{ return  _labelsID;	}
 
 	void						addValue(const readstat_value_t & val);
+	void						addValue(const ReadStatImportValue & val);
 	void						addValue(const double			& val);
 	void						addValue(const int				& val);
 	void						addValue(const std::string		& val);
@@ -41,6 +56,7 @@ public:
 	static double						missingValueDouble()		{ return NAN; }
 	static std::string					missingValueString();
 
+	void						reserve(size_t rows);
 	void						addMissingValue();
 	void						addLeadingMissingValues();
 	void						setType(columnType newType);
@@ -65,7 +81,8 @@ private:
 	std::vector<int>			_ints;
 	std::vector<double>			_doubles;
 	std::vector<std::string>	_strings;
-	size_t						_leadingMissingValues = 0;
+	size_t						_leadingMissingValues	= 0,
+								_reserveRows			= 0;
 
 	std::map<int,			std::string>	_intLabels;
 	std::map<std::string,	std::string>	_strLabels;
@@ -19,6 +19,18 @@
 #include "log.h"
 #include "utils.h"
 #include "columnutils.h"
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <set>
+#include <thread>
+#include <stdexcept>
+#include <utility>
+
+#ifdef WIN32
+#include "readstat_custom_io.h"
+#endif
 
 bool operator<(const readstat_value_t & l, const readstat_value_t & r)
 {
@@ -70,21 +82,22 @@ const std::string &	ReadStatImportDataSet::getLabel(const std::string & labelsID
 
 void ReadStatImportDataSet::addColumn(int index, ReadStatImportColumn * col)
 {
+	if(size_t(index) >= _cols.size())
+		_cols.resize(index + 1, nullptr);
+
 	_cols[index] = col;
 	ImportDataSet::addColumn(col);
-}
 
-ReadStatImportColumn * ReadStatImportDataSet::column(int index)
-{
-	if(_cols.count(index) > 0)	return _cols[index];
-	else						return nullptr;
+	if(_expectedRows > 0)
+		col->reserve(_expectedRows);
 }
 
 void ReadStatImportDataSet::setLabelsToColumns()
 {
-	for(auto & colKeyVal : _cols)
+	for(ReadStatImportColumn * col : _cols)
 	{
-		ReadStatImportColumn * col = colKeyVal.second;
+		if(!col)
+			continue;
 		
 		//Log::log() << "Setting labels for column " << col->name() << std::endl;		
 
@@ -156,5 +169,370 @@ void ReadStatImportDataSet::setCurrentRow(int row)
 
 	_currentRow = row;
 
-	_progressCallback(int(float(_currentRow) / float(_expectedRows) * 100.0));
+	if(_expectedRows <= 0) return;
+
+	//This is called for every row, so only bother the callback (and through it the UI) when the percentage actually changes
+	int progress = int(float(_currentRow) / float(_expectedRows) * 100.0);
+
+	if(progress != _lastProgress)
+		_progressCallback(_lastProgress = progress);
+}
+
+///The handlers are called from readstat's C code, which an exception (like LoadCancelled from the progressCallback) must not unwind through.
+///So whatever a handler throws is kept and readstat is told to stop, parse rethrows it once readstat returned and was cleaned up.
+template<typename HANDLER>
+static int guarded(void * ctx, HANDLER handler)
+{
+	try
+	{
+		handler(static_cast<ReadStatImportDataSet*>(ctx));
+		return READSTAT_HANDLER_OK;
+	}
+	catch(...)
+	{
+		static_cast<ReadStatImportDataSet*>(ctx)->abortParse(std::current_exception());
+		return READSTAT_HANDLER_ABORT;
+	}
+}
+
+static int handle_metadata(readstat_metadata_t *metadata, void *ctx)
+{
+	return guarded(ctx, [&](ReadStatImportDataSet * data)
+	{
+		data->setVariableCount(readstat_get_var_count(metadata));
+		data->setExpectedRows(readstat_get_row_count(metadata));
+	});
+}
+
+static int handle_variable(int, readstat_variable_t *variable, const char *val_labels, void *ctx)
+{
+	return guarded(ctx, [&](ReadStatImportDataSet * data)
+	{
+		int 					var_index		= readstat_variable_get_index(variable);
+		std::string				name			= readstat_variable_get_name(variable),
+								labelsID		= val_labels != NULL ? val_labels : "";
+		readstat_measure_t		colMeasure		= readstat_variable_get_measure(variable);
+		columnType				colType;
+
+		switch(colMeasure)
+		{
+		case READSTAT_MEASURE_UNKNOWN:	colType = columnType::unknown;	break;
+		case READSTAT_MEASURE_NOMINAL:	colType = columnType::nominal;	break;
+		case READSTAT_MEASURE_ORDINAL:	colType = columnType::ordinal;	break;
+		case READSTAT_MEASURE_SCALE:	colType = columnType::scale;	break;
+		}
+
+		data->addColumn(var_index, new ReadStatImportColumn(variable, data, name, labelsID, colType));
+	});
+}
+
+static int handle_value(int , readstat_variable_t *variable, readstat_value_t value, void *ctx)
+{
+	return guarded(ctx, [&](ReadStatImportDataSet * data)
+	{
+		int						var_index		= readstat_variable_get_index(variable);
+		ReadStatImportColumn  *	col				= data->column(var_index);
+
+		if(var_index == 0) data->incrementRow(); //Reports progress, which throws when the user cancels
+
+		col->addValue(value);
+	});
+}
+
+static int handle_value_label(const char *val_labels, readstat_value_t value, const char *label, void *ctx)
+{
+	return guarded(ctx, [&](ReadStatImportDataSet * data)
+	{
+		data->addLabelKeyValue(val_labels, value, label);
+	});
+}
+
+///Stops the dictionary parse of _parseRowRanges at the first value, the rows are read by the parsers of the row ranges
+static int handle_first_value(int, readstat_variable_t *, readstat_value_t, void *)
+{
+	return READSTAT_HANDLER_ABORT;
+}
+
+///The rows one parser reads on its own thread in _parseRowRanges, kept per column until they are added to the columns in order
+struct RowRange
+{
+	ReadStatImportDataSet							*	data		= nullptr;
+	long												offset		= 0,
+														limit		= 0;	///< 0 means up to and including the last row
+	std::vector<std::vector<ReadStatImportValue>>		columns;
+	std::atomic<int>								*	rowsParsed	= nullptr;
+	const std::atomic<bool>							*	stop		= nullptr;
+	readstat_error_t									error		= READSTAT_OK;
+	std::exception_ptr									exception;
+};
+
+///Like guarded, but for the handlers of a RowRange, which also stop when the parse was cancelled on another thread
+template<typename HANDLER>
+static int guardedRange(void * ctx, HANDLER handler)
+{
+	RowRange * range = static_cast<RowRange*>(ctx);
+
+	if(*range->stop)
+		return READSTAT_HANDLER_ABORT;
+
+	try
+	{
+		handler(range);
+		return READSTAT_HANDLER_OK;
+	}
+	catch(...)
+	{
+		range->exception = std::current_exception();
+		return READSTAT_HANDLER_ABORT;
+	}
+}
+
+static int handle_range_value(int, readstat_variable_t *variable, readstat_value_t value, void *ctx)
+{
+	return guardedRange(ctx, [&](RowRange * range)
+	{
+		size_t var_index = readstat_variable_get_index(variable);
+
+		if(var_index >= range->columns.size())
+			range->columns.resize(var_index + 1);
+
+		if(var_index == 0)
+			(*range->rowsParsed)++;
+
+		range->columns[var_index].emplace_back(value, variable);
+	});
+}
+
+///Only the range that reads up to the last row gets this, so the labels are added once even though every parser reads the dictionary
+static int handle_range_value_label(const char *val_labels, readstat_value_t value, const char *label, void *ctx)
+{
+	return guardedRange(ctx, [&](RowRange * range)
+	{
+		range->data->addLabelKeyValue(val_labels, value, label);
+	});
+}
+
+///Frees a readstat parser, and on Windows the io context JASP gave it, however the parse ended
+struct ReadStatParserDeleter
+{
+	void operator()(readstat_parser_t * parser) const
+	{
+#ifdef WIN32
+		io_cleanup(parser);
+#endif
+		readstat_parser_free(parser);
+	}
+};
+
+typedef std::unique_ptr<readstat_parser_t, ReadStatParserDeleter> ReadStatParserPtr;
+
+static ReadStatParserPtr newParser()
+{
+	ReadStatParserPtr parser(readstat_parser_init());
+
+#ifdef WIN32
+	init_io_handlers(parser.get());
+#endif
+
+	return parser;
+}
+
+static readstat_error_t parseFile(readstat_parser_t * parser, const std::string & ext, const std::string & locator, void * ctx)
+{
+	if		(ext == "sav")			return readstat_parse_sav(		parser, locator.c_str(), ctx);
+	else if	(ext == "zsav")			return readstat_parse_sav(		parser, locator.c_str(), ctx);
+	else if	(ext == "dta")			return readstat_parse_dta(		parser, locator.c_str(), ctx);
+	else if	(ext == "por")			return readstat_parse_por(		parser, locator.c_str(), ctx);
+	else if	(ext == "sas7bdat")		return readstat_parse_sas7bdat(	parser, locator.c_str(), ctx);
+	else if	(ext == "sas7bcat")		return readstat_parse_sas7bcat(	parser, locator.c_str(), ctx);
+	else if	(ext == "xpt")			return readstat_parse_xport(	parser, locator.c_str(), ctx);
+
+	throw std::runtime_error("JASP does not support extension " + ext);
+}
+
+///The formats whose readstat parser honours readstat_set_row_offset, a catalog (sas7bcat) has no rows to split
+static bool parsesRowRanges(const std::string & ext)
+{
+	static const std::set<std::string> exts({"sav", "zsav", "dta", "sas7bdat"});
+	return exts.count(ext) > 0;
+}
+
+///Fewer rows than this are not worth another parser reading the dictionary and skipping to its offset
+static const long minRowsPerRange = 1024;
+
+readstat_error_t ReadStatImportDataSet::parse(const std::string & ext, const std::string & locator, size_t threads)
+{
+	threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+
+	if(threads > 1 && parsesRowRanges(ext))
+		return _parseRowRanges(ext, locator, threads);
+
+	readstat_error_t	error;
+	ReadStatParserPtr	parser	= newParser();
+
+	//typedef int (*readstat_note_handler)(int note_index, const char *note, void *ctx); //Could be nice to have the notes from whatever file in JASP? Although I am not sure where we would show the data.
+
+	Log::log() << "Setting up readstat handlers" << std::endl;
+
+	readstat_set_metadata_handler(		parser.get(), &handle_metadata		);
+	readstat_set_variable_handler(		parser.get(), &handle_variable		);
+	readstat_set_value_handler(			parser.get(), &handle_value			);
+	readstat_set_value_label_handler(	parser.get(), &handle_value_label	);
+
+	error = parseFile(parser.get(), ext, locator, this);
+
+	Log::log() << "Done parsing file, freeing readstat structs" << std::endl;
+	parser.reset();
+
+	if(_handlerException)
+		std::rethrow_exception(std::exchange(_handlerException, nullptr));
+
+	return error;
+}
+
+///First a parser reads only the dictionary, stopping at the first value, so the columns exist and the number of rows is known.
+///Then every thread parses its own range of rows with its own parser into buffers reserved for that range.
+///Afterwards the buffers are added to the columns in row order, so the columns end up exactly as they would after a single parse.
+readstat_error_t ReadStatImportDataSet::_parseRowRanges(const std::string & ext, const std::string & locator, size_t threads)
+{
+	readstat_error_t	error;
+	ReadStatParserPtr	dictionary	= newParser();
+
+	readstat_set_metadata_handler(		dictionary.get(), &handle_metadata		);
+	readstat_set_variable_handler(		dictionary.get(), &handle_variable		);
+	readstat_set_value_handler(			dictionary.get(), &handle_first_value	);
+
+	error = parseFile(dictionary.get(), ext, locator, this);
+	dictionary.reset();
+
+	if(_handlerException)
+		std::rethrow_exception(std::exchange(_handlerException, nullptr));
+
+	if(error != READSTAT_OK && error != READSTAT_ERROR_USER_ABORT)
+		return error;
+
+	//Without a row count from the metadata a single range reads whatever rows there are
+	const long				rows		= _expectedRows;
+	const size_t			rangeCount	= std::max<size_t>(1, rows > 0 ? std::min<size_t>(threads, (rows + minRowsPerRange - 1) / minRowsPerRange) : 1);
+	std::vector<RowRange>	ranges(rangeCount);
+	std::atomic<int>		rowsParsed(0);
+	std::atomic<bool>		stop(false);
+
+	Log::log() << "Parsing " << rows << " rows in " << rangeCount << " ranges" << std::endl;
+
+	for(size_t r=0; r<rangeCount; r++)
+	{
+		ranges[r].data			= this;
+		ranges[r].offset		= rows * r / long(rangeCount);
+		ranges[r].limit			= r + 1 < rangeCount ? rows * (r + 1) / long(rangeCount) - ranges[r].offset : 0;
+		ranges[r].rowsParsed	= &rowsParsed;
+		ranges[r].stop			= &stop;
+		ranges[r].columns.resize(_cols.size());
+	}
+
+	std::vector<std::future<void>> parsing;
+
+	for(size_t r=0; r<rangeCount; r++)
+		parsing.push_back(std::async(std::launch::async, [&, r]()
+		{
+			RowRange			&	range	= ranges[r];
+			ReadStatParserPtr		parser	= newParser();
+
+			for(auto & column : range.columns)
+				column.reserve(range.limit ? range.limit : std::max(0L, rows - range.offset));
+
+			readstat_set_value_handler(parser.get(), &handle_range_value);
+
+			if(r + 1 == rangeCount)
+				readstat_set_value_label_handler(parser.get(), &handle_range_value_label);
+
+			readstat_set_row_offset(parser.get(), range.offset);
+			readstat_set_row_limit(	parser.get(), range.limit);
+
+			range.error = parseFile(parser.get(), ext, locator, &range);
+		}));
+
+	try
+	{
+		for(auto & parse : parsing)
+			while(parse.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
+				setCurrentRow(rowsParsed); //Reports progress, which throws when the user cancels
+	}
+	catch(...)
+	{
+		stop = true;
+
+		for(auto & parse : parsing)
+			parse.wait();
+
+		throw;
+	}
+
+	for(auto & parse : parsing)
+		parse.get();
+
+	for(RowRange & range : ranges)
+		if(range.exception)
+			std::rethrow_exception(range.exception);
+
+	for(RowRange & range : ranges)
+		if(range.error != READSTAT_OK)
+			return range.error;
+
+	setCurrentRow(rowsParsed);
+
+	for(size_t c=0; c<_cols.size(); c++)
+	{
+		ReadStatImportColumn * col = _cols[c];
+
+		if(!col)
+			continue;
+
+		for(RowRange & range : ranges)
+			if(c < range.columns.size())
+			{
+				for(const ReadStatImportValue & value : range.columns[c])
+					col->addValue(value);
+
+				std::vector<ReadStatImportValue>().swap(range.columns[c]); //Added, so let go of the copy
+			}
+	}
+
+	return READSTAT_OK;
+}
+
+///Checking whether a nominalText column can be nominal means parsing each of its strings and the columns are independent, so do the checking on several threads.
+void ReadStatImportDataSet::tryNominalMinusText(size_t threads)
+{
+	std::vector<ReadStatImportColumn*> textCols;
+
+	for(ReadStatImportColumn * col : _cols)
+		if(col && col->getColumnType() == columnType::nominalText)
+			textCols.push_back(col);
+
+	if(textCols.size() == 0)
+		return;
+
+	threads = std::min<size_t>(textCols.size(), threads ? threads : std::max(1u, std::thread::hardware_concurrency()));
+
+	std::vector<char>	convertible(textCols.size(), false);
+	std::vector<std::future<void>>	checks;
+
+	for(size_t t=0; t<threads; t++)
+		checks.push_back(std::async(std::launch::async, [&, t]()
+		{
+			for(size_t c=t; c<textCols.size(); c+=threads)
+				convertible[c] = textCols[c]->canConvertToType(columnType::nominal);
+		}));
+
+	for(auto & check : checks)
+		check.get();
+
+	//setType logs, so that stays on this thread
+	for(size_t c=0; c<textCols.size(); c++)
+		if(convertible[c])
+		{
+			Log::log() << "Converting column '" << textCols[c]->name() << "' from nominalText to nominal because all values can be converted to int without losing information." << std::endl;
+			textCols[c]->setType(columnType::nominal);
+		}
 }
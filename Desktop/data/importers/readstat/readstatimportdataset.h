@@ -20,8 +20,9 @@
 
 #include <string>
 #include <map>
+#include <exception>
+#include <boost/function.hpp>
 #include "../importdataset.h"
-#include "../readstatimporter.h"
 #include "readstatimportcolumn.h"
 
 //needed for the key of the submap in ReadStatImportDataSet::labelsMapT (otherwise it just compares the pointer probably)
@@ -35,7 +36,7 @@ class ReadStatImportDataSet : public ImportDataSet
 	typedef std::pair<readstat_type_t, std::string>							keyTypeAndLabelT;
 	typedef std::map<std::string, std::map<std::string, keyTypeAndLabelT>>	labelsMapT;
 public:
-				ReadStatImportDataSet(ReadStatImporter * importer, boost::function<void(int)>	progressCallback)
+				ReadStatImportDataSet(Importer * importer, boost::function<void(int)>	progressCallback)
 					: ImportDataSet(importer), _progressCallback(progressCallback) {}
 
 				~ReadStatImportDataSet()					override;
@@ -48,20 +49,29 @@ public:
 	void						setLabelsToColumns();
 
 	void						addColumn(int index, ReadStatImportColumn * col); //Calls hidden virtual function addColumn(ImportColumn*)
-	ReadStatImportColumn	*	column(int index);
-	ReadStatImportColumn	*	operator[](int index) { return column(index); };
+	ReadStatImportColumn	*	column(int index)			{ return index >= 0 && size_t(index) < _cols.size() ? _cols[index] : nullptr; } ///< Called for every value, so a plain vector instead of a map
+	ReadStatImportColumn	*	operator[](int index)		{ return column(index); };
 
 	void						setExpectedRows(int rows)	{ _expectedRows = rows; }
+	int							expectedRows()		const	{ return _expectedRows; }
 	void						setCurrentRow(int row);
 	void						incrementRow()				{ setCurrentRow(_currentRow + 1); }
 
+	readstat_error_t			parse(const std::string & ext, const std::string & locator, size_t threads = 0); ///< Runs readstat over the file with this as the context of the handlers, throws if JASP does not support ext or rethrows what a handler threw. Formats readstat can start at a row offset are parsed in row ranges on `threads` threads, 0 means as many as the hardware has
+	void						abortParse(std::exception_ptr exception)	{ _handlerException = exception; } ///< Exceptions cannot pass through readstat, so a handler keeps it here and tells readstat to stop
+	void						tryNominalMinusText(size_t threads = 0); ///< 0 means as many as the hardware has
+
 private:
+	readstat_error_t			_parseRowRanges(const std::string & ext, const std::string & locator, size_t threads);
+
 	labelsMapT								_labelMap;
 	int										_var_count			= 0;
-	std::map<int,ReadStatImportColumn*>		_cols;
+	std::vector<ReadStatImportColumn*>		_cols;
 	int										_expectedRows		= 0,
-											_currentRow			= 0;
+											_currentRow			= 0,
+											_lastProgress		= -1;
 	boost::function<void(int)>				_progressCallback;
+	std::exception_ptr						_handlerException;
 };
 
 #endif // ReadStatImportDataSet_H
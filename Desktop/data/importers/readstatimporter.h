@@ -22,6 +22,7 @@ public:
 
 	static bool extSupported(const std::string & ext);
 	void initColumn(QVariant colId, ImportColumn * importColumn) override;
+	bool decodesColumnsInParallel() const override { return false; } ///< Columns were already decoded in loadFile
 
 protected:
 	ImportDataSet *	loadFile(const std::string &locator, boost::function<void(int)> progressCallback)	override;
@@ -0,0 +1,140 @@
+#include "enginememorygovernor.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+const size_t	EngineMemoryGovernor::MB					= 1024 * 1024;
+const long		EngineMemoryGovernor::_cleanCooldownMs		= 30000,	///< Don't ask the same engine to clean up more often than this
+				EngineMemoryGovernor::_restartCooldownMs	= 60000,	///< Restart at most one engine per this long, otherwise we might restart all of them before the first one has shown what it helped
+				EngineMemoryGovernor::_settleMs				= 5000;		///< How long a cleaned engine gets to show it helped before restarting it is considered
+const size_t	EngineMemoryGovernor::_freshEngine			= 300 * MB;	///< Roughly what an engine uses right after starting, restarting one that isn't much bigger doesn't help
+
+///Reads a "Name:   1234 kB" line from files like /proc/meminfo
+static size_t procKiloBytes(const std::string & path, const std::string & name)
+{
+#ifdef __linux__
+	std::ifstream	file(path);
+	std::string		line;
+
+	while(std::getline(file, line))
+		if(line.compare(0, name.size(), name) == 0)
+		{
+			std::istringstream	numbers(line.substr(name.size()));
+			size_t				kiloBytes = 0;
+
+			numbers >> kiloBytes;
+			return kiloBytes * 1024;
+		}
+#endif
+	return 0;
+}
+
+size_t ProcMemorySource::residentBytes(long pid)	{ return pid <= 0 ? 0 : procKiloBytes("/proc/" + std::to_string(pid) + "/status", "VmRSS:"); }
+size_t ProcMemorySource::availableBytes()			{ return procKiloBytes("/proc/meminfo", "MemAvailable:");	}
+size_t ProcMemorySource::totalBytes()				{ return procKiloBytes("/proc/meminfo", "MemTotal:");		}
+
+EngineMemoryGovernor::EngineMemoryGovernor(EngineMemorySource * source)
+	: _source(source ? source : new ProcMemorySource())
+{}
+
+size_t EngineMemoryGovernor::budget() const
+{
+	return _budget ? _budget : _total / 2;
+}
+
+///Below this the machine is about to start swapping
+size_t EngineMemoryGovernor::lowMemory() const
+{
+	return std::max(256 * MB, _total / 10);
+}
+
+///A new engine will probably grow to at least the size of the smallest one running now
+size_t EngineMemoryGovernor::expectedEngineSize() const
+{
+	return _smallestEngine ? std::min(_smallestEngine, _freshEngine) : _freshEngine;
+}
+
+bool EngineMemoryGovernor::underPressure() const
+{
+	bool	overBudget	= budget()	> 0 && _enginesResident > budget(),
+			machineLow	= _total	> 0 && _available < lowMemory();
+
+	return overBudget || machineLow;
+}
+
+void EngineMemoryGovernor::measure(std::vector<Sample> & engines)
+{
+	_total				= _source->totalBytes();
+	_available			= _source->availableBytes();
+	_enginesResident	= 0;
+	_smallestEngine		= 0;
+
+	for(Sample & engine : engines)
+	{
+		engine.resident		= _source->residentBytes(engine.pid);
+		_enginesResident	+= engine.resident;
+
+		if(engine.resident && (!_smallestEngine || engine.resident < _smallestEngine))
+			_smallestEngine = engine.resident;
+	}
+}
+
+std::vector<EngineMemoryGovernor::Advice> EngineMemoryGovernor::advise(const std::vector<Sample> & engines, long nowMs)
+{
+	std::vector<Advice> advice;
+
+	for(auto cleaned = _cleaned.begin(); cleaned != _cleaned.end();)
+		if(std::none_of(engines.begin(), engines.end(), [&](const Sample & engine) { return engine.pid == cleaned->first; }))
+			cleaned = _cleaned.erase(cleaned);
+		else
+			cleaned++;
+
+	if(!underPressure())
+		return advice;
+
+	std::vector<const Sample *> idles;
+
+	for(const Sample & engine : engines)
+		if(engine.idle && engine.resident > 0)
+			idles.push_back(&engine);
+
+	std::sort(idles.begin(), idles.end(), [](const Sample * l, const Sample * r) { return l->resident > r->resident; }); //Biggest first, that is where there is most to win
+
+	const Sample * restartMe = nullptr;
+
+	for(const Sample * engine : idles)
+	{
+		Cleaned & cleaned = _cleaned[engine->pid];
+
+		if(cleaned.at == -1 || cleaned.at + _cleanCooldownMs < nowMs)
+		{
+			advice.push_back({ engine->channel, action::cleanMemory });
+			cleaned.at			= nowMs;
+			cleaned.resident	= engine->resident;
+		}
+		else if(!restartMe && cleaned.at + _settleMs < nowMs && engine->resident > 2 * _freshEngine)
+			restartMe = engine; //It was cleaned, we are still under pressure and a fresh engine would be much smaller
+	}
+
+	if(restartMe && (_lastRestart == -1 || _lastRestart + _restartCooldownMs < nowMs))
+	{
+		advice.push_back({ restartMe->channel, action::restart });
+		_lastRestart = nowMs;
+		_cleaned.erase(restartMe->pid);
+	}
+
+	return advice;
+}
+
+bool EngineMemoryGovernor::mayStartEngine(size_t runningEngines) const
+{
+	if(runningEngines == 0)
+		return true; //Without any engine nothing gets done at all
+
+	size_t	expected	= expectedEngineSize();
+	bool	inBudget	= budget()	== 0 || _enginesResident + expected <= budget(),
+			machineOk	= _total	== 0 || _available >= lowMemory() + expected;
+
+	return inBudget && machineOk;
+}
@@ -0,0 +1,93 @@
+#ifndef ENGINEMEMORYGOVERNOR_H
+#define ENGINEMEMORYGOVERNOR_H
+
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstddef>
+
+///
+/// Where EngineMemoryGovernor gets its numbers from, 0 means "don't know".
+/// The default reads /proc on Linux, tests can pass a fake one.
+class EngineMemorySource
+{
+public:
+	virtual			~EngineMemorySource() {}
+
+	virtual size_t	residentBytes(long pid)	= 0;	///< How much of the memory of the machine the process is actually using
+	virtual size_t	availableBytes()		= 0;	///< How much the machine could still give out without swapping
+	virtual size_t	totalBytes()			= 0;
+};
+
+class ProcMemorySource : public EngineMemorySource
+{
+public:
+	size_t	residentBytes(long pid)	override;
+	size_t	availableBytes()		override;
+	size_t	totalBytes()			override;
+};
+
+///
+/// Keeps an eye on how much memory the engines use together and what is left on the machine, see EngineSync::governMemory().
+/// When the engines go over the budget, or the machine runs low, idle engines are first asked to clean up their memory.
+/// If that doesn't help enough the biggest idle one is restarted, busy engines are left alone.
+/// It also tells EngineSync whether there is room to start another engine.
+class EngineMemoryGovernor
+{
+public:
+	struct Sample
+	{
+		size_t	channel		= 0;
+		long	pid			= 0;
+		bool	idle		= false;
+		size_t	resident	= 0;	///< Filled in by measure()
+	};
+
+	enum class action { cleanMemory, restart };
+
+	struct Advice
+	{
+		size_t	channel;
+		action	what;
+	};
+
+	EngineMemoryGovernor(EngineMemorySource * source = nullptr); ///< Takes ownership of source, by default a ProcMemorySource
+
+	void				setBudget(size_t bytes)			{ _budget = bytes; }	///< 0 means half of the memory of the machine
+	size_t				budget()				const;
+	bool				underPressure()			const;
+	size_t				enginesResident()		const	{ return _enginesResident;	}
+	size_t				available()				const	{ return _available;		}
+
+	void				measure(std::vector<Sample> & engines);
+	std::vector<Advice>	advise(const std::vector<Sample> & engines, long nowMs);
+	bool				mayStartEngine(size_t runningEngines)	const;
+
+	static const size_t	MB;
+
+private:
+	size_t				lowMemory()				const;
+	size_t				expectedEngineSize()	const;
+
+	struct Cleaned
+	{
+		long	at			= -1;
+		size_t	resident	= 0;
+	};
+
+	std::unique_ptr<EngineMemorySource>	_source;
+	size_t								_budget				= 0,
+										_total				= 0,
+										_available			= 0,
+										_enginesResident	= 0,
+										_smallestEngine		= 0;
+	long								_lastRestart		= -1;
+	std::map<long, Cleaned>				_cleaned;			///< Per pid, when it was last asked to clean up and how big it was then. Forgotten when the pid is gone
+
+	static const long					_cleanCooldownMs,
+										_restartCooldownMs,
+										_settleMs;
+	static const size_t					_freshEngine;
+};
+
+#endif // ENGINEMEMORYGOVERNOR_H
@@ -54,6 +54,8 @@ void EngineRepresentation::cleanUpAfterClose(bool forgetAnalyses)
 	_settingsChanged	= true;
 	_abortAndRestart	= false;
 	_lastCompColName	= "???";
+	_statesKept.clear(); //Closing cleans the memory of the engines and a restarted one keeps nothing
+	_statesHandingOver.clear();
 
 
 	if(_dynModName != "")
@@ -90,7 +92,7 @@ void EngineRepresentation::processFinished(int exitCode, QProcess::ExitStatus ex
 
 void EngineRepresentation::handleEngineCrash()
 {
-	Log::log() << "EngineRepresentation::handleEngineCrash():\n" << currentStateForDebug() << std::endl;
+	Log::error() << "EngineRepresentation::handleEngineCrash():\n" << currentStateForDebug() << std::endl;
 
 	switch(_engineState)
 	{
@@ -116,6 +118,8 @@ void EngineRepresentation::handleEngineCrash()
 		break;
 
 	case engineState::logCfg:
+	case engineState::cleanMemory:
+	case engineState::saveStates:
 		//So if the engine crashes on log config change request then we can still continue because it will also get the proper settings on startup.
 		//And if it is still broken then we will simply see a crash screen then...
 		break;
@@ -224,7 +228,8 @@ void EngineRepresentation::processReplies()
 		return;
 	}
 
-	_idleStartSecs = -1;
+	if(_engineState != engineState::cleanMemory) //Cleaning up doesn't make an engine any less bored
+		_idleStartSecs = -1;
 
 	std::string data;
 
@@ -273,6 +278,9 @@ void EngineRepresentation::processReplies()
 
 		engineState typeRequest = engineStateFromString(json.get("typeRequest", "analysis").asString());
 
+		if(typeRequest == engineState::analysis && _analysisInProgress)
+			emit analysisReplyReceived(_analysisInProgress, data.size());
+
 		if(_engineState == engineState::initializing)
 		{
 			Log::log() << "Engine #" << channelNumber() << " still initializing and got " + engineStateToString(typeRequest) << std::endl;
@@ -295,6 +303,8 @@ void EngineRepresentation::processReplies()
 			case engineState::logCfg:				processLogCfgReply();				break;
 			case engineState::settings:				processSettingsReply();				break;
 			case engineState::reloadData:			processReloadDataReply();			break;
+			case engineState::cleanMemory:			processCleanMemoryReply();			break;
+			case engineState::saveStates:			processSaveStatesReply();			break;
 			default:								throw std::logic_error("If you define new engineStates you should add them to the switch in EngineRepresentation::process()!");
 			}
 	}
@@ -431,12 +441,19 @@ void EngineRepresentation::processComputeColumnReply(Json::Value & json)
 	setState(engineState::idle);
 
 
-	std::string result		= json.get("result", "some string that is not 'TRUE' or 'FALSE'").asString();
-	std::string error		= json.get("error", "").asString();
-	std::string columnName	= json.get("columnName", "").asString();
+	std::string		result		= json.get("result", "some string that is not 'TRUE' or 'FALSE'").asString();
+	std::string		error		= json.get("error", "").asString();
+	std::string		columnName	= json.get("columnName", "").asString();
+	ColumnChanges	changes		= ColumnChanges::fromJson(json["changes"]);
+
+	if(result == "TRUE")
+		Log::log() << "Computed column '" << columnName << "' changed " << changes.rows.rows << " rows" << (changes.allRows ? "" : " in " + std::to_string(changes.rows.runs.size()) + " runs")
+				   << (changes.labels.size() ? ", " + std::to_string(changes.labels.size()) + " labels" : "") << (changes.type ? ", its type" : "") << "." << std::endl;
+	else if(result == "FALSE")
+		Log::log() << "Computed column '" << columnName << "' did not change, nothing that depends on it needs to be redone." << std::endl;
 
-	if(result == "TRUE")		emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), true);
-	else if(result == "FALSE")	emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), false);
+	if(result == "TRUE")		emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), changes);
+	else if(result == "FALSE")	emit computeColumnSucceeded(QString::fromStdString(columnName), QString::fromStdString(error), ColumnChanges());
 	else						emit computeColumnFailed(	QString::fromStdString(columnName), QString::fromStdString(error == "" ? "Unknown Error" : error));
 }
 
@@ -447,15 +464,20 @@ void EngineRepresentation::runAnalysisOnProcess(Analysis *analysis)
 #endif
 
 	setAnalysisInProgress(analysis);
+	_statesKept.insert(analysis->id());
 
 	Json::Value json(analysis->createAnalysisRequestJson());
+	addRemovedAnalysesToJson(json);
 
 #ifdef PRINT_ENGINE_MESSAGES
-	Log::log() << "sending: " << json.toStyledString() << std::endl;
+	if(Log::active()) Log::log() << "sending: " << json.toStyledString() << std::endl;
 #endif
 
-	channel()->send(json.toStyledString());
+	const std::string request = json.toStyledString();
 
+	channel()->send(request);
+
+	emit analysisRequestSent(analysis, int(channelNumber()), request.size());
 }
 
 void EngineRepresentation::analysisRemoved(Analysis * analysis)
@@ -465,7 +487,10 @@ void EngineRepresentation::analysisRemoved(Analysis * analysis)
 		_analysisAborted = nullptr;
 
 	if(_engineState != engineState::analysis || _analysisInProgress != analysis)
+	{
+		_removedAnalyses.insert(analysis->id());
 		return;
+	}
 
 	_idRemovedAnalysis = analysis->id();
 	abortAnalysisInProgress(false);
@@ -477,7 +502,7 @@ void EngineRepresentation::analysisRemoved(Analysis * analysis)
 void EngineRepresentation::processAnalysisReply(Json::Value & json)
 {
 #ifdef PRINT_ENGINE_MESSAGES
-	Log::log() << "Analysis reply: " << json.toStyledString() << std::endl;
+	if(Log::active()) Log::log() << "Analysis reply: " << json.toStyledString() << std::endl;
 #endif
 
 	if(_engineState == engineState::paused || _engineState == engineState::resuming || _engineState == engineState::idle)
@@ -510,6 +535,7 @@ void EngineRepresentation::processAnalysisReply(Json::Value & json)
 		case analysisResultStatus::fatalError:
 		case analysisResultStatus::validationError:
 			setState(engineState::idle);
+			_removedAnalyses.insert(_idRemovedAnalysis); //Only now, otherwise the aborted run might still store its state after the engine forgot it
 			_idRemovedAnalysis	= -1;
 
 			//If an analysis really was just removed we probably don't care about _analysisAborted
@@ -615,14 +641,19 @@ void EngineRepresentation::checkForComputedColumns(const Json::Value & results)
 
 		if(memberset.count("columnName") > 0 && memberset.count("columnType") > 0 && memberset.count("dataChanged") > 0)
 		{
-			Log::log() << "The analysis reply contained information on changed computed columns: " << results.toStyledString() << std::endl;
+			if(Log::active()) Log::log() << "The analysis reply contained information on changed computed columns: " << results.toStyledString() << std::endl;
 
 			//jaspColumnType	columnType	= jaspColumnTypeFromString(results["columnType"].asString()); This would work if jaspColumn wasn't defined in jaspColumn.h and Windows would not need to have that separately in a DLL... But it isn't really needed here anyway.
 			std::string		columnName	= results["columnName"].asString();
 			bool			dataChanged	= results["dataChanged"].asBool();
 			bool			typeChanged	= results["typeChanged"].asBool();
 
-			emit computeColumnSucceeded(tq(columnName), "", dataChanged);
+			//Which rows an analysis changed is not sent along, so the whole column is redrawn
+			ColumnChanges changes;
+			changes.allRows	= dataChanged;
+			changes.type	= typeChanged;
+
+			emit computeColumnSucceeded(tq(columnName), "", changes);
 
 			if(typeChanged)
 				emit columnDataTypeChanged(tq(columnName));
@@ -711,6 +742,7 @@ void EngineRepresentation::sendStopEngine()
 	Json::Value json		= Json::Value(Json::objectValue);
 	setState(engineState::stopRequested);
 	json["typeRequest"]		= engineStateToString(_engineState);
+	addRemovedAnalysesToJson(json); //Stopping writes the states, but not those another engine ran since
 
 	Log::log() << "informing engine #" << channelNumber() << " that it ought to stop" << std::endl;
 
@@ -784,6 +816,7 @@ void EngineRepresentation::sendPauseEngine()
 	setState(engineState::pauseRequested);
 	json["typeRequest"]		= engineStateToString(_engineState);
 	json["unloadData"]		= _pauseUnloadData;
+	addRemovedAnalysesToJson(json); //Pausing writes the states, but not those another engine ran since
 
 	Log::log() << "informing engine #" << channelNumber() << " that it ought to pause for a bit" << std::endl;
 
@@ -1031,6 +1064,89 @@ void EngineRepresentation::sendReloadData()
 	sendString(msg.toStyledString());
 }
 
+void EngineRepresentation::sendCleanMemory()
+{
+	Log::log() << "EngineRepresentation::sendCleanMemory()" << std::endl;
+
+	if(_engineState != engineState::idle)
+		throw std::runtime_error("EngineRepresentation::sendCleanMemory() expects to be run from an idle engine.");
+
+	setState(engineState::cleanMemory);
+	Json::Value msg			= Json::objectValue;
+	msg["typeRequest"]		= engineStateToString(_engineState);
+	addRemovedAnalysesToJson(msg);
+	_statesKept.clear(); //Cleaning writes them all and drops them
+
+	sendString(msg.toStyledString());
+}
+
+void EngineRepresentation::sendSaveStates(bool all, const std::set<int> & analyses, bool handOver)
+{
+	if(_engineState != engineState::idle)
+		throw std::runtime_error("EngineRepresentation::sendSaveStates() expects to be run from an idle engine.");
+
+	setState(engineState::saveStates);
+	Json::Value msg			= Json::objectValue;
+	msg["typeRequest"]		= engineStateToString(_engineState);
+	msg["all"]				= all;
+	msg["handOver"]			= handOver;
+	addRemovedAnalysesToJson(msg);
+
+	Json::Value ids = Json::arrayValue;
+	for(int id : analyses)
+	{
+		ids.append(id);
+
+		if(handOver)
+		{
+			_statesKept.erase(id);
+			_statesHandingOver.insert(id);
+		}
+	}
+
+	msg["analyses"] = ids;
+
+	sendString(msg.toStyledString());
+}
+
+bool EngineRepresentation::handOverState(int id)
+{
+	if(_statesHandingOver.count(id))
+		return true;
+
+	if(!keepsStateOf(id))
+		return false;
+
+	if(idle())
+	{
+		sendSaveStates(false, { id }, true);
+		return true;
+	}
+
+	//It is busy, paused or stopped, the last two already wrote it and while busy it might be long. Its file might then be older, but jaspBase only reuses what the options still match.
+	_statesKept.erase(id);
+	_removedAnalyses.insert(id);
+
+	return false;
+}
+
+void EngineRepresentation::addRemovedAnalysesToJson(Json::Value & msg)
+{
+	if(_removedAnalyses.empty())
+		return;
+
+	Json::Value removed = Json::arrayValue;
+	for(int id : _removedAnalyses)
+		removed.append(id);
+
+	msg["removedAnalyses"] = removed;
+
+	for(int id : _removedAnalyses)
+		_statesKept.erase(id);
+
+	_removedAnalyses.clear();
+}
+
 void EngineRepresentation::addSettingsToJson(Json::Value & msg)
 {
 	msg["ppi"]					=	 PreferencesModel::prefs()->plotPPI();
@@ -1083,6 +1199,8 @@ bool EngineRepresentation::idleSoon() const
 	case engineState::logCfg:
 	case engineState::moduleLoadRequest:
 	case engineState::reloadData:
+	case engineState::cleanMemory:
+	case engineState::saveStates:
 	case engineState::idle:
 		return true;
 	
@@ -11,6 +11,7 @@
 #include "ipcchannel.h"
 #include "data/datasetpackage.h"
 #include <queue>
+#include <set>
 #include "enginedefinitions.h"
 #include "rscriptstore.h"
 #include "modules/dynamicmodules.h"
@@ -47,11 +48,18 @@ public:
 	void			runScriptOnProcess(const QString & rCmdCode);
 	void			runScriptOnProcess(RComputeColumnStore * computeColumnStore);
 	void			runAnalysisOnProcess(Analysis *analysis);
+	void			abortAnalysisInProgress(bool restartAfterwards);
 	void			runModuleInstallRequestOnProcess(Json::Value request);
 	void			runModuleLoadRequestOnProcess(Json::Value request);
 	void			sendLogCfg();
 	void			sendSettings();
 	void			sendReloadData();
+	void			sendCleanMemory();
+	///Asks the engine to write all the states it keeps in memory to their files or only those of analyses. When handing them over to another engine it also forgets them.
+	///Either way it first forgets the states it was told to, which is all that happens when nothing needs to be written.
+	void			sendSaveStates(bool all, const std::set<int> & analyses = {}, bool handOver = false);
+	///Another engine is going to run analysis id, returns true if this one will first write its state and should be waited for.
+	bool			handOverState(int id);
 
 	///Kills engine outright by killing process
 	void 			killEngine();
@@ -92,11 +100,15 @@ public:
 	bool			busyWithData()			const;
 	bool			needsReloadData()		const { return idle() && _reloadData; }
 	bool			moduleLoaded()			const { return _moduleLoaded; }
+	bool			keepsStates()			const { return _statesKept.size() > 0; }
+	bool			keepsStateOf(int id)	const { return _statesKept.count(id) > 0; }
+	bool			shouldForgetStates()	const { return idle() && _removedAnalyses.size() > 0; }
 
 	///How many seconds has this engine been idle?
 	int				idleFor() const;
 
 	bool			jaspEngineStillRunning() { return  _slaveProcess != nullptr && !killed() && !stopped(); }
+	long			processId()				const { return _slaveProcess ? long(_slaveProcess->processId()) : 0; }
 
 	void			processReplies();
 	void			restartAbortedAnalysis();
@@ -123,6 +135,8 @@ protected:
 	void			processComputeColumnReply(	Json::Value & json);
 	void			processModuleRequestReply(	Json::Value & json);
 	void			processReloadDataReply()							{ _reloadData = false; setState(engineState::idle); }
+	void			processCleanMemoryReply()							{ setState(engineState::idle); }
+	void			processSaveStatesReply()							{ _statesHandingOver.clear(); setState(engineState::idle); }
 	void			processEnginePausedReply();
 	void			processEngineStoppedReply();
 	void			processEngineResumedReply();
@@ -152,7 +166,7 @@ signals:
 	void			rCodeReturned(					const QString & result, int requestId, bool hasError	);
 	void			rCodeReturnedLog(				const QString & log, bool hasError						);
 
-	void			computeColumnSucceeded(			const QString & columnName, const QString & warning, bool dataChanged);
+	void			computeColumnSucceeded(			const QString & columnName, const QString & warning, const ColumnChanges & changes);
 	void			computeColumnFailed(			const QString & columnName, const QString & error);
 	void			columnDataTypeChanged(			const QString & columnName);
 
@@ -170,6 +184,8 @@ signals:
 	void			stopModuleEngine(				QString moduleName);
 	void			stopAndDestroyEngine(			EngineRepresentation * e);
 	void			plotEditorRefresh();
+	void			analysisRequestSent(			Analysis * analysis, int channelNumber, size_t bytes);
+	void			analysisReplyReceived(			Analysis * analysis, size_t bytes);
 	void			runsAnalysisChanged(	bool runsAnalysis);
 	void			runsUtilityChanged(	bool runsUtility);
 	void			runsRCmdChanged(		bool runsRCmd);
@@ -190,8 +206,8 @@ private:
 	void			setSlaveProcess(QProcess * slaveProcess);
 	void			checkForComputedColumns(const Json::Value & results);
 	void			handleEngineCrash();
-	void			abortAnalysisInProgress(bool restartAfterwards);
 	void			addSettingsToJson(Json::Value & msg);
+	void			addRemovedAnalysesToJson(Json::Value & msg);
 
 	IPCChannel	*	channel() { return emit channelSignal(_channelNumber); }
 
@@ -223,6 +239,9 @@ private:
 	std::string		_lastCompColName	= "???",
 					_dynModName			= "",		///<If filled: refers to the particular dynamic module this engine was meant for.
 					_requestModName		= "";		///<To keep track of which engine is handling a request for a module
+	std::set<int>	_removedAnalyses,				///<Removed analyses, or ones another engine ran since, whose state the engine might still keep in memory. Sent along with the next request that could use or write it.
+					_statesKept,					///<Analyses this engine ran, whose state it might keep in memory without having written it to its file yet
+					_statesHandingOver;				///<Analyses whose state the engine is writing for another engine, which should wait for that
 
 	QMetaObject::Connection	_slaveFinishedConnection,
 							_analysisInProgressStatusConnection;
@@ -34,6 +34,7 @@
 #include "utilities/qutils.h"
 #include "utils.h"
 #include "tempfiles.h"
+#include "utilities/imagecache.h"
 #include "timers.h"
 #include "gui/preferencesmodel.h"
 #include "utilities/appdirs.h"
@@ -72,6 +73,9 @@ EngineSync::EngineSync(QObject *parent)
 	connect(PreferencesModel::prefs(),	&PreferencesModel::exactPValuesChanged,				this,						&EngineSync::settingsChanged					);
 	connect(PreferencesModel::prefs(),	&PreferencesModel::normalizedNotationChanged,		this,						&EngineSync::settingsChanged					);
 
+	connect(PreferencesModel::prefs(),	&PreferencesModel::engineMemoryBudgetChanged,		this,						&EngineSync::engineMemoryBudgetChanged			);
+	connect(PreferencesModel::prefs(),	&PreferencesModel::preemptBackgroundRunsChanged,	this,						&EngineSync::preemptBackgroundRunsChanged		);
+
 	// delay start so as not to increase program start up time 10sec is better than 100ms, because they are orphaned anyway
 	// Except, that it might somehow cause a crash? If the timer goes off while waiting for a download from OSF than it might remove the files while making them..
 	// So lets put it on 500ms...
@@ -92,6 +96,7 @@ EngineSync::~EngineSync()
 			engine->killEngine();
 
 	_moduleEngines.clear();
+	_extraModuleEngines.clear();
 	_engines.clear();
 
 	for(auto* channel : _channels)
@@ -103,6 +108,7 @@ EngineSync::~EngineSync()
 	_rCmder			= nullptr;
 
 	TempFiles::deleteAll();
+	ImageCache::cache()->clear();
 
 	_singleton = nullptr;
 }
@@ -173,10 +179,24 @@ QHash<int, QByteArray> EngineSync::roleNames() const
 
 size_t EngineSync::maxEngineCount() const
 {
+	if(_enginePool > 0)
+		return _enginePool;
+
 	size_t maxEngines = std::max(1, PreferencesModel::prefs()->maxEngines());	
 	return maxEngines;
 }
 
+void EngineSync::setEnginePool(size_t engines)
+{
+	if(_enginePool == engines)
+		return;
+
+	Log::log() << "EngineSync::setEnginePool(" << engines << ")" << std::endl;
+
+	_enginePool = engines;
+	maxEngineCountChanged();
+}
+
 void EngineSync::maxEngineCountChanged()
 {
 	Log::log() << "EngineSync::maxEngineCountChanged called and currently there are #" << _moduleEngines.size() << " while the max we want is: " << maxEngineCount() << std::endl;
@@ -254,6 +274,8 @@ EngineRepresentation * EngineSync::createNewEngine(bool addToEngines, int overri
 		connect(engine,						&EngineRepresentation::moduleLoadingFailed,				this,					&EngineSync::moduleLoadingFailed										);
 		connect(engine,						&EngineRepresentation::logCfgReplyReceived,				this,					&EngineSync::logCfgReplyReceived										);
 		connect(engine,						&EngineRepresentation::plotEditorRefresh,				this,					&EngineSync::plotEditorRefresh											);
+		connect(engine,						&EngineRepresentation::analysisRequestSent,				this,					&EngineSync::analysisRequestSent										);
+		connect(engine,						&EngineRepresentation::analysisReplyReceived,			this,					&EngineSync::analysisReplyReceived										);
 		connect(engine,						&EngineRepresentation::requestEngineRestartAfterCrash,	this,					&EngineSync::restartEngineAfterCrash									);
 		connect(engine,						&EngineRepresentation::registerForModule,				this,					&EngineSync::registerEngineForModule									);
 		connect(engine,						&EngineRepresentation::unregisterForModule,				this,					&EngineSync::unregisterEngineForModule									);
@@ -276,7 +298,7 @@ EngineRepresentation * EngineSync::createNewEngine(bool addToEngines, int overri
 	}
 	catch (interprocess_exception & e)
 	{
-		Log::log()  << "interprocess exception! " << e.what() <<  std::endl;
+		Log::error()  << "interprocess exception! " << e.what() <<  std::endl;
 		throw e;
 	}
 }
@@ -298,6 +320,9 @@ void EngineSync::start(int )
 	for(size_t s=0;s < _engineStopTimes.size(); s++)
 		_engineStopTimes[s] = -1;
 
+	engineMemoryBudgetChanged();
+	preemptBackgroundRunsChanged();
+
 	//We start with a single engine. Later we can start more if necessary and allowed by the user. This one engine can run filters etc and it can be assigned to a particular module.
 	//Once it is assigned to a module it won't be possible to use it for another module until it is restarted.
 	createNewEngine();
@@ -370,6 +395,63 @@ void EngineSync::shutdownBoredEngines()
 		stopAndDestroyEngine(engine);
 }
 
+void EngineSync::engineMemoryBudgetChanged()
+{
+	_memoryGovernor.setBudget(size_t(std::max(0, PreferencesModel::prefs()->engineMemoryBudget())) * EngineMemoryGovernor::MB);
+}
+
+void EngineSync::preemptBackgroundRunsChanged()
+{
+	_runScheduler.setPreemption(PreferencesModel::prefs()->preemptBackgroundRuns());
+}
+
+///Every couple of seconds checks whether the engines together use more memory than they may, and if so does what EngineMemoryGovernor advises.
+void EngineSync::governMemory()
+{
+	const long now = Utils::currentMillis();
+
+	if(_memoryGovernedAt != -1 && _memoryGovernedAt + 2000 > now)
+		return;
+
+	_memoryGovernedAt = now;
+
+	std::vector<EngineMemoryGovernor::Sample>	samples;
+	std::map<size_t, EngineRepresentation *>	channelEngines;
+
+	for(EngineRepresentation * engine : _engines)
+		if(engine->processId() > 0)
+		{
+			EngineMemoryGovernor::Sample sample;
+			sample.channel	= engine->channelNumber();
+			sample.pid		= engine->processId();
+			sample.idle		= engine->idle() && !engine->analysisInProgress();
+
+			samples.push_back(sample);
+			channelEngines[sample.channel] = engine;
+		}
+
+	_memoryGovernor.measure(samples);
+
+	for(const EngineMemoryGovernor::Advice & advice : _memoryGovernor.advise(samples, now))
+	{
+		EngineRepresentation * engine = channelEngines[advice.channel];
+
+		if(!engine->idle())
+			continue;
+
+		if(advice.what == EngineMemoryGovernor::action::cleanMemory)
+		{
+			Log::log() << "Engines use " << _memoryGovernor.enginesResident() / EngineMemoryGovernor::MB << "MB (budget " << _memoryGovernor.budget() / EngineMemoryGovernor::MB << "MB, machine has " << _memoryGovernor.available() / EngineMemoryGovernor::MB << "MB left), asking idle engine #" << engine->channelNumber() << " to clean up its memory." << std::endl;
+			engine->sendCleanMemory();
+		}
+		else
+		{
+			Log::log() << "Engines still use " << _memoryGovernor.enginesResident() / EngineMemoryGovernor::MB << "MB after cleaning up, so idle engine #" << engine->channelNumber() << " is shut down and will be started fresh when needed." << std::endl;
+			stopAndDestroyEngine(engine);
+		}
+	}
+}
+
 /**
  * @brief EngineSync::process the beating heart of jasp-desktop
  * 
@@ -398,6 +480,7 @@ void EngineSync::process()
 	
 	restartKilledAndStoppedEngines();
 	shutdownBoredEngines();
+	governMemory();
 
 	for(auto * engine : _engines)
 		engine->processReplies();
@@ -406,6 +489,7 @@ void EngineSync::process()
 
 	processReloadData();
 	processSettingsChanged();
+	processStatesToForget();
 	processFilterScript();
 
 	if(_filterRunning) return; //Do not do anything else while waiting for a filter to return
@@ -552,6 +636,14 @@ void EngineSync::processSettingsChanged()
 		_rCmder->sendSettings();
 }
 
+///An engine that was busy when another ran one of its analyses forgets that state as soon as it is idle, before it would write it over the newer one when cleaning up
+void EngineSync::processStatesToForget()
+{
+	for(auto * engine : _engines)
+		if(engine->shouldForgetStates())
+			engine->sendSaveStates(false);
+}
+
 void EngineSync::processReloadData()
 {
 	for(auto * engine : _engines)
@@ -603,7 +695,11 @@ stringset EngineSync::processRCodeQueue()
 				{
 					foundEngine = true;
 					if(_moduleEngines[mod]->idle())		_moduleEngines[mod]->runScriptOnProcess(waiting);
-					else								engineNotIdle = true;
+					else
+					{
+						engineNotIdle = true;
+						preemptIfWorthIt(_moduleEngines[mod], RunScheduler::runPriority::rCode); //A form is probably waiting for this
+					}
 				}
 			
 				
@@ -716,9 +812,36 @@ std::set<std::string> EngineSync::processAnalysisRequests()
 	for(auto * engine : _engines)
 		engine->handleRunningAnalysisStatusChanges();
 
+	std::vector<RunScheduler::Request>	waiting;
+	std::map<size_t, Analysis *>		waitingAnalyses;
+	std::set<size_t>					running;
+
+	_modulesRewriting.clear();
+
 	Analyses::analyses()->applyToAll([&](Analysis * analysis)
 	{
 		if(analysis && analysis->shouldRun())
+		{
+			waiting.push_back({ analysis->id(), runPriority(analysis) });
+			waitingAnalyses[analysis->id()] = analysis;
+
+			if(analysis->isRewriteImgs() && analysis->dynamicModule())
+				_modulesRewriting.insert(analysis->dynamicModule()->name());
+		}
+	});
+
+	for(auto * engine : _engines)
+		if(engine->analysisInProgress())
+			running.insert(engine->analysisInProgress()->id());
+
+	const long now = Utils::currentMillis();
+
+	//The analysis the user is working on gets an engine first, then those they can see, and whatever waited long enough
+	for(size_t id : _runScheduler.schedule(waiting, running, now))
+	{
+		Analysis * analysis = waitingAnalyses[id];
+
+		if(analysis->shouldRun())
 		{
 			try
 			{
@@ -730,7 +853,10 @@ std::set<std::string> EngineSync::processAnalysisRequests()
 					auto * engine = _moduleEngines[modName];
 
 					if(engine->willProcessAnalysis(analysis))
-						engine->runAnalysisOnProcess(analysis);
+					{
+						if(!waitForStateHandOver(engine, analysis))
+							engine->runAnalysisOnProcess(analysis);
+					}
 
 					else if(engine->stopped())
 						startStoppedEngine(engine);
@@ -745,6 +871,9 @@ std::set<std::string> EngineSync::processAnalysisRequests()
 						//else
 						// If the engine is being stopped it might be here	throw std::runtime_error("An engine is meant for module " + modName + " but won't process analysis " + analysis->name() + " and is also loaded, which does not make any sense.");
 					}
+
+					else if(!runOnExtraModuleEngine(analysis, modName, modulesNeedingEngines))
+						preemptIfWorthIt(engine, runPriority(analysis)); //Not the aged priority, a background run shouldn't abort another one because it waited longer
 				}
 				else
 				{
@@ -768,11 +897,101 @@ std::set<std::string> EngineSync::processAnalysisRequests()
 			}
 			catch(std::exception & e)	{ Log::log() << "Exception " << e.what() << " thrown in ProcessAnalysisRequests" << std::endl;	}
 		}
-	});
+	}
 	
 	return modulesNeedingEngines;
 }
 
+RunScheduler::runPriority EngineSync::runPriority(const Analysis * analysis) const
+{
+	if(analysis->isSaveImg() || analysis->isEditImg() || Analyses::analyses()->isCurrent(analysis))
+		return RunScheduler::runPriority::interactive;
+
+	if(Analyses::analyses()->inView(analysis))
+		return RunScheduler::runPriority::visible; //Also for a rewrite, so that the plots the user is looking at are redone first
+
+	if(analysis->isRewriteImgs())
+		return RunScheduler::runPriority::imageRewrite;
+
+	return RunScheduler::runPriority::background;
+}
+
+///When there is an engine pool the analyses of a module need not wait for each other, this looks for or asks for another engine for the module.
+///Returns false if the analysis will just have to wait for the module's engine.
+bool EngineSync::runOnExtraModuleEngine(Analysis * analysis, const std::string & modName, stringset & modulesNeedingEngines)
+{
+	const size_t pool = enginePoolFor(modName);
+
+	if(pool < 2)
+		return false;
+
+	std::set<EngineRepresentation*> & extras = _extraModuleEngines[modName];
+
+	for(auto * engine : extras)
+		if(engine->willProcessAnalysis(analysis))
+		{
+			if(!waitForStateHandOver(engine, analysis))
+				engine->runAnalysisOnProcess(analysis);
+			return true;
+		}
+
+	for(auto * engine : extras)
+		if(!engine->analysisInProgress())
+		{
+			if(engine->stopped())																startStoppedEngine(engine);
+			else if(engine->idle() && !engine->moduleLoaded() && !engine->moduleLoading())	engine->moduleLoad();
+
+			return true; //It will be ready for this analysis soon
+		}
+
+	if(extras.size() + 1 >= pool)
+		return false;
+
+	for(auto * engine : _engines)
+		if(engine->module() == "" && engine->idle() && engine->runsAnalysis())
+		{
+			registerEngineForModule(engine, modName);
+			return true;
+		}
+
+	modulesNeedingEngines.insert(modName); //process() will start one and register it for the module, which then makes it an extra
+	return true;
+}
+
+///Engines keep the state of the analyses they ran in memory and only write it to its file when needed, so when another engine is going to run one of those it has to wait for that.
+///The engine that had it also forgets it, because the state the other one makes will be newer.
+bool EngineSync::waitForStateHandOver(EngineRepresentation * engine, Analysis * analysis)
+{
+	bool wait = false;
+
+	for(auto * other : _engines)
+		if(other != engine && other->handOverState(analysis->id()))
+			wait = true;
+
+	return wait;
+}
+
+///A rewrite only needs the state the analysis left on disk, so while a module has plots to redo they may spread over as many engines as the user allows.
+size_t EngineSync::enginePoolFor(const std::string & modName) const
+{
+	return _modulesRewriting.count(modName) ? std::max(_enginePool, maxEngineCount()) : _enginePool;
+}
+
+///If engine is running an analysis nobody is looking at while something the user waits on is queued behind it, the run is aborted and redone later.
+void EngineSync::preemptIfWorthIt(EngineRepresentation * engine, RunScheduler::runPriority waiting)
+{
+	Analysis * running = engine->analysisInProgress();
+
+	if(!running || running->status() != Analysis::Running)
+		return;
+
+	if(_runScheduler.shouldPreempt({ running->id(), runPriority(running) }, waiting))
+	{
+		Log::log() << "Analysis " << running->title() << " (" << running->id() << ") runs in the background on engine #" << engine->channelNumber() << " while a request with priority " << RunScheduler::priorityName(waiting) << " waits for it, so it is aborted and will be run again afterwards." << std::endl;
+		engine->abortAnalysisInProgress(true);
+	}
+}
+
 ///Maybe no engines are idle, but if one is initializing or setting up some stuff it'll be so soon. So tell JASP to be patient then.
 bool EngineSync::anEngineIdleSoon() const
 {
@@ -808,6 +1027,9 @@ size_t EngineSync::enginesIdleSoon() const
 
 size_t EngineSync::enginesStartableCount() const
 {
+	if(!_memoryGovernor.mayStartEngine(_engines.size()))
+		return 0; //Another one would take the engines over their memory budget, or the machine into swap
+
 	size_t enginesPossible = maxEngineCount() - _engines.size();
 
 	//But perhaps they have to cool down for a bit.
@@ -1014,6 +1236,44 @@ void EngineSync::pauseEngines(bool unloadData)
 			engine->killEngine();
 }
 
+///The engines only write the states of the analyses to their files when needed, and the .jasp that is about to be written should have the latest.
+///An engine still busy running an analysis after a while is not waited for, the states it keeps will then be those from before in the file.
+void EngineSync::saveAnalysisStates()
+{
+	JASPTIMER_SCOPE(EngineSync::saveAnalysisStates);
+
+	std::set<EngineRepresentation*> toAsk, asked;
+
+	for(auto * engine : _engines)
+		if(engine->keepsStates())
+			toAsk.insert(engine);
+
+	long tryTill = Utils::currentMillis() + 10000;
+
+	while((toAsk.size() || asked.size()) && tryTill >= Utils::currentMillis())
+	{
+		for(auto * engine : _engines)
+			engine->processReplies();
+
+		for(auto * engine : std::set<EngineRepresentation*>(asked))
+			if(engine->idle() || engine->killed())
+				asked.erase(engine);
+
+		for(auto * engine : std::set<EngineRepresentation*>(toAsk))
+			if(engine->idle())
+			{
+				engine->sendSaveStates(true);
+				asked.insert(engine);
+				toAsk.erase(engine);
+			}
+			else if(engine->paused() || engine->stopped() || engine->killed())
+				toAsk.erase(engine); //Pausing and stopping already wrote them, and a killed one lost them
+	}
+
+	for(auto * engine : toAsk)
+		Log::log() << "Engine #" << engine->channelNumber() << " was still busy, the file will have the states it keeps as they were last written." << std::endl;
+}
+
 void EngineSync::startStoppedEngine(EngineRepresentation * engine)
 {
 	if(!engine->jaspEngineStillRunning())
@@ -1128,9 +1388,10 @@ bool EngineSync::isModuleInstallRequestActive(const QString &moduleName)
 
 void EngineSync::refreshAllPlots()
 {
+	//Analyses that are rendering images will rewrite them again when done (see Analysis::rewriteImages), those running fully will use the new settings anyway
 	std::set<Analysis*> inProgress;
 	for(EngineRepresentation * engine : _engines)
-		if(engine->analysisInProgress() != nullptr)
+		if(engine->analysisInProgress() != nullptr && !engine->analysisInProgress()->isRunningImg())
 			inProgress.insert(engine->analysisInProgress());
 
 	//If an analysis is empty it means it will be reran anyway, so rewriteImgs is pointless
@@ -1157,6 +1418,15 @@ void EngineSync::logCfgReplyReceived(EngineRepresentation * engine)
 
 void EngineSync::registerEngineForModule(EngineRepresentation * engine, std::string modName)
 {
+	if(_moduleEngines.count(modName) > 0 && _moduleEngines[modName] != engine && _extraModuleEngines[modName].size() + 1 < enginePoolFor(modName))
+	{
+		Log::log() << "Registering engine #" << engine->channelNumber() << " as an extra engine for module '" << modName << "'" << std::endl;
+
+		_extraModuleEngines[modName].insert(engine);
+		engine->setDynamicModule(modName);
+		return;
+	}
+
 	if(_moduleEngines.count(modName) > 0 && _moduleEngines[modName] != engine)
 		throw std::runtime_error("Trying to register module '" + modName + "' to engine #" +
 								 std::to_string(engine->channelNumber()) + " but it is already registered to " +
@@ -1171,6 +1441,14 @@ void EngineSync::registerEngineForModule(EngineRepresentation * engine, std::str
 
 void EngineSync::unregisterEngineForModule(EngineRepresentation * engine, std::string modName)
 {
+	if(_extraModuleEngines.count(modName) && _extraModuleEngines[modName].count(engine))
+	{
+		Log::log() << "Unregistering extra engine #" << engine->channelNumber() << " for module '" << modName << "'" << std::endl;
+		_extraModuleEngines[modName].erase(engine);
+		engine->setDynamicModule("");
+		return;
+	}
+
 	if(_moduleEngines.count(modName) > 0 && _moduleEngines[modName] != engine)
 		return;
 
@@ -1185,6 +1463,9 @@ void EngineSync::stopModuleEngine(QString moduleName)
 	const std::string modName = fq(moduleName);
 	if(_moduleEngines.count(modName))
 		_moduleEngines[modName]->shutEngineDown();
+
+	for(auto * engine : _extraModuleEngines[modName])
+		engine->shutEngineDown();
 }
 
 void EngineSync::moduleInstallationFailedHandler(const QString &moduleName, const QString &)
@@ -1196,6 +1477,9 @@ void EngineSync::moduleInstallationFailedHandler(const QString &moduleName, cons
 
 void EngineSync::killModuleEngine(Modules::DynamicModule * mod)
 {
+	for(auto * engine : _extraModuleEngines[mod->name()])
+		engine->shutEngineDown();
+
 	if(!_moduleEngines.count(mod->name()))
 		return;
 
@@ -1247,6 +1531,7 @@ void EngineSync::cleanUpAfterClose(bool forgetAnalyses)
 	_waitingFilter = nullptr;
 
 	TempFiles::clearSessionDir();
+	ImageCache::cache()->clear();
 
 	for(EngineRepresentation * e : _engines)
 		e->cleanUpAfterClose(forgetAnalyses);
@@ -1313,7 +1598,11 @@ void EngineSync::destroyEngine(EngineRepresentation * engine)
 		});
 	}
 
-	if(engine->module() != "")	_moduleEngines.erase(engine->module());
+	for(auto & modEngines : _extraModuleEngines)
+		modEngines.second.erase(engine);
+
+	if(engine->module() != "" && _moduleEngines.count(engine->module()) && _moduleEngines[engine->module()] == engine)
+		_moduleEngines.erase(engine->module());
 	else
 	{
 		std::string modName = "";
@@ -30,6 +30,8 @@
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
 
 #include "enginerepresentation.h"
+#include "enginememorygovernor.h"
+#include "runscheduler.h"
 
 /// EngineSync is responsible for launching the background
 /// processes, scheduling analyses, and for sending and
@@ -56,6 +58,9 @@ public:
 
 	std::string	currentStateForDebug() const;
 
+	void		setEnginePool(size_t engines);	///< Overrides the preference for the number of engines, and lets up to that many run the analyses of a single module side by side. 0 goes back to the usual one engine per module.
+	size_t		enginePool() const { return _enginePool; }
+
 	int						rowCount(const QModelIndex & = QModelIndex())				const override;
 	QVariant				data(const QModelIndex &index, int role = Qt::DisplayRole)	const override;
 	QHash<int, QByteArray>	roleNames()													const override;
@@ -68,6 +73,7 @@ public slots:
 	void		sendRCode(		const QString & rCode,				int requestId,					bool whiteListedVersion, QString module);
 	void		computeColumn(	const QString & columnName,			const QString & computeCode,	columnType columnType);
 	void		pauseEngines(bool  unloadData = false);
+	void		saveAnalysisStates();
 	void		stopEngines();
 	void		resumeEngines();
 	void		restartEngines();
@@ -93,7 +99,7 @@ signals:
 	void		filterUpdated(int requestID);
 	void		filterErrorTextChanged(const QString & error);
 
-	void		computeColumnSucceeded(			const QString & columnName, const QString & warning, bool dataChanged);
+	void		computeColumnSucceeded(			const QString & columnName, const QString & warning, const ColumnChanges & changes);
 	void		computeColumnFailed(			const QString & columnName, const QString & error);
 	void		columnDataTypeChanged(			const QString & columnName);
 
@@ -108,19 +114,30 @@ signals:
 	void		settingsChanged();
 	void		reloadData();
 
+	void		analysisRequestSent(			Analysis * analysis, int channelNumber, size_t bytes);
+	void		analysisReplyReceived(			Analysis * analysis, size_t bytes);
+
 private:
 	//These process functions can request a new engine to be started:
 	stringset	processRCodeQueue();
 	bool		processComputedColumnQueue();
 	stringset	processDynamicModules();
 	stringset	processAnalysisRequests();	///< Returns modules that still need an engine
+	void		preemptIfWorthIt(EngineRepresentation * engine, RunScheduler::runPriority waiting);
+	bool		runOnExtraModuleEngine(Analysis * analysis, const std::string & modName, stringset & modulesNeedingEngines);
+	bool		waitForStateHandOver(EngineRepresentation * engine, Analysis * analysis);
+	size_t		enginePoolFor(const std::string & modName) const;	///< How many engines the analyses of modName may spread over
+
+	RunScheduler::runPriority runPriority(const Analysis * analysis) const;
 	
 	void		processLogCfgRequests();
 	void		processFilterScript();
 	void		processSettingsChanged();
+	void		processStatesToForget();
 	void		processReloadData();
 	
 	void		shutdownBoredEngines();
+	void		governMemory();
 	bool		allEnginesStopped(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
 	bool		allEnginesPaused(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
 	bool		allEnginesResumed(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
@@ -155,6 +172,8 @@ private slots:
 	void	moduleInstallationFailedHandler(	const QString & moduleName, const QString & );
 	
 	void	maxEngineCountChanged();
+	void	engineMemoryBudgetChanged();
+	void	preemptBackgroundRunsChanged();
 	void	startExtraEngines(size_t num=1);
 	bool	anEngineIdleSoon() const;
 	bool	moduleHasEngine(const std::string & name) { return _moduleEngines.count(name); }
@@ -177,12 +196,19 @@ private:
 	std::queue<RScriptStore*>			_waitingScripts;
 	std::map<std::string,
 		EngineRepresentation * >		_moduleEngines;					///< An engine per module active. Engines will be started and closed as needed.
+	std::map<std::string,
+		std::set<EngineRepresentation*>>_extraModuleEngines;			///< Engines that run analyses of a module next to the one in _moduleEngines, only when there is an _enginePool or its plots are being rewritten
 	std::set<EngineRepresentation*>		_engines,						///< All analysis/utility/module engines, excepting _rCmder
 										_logCfgRequested;
 	std::vector<IPCChannel*>			_channels;						///< Channels are instantiated separately from the engines to avoid boost messing up
 	EngineRepresentation			*	_rCmder				= nullptr;	///< For those special occassions where you just want to shout at R in a more personal manner
 	IPCChannel						*	_rCmderChannel		= nullptr;	///< The channel for shouting at R in a more personal manner
 	std::vector<long>					_engineStopTimes;				///< Here we keep track of how long ago it is an engine shut down, this way we can give it a slight time between closing and starting an engine. To avoid shared memory problems on windows.
+	EngineMemoryGovernor				_memoryGovernor;
+	RunScheduler						_runScheduler;
+	long								_memoryGovernedAt	= -1;
+	size_t								_enginePool			= 0;
+	stringset							_modulesRewriting;				///< Modules that have analyses waiting to rewrite their images, set by processAnalysisRequests()
 
 };
 
@@ -0,0 +1,110 @@
+#include "runscheduler.h"
+#include <algorithm>
+
+const long	RunScheduler::_forgetMs			= 10000;	///< An aborted analysis is neither waiting nor running for a moment, this is how long it keeps its age and preemption count meanwhile
+const int	RunScheduler::_maxPreemptions	= 2;		///< After being aborted this many times an analysis gets to finish, whatever comes along
+const RunScheduler::runPriority	RunScheduler::_agedAtMost	= RunScheduler::runPriority::visible;	///< Only what the user is waiting on is ranked above this, however long others wait
+
+std::vector<size_t> RunScheduler::schedule(const std::vector<Request> & waiting, const std::set<size_t> & running, long nowMs)
+{
+	for(const Request & request : waiting)
+	{
+		Record & record = _records[request.id];
+
+		if(record.waitingSince == -1)
+			record.waitingSince = nowMs;
+
+		record.lastSeen = nowMs;
+	}
+
+	for(size_t id : running)
+	{
+		Record & record = _records[id];
+
+		if(record.preemptions == 0)	//A preempted run keeps its age so that it will soon outrank whatever interrupted it
+			record.waitingSince = -1;
+
+		record.lastSeen = nowMs;
+	}
+
+	for(auto record = _records.begin(); record != _records.end();)
+		if(record->second.lastSeen + _forgetMs < nowMs)
+			record = _records.erase(record);
+		else
+			record++;
+
+	struct Ranked
+	{
+		size_t	id;
+		int		rank;
+		long	since;
+	};
+
+	std::vector<Ranked> ranked;
+	ranked.reserve(waiting.size());
+
+	for(const Request & request : waiting)
+		ranked.push_back({ request.id, int(effectivePriority(request, nowMs)), _records[request.id].waitingSince });
+
+	//Stable so that requests of the same rank that started waiting together keep the order of the results
+	std::stable_sort(ranked.begin(), ranked.end(), [](const Ranked & l, const Ranked & r) { return l.rank != r.rank ? l.rank < r.rank : l.since < r.since; });
+
+	std::vector<size_t> order;
+	order.reserve(ranked.size());
+
+	for(const Ranked & r : ranked)
+		order.push_back(r.id);
+
+	return order;
+}
+
+RunScheduler::runPriority RunScheduler::effectivePriority(const Request & request, long nowMs) const
+{
+	auto	record	= _records.find(request.id);
+	long	waited	= record == _records.end() || record->second.waitingSince == -1 ? 0 : nowMs - record->second.waitingSince;
+	long	aged	= _agingMs > 0 ? waited / _agingMs : 0;
+
+	if(request.priority <= _agedAtMost)
+		return request.priority;
+
+	return runPriority(std::max(long(_agedAtMost), long(request.priority) - aged));
+}
+
+bool RunScheduler::shouldPreempt(const Request & running, const Request & waiting)
+{
+	return running.id != waiting.id && shouldPreempt(running, waiting.priority);
+}
+
+bool RunScheduler::shouldPreempt(const Request & running, runPriority waiting)
+{
+	if(!_preempt || running.priority != runPriority::background || waiting > runPriority::rCode)
+		return false; //Only the user waiting on something is worth throwing away work for, and only work nobody is looking at
+
+	Record & record = _records[running.id];
+
+	if(record.preemptions >= _maxPreemptions)
+		return false;
+
+	record.preemptions++;
+
+	return true;
+}
+
+int RunScheduler::preemptions(size_t id) const
+{
+	auto record = _records.find(id);
+	return record == _records.end() ? 0 : record->second.preemptions;
+}
+
+const char * RunScheduler::priorityName(runPriority priority)
+{
+	switch(priority)
+	{
+	case runPriority::interactive:	return "interactive";
+	case runPriority::rCode:		return "rCode";
+	case runPriority::visible:		return "visible";
+	case runPriority::imageRewrite:	return "imageRewrite";
+	case runPriority::background:	return "background";
+	}
+	return "?";
+}
@@ -0,0 +1,57 @@
+#ifndef RUNSCHEDULER_H
+#define RUNSCHEDULER_H
+
+#include <vector>
+#include <map>
+#include <set>
+#include <cstddef>
+
+///
+/// Decides in which order waiting analyses get an engine, see EngineSync::processAnalysisRequests().
+/// Every request gets a priority class, lower is more urgent. The longer a request waits the more urgent it becomes (aging),
+/// so that a bulk refresh of all analyses still finishes while the user keeps editing one of them.
+/// Aging stops at visible, otherwise a long refresh would rank its requests with the one the user just edited and, having waited longer, before it.
+/// It also decides whether a background run should be aborted to make room for something the user is waiting on, which is only done a limited number of times per analysis.
+/// Aging only changes the order, an aged background request is still nothing the user waits on, so it never preempts.
+/// This knows nothing about engines or analyses, only about ids and times, so that the policy can be tested by itself.
+class RunScheduler
+{
+public:
+	enum class runPriority { interactive, rCode, visible, imageRewrite, background };
+
+	struct Request
+	{
+		size_t		id;
+		runPriority	priority;
+	};
+
+	void				setAgingMs(long agingMs)		{ _agingMs		= agingMs;		}
+	void				setPreemption(bool preempt)		{ _preempt		= preempt;		}
+	bool				preemption()			const	{ return _preempt;				}
+
+	std::vector<size_t>	schedule(const std::vector<Request> & waiting, const std::set<size_t> & running, long nowMs);	///< Returns the ids of waiting, most urgent first, and ages the requests
+	runPriority			effectivePriority(const Request & request, long nowMs) const;
+	bool				shouldPreempt(const Request & running, const Request & waiting);									///< If true the running one is counted as preempted, so the caller is expected to abort it. Goes by the class waiting was asked for, not its aged one
+	bool				shouldPreempt(const Request & running, runPriority waiting);										///< For requests that aren't scheduled themselves, like R code
+	int					preemptions(size_t id)	const;
+
+	static const char *	priorityName(runPriority priority);
+
+private:
+	struct Record
+	{
+		long	waitingSince	= -1,
+				lastSeen		= -1;
+		int		preemptions		= 0;
+	};
+
+	std::map<size_t, Record>	_records;
+	long						_agingMs		= 3000;		///< Waiting this long makes a request one class more urgent
+	bool						_preempt		= true;
+
+	static const long			_forgetMs;
+	static const int			_maxPreemptions;
+	static const runPriority	_agedAtMost;
+};
+
+#endif // RUNSCHEDULER_H
@@ -60,6 +60,8 @@ class PreferencesModel : public PreferencesModelBase
 	Q_PROPERTY(QStringList	allResultFonts			READ allResultFonts				CONSTANT																	)
 	Q_PROPERTY(int			maxEngines				READ maxEngines					WRITE setMaxEngines					NOTIFY maxEnginesChanged				)
 	Q_PROPERTY(int			maxEnginesAdmin			READ maxEnginesAdmin												NOTIFY maxEnginesAdminChanged			)
+	Q_PROPERTY(int			engineMemoryBudget		READ engineMemoryBudget			WRITE setEngineMemoryBudget			NOTIFY engineMemoryBudgetChanged		)
+	Q_PROPERTY(bool			preemptBackgroundRuns	READ preemptBackgroundRuns		WRITE setPreemptBackgroundRuns		NOTIFY preemptBackgroundRunsChanged		)
 	Q_PROPERTY(bool			windowsNoBomNative		READ windowsNoBomNative			WRITE setWindowsNoBomNative			NOTIFY windowsNoBomNativeChanged		)
 	Q_PROPERTY(int			windowsChosenCodePage	READ windowsChosenCodePage		WRITE setWindowsChosenCodePage		NOTIFY windowsChosenCodePageChanged		)
 	Q_PROPERTY(bool			dbShowWarning			READ dbShowWarning				WRITE setDbShowWarning				NOTIFY dbShowWarningChanged				)
@@ -135,6 +137,8 @@ public:
 	void		zoomOut();
 	void		zoomReset();
 	int 		maxEnginesAdmin() 						const;
+	int			engineMemoryBudget()					const;
+	bool		preemptBackgroundRuns()					const;
 	bool		developerMode()							const;
 	bool		ALTNavModeActive()						const;
 
@@ -184,6 +188,8 @@ public slots:
 	void setGenerateMarkdown(			bool		generateMarkdown);
 	void resetRememberedModules(		bool		clear);
 	void setMaxEngines(					int			maxEngines);
+	void setEngineMemoryBudget(			int			engineMemoryBudget);
+	void setPreemptBackgroundRuns(		bool		preemptBackgroundRuns);
 	void setWindowsNoBomNative(			bool		windowsNoBomNative);
 	void setWindowsChosenCodePage(		int			windowsChosenCodePage);
 	void setDbShowWarning(				bool		dbShowWarning);
@@ -237,6 +243,8 @@ signals:
 	void lcCtypeChanged();
 	void restartAllEngines();
 	void maxEnginesChanged(				int			maxEngines);
+	void engineMemoryBudgetChanged(		int			engineMemoryBudget);
+	void preemptBackgroundRunsChanged(	bool		preemptBackgroundRuns);
 	void windowsNoBomNativeChanged(		bool		windowsNoBomNative);
 	void windowsChosenCodePageChanged(	int			windowsChosenCodePage);
 	void dbShowWarningChanged(			bool		dbShowWarning);
@@ -13,7 +13,16 @@ $(document).ready(function () {
 		$("#note").css("background-image", "url('img/snow.gif')");
 
 	if (typeof qt !== "undefined")
-		var ch = new QWebChannel(qt.webChannelTransport, function (channel) { jasp = channel.objects.jasp; });
+		var ch = new QWebChannel(qt.webChannelTransport, function (channel) {
+			jasp = channel.objects.jasp;
+
+			// Calls concerning the analyses arrive in order as one compact JSON array per frame instead of as escaped javascript
+			jasp.resultsCalls.connect(function (calls) {
+				JSON.parse(calls).forEach(function (call) { window[call.function].apply(window, call.args); });
+			});
+
+			jasp.resultsChannelReady();
+		});
 
 	var ua = navigator.userAgent.toLowerCase();
 
@@ -426,6 +435,27 @@ $(document).ready(function () {
 
 	}
 
+	// Let JASP know which analyses are on screen, so that those get rendered first
+	var analysesInView			= new Set();
+	var analysesInViewTimer		= null;
+	var analysesInViewObserver	= new IntersectionObserver(function (entries) {
+
+		entries.forEach(function (entry) {
+			var analysisId = parseInt(entry.target.id.substring(3)); // id is "id-" + analysis.id
+
+			if (entry.isIntersecting)	analysesInView.add(analysisId);
+			else						analysesInView.delete(analysisId);
+		});
+
+		if (analysesInViewTimer === null)
+			analysesInViewTimer = setTimeout(function () {
+				analysesInViewTimer = null;
+
+				if (jasp !== null)
+					jasp.analysesInViewChanged(Array.from(analysesInView));
+			}, 100);
+	});
+
 	window.analysisChanged = function (analysis) {
 
 		if (showInstructions)
@@ -478,6 +508,7 @@ $(document).ready(function () {
 			}
 
 			analyses.addAnalysis(jaspWidget);
+			analysesInViewObserver.observe(newItem[0]);
 
 			jaspWidget.on("optionschanged",				function (id, options)	{ jasp.analysisChangedDownstream(id, JSON.stringify(options))	});
 			jaspWidget.on("saveimage",					function (id, options)	{ jasp.analysisSaveImage(id, JSON.stringify(options))			});
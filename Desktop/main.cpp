@@ -18,6 +18,7 @@
 
 
 #include <QDir>
+#include <QThread>
 
 #include "utilities/application.h"
 #include "utilities/settings.h"
@@ -39,6 +40,11 @@ const std::string	jaspExtension		= ".jasp",
 					unitTestArg			= "--unitTest",
 					saveArg				= "--save",
 					timeOutArg			= "--timeOut=",
+					restoreTestArg		= "--restoreTest=",
+					filterTestArg		= "--filterTest=",
+					batchArg			= "--batch",
+					enginesArg			= "--engines=",
+					rewriteImagesArg	= "--rewriteImages",
 					junctionArg			= "--junctions",
 					removeJunctionsArg	= "--removeJunctions";
 
@@ -89,7 +95,7 @@ bool runJaspEngineJunctionFixer(int argc, char *argv[], bool removeJunctions = f
 #endif
 
 
-void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP, bool & safeGraphics, Json::Value & dbJson, QString & reportingDir)
+void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitTest, bool & dirTest, int & timeOut, bool & save, bool & logToFile, bool & hideJASP, bool & safeGraphics, Json::Value & dbJson, QString & reportingDir, int & restoreTestCopies, QString & batchDir, QStringList & batchPaths, int & enginePool, bool & batchRewriteImages, int & filterTestSteps)
 {
 	filePath		= "";
 	unitTest		= false;
@@ -100,6 +106,12 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 	safeGraphics	= false;
 	reportingDir	= "";
 	timeOut			= 10;
+	restoreTestCopies	= 0;
+	batchDir		= "";
+	batchPaths		= {};
+	enginePool		= 0;
+	batchRewriteImages	= false;
+	filterTestSteps	= 0;
 	dbJson			= Json::nullValue;
 
 	bool letsExplainSomeThings = false;
@@ -189,6 +201,47 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 					reportingDir = testMe.absolutePath();
 			}
 		}
+		else if(args[arg] == batchArg)
+		{
+			if(arg >= args.size() - 1)
+			{
+				std::cerr << "Argument for batch output directory missing!" << std::endl;
+				letsExplainSomeThings = true;
+			}
+			else
+			{
+				arg++;
+				QDir outputDir(QSTRING_FILE_ARG(args[arg].c_str()));
+				outputDir.mkpath(".");
+
+				if(!outputDir.exists())
+				{
+					std::cerr << "Directory to write batch results to " << outputDir.absolutePath().toStdString() << " does not exist and cannot be created!" << std::endl;
+					letsExplainSomeThings = true;
+				}
+				else
+					batchDir = outputDir.absolutePath();
+			}
+		}
+		else if(args[arg] == rewriteImagesArg)
+			batchRewriteImages = true;
+		else if(args[arg].size() > enginesArg.size() && args[arg].substr(0, enginesArg.size()) == enginesArg)
+		{
+			std::string engines			= args[arg].substr(enginesArg.size());
+			size_t		convertedChars	= 0;
+			int			convertedEngines	= 0;
+			try								{ convertedEngines = std::stoi(engines, &convertedChars); }
+			catch(std::invalid_argument &)	{}
+			catch(std::out_of_range &)		{}
+
+			if(convertedChars > 0 && convertedEngines > 0)
+				enginePool = convertedEngines;
+			else
+			{
+				std::cerr << "Argument " << enginesArg << " needs a positive number of engines!" << std::endl;
+				letsExplainSomeThings = true;
+			}
+		}
 		else if(args[arg].size() > timeOutArg.size() && args[arg].substr(0, timeOutArg.size()) == timeOutArg)
 		{
 			std::string time			= timeOutArg.substr(timeOutArg.size());
@@ -201,6 +254,40 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 			if(convertedChars > 0)
 				timeOut = convertedTime;
 		}
+		else if(args[arg].size() > restoreTestArg.size() && args[arg].substr(0, restoreTestArg.size()) == restoreTestArg)
+		{
+			std::string copies			= args[arg].substr(restoreTestArg.size());
+			size_t		convertedChars	= 0;
+			int			convertedCopies	= 0;
+			try								{ convertedCopies = std::stoi(copies, &convertedChars); }
+			catch(std::invalid_argument &)	{}
+			catch(std::out_of_range &)		{}
+
+			if(convertedChars > 0 && convertedCopies > 0)
+				restoreTestCopies = convertedCopies;
+			else
+			{
+				std::cerr << "Argument " << restoreTestArg << " needs a positive number of copies!" << std::endl;
+				letsExplainSomeThings = true;
+			}
+		}
+		else if(args[arg].size() > filterTestArg.size() && args[arg].substr(0, filterTestArg.size()) == filterTestArg)
+		{
+			std::string steps			= args[arg].substr(filterTestArg.size());
+			size_t		convertedChars	= 0;
+			int			convertedSteps	= 0;
+			try								{ convertedSteps = std::stoi(steps, &convertedChars); }
+			catch(std::invalid_argument &)	{}
+			catch(std::out_of_range &)		{}
+
+			if(convertedChars > 0 && convertedSteps > 0)
+				filterTestSteps = convertedSteps;
+			else
+			{
+				std::cerr << "Argument " << filterTestArg << " needs a positive number of filters!" << std::endl;
+				letsExplainSomeThings = true;
+			}
+		}
 		else
 		{
 			const std::string	remoteDebuggingPort = "--remote-debugging-port=",
@@ -248,7 +335,10 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 					QFileInfo openMe(QSTRING_FILE_ARG(args[arg].c_str()));
 
 					if(startsWith("https:") || startsWith("http:") || openMe.exists())
+					{
 						filePath = args[arg];
+						batchPaths.append(QSTRING_FILE_ARG(args[arg].c_str()));
+					}
 					else
 					{
 						//Check whether it can be parsed as a json and if so assume it is a database connection json as returned by DatabaseConnectionInfo
@@ -272,13 +362,39 @@ void parseArguments(int argc, char *argv[], std::string & filePath, bool & unitT
 		letsExplainSomeThings = true;
 	}
 
+	if(filePath == "" && filterTestSteps > 0)
+	{
+		std::cerr << "If you want JASP to test filters you should also give it a datafile to filter." << std::endl;
+		letsExplainSomeThings = true;
+	}
+
+	if(batchDir != "")
+	{
+		if(batchPaths.isEmpty())
+		{
+			std::cerr << "If you want JASP to run a batch you should also give it one or more jaspfiles or folders to run." << std::endl;
+			letsExplainSomeThings = true;
+		}
+
+		if(enginePool == 0)
+			enginePool = std::max(1, QThread::idealThreadCount() / 2);
+	}
+	else if(batchRewriteImages)
+	{
+		std::cerr << rewriteImagesArg << " only makes sense together with " << batchArg << "." << std::endl;
+		letsExplainSomeThings = true;
+	}
+
 	if(letsExplainSomeThings)
 	{
-		std::cerr	<< "JASP can be started without arguments, or the following: { --help | -h | filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --logToFile | --hide } \n"
+		std::cerr	<< "JASP can be started without arguments, or the following: { --help | -h | filename | --unitTest filename | --unitTestRecursive folder | --save | --timeOut=10 | --restoreTest=10 filename | --filterTest=200 filename | --batch folder [--engines=4] [--rewriteImages] filenames/folders | --logToFile | --hide } \n"
 					<< "If a filename is supplied JASP will try to load it. \nIf --unitTest is specified JASP will refresh all analyses in \"filename\" (which must be a JASP file) and see if the output remains the same and will then exit with an errorcode indicating succes or failure.\n"
 					<< "If --unitTestRecursive is specified JASP will go through specified \"folder\" and perform a --unitTest on each JASP file. After it has done this it will exit with an errorcode indication succes or failure.\n"
 					<< "For both testing arguments there is the optional --save argument, which specifies that JASP should save the file after refreshing it.\n"
 					<< "For both testing arguments there is the optional --timeout argument, which specifies how many minutes JASP will wait for the analyses-refresh to take. Default is 10 minutes.\n"
+					<< "If --restoreTest=N is specified JASP will restore the analyses in \"filename\" N times over, first all at once and then a slice at a time like it does for users, and exit with an errorcode indicating whether both gave the same analyses. The time it took is written to the log.\n"
+					<< "If --filterTest=N is specified JASP will load the data in \"filename\", apply N random filters to it as if they came from R and exit with an errorcode indicating whether the views on the data showed exactly the rows passing each filter.\n"
+					<< "If --batch is specified JASP runs all analyses in the given jaspfiles (and those in given folders) one file after the other without showing anything, and writes their results and a batch-report.json with the timing, queue-wait and data-transfer of each analysis to the folder after --batch. It exits with an errorcode indicating whether all analyses completed. --engines=N sets how many engines may run analyses side by side, even of the same module, by default half the number of cores. --rewriteImages makes it rewrite all plots afterwards, as after a change of PPI or theme, and report how long that took and whether the analysis in view was redone first. --timeOut applies per file.\n"
 					<< "If --logToFile is specified then JASP will try it's utmost to write logging to a file, this might come in handy if you want to figure out why JASP does not start in case of a bug.\n"
 					<< "If --hide is specified then JASP will not be shown during recursive testing or reporting.\n"
 					<< "If --safeGraphics is specified then JASP will be started with software rendering enabled, this will be saved to your settings.\n"
@@ -377,14 +493,20 @@ int main(int argc, char *argv[])
 				logToFile,
 				hideJASP,
 				safeGraphics;
-	int			timeOut;
+	int			timeOut,
+				restoreTestCopies,
+				filterTestSteps,
+				enginePool;
+	bool		batchRewriteImages;
 	Json::Value	dbJson;
+	QString		batchDir;
+	QStringList	batchPaths;
 
 	QCoreApplication::setOrganizationName("JASP");
 	QCoreApplication::setOrganizationDomain("jasp-stats.org");
 	QCoreApplication::setApplicationName("JASP");
 	
-	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP, safeGraphics, dbJson, reportingDir);
+	parseArguments(argc, argv, filePath, unitTest, dirTest, timeOut, save, logToFile, hideJASP, safeGraphics, dbJson, reportingDir, restoreTestCopies, batchDir, batchPaths, enginePool, batchRewriteImages, filterTestSteps);
 	
 	if(safeGraphics)		Settings::setValue(Settings::SAFE_GRAPHICS_MODE, true);
 	else					safeGraphics = Settings::value(Settings::SAFE_GRAPHICS_MODE).toBool();
@@ -410,7 +532,7 @@ int main(int argc, char *argv[])
 				putenv(dst);
 			}
 			
-			if(hideJASP)
+			if(hideJASP || batchDir != "")
 			{
 				args.push_back("-platform");
 				args.push_back("minimal");
@@ -457,7 +579,8 @@ int main(int argc, char *argv[])
 
 			JASPTIMER_START("JASP");
 
-			QtWebEngineQuick::initialize(); // We can do this here and not in MainWindow::loadQML() (before QQmlApplicationEngine is instantiated) because that is called from a singleshot timer. And will only be executed once we enter a.exec() below!
+			if(batchDir == "") //A batch has no results page
+				QtWebEngineQuick::initialize(); // We can do this here and not in MainWindow::loadQML() (before QQmlApplicationEngine is instantiated) because that is called from a singleshot timer. And will only be executed once we enter a.exec() below!
 			std::cout << "QtWebEngineQuick initialized" << std::endl;
 
 			Application a(argvsize, argvs);
@@ -486,7 +609,7 @@ int main(int argc, char *argv[])
 			}
 #endif
 			
-			a.init(filePathQ, unitTest, timeOut, save, logToFile, dbJson, reportingDir);
+			a.init(filePathQ, unitTest, timeOut, save, logToFile, dbJson, reportingDir, restoreTestCopies, batchDir, batchPaths, enginePool, batchRewriteImages, filterTestSteps);
 			
 			try 
 			{
@@ -28,8 +28,10 @@
 #include <QtWebEngineQuick/qtwebenginequickglobal.h>
 #include <QAction>
 #include <QMenuBar>
+#include <QSortFilterProxyModel>
 
 #include <iostream>
+#include <random>
 
 #include "log.h"
 #include "dirs.h"
@@ -82,7 +84,9 @@
 #include "utilities/appdirs.h"
 #include "utilities/settings.h"
 #include "utilities/qmlutils.h"
+#include "utilities/qmlcomponentcache.h"
 #include "utilities/reporter.h"
+#include "utilities/imagecache.h"
 
 #include "widgets/filemenu/filemenu.h"
 #include "rsyntax/formulabase.h"
@@ -259,8 +263,8 @@ QString MainWindow::windowTitle() const
 
 bool MainWindow::checkDoSync()
 {
-	//Only do this if we are *not* running in reporting mode. 
-	if (!_reporter && checkAutomaticSync() && !MessageForwarder::showYesNo(tr("Datafile changed"), tr("The datafile that was used by this JASP file was modified. Do you want to reload the analyses with this new data?")))
+	//Only do this if we are *not* running in reporting or batch mode.
+	if (!_reporter && !_batchRunner && checkAutomaticSync() && !MessageForwarder::showYesNo(tr("Datafile changed"), tr("The datafile that was used by this JASP file was modified. Do you want to reload the analyses with this new data?")))
 	{
 		_preferences->setDataAutoSynchronization(false);
 		return false;
@@ -280,6 +284,7 @@ void MainWindow::startOnlineDataManager()
 }
 
 Q_DECLARE_METATYPE(columnType)
+Q_DECLARE_METATYPE(ColumnChanges)
 
 void MainWindow::makeConnections()
 {
@@ -291,6 +296,8 @@ void MainWindow::makeConnections()
 	connect(_package,				&DataSetPackage::datasetChanged,					_filterModel,			&FilterModel::datasetChanged,								Qt::QueuedConnection);
 	connect(_package,				&DataSetPackage::datasetChanged,					_computedColumnsModel,	&ComputedColumnsModel::datasetChanged,						Qt::QueuedConnection);
 	connect(_package,				&DataSetPackage::datasetChanged,					_columnsModel,			&ColumnsModel::datasetChanged,								Qt::QueuedConnection);
+	connect(_package,				&DataSetPackage::labelsReordered,					_filterModel,			&FilterModel::labelsOfColumnChanged,						Qt::QueuedConnection);
+	connect(_package,				&DataSetPackage::labelChanged,						_filterModel,			[this](QString columnName, QString, QString) { _filterModel->labelsOfColumnChanged(columnName); }, Qt::QueuedConnection);
 	connect(_package,				&DataSetPackage::isModifiedChanged,					this,					&MainWindow::packageChanged									);
 	connect(_package,				&DataSetPackage::windowTitleChanged,				this,					&MainWindow::windowTitleChanged								);
 	connect(_package,				&DataSetPackage::columnDataTypeChanged,				_computedColumnsModel,	&ComputedColumnsModel::recomputeColumn						);
@@ -309,6 +316,7 @@ void MainWindow::makeConnections()
 	connect(_engineSync,			&EngineSync::plotEditorRefresh,						_plotEditorModel,		&PlotEditorModel::refresh									);
 
 	qRegisterMetaType<columnType>();
+	qRegisterMetaType<ColumnChanges>();
 	qRegisterMetaType<ListModel*>();
 	qRegisterMetaType<DbType>();
 
@@ -328,6 +336,7 @@ void MainWindow::makeConnections()
 	connect(_resultsJsInterface,	&ResultsJsInterface::openFileTab,					_fileMenu,				&FileMenu::showFileOpenMenu									);
 	connect(_resultsJsInterface,	&ResultsJsInterface::removeAnalysisRequest,			_analyses,				&Analyses::removeAnalysisById								);
 	connect(_resultsJsInterface,	&ResultsJsInterface::analysisSelected,				_analyses,				&Analyses::analysisIdSelectedInResults						);
+	connect(_resultsJsInterface,	&ResultsJsInterface::analysesInViewChanged,			_analyses,				&Analyses::setAnalysesInView								);
 	connect(_resultsJsInterface,	&ResultsJsInterface::analysisUnselected,			_analyses,				&Analyses::analysesUnselectedInResults						);
 	connect(_resultsJsInterface,	&ResultsJsInterface::analysisTitleChangedInResults,	_analyses,				&Analyses::analysisTitleChangedInResults					);
 	connect(_resultsJsInterface,	&ResultsJsInterface::duplicateAnalysis,				_analyses,				&Analyses::duplicateAnalysis								);
@@ -343,6 +352,7 @@ void MainWindow::makeConnections()
 	connect(_analyses,				&Analyses::analysisImageSaved,						this,					&MainWindow::analysisImageSavedHandler						);
 	connect(_analyses,				&Analyses::emptyQMLCache,							this,					&MainWindow::resetQmlCache									);
 	connect(_analyses,				&Analyses::analysisAdded,							this,					&MainWindow::analysisAdded									);
+	connect(_analyses,				&Analyses::analysesRestored,						this,					&MainWindow::analysesRestored								);
 	connect(_analyses,				&Analyses::analysisAdded,							_fileMenu,				&FileMenu::analysisAdded									);
 	connect(_analyses,				&Analyses::analysesExportResults,					_fileMenu,				&FileMenu::analysesExportResults							);
 	connect(_analyses,				&Analyses::analysisStatusChanged,					_resultsJsInterface,	&ResultsJsInterface::setStatus								);
@@ -414,6 +424,9 @@ void MainWindow::makeConnections()
 	connect(_dynamicModules,		&DynamicModules::reloadQmlImportPaths,				this,					&MainWindow::setQmlImportPaths,								Qt::QueuedConnection); //If this is queued this should make the loadingprocess of qml a bit less weird I think.
 	connect(_dynamicModules,		&DynamicModules::dynamicModuleUnloadBegin,			_engineSync,			&EngineSync::killModuleEngine								);
 	connect(_dynamicModules,		&DynamicModules::isModuleInstallRequestActive,		_engineSync,			&EngineSync::isModuleInstallRequestActive					);
+	connect(_dynamicModules,		&DynamicModules::dynamicModuleChanged,				this,					[](Modules::DynamicModule * mod)						{ ImageCache::cache()->forget(tq(mod->moduleInstFolder())); });
+	connect(_dynamicModules,		&DynamicModules::dynamicModuleUnloadBegin,			this,					[](Modules::DynamicModule * mod)						{ ImageCache::cache()->forget(tq(mod->moduleInstFolder())); });
+	connect(_dynamicModules,		&DynamicModules::dynamicModuleReplaced,				this,					[](Modules::DynamicModule * oldMod, Modules::DynamicModule *)	{ ImageCache::cache()->forget(tq(oldMod->moduleInstFolder())); }, Qt::DirectConnection);
 
 	connect(_languageModel,			&LanguageModel::currentLanguageChanged,				_fileMenu,				&FileMenu::refresh											);
 	connect(_languageModel,			&LanguageModel::aboutToChangeLanguage,				_analyses,				&Analyses::prepareForLanguageChange							);
@@ -540,6 +553,21 @@ void MainWindow::loadQML()
 		connect(_preferences,		&PreferencesModel::maxFlickVelocityChanged, 	keyval.second,		&JaspTheme::maxFlickVeloHandler				);
 	}
 
+	if(_batchRunner)
+	{
+		//No windows and no results page, only what is needed to load the modules and run their analyses
+		_upgrader->loadOldSchoolUpgrades();
+		disconnect(exitOnFailConnection);
+
+		_ribbonModel->loadModules(
+			ActiveModules::getActiveCommonModules(),
+			ActiveModules::getActiveExtraModules());
+
+		_qmlLoaded = _resultsPageLoaded = true;
+		_batchRunner->start();
+		return;
+	}
+
 	Log::log() << "Loading HelpWindow"  << std::endl; _qml->load(QUrl("qrc:///components/JASP/Widgets/HelpWindow.qml"));
 	Log::log() << "Loading AboutWindow" << std::endl; _qml->load(QUrl("qrc:///components/JASP/Widgets/AboutWindow.qml"));
 	Log::log() << "Loading MainWindow"  << std::endl; _qml->load(QUrl("qrc:///components/JASP/Widgets/MainWindow.qml"));
@@ -857,7 +885,8 @@ void MainWindow::analysisResultsChangedHandler(Analysis *analysis)
 		showInstructions = false;
 	}
 
-	_resultsJsInterface->analysisChanged(analysis);
+	if(!_batchRunner) //There is no results page to show it on
+		_resultsJsInterface->analysisChanged(analysis);
 
 	setPackageModified();
 
@@ -985,15 +1014,17 @@ void MainWindow::dataSetIORequestHandler(FileEvent *event)
 			setWelcomePageVisible(false);
 
 			_loader->io(event);
-			showProgress();
+			showProgress(true);
 		}
 	}
 	else if (event->operation() == FileEvent::FileSave)
 	{
 		connectFileEventCompleted(event);
 		
+		_analyses->finishRestoring();
 		_resultsJsInterface->exportPreviewHTML();
 		_package->setAnalysesData(_analyses->asJson());
+		_engineSync->saveAnalysisStates(); //The engines keep them in memory, JASPExporter archives their files
 
 		_loader->io(event);
 		showProgress();
@@ -1109,7 +1140,7 @@ void MainWindow::dataSetIOCompleted(FileEvent *event)
 			if(event->osfPath() != "")
 				_package->setFolder("OSF://" + event->osfPath()); //It is also set by setCurrentPath, but then we get some weirdlooking OSF path
 
-			if (event->type() == Utils::FileType::jasp)
+			if (event->type() == Utils::FileType::jasp && !_batchRunner) //A batch runs on the data as stored in the file
 			{
 				if(!_package->dataFilePath().empty() && !_package->dataFileReadOnly() && strncmp("http", _package->dataFilePath().c_str(), 4) != 0)
 				{
@@ -1143,12 +1174,18 @@ void MainWindow::dataSetIOCompleted(FileEvent *event)
 			else if(_reporter && !_reporter->isJaspFileNotDabaseOrSynching())
 					exit(12);			
 		}
+		else if(_batchRunner)
+		{
+			_package->reset();
+			_batchRunner->fileFailed(event->message());
+		}
 		else
 		{
 			_package->reset();
 			setWelcomePageVisible(true);
 
-			MessageForwarder::showWarning(tr("Unable to open file because:\n%1").arg(event->message()));
+			if(!event->isCancelled())
+				MessageForwarder::showWarning(tr("Unable to open file because:\n%1").arg(event->message()));
 
 			if (_openedUsingArgs)	exit(3);
 
@@ -1220,26 +1257,59 @@ void MainWindow::dataSetIOCompleted(FileEvent *event)
 void MainWindow::populateUIfromDataSet()
 {
 	JASPTIMER_SCOPE(MainWindow::populateUIfromDataSet);
-	bool errorFound = false;
-	stringstream errorMsg;
 
 	_resultsJsInterface->setScrollAtAll(false);
 
-	_analyses->loadAnalysesFromDatasetPackage(errorFound, errorMsg, _ribbonModel);
+	setDataAvailable((_package->rowCount() > 0 || _package->columnCount() > 0));
+
+	if(_restoreTestCopies > 0)
+	{
+		startRestoreTest();
+		return;
+	}
+
+	if(_filterTestSteps > 0)
+	{
+		QTimer::singleShot(0, this, &MainWindow::runFilterTest);
+		return;
+	}
+
+	//Unit tests and reports expect all analyses to be there once the file is loaded, otherwise they show up while the user can already look around
+	bool progressive = !resultXmlCompare::compareResults::theOne()->testMode() && !_reporter && !_batchRunner;
+
+	_analyses->loadAnalysesFromDatasetPackage(_ribbonModel, progressive);
+}
+
+void MainWindow::analysesRestored(bool errorFound, QString errorMsg)
+{
+	JASPTIMER_SCOPE(MainWindow::analysesRestored);
+
+	if(_restoreTestCopies > 0)
+	{
+		restoreTestStep();
+		return;
+	}
+
+	if(_batchRunner)
+	{
+		hideProgress();
+		matchComputedColumnsToAnalyses();
+		_package->setLoaded();
+		_batchRunner->analysesRestored(errorFound, errorMsg);
+		return;
+	}
 
 	if (_analyses->count() == 1 && !resultXmlCompare::compareResults::theOne()->testMode()) //I do not want to see QML forms in unit test mode to make sure stuff breaks when options are changed
 		(*_analyses)[0]->expandAnalysis(); //Show options for only analysis
 
 	bool hasAnalyses = _analyses->count() > 0;
 
-	setDataAvailable((_package->rowCount() > 0 || _package->columnCount() > 0));
-
 	hideProgress();
 
 	_analyses->setVisible(hasAnalyses && !resultXmlCompare::compareResults::theOne()->testMode());
 
 	if (_package->warningMessage() != "")	MessageForwarder::showWarning(_package->warningMessage());
-	else if (errorFound)					MessageForwarder::showWarning(errorMsg.str());
+	else if (errorFound)					MessageForwarder::showWarning(errorMsg);
 
 	matchComputedColumnsToAnalyses();
 
@@ -1624,16 +1694,31 @@ void MainWindow::startDataEditor(QString path)
 		}
 }
 
-void MainWindow::showProgress()
+void MainWindow::showProgress(bool cancellable)
 {
 	_fileMenu->setVisible(false);
 
 	setProgressBarVisible(true);
+
+	_progressCancellable = cancellable;
+	emit progressCancellableChanged(_progressCancellable);
 }
 
 void MainWindow::hideProgress()
 {
 	setProgressBarVisible(false);
+
+	_progressCancellable = false;
+	emit progressCancellableChanged(_progressCancellable);
+}
+
+void MainWindow::cancelProgress()
+{
+	if(!_progressCancellable)
+		return;
+
+	setProgressBarStatus(tr("Cancelling..."));
+	_loader->cancel(); //Called directly, the loader thread is busy and checks for this whenever it reports progress
 }
 
 
@@ -1654,11 +1739,205 @@ void MainWindow::testLoadedJaspFile(int timeOut, bool save)
 	QTimer::singleShot(60000 * timeOut, this, &MainWindow::unitTestTimeOut);
 }
 
+void MainWindow::testRestoringAnalyses(int copies)
+{
+	Log::log() << "Will restore the analyses of the file " << copies << " times over, once at once and once progressively, and compare them." << std::endl;
+	_restoreTestCopies = std::max(1, copies);
+}
+
+void MainWindow::startRestoreTest()
+{
+	Json::Value	analysesData	= _package->analysesData(),
+				original		= analysesData.isArray() ? analysesData : analysesData.get("analyses", Json::arrayValue),
+				multiplied		= Json::arrayValue;
+	size_t		idRange			= 0;
+
+	for(const Json::Value & analysis : original)
+		idRange = std::max<size_t>(idRange, analysis["id"].asUInt() + 1);
+
+	for(int copy = 0; copy < _restoreTestCopies; copy++)
+		for(Json::Value analysis : original)
+		{
+			analysis["id"] = Json::UInt(analysis["id"].asUInt() + copy * idRange);
+			multiplied.append(analysis);
+		}
+
+	if(analysesData.isArray())	analysesData				= multiplied;
+	else						analysesData["analyses"]	= multiplied;
+
+	_package->setAnalysesData(analysesData);
+
+	_restoreTestEager = Json::nullValue;
+	_analyses->loadAnalysesFromDatasetPackage(_ribbonModel, false);
+}
+
+void MainWindow::restoreTestStep()
+{
+	//The forms set some of the options, so they all have to be there before the analyses can be compared
+	if(_analyses->formsPending())
+	{
+		QTimer::singleShot(50, this, &MainWindow::restoreTestStep);
+		return;
+	}
+
+	if(_restoreTestEager.isNull())
+	{
+		_restoreTestEager = _analyses->asJson();
+
+		QTimer::singleShot(0, this, [this]()
+		{
+			_analyses->clear();
+			_analyses->loadAnalysesFromDatasetPackage(_ribbonModel, true);
+		});
+		return;
+	}
+
+	Json::Value progressive = _analyses->asJson();
+	bool		same		= progressive == _restoreTestEager;
+
+	std::cout << "Restored " << _analyses->count() << " analyses progressively, " << (same ? "they are the same as when restored all at once." : "they DIFFER from when restored all at once!") << std::endl;
+
+	if(!same)
+		for(Json::ArrayIndex i=0; i<std::min(progressive["analyses"].size(), _restoreTestEager["analyses"].size()); i++)
+			if(progressive["analyses"][i] != _restoreTestEager["analyses"][i])
+			{
+				std::cerr << "First difference is in analysis " << i << ":\n" << progressive["analyses"][i].toStyledString() << "\nversus:\n" << _restoreTestEager["analyses"][i].toStyledString() << std::endl;
+				break;
+			}
+
+	exit(same ? 0 : 1);
+}
+
+void MainWindow::testFilterChanges(int steps)
+{
+	Log::log() << "Will apply " << steps << " random filters to the data and check what the views on it show." << std::endl;
+	_filterTestSteps = steps;
+}
+
+///Applies random filters through DataSetPackage::setFilterData, as if they came back from R, with proxies on the filter and data subnodes that only let through rows passing the filter.
+///Those only get the rows right if setFilterData tells them about every row that changed, through the right parent and with the right roles.
+void MainWindow::runFilterTest()
+{
+	const int	rows		= _package->dataRowCount();
+	int			failures	= 0,
+				resets		= 0,
+				changes		= 0;
+
+	auto check = [&](bool ok, const std::string & what)
+	{
+		if(!ok && failures++ < 10)
+			std::cerr << "FAILED: " << what << std::endl;
+	};
+
+	if(rows == 0)
+	{
+		std::cerr << "There are no rows to filter in this file!" << std::endl;
+		exit(1);
+	}
+
+	auto passingRows = [&](QAbstractItemModel * subNode, int role)
+	{
+		QSortFilterProxyModel * proxy = new QSortFilterProxyModel(this);
+		proxy->setFilterRole(role);
+		proxy->setFilterFixedString("true");
+		proxy->setDynamicSortFilter(true);
+		proxy->setSourceModel(subNode);
+		return proxy;
+	};
+
+	QSortFilterProxyModel	*	filterProxy	= passingRows(_package->filterSubModel(),	Qt::DisplayRole),
+							*	dataProxy	= passingRows(_package->dataSubModel(),		int(DataSetPackage::specialRoles::filter));
+
+	QMetaObject::Connection resetCounter	= connect(_package, &DataSetPackage::modelReset,	this, [&]() { resets++; }),
+							changeChecker	= connect(_package, &DataSetPackage::dataChanged,	this, [&](const QModelIndex & topLeft, const QModelIndex & bottomRight)
+	{
+		changes++;
+		check(topLeft.isValid() && bottomRight.isValid() && topLeft.parent() == bottomRight.parent(),											"dataChanged is about rows under one parent");
+		check(bottomRight.row() < _package->rowCount(topLeft.parent()) && bottomRight.column() < _package->columnCount(topLeft.parent()),		"dataChanged stays within its parent");
+	});
+
+	std::mt19937		random(47);
+	std::vector<bool>	filter(rows, true);
+	auto				chance		= [&](double p)			{ return std::uniform_real_distribution<double>(0, 1)(random) < p;	};
+	auto				between		= [&](int lo, int hi)	{ return std::uniform_int_distribution<int>(lo, hi)(random);		};
+
+	for(int step=0; step<_filterTestSteps; step++)
+	{
+		switch(step % 4)
+		{
+		case 0: //Some block of rows is toggled, like a filter on a range of values of a sorted column
+		{
+			int from = between(0, rows - 1), to = std::min(rows, from + between(1, std::max(1, rows / 10)));
+			for(int r=from; r<to; r++)
+				filter[r] = !filter[r];
+			break;
+		}
+
+		case 1: //A handful of random rows
+			for(int i=0; i<10; i++)
+			{
+				int r		= between(0, rows - 1);
+				filter[r]	= !filter[r];
+			}
+			break;
+
+		case 2: //Every row has a chance, which is what a filter on a noisy column does
+			for(int r=0; r<rows; r++)
+				if(chance(0.3))
+					filter[r] = !filter[r];
+			break;
+
+		case 3: //The filter is undone, sometimes it was already
+			if(chance(0.5))
+				filter.assign(rows, true);
+			break;
+		}
+
+		_package->setFilterData(_package->dataFilter(), filter);
+
+		const int passing = int(std::count(filter.begin(), filter.end(), true));
+
+		check(filterProxy->rowCount() == passing && dataProxy->rowCount() == passing,	"the proxies show as many rows as pass filter " + std::to_string(step));
+
+		for(int r=0, proxyRow=0; r<rows && proxyRow < dataProxy->rowCount(); r++)
+			if(filter[r])
+				check(dataProxy->mapToSource(dataProxy->index(proxyRow++, 0)).row() == r,	"the data proxy shows exactly the rows passing filter " + std::to_string(step));
+	}
+
+	disconnect(resetCounter);
+	disconnect(changeChecker);
+
+	check(changes > 0 && resets > 0,																"both dataChanged for runs of rows and resets for scattered changes happened");
+
+	std::cout << "Applied " << _filterTestSteps << " random filters to " << rows << " rows with " << changes << " dataChanged signals and " << resets << " resets, "
+			  << (failures == 0 ? "the views showed exactly the rows passing each of them." : "the views did NOT show the rows passing them!") << std::endl;
+
+	exit(failures == 0 ? 0 : 1);
+}
+
 void MainWindow::reportHere(QString dir)
 {
 	_reporter = new Reporter(this, dir);
 }
 
+void MainWindow::runBatch(const QStringList & paths, QString outputDir, int enginePool, int timeOut, bool rewriteImages)
+{
+	_batchRunner = new BatchRunner(this, paths, QDir(outputDir), enginePool, timeOut, rewriteImages);
+
+	_engineSync->setEnginePool(enginePool);
+
+	connect(_analyses,		&Analyses::analysisStatusChanged,		_batchRunner,	&BatchRunner::analysisStatusChanged	);
+	connect(_engineSync,	&EngineSync::analysisRequestSent,		_batchRunner,	&BatchRunner::analysisRequestSent	);
+	connect(_engineSync,	&EngineSync::analysisReplyReceived,		_batchRunner,	&BatchRunner::analysisReplyReceived	);
+	connect(_batchRunner,	&BatchRunner::rewriteAllPlots,			_engineSync,	&EngineSync::refreshAllPlots		);
+	connect(_batchRunner,	&BatchRunner::openFile,					this,			[this](const QString & path) { _fileMenu->open(path); });
+	connect(_batchRunner,	&BatchRunner::closeFile,				this,			[this]()
+	{
+		_package->setModified(false); //Nobody to ask whether it should be saved
+		_fileMenu->close();
+	});
+}
+
 void MainWindow::unitTestTimeOut()
 {
 	//If we are showing the user whatever went wrong we shouldnt close JASP automatically because it could get confusing
@@ -1827,6 +2106,7 @@ void MainWindow::setAnalysesAvailable(bool analysesAvailable)
 void MainWindow::resetQmlCache()
 {
 	_qml->clearComponentCache();
+	QmlComponentCache::cache(_qml)->clear();
 }
 
 void MainWindow::makeAppleMenu()
@@ -53,6 +53,7 @@
 #include "utilities/jsonutilities.h"
 #include "utilities/helpmodel.h"
 #include "utilities/reporter.h"
+#include "utilities/batchrunner.h"
 #include "utilities/codepageswindows.h"
 #include "widgets/filemenu/filemenu.h"
 
@@ -75,6 +76,7 @@ class MainWindow : public QObject
 	Q_PROPERTY(bool		progressBarVisible	READ progressBarVisible		WRITE setProgressBarVisible		NOTIFY progressBarVisibleChanged	)
 	Q_PROPERTY(int		progressBarProgress	READ progressBarProgress	WRITE setProgressBarProgress	NOTIFY progressBarProgressChanged	)
 	Q_PROPERTY(QString	progressBarStatus	READ progressBarStatus		WRITE setProgressBarStatus		NOTIFY progressBarStatusChanged		)
+	Q_PROPERTY(bool		progressCancellable	READ progressCancellable									NOTIFY progressCancellableChanged	)
 	Q_PROPERTY(QString	windowTitle			READ windowTitle											NOTIFY windowTitleChanged			)
 	Q_PROPERTY(int		screenPPI			READ screenPPI				WRITE setScreenPPI				NOTIFY screenPPIChanged				)
 	Q_PROPERTY(bool		dataAvailable		READ dataAvailable											NOTIFY dataAvailableChanged			)
@@ -89,13 +91,17 @@ public:
 	void open(QString filepath);
 	void open(const Json::Value & dbJson);
 	void testLoadedJaspFile(int timeOut, bool save);
+	void testRestoringAnalyses(int copies);
+	void testFilterChanges(int steps);
 	void reportHere(QString dir);
+	void runBatch(const QStringList & paths, QString outputDir, int enginePool, int timeOut, bool rewriteImages);
 
 	~MainWindow() override;
 
 	bool	progressBarVisible()	const	{ return _progressBarVisible;	}
 	int		progressBarProgress()	const	{ return _progressBarProgress;	}
 	QString	progressBarStatus()		const	{ return _progressBarStatus;	}
+	bool	progressCancellable()	const	{ return _progressCancellable;	}
 	QString	windowTitle()			const;
 	int		screenPPI()				const	{ return _screenPPI;			}
 	bool	dataAvailable()			const	{ return _dataAvailable;		}
@@ -113,6 +119,7 @@ public slots:
 	void setProgressBarVisible(bool progressBarVisible);
 	void setWelcomePageVisible(bool welcomePageVisible);
 	void setProgressBarStatus(QString progressBarStatus);
+	void cancelProgress();
 	void setAnalysesAvailable(bool analysesAvailable);
 	void setDataAvailable(bool dataAvailable);
 	void setScreenPPI(int screenPPI);
@@ -198,6 +205,7 @@ signals:
 	void progressBarVisibleChanged(	bool		progressBarVisible);
 	void progressBarProgressChanged(int			progressBarProgress);
 	void progressBarStatusChanged(	QString		progressBarStatus);
+	void progressCancellableChanged(bool		progressCancellable);
 	void dataPanelVisibleChanged(	bool		dataPanelVisible);
 	void analysesVisibleChanged(	bool		analysesVisible);
 	void windowTitleChanged();
@@ -218,19 +226,23 @@ private slots:
 	void dataSetIORequestHandler(FileEvent *event);
 	void dataSetIOCompleted(FileEvent *event);
 	void populateUIfromDataSet();
+	void analysesRestored(bool errorFound, QString errorMsg);
 	void startDataEditorEventCompleted(FileEvent *event);
 	void analysisAdded(Analysis *analysis);
 	void resendResultsToWebEngine();
 
 	void fatalError();
 	void closeVariablesPage();
-	void showProgress();
+	void showProgress(bool cancellable = false);
 	void hideProgress();
 	void setProgressStatus(QString status, int progress);
 	void showAnalysis() { emit hideDataPanel(); _analyses->setVisible(true); }
 
 	bool checkDoSync();
 	void unitTestTimeOut();
+	void startRestoreTest();
+	void restoreTestStep();
+	void runFilterTest();
 	void saveJaspFileHandler();
 	void logToFileChanged(bool logToFile);
 	void logRemoveSuperfluousFiles(int maxFilesToKeep);
@@ -280,6 +292,7 @@ private:
 	JaspTheme					*	_jaspTheme				= nullptr;
 	Upgrader					*	_upgrader				= nullptr;
 	Reporter					*	_reporter				= nullptr;
+	BatchRunner					*	_batchRunner			= nullptr;
 	CodePagesWindows			*	_windowsWorkaroundCPs	= nullptr;
 
 	QSettings						_settings;
@@ -291,7 +304,10 @@ private:
 									_fatalError				= "The engine crashed...",
 									_progressBarStatus,
 									_downloadNewJASPUrl		= "";
-	Json::Value						_openOnLoadDbJson		= Json::nullValue;
+	Json::Value						_openOnLoadDbJson		= Json::nullValue,
+									_restoreTestEager		= Json::nullValue;	///< The analyses as restored all at once, to compare the progressively restored ones with
+	int								_restoreTestCopies		= 0,
+									_filterTestSteps		= 0;
 
 	AsyncLoader					*	_loader					= nullptr;
 	AsyncLoaderThread				_loaderThread;
@@ -302,6 +318,7 @@ private:
 									_openedUsingArgs		= false,
 									_runButtonEnabled		= false,
 									_progressBarVisible		= false,
+									_progressCancellable	= false,
 									_dataAvailable			= false,
 									_analysesAvailable		= false,
 									_savingForClose			= false,
@@ -4,11 +4,13 @@
 #include <QSGGeometry>
 #include <QSGNode>
 #include <queue>
+#include <algorithm>
 #include "timers.h"
 #include "log.h"
 #include "gui/preferencesmodel.h"
 #include "jasptheme.h"
 #include <QScreen>
+#include <QTimer>
 #include "data/datasetpackage.h"
 #include <iostream>
 
@@ -55,6 +57,8 @@ void DataSetView::setModel(QAbstractItemModel * model)
 		_model = model;
 
 		connect(_model, &QAbstractItemModel::dataChanged,			this, &DataSetView::modelDataChanged		);
+		connect(_model, &QAbstractItemModel::rowsInserted,			this, &DataSetView::modelRowsChanged		);
+		connect(_model, &QAbstractItemModel::rowsRemoved,			this, &DataSetView::modelRowsChanged		);
 		connect(_model, &QAbstractItemModel::headerDataChanged,		this, &DataSetView::modelHeaderDataChanged	);
 		connect(_model, &QAbstractItemModel::modelAboutToBeReset,	this, &DataSetView::modelAboutToBeReset		);
 		connect(_model, &QAbstractItemModel::modelReset,			this, &DataSetView::modelWasReset			);
@@ -112,6 +116,15 @@ QSizeF DataSetView::getRowHeaderSize()
 
 void DataSetView::modelDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
 {
+	const int	filterRole	= int(DataSetPackage::specialRoles::filter),
+				linesRole	= int(DataSetPackage::specialRoles::lines);
+
+	if(roles.size() && std::all_of(roles.begin(), roles.end(), [&](int role) { return role == filterRole || role == linesRole; }))
+	{
+		modelFilterChanged(topLeft.row(), bottomRight.row());
+		return;
+	}
+
 	int col = topLeft.column();
 	QSizeF calcSize = getColumnSize(col);
 
@@ -150,6 +163,56 @@ void DataSetView::modelDataChanged(const QModelIndex &topLeft, const QModelIndex
 
 }
 
+///Whether a row is active doesn't change the size of anything, so only the lines and the items of those rows are redone
+void DataSetView::modelFilterChanged(int firstRow, int lastRow)
+{
+	if(firstRow < 0 || lastRow < firstRow)
+		return;
+
+	_storedLineFlags.erase(_storedLineFlags.lower_bound(firstRow), _storedLineFlags.upper_bound(lastRow));
+
+	for(auto & col : _cellTextItems)
+		for(auto row = col.second.lower_bound(firstRow); row != col.second.end() && row->first <= lastRow; row++)
+			if(row->second)
+				setStyleDataItem(row->second->context, _model->data(_model->index(row->first, col.first), _roleNameToRole["filter"]).toBool(), col.first, row->first);
+
+	queueViewportChanged();
+}
+
+///A proxy hiding inactive rows inserts and removes them when the filter changes, that moves all rows below so those are laid out again, once
+void DataSetView::modelRowsChanged()
+{
+	queueCalculateCellSizes();
+}
+
+void DataSetView::queueViewportChanged()
+{
+	if(_viewportChangeQueued)
+		return;
+
+	_viewportChangeQueued = true;
+
+	QTimer::singleShot(0, this, [&]()
+	{
+		_viewportChangeQueued = false;
+		viewportChanged();
+	});
+}
+
+void DataSetView::queueCalculateCellSizes()
+{
+	if(_cellSizesQueued)
+		return;
+
+	_cellSizesQueued = true;
+
+	QTimer::singleShot(0, this, [&]()
+	{
+		_cellSizesQueued = false;
+		calculateCellSizes();
+	});
+}
+
 void DataSetView::modelHeaderDataChanged(Qt::Orientation, int, int)
 {
 	calculateCellSizes();
@@ -146,6 +146,7 @@ public slots:
 	void reloadColumnHeaders();
 
 	void modelDataChanged(const QModelIndex &, const QModelIndex &, const QVector<int> &);
+	void modelRowsChanged();
 	void modelHeaderDataChanged(Qt::Orientation, int, int);
 	void modelAboutToBeReset();
 	void modelWasReset();
@@ -157,6 +158,9 @@ protected:
 	void determineCurrentViewPortIndices();
 	void storeOutOfViewItems();
 	void buildNewLinesAndCreateNewItems();
+	void modelFilterChanged(int firstRow, int lastRow);
+	void queueViewportChanged();
+	void queueCalculateCellSizes();
 
 #ifdef DATASETVIEW_ADD_LINES_PLEASE
 	QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
@@ -205,7 +209,9 @@ protected:
 														*	_tableViewItem		= nullptr;
 
 	bool		_recalculateCellSizes	= false,
-				_ignoreViewpoint		= true;
+				_ignoreViewpoint		= true,
+				_viewportChangeQueued	= false,	///< A filter change can come as many small dataChanged signals, these make sure the view is redone only once for them
+				_cellSizesQueued		= false;
 
 	double		_dataRowsMaxHeight,
 				_dataWidth				= -1,
@@ -29,6 +29,7 @@
 #include "appinfo.h"
 #include "tempfiles.h"
 #include <functional>
+#include <algorithm>
 #include "timers.h"
 #include "utilities/settings.h"
 #include <QMimeData>
@@ -37,6 +38,8 @@
 #include <QApplication>
 #include "gui/preferencesmodel.h"
 #include <QThread>
+#include <QDateTime>
+#include "analysis/analyses.h"
 #include "log.h"
 
 ResultsJsInterface * ResultsJsInterface::_singleton = nullptr;
@@ -47,7 +50,11 @@ ResultsJsInterface::ResultsJsInterface(QObject *parent) : QObject(parent)
 
 	connect(this, &ResultsJsInterface::zoomChanged,					this, &ResultsJsInterface::setZoomInWebEngine);
 	connect(this, &ResultsJsInterface::runJavaScriptSignalQueued,	this, &ResultsJsInterface::runJavaScriptSignal, Qt::QueuedConnection);
-	
+
+	_resultsCallTimer.setSingleShot(true);
+	_resultsCallTimer.setInterval(16);
+	_resultsCallTimer.setTimerType(Qt::PreciseTimer);
+	connect(&_resultsCallTimer,		&QTimer::timeout,				this, &ResultsJsInterface::flushResultsCalls);
 
 	setZoom(Settings::value(Settings::UI_SCALE).toDouble());
 }
@@ -77,6 +84,37 @@ void ResultsJsInterface::setResultsLoaded(bool resultsLoaded)
 		return;
 
 	_resultsLoaded = resultsLoaded;
+
+	if(!resultsLoaded && _channelReady)
+	{
+		//The page is (re)loading and its WebChannel goes with it, whatever was waiting for it goes in the queue of javascript instead, in the same order
+		std::vector<ResultsCall> pending;
+		pending.swap(_pendingCalls);
+		_pendingChanges.clear();
+		_resultsCallTimer.stop();
+		_channelReady = false;
+
+		for(ResultsCall & call : pending)
+		{
+			if(call.function == "analysisChanged")
+			{
+				Analysis * analysis = Analyses::analyses()->get(call.analysisId);
+
+				if(!analysis)
+				{
+					_updatesDropped++;
+					continue;
+				}
+
+				call.args = Json::arrayValue;
+				call.args.append(analysis->asJSON());
+			}
+
+			if(!call.function.empty())
+				runJavaScript(javaScriptCall(call.function, call.args));
+		}
+	}
+
 	emit resultsLoadedChanged(_resultsLoaded);
 
 	if (resultsLoaded)
@@ -164,18 +202,12 @@ void ResultsJsInterface::saveTempImage(int id, QString path, QByteArray data)
 
 void ResultsJsInterface::analysisImageEditedHandler(Analysis *analysis)
 {
-	Json::Value imgJson = analysis->imgResults();
-	QString	results = tq(imgJson.toStyledString());
-	results = escapeJavascriptString(results);
-	results = "window.refreshEditedImage(" + QString::number(analysis->id()) + ", JSON.parse('" + results + "'));";
-	runJavaScript(results);
-
-	return;
+	callInResults("refreshEditedImage", { Json::UInt64(analysis->id()), analysis->imgResults() }, analysis->id());
 }
 
 void ResultsJsInterface::cancelImageEdit(int id)
 {
-	runJavaScript("window.cancelImageEdit(" + QString::number(id) + ");");
+	callInResults("cancelImageEdit", { id }, id);
 }
 
 void ResultsJsInterface::menuHiding()
@@ -258,58 +290,176 @@ void ResultsJsInterface::displayMessageFromResults(QString msg)
 
 void ResultsJsInterface::setStatus(Analysis *analysis)
 {
-	int id = analysis->id();
-	QString status = analysis->statusQ();
-
-	runJavaScript("window.setStatus(" + QString::number(id) + ", '" + status + "')");
+	callInResults("setStatus", { Json::UInt64(analysis->id()), fq(analysis->statusQ()) }, analysis->id());
 }
 
 void ResultsJsInterface::changeTitle(Analysis *analysis)
 {
-    int id = analysis->id();
-	QString title = tq(analysis->title());
-	
 	Log::log() << " void ResultsJsInterface::changeTitle(Analysis *analysis)" << std::endl;
 
-    runJavaScript("window.changeTitle(" + QString::number(id) + ", '" + escapeJavascriptString(title) + "')");
+	callInResults("changeTitle", { Json::UInt64(analysis->id()), analysis->title() }, analysis->id());
 }
 
 void ResultsJsInterface::overwriteUserdata(Analysis *analysis)
 {
-	size_t id = analysis->id();
-	QString userData = tq(analysis->userData().toStyledString());
-
-	runJavaScript("window.overwriteUserdata(" + QString::number(id) + ", JSON.parse('" + escapeJavascriptString(userData) + "'))");
+	callInResults("overwriteUserdata", { Json::UInt64(analysis->id()), analysis->userData() }, analysis->id());
 }
 
 void ResultsJsInterface::showAnalysis(int id)
 {
-	runJavaScript("window.select(" + QString::number(id) + ", true)");
+	callInResults("select", { id, true }, id);
 }
 
 void ResultsJsInterface::exportSelected(const QString &filename)
 {
-	runJavaScript("window.exportHTML('" + filename + "');");
+	callInResults("exportHTML", { fq(filename) });
 }
 
 void ResultsJsInterface::analysisChanged(Analysis *analysis)
 {
-	runJavaScript("window.analysisChanged(JSON.parse('" + escapeJavascriptString(tq(analysis->asJSON().toStyledString())) + "'));");
+	if(!_channelReady || !_resultsLoaded)
+		return callInResults("analysisChanged", { analysis->asJSON() });
+
+	if(_pendingChanges.count(analysis->id()))
+	{
+		//It is serialized when delivered, so the pending one will carry this change as well
+		_updatesSuperseded++;
+		return;
+	}
+
+	_pendingChanges[analysis->id()] = _pendingCalls.size();
+	_pendingCalls.push_back({ "analysisChanged", Json::nullValue, analysis->id() });
+
+	if(!_resultsCallTimer.isActive())
+		_resultsCallTimer.start();
+}
+
+void ResultsJsInterface::callInResults(const std::string & function, std::initializer_list<Json::Value> args, size_t analysisId)
+{
+	//A change to this analysis after this call must be delivered after it as well, so it can no longer be merged with the one before
+	if(analysisId)
+		_pendingChanges.erase(analysisId);
+
+	Json::Value argsJson = Json::arrayValue;
+	for(const Json::Value & arg : args)
+		argsJson.append(arg);
+
+	if(_channelReady && _resultsLoaded)
+	{
+		_pendingCalls.push_back({ function, argsJson, analysisId });
+
+		if(!_resultsCallTimer.isActive())
+			_resultsCallTimer.start();
+	}
+	else
+		runJavaScript(javaScriptCall(function, argsJson));
+}
+
+QString ResultsJsInterface::javaScriptCall(const std::string & function, const Json::Value & args)
+{
+	return "window." + tq(function) + ".apply(window, JSON.parse('" + escapeJavascriptString(tq(args.toStyledString())) + "'));";
+}
+
+void ResultsJsInterface::resultsChannelReady()
+{
+	Log::log() << "ResultsJsInterface::resultsChannelReady, calls concerning the analyses now go through the WebChannel." << std::endl;
+	_channelReady = true;
+}
+
+void ResultsJsInterface::flushResultsCalls()
+{
+	_resultsCallTimer.stop();
+
+	if(_pendingCalls.empty())
+		return;
+
+	static Json::StreamWriterBuilder compact = []()
+	{
+		Json::StreamWriterBuilder builder;
+		builder["indentation"] = "";
+		return builder;
+	}();
+
+	Json::Value calls = Json::arrayValue;
+
+	for(const ResultsCall & pending : _pendingCalls)
+	{
+		if(pending.function.empty())
+			continue;
+
+		Json::Value call = Json::objectValue;
+
+		if(pending.function == "analysisChanged")
+		{
+			Analysis * analysis = Analyses::analyses()->get(pending.analysisId);
+
+			if(!analysis)
+			{
+				_updatesDropped++;
+				continue;
+			}
+
+			call["args"] = Json::arrayValue;
+			call["args"].append(analysis->asJSON());
+			_updatesDelivered++;
+		}
+		else
+			call["args"] = pending.args;
+
+		call["function"] = pending.function;
+		calls.append(call);
+	}
+
+	_pendingCalls.clear();
+	_pendingChanges.clear();
+
+	if(calls.size() == 0)
+		return;
+
+	emit resultsCallsSignal(tq(Json::writeString(compact, calls)));
+
+	logDeliveryStatistics();
+}
+
+void ResultsJsInterface::dropAnalysisChange(size_t analysisId)
+{
+	if(!_pendingChanges.count(analysisId))
+		return;
+
+	_pendingCalls[_pendingChanges[analysisId]].function.clear();
+	_pendingChanges.erase(analysisId);
+	_updatesDropped++;
+}
+
+void ResultsJsInterface::logDeliveryStatistics(bool force)
+{
+	const qint64 now = QDateTime::currentMSecsSinceEpoch();
+
+	if(!force && now - _statisticsLogged < 10000)
+		return;
+
+	_statisticsLogged = now;
+
+	Log::log() << "ResultsJsInterface delivered " << _updatesDelivered << " analysis changes, " << _updatesSuperseded << " were superseded by a later one in the same frame and " << _updatesDropped << " dropped because the analysis was removed." << std::endl;
 }
 
 void ResultsJsInterface::setResultsMeta(const QString & str)
 {
-	runJavaScript("window.setResultsMeta(JSON.parse('" + escapeJavascriptString(str) + "'));");
+	Json::Value meta;
+	Json::Reader().parse(fq(str), meta);
+
+	callInResults("setResultsMeta", { meta });
 }
 
 void ResultsJsInterface::resetResults()
 {
+	logDeliveryStatistics(true);
 	emit resultsPageUrlChanged(_resultsPageUrl);
 }
 
 void ResultsJsInterface::setRSyntax(int id, const QString &syntax)
 {
-	runJavaScript("window.setRSyntaxText(" + QString::number(id) + ", '" + escapeJavascriptString(syntax) + "')");
+	callInResults("setRSyntaxText", { id, fq(syntax) }, id);
 }
 
 void ResultsJsInterface::unselect()
@@ -319,17 +469,21 @@ void ResultsJsInterface::unselect()
 
 void ResultsJsInterface::removeAnalysis(Analysis *analysis)
 {
-	runJavaScript("window.remove(" + QString::number(analysis->id()) + ")");
+	dropAnalysisChange(analysis->id());
+	callInResults("remove", { Json::UInt64(analysis->id()) }, analysis->id());
 }
 
 void ResultsJsInterface::removeAnalyses()
 {
-	runJavaScript("window.removeAllAnalyses()");
+	while(_pendingChanges.size())
+		dropAnalysisChange(_pendingChanges.begin()->first);
+
+	callInResults("removeAllAnalyses", {});
 }
 
 void ResultsJsInterface::moveAnalyses(quint64 fromId, quint64 toId)
 {
-	runJavaScript("window.moveAnalyses(" + QString::number(fromId) + "," + QString::number(toId) + ")");
+	callInResults("moveAnalyses", { Json::UInt64(fromId), Json::UInt64(toId) });
 }
 
 void ResultsJsInterface::showInstruction()
@@ -340,48 +494,31 @@ void ResultsJsInterface::showInstruction()
 void ResultsJsInterface::exportPreviewHTML()
 {
 	DataSetPackage::pkg()->setWaitingForReady();
-	runJavaScript("window.exportHTML('%PREVIEW%');");
+	callInResults("exportHTML", { "%PREVIEW%" });
 }
 
 void ResultsJsInterface::exportHTML()
 {
 	DataSetPackage::pkg()->setWaitingForReady();
-	runJavaScript("window.exportHTML('%EXPORT%');");
+	callInResults("exportHTML", { "%EXPORT%" });
 }
 
 QString ResultsJsInterface::escapeJavascriptString(const QString &str)
 {
 	QString out;
-	static QRegularExpression rx("(\\r|\\n|\\\\|\"|\')");
-	int pos = 0, lastPos = 0;
+	out.reserve(str.size() + str.size() / 16);
 
-	for (const QRegularExpressionMatch &match : rx.globalMatch(str))
-	{
-		QString matched = match.captured(1);
-		pos = match.capturedStart(1);
-		out += str.mid(lastPos, pos - lastPos);
-		switch (matched.at(0).unicode())
+	for(const QChar & c : str)
+		switch (c.unicode())
 		{
-		case '\r':
-			out += "\\r";
-			break;
-		case '\n':
-			out += "\\n";
-			break;
-		case '"':
-			out += "\\\"";
-			break;
-		case '\'':
-			out += "\\'";
-			break;
-		case '\\':
-			out += "\\\\";
-			break;
+		case '\r':	out += "\\r";		break;
+		case '\n':	out += "\\n";		break;
+		case '"':	out += "\\\"";		break;
+		case '\'':	out += "\\'";		break;
+		case '\\':	out += "\\\\";		break;
+		default:	out += c;			break;
 		}
-		pos++;
-		lastPos = pos;
-	}
-	out += str.mid(lastPos);
+
 	return out;
 }
 
@@ -24,7 +24,10 @@
 #include <QQmlWebChannel>
 #include <QAuthenticator>
 #include <QNetworkReply>
+#include <QTimer>
 #include <queue>
+#include <vector>
+#include <map>
 
 #include "utilities/jsonutilities.h"
 #include "analysis/analysis.h"
@@ -33,6 +36,8 @@
 /// Converts slots etc to proper javascript commands as JS could understand them and then passes them through to QML for use by WebChannel+WebEngine in MainPage.qml
 /// It also collects javascript commands for when the webengine isn't loaded (this happens during language changing and during startup) and runs them once the time is right.
 /// It will also get called through the WebChannel object "jasp" in MainPage.qml to get output and user interaction from JS to the rest of the application.
+/// Everything that concerns the analyses, like changing, selecting or removing them, is not sent as javascript. Once the page has its WebChannel those calls are collected in order and delivered
+/// at most once per frame as compact JSON through "jasp", with changes to one analysis that follow each other collapsed into one. Until then they are queued as javascript like the rest.
 class ResultsJsInterface : public QObject
 {
 	Q_OBJECT
@@ -67,6 +72,7 @@ public:
 	Q_INVOKABLE void purgeClipboard();
 	Q_INVOKABLE void analysisEditImage(int id, QString options);
 	Q_INVOKABLE void runJavaScript(const QString & js);
+	Q_INVOKABLE void resultsChannelReady();
 
 	//Callable from javascript through resultsJsInterfaceInterface...
 signals:
@@ -78,6 +84,7 @@ signals:
 				void analysisResizeImage(			int id, QString options);
 				void showPlotEditor(				int id, QString options);
 	Q_INVOKABLE void analysisSelected(				int id);
+	Q_INVOKABLE void analysesInViewChanged(			QVariantList ids);
 	Q_INVOKABLE void analysisTitleChangedInResults(	int id, QString title);
 	Q_INVOKABLE void removeAnalysisRequest(			int id);
 	Q_INVOKABLE void duplicateAnalysis(				int id);
@@ -119,6 +126,7 @@ signals:
 	void resultsPageUrlChanged(	QUrl	resultsPageUrl);
 	void runJavaScriptSignal(			QString js); //Do not call this directly here, use runJavaScript()
 	void runJavaScriptSignalQueued(		QString js); //Same same
+	void resultsCallsSignal(			QString callsJson); //A JSON array of calls to functions on window, forwarded to the page by resultsJsInterfaceInterface
 	void zoomChanged();
 	void resultsPageLoadedSignal();
 	void resultsLoadedChanged(bool resultsLoaded);
@@ -141,6 +149,11 @@ private:
 	void	setGlobalJsValues();
 	QString escapeJavascriptString(const QString &str);
 	void	dequeueJsQueue();
+	void	callInResults(const std::string & function, std::initializer_list<Json::Value> args, size_t analysisId = 0);	///< analysisId is the analysis the call is about, if any
+	QString	javaScriptCall(const std::string & function, const Json::Value & args);
+	void	flushResultsCalls();
+	void	dropAnalysisChange(size_t analysisId);
+	void	logDeliveryStatistics(bool force = false);
 
 private slots:
 	void menuHiding();
@@ -153,6 +166,22 @@ private:
 	
 	std::queue<QString>	_delayedJs;
 
+	struct ResultsCall
+	{
+		std::string		function;		///< Empty if it was dropped
+		Json::Value		args;			///< Left null for analysisChanged, the analysis is serialized when delivered
+		size_t			analysisId;
+	};
+
+	bool						_channelReady	= false;
+	QTimer						_resultsCallTimer;			///< One frame, calls within it are delivered together
+	std::vector<ResultsCall>	_pendingCalls;
+	std::map<size_t, size_t>	_pendingChanges;			///< Analysis id to its analysisChanged in _pendingCalls, as long as nothing else about that analysis came after it
+	size_t						_updatesDelivered	= 0,
+								_updatesSuperseded	= 0,	///< Replaced by a later change to the same analysis before being delivered
+								_updatesDropped		= 0;	///< The analysis was removed before its change was delivered
+	qint64						_statisticsLogged	= 0;
+
 	static ResultsJsInterface * _singleton;
 };
 
@@ -25,7 +25,7 @@
 #include "utilities/settings.h"
 #include <iostream>
 
-void Application::init(QString filePath, bool unitTest, int timeOut, bool save, bool logToFile, const Json::Value & dbJson, QString reportingPath)
+void Application::init(QString filePath, bool unitTest, int timeOut, bool save, bool logToFile, const Json::Value & dbJson, QString reportingPath, int restoreTestCopies, QString batchDir, const QStringList & batchPaths, int enginePool, bool batchRewriteImages, int filterTestSteps)
 {	
 	std::cout << "Application init entered" << std::endl;
 	
@@ -39,7 +39,15 @@ void Application::init(QString filePath, bool unitTest, int timeOut, bool save,
 	if(unitTest)
 		_mainWindow->testLoadedJaspFile(timeOut, save);
 
-	if(filePath.size() > 0)
+	if(restoreTestCopies > 0)
+		_mainWindow->testRestoringAnalyses(restoreTestCopies);
+
+	if(filterTestSteps > 0)
+		_mainWindow->testFilterChanges(filterTestSteps);
+
+	if(batchDir != "")
+		_mainWindow->runBatch(batchPaths, batchDir, enginePool, timeOut, batchRewriteImages);
+	else if(filePath.size() > 0)
 		_mainWindow->open(filePath);
 	
 	if(!dbJson.isNull())
@@ -76,12 +84,12 @@ bool Application::notify(QObject *receiver, QEvent *event)
 	}
 	catch (std::exception &e)
 	{
-		Log::log() << "Error in object: " << receiver->objectName().toStdString() << ", with event: " << event->type() << ": " << e.what() << std::endl;
+		Log::error() << "Error in object: " << receiver->objectName().toStdString() << ", with event: " << event->type() << ": " << e.what() << std::endl;
 		throw e;
 	}
 	catch (...)
 	{
-		Log::log() << "Unknown error in object: " << receiver->objectName().toStdString() << ", with event: " << event->type() << std::endl;
+		Log::error() << "Unknown error in object: " << receiver->objectName().toStdString() << ", with event: " << event->type() << std::endl;
 		throw std::exception();
 	}
 }
@@ -103,7 +111,7 @@ bool Application::event(QEvent *event)
 		}
 		catch (const std::exception & e)
 		{
-			Log::log() << "Caught exception in Application::event(" << event << "): " << e.what() << std::endl;
+			Log::error() << "Caught exception in Application::event(" << event << "): " << e.what() << std::endl;
 			throw e;
 		}
 	}
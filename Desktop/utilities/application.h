@@ -34,7 +34,7 @@ public:
 
 	virtual bool notify(QObject *receiver, QEvent *event) OVERRIDE;
 	virtual bool event(QEvent *event) OVERRIDE;
-	void init(QString filePath, bool unitTest, int timeOut, bool save, bool logToFile, const Json::Value & dbJson, QString reportingPath);
+	void init(QString filePath, bool unitTest, int timeOut, bool save, bool logToFile, const Json::Value & dbJson, QString reportingPath, int restoreTestCopies = 0, QString batchDir = "", const QStringList & batchPaths = {}, int enginePool = 0, bool batchRewriteImages = false, int filterTestSteps = 0);
 
 signals:
 
@@ -0,0 +1,188 @@
+#include "batchrunner.h"
+#include "analysis/analyses.h"
+#include "utilities/qutils.h"
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <iostream>
+#include "utils.h"
+#include "log.h"
+
+BatchRunner * BatchRunner::_batchRunner = nullptr;
+
+BatchRunner::BatchRunner(QObject * parent, const QStringList & paths, QDir outputDir, int enginePool, int timeOutMinutes, bool rewriteImages)
+	: QObject(parent), _outputDir(outputDir), _enginePool(enginePool), _timeOutMinutes(timeOutMinutes), _rewriteImages(rewriteImages)
+{
+	assert(_batchRunner == nullptr);
+	_batchRunner = this;
+
+	//Folders are searched for jasp-files, so that a data library can be run in one go
+	for(const QString & path : paths)
+		if(QFileInfo(path).isDir())
+		{
+			QStringList found;
+
+			for(QDirIterator it(path, { "*.jasp" }, QDir::Files, QDirIterator::Subdirectories); it.hasNext(); )
+				found.append(it.next());
+
+			found.sort();
+			_files.append(found);
+		}
+		else
+			_files.append(QFileInfo(path).absoluteFilePath());
+
+	_timeOut.setSingleShot(true);
+	_timeOut.setInterval(60000 * std::max(1, _timeOutMinutes));
+
+	connect(&_timeOut, &QTimer::timeout, this, &BatchRunner::fileTimedOut);
+
+	Log::log() << "BatchRunner will run " << _files.size() << " jasp-files on a pool of " << _enginePool << " engines" << (_rewriteImages ? ", rewrites their plots afterwards" : "") << " and writes to " << _outputDir.absolutePath() << std::endl;
+}
+
+void BatchRunner::start()
+{
+	nextFile();
+}
+
+void BatchRunner::nextFile()
+{
+	_current++;
+
+	if(_current >= _files.size())
+	{
+		writeReport();
+
+		size_t failed = _statistics.failedFiles();
+		std::cout << "Batch of " << _files.size() << " jasp-files done, " << failed << " failed. See " << fq(_outputDir.absoluteFilePath("batch-report.json")) << std::endl;
+
+		exit(failed == 0 ? 0 : 1);
+	}
+
+	const QString & file = _files[_current];
+
+	std::cout << "Batch running " << (_current + 1) << "/" << _files.size() << ": " << fq(file) << std::endl;
+
+	_restoreProblem = "";
+	_statistics.fileStarted(fq(file), Utils::currentMillis());
+	_timeOut.start();
+
+	emit openFile(file);
+}
+
+void BatchRunner::fileFailed(const QString & problem)
+{
+	std::cerr << "Batch could not open " << fq(_files[_current]) << ": " << fq(problem) << std::endl;
+
+	finishFile("Could not be opened: " + problem);
+}
+
+void BatchRunner::analysesRestored(bool errorFound, const QString & errorMsg)
+{
+	if(errorFound)
+		_restoreProblem = "Restoring analyses: " + errorMsg;
+
+	if(Analyses::analyses()->count() == 0)
+	{
+		finishFile(_restoreProblem);
+		return;
+	}
+
+	const long now = Utils::currentMillis();
+
+	Analyses::analyses()->applyToAll([&](Analysis * analysis)
+	{
+		_statistics.queued(analysis->id(), analysis->name(), analysis->module(), now);
+	});
+
+	_running = true;
+	Analyses::analyses()->refreshAllAnalyses();
+}
+
+void BatchRunner::analysisStatusChanged(Analysis * analysis)
+{
+	if(!_running || !analysis->isFinished())
+		return;
+
+	_statistics.finished(analysis->id(), Analysis::statusToString(analysis->status()), Utils::currentMillis());
+
+	if(!_statistics.allFinished())
+		return;
+
+	if(_rewriteImages && !_rewriting)
+		startRewritingImages();
+	else
+		finishFile(_rewriting && !_statistics.inViewRewrittenFirst() ? "The plots of the analysis in view were not rewritten first" : _restoreProblem);
+}
+
+void BatchRunner::startRewritingImages()
+{
+	//As if the user scrolled down to the last analysis and then changed the PPI, so that one should get its plots back before the rest
+	size_t last = 0;
+	Analyses::analyses()->applyToAll([&](Analysis * analysis) { last = analysis->id(); });
+
+	Analyses::analyses()->setAnalysesInView({ QVariant(qulonglong(last)) });
+
+	_rewriting = true;
+	_statistics.rewritesStarted({ last }, Utils::currentMillis());
+
+	//This is reached from an engine reply, the rewrites go out once that is handled
+	QTimer::singleShot(0, this, &BatchRunner::rewriteAllPlots);
+}
+
+void BatchRunner::analysisRequestSent(Analysis * analysis, int channelNumber, size_t bytes)
+{
+	if(_running)
+		_statistics.sent(analysis->id(), channelNumber, bytes, Utils::currentMillis());
+}
+
+void BatchRunner::analysisReplyReceived(Analysis * analysis, size_t bytes)
+{
+	if(_running)
+		_statistics.received(analysis->id(), bytes);
+}
+
+void BatchRunner::fileTimedOut()
+{
+	std::cerr << "Batch timed out on " << fq(_files[_current]) << " after " << _timeOutMinutes << " minutes." << std::endl;
+
+	finishFile("Timed out after " + QString::number(_timeOutMinutes) + " minutes");
+}
+
+void BatchRunner::finishFile(const QString & problem)
+{
+	_running	= false;
+	_rewriting	= false;
+	_timeOut.stop();
+	_statistics.fileFinished(fq(problem), Utils::currentMillis());
+
+	writeResults();
+
+	//This is usually reached from an engine reply, so closing the file and with it all analyses has to wait until that is done
+	QTimer::singleShot(0, this, [this]()
+	{
+		emit closeFile();
+		nextFile();
+	});
+}
+
+void BatchRunner::writeResults()
+{
+	const QString name = QString::number(_current + 1) + "-" + QFileInfo(_files[_current]).completeBaseName() + ".results.json";
+
+	QFile resultsFile(_outputDir.absoluteFilePath(name));
+
+	if(resultsFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+		resultsFile.write(Analyses::analyses()->asJson().toStyledString().c_str());
+	else
+		std::cerr << "Batch could not write results to " << fq(resultsFile.fileName()) << std::endl;
+}
+
+void BatchRunner::writeReport()
+{
+	QFile reportFile(_outputDir.absoluteFilePath("batch-report.json"));
+
+	if(reportFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+		reportFile.write(_statistics.report(_enginePool).toStyledString().c_str());
+	else
+		std::cerr << "Batch could not write its report to " << fq(reportFile.fileName()) << std::endl;
+}
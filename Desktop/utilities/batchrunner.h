@@ -0,0 +1,64 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QObject>
+#include <QDir>
+#include <QTimer>
+#include <QStringList>
+#include "batchstatistics.h"
+
+class Analysis;
+
+/// Runs all analyses of one or more jasp-files without any windows or results page, to benchmark engine throughput and to check projects in bulk on servers.
+/// The files are opened one after the other, all their analyses are refreshed on a pool of engines (see EngineSync::setEnginePool) and the file is closed again once they are done or it timed out.
+/// The results of each file are written to the output dir as "<n>-<name>.results.json", and once all files are done "batch-report.json" gets the timing, queue-wait and data-transfer of every analysis.
+/// With rewriteImages all plots are rewritten once the analyses are done, as after a change of PPI or theme, with the last analysis in view. The time that took is reported, and a file fails if the analysis in view was not redone first.
+/// It will only be instantiated if JASP is started with --batch.
+class BatchRunner : public QObject
+{
+	Q_OBJECT
+public:
+	explicit BatchRunner(QObject * parent, const QStringList & paths, QDir outputDir, int enginePool, int timeOutMinutes, bool rewriteImages = false);
+
+	static BatchRunner * batchRunner() { return _batchRunner; }
+
+	int		enginePool() const { return _enginePool; }
+
+public slots:
+	void	start();												///< Called once the modules are loaded
+	void	fileFailed(			const QString & problem);			///< Opening the current file failed
+	void	analysesRestored(	bool errorFound, const QString & errorMsg);
+	void	analysisStatusChanged(	Analysis * analysis);
+	void	analysisRequestSent(	Analysis * analysis, int channelNumber, size_t bytes);
+	void	analysisReplyReceived(	Analysis * analysis, size_t bytes);
+
+signals:
+	void	openFile(const QString & path);
+	void	closeFile();
+	void	rewriteAllPlots();
+
+private:
+	void	nextFile();
+	void	finishFile(const QString & problem);
+	void	startRewritingImages();
+	void	fileTimedOut();
+	void	writeResults();
+	void	writeReport();
+
+private:
+	QStringList				_files;
+	QDir					_outputDir;
+	int						_enginePool,
+							_timeOutMinutes,
+							_current		= -1;
+	bool					_running		= false,	///< From refreshing the analyses of the current file until it is finished
+							_rewriteImages,
+							_rewriting		= false;	///< The analyses of the current file are done and now their plots are being rewritten
+	QString					_restoreProblem;
+	QTimer					_timeOut;
+	BatchStatistics			_statistics;
+
+	static BatchRunner	*	_batchRunner;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,296 @@
+#include "batchstatistics.h"
+#include <algorithm>
+#include <numeric>
+
+void BatchStatistics::fileStarted(const std::string & path, long nowMs)
+{
+	_files.push_back(File());
+	_files.back().path		= path;
+	_files.back().startedAt	= nowMs;
+}
+
+void BatchStatistics::fileFinished(const std::string & problem, long nowMs)
+{
+	if(_files.empty())
+		return;
+
+	_files.back().problem		= problem;
+	_files.back().finishedAt	= nowMs;
+}
+
+void BatchStatistics::queued(size_t id, const std::string & name, const std::string & module, long nowMs)
+{
+	if(_files.empty())
+		return;
+
+	Run & run = _files.back().runs[id];
+
+	run.name		= name;
+	run.module		= module;
+	run.queuedAt	= nowMs;
+}
+
+void BatchStatistics::sent(size_t id, int channel, size_t bytes, long nowMs)
+{
+	if(_files.empty() || !_files.back().runs.count(id))
+		return; //Not one of ours, an image being saved or so
+
+	Run & run = _files.back().runs[id];
+
+	if(_files.back().rewritesStartedAt != -1)
+	{
+		if(run.rewriteSentAt == -1)
+			run.rewriteSentAt = nowMs;
+
+		run.bytesSent += bytes;
+		return;
+	}
+
+	if(run.firstSentAt == -1)
+		run.firstSentAt = nowMs;
+
+	run.runs++;
+	run.bytesSent += bytes;
+
+	if(std::find(run.channels.begin(), run.channels.end(), channel) == run.channels.end())
+		run.channels.push_back(channel);
+}
+
+void BatchStatistics::received(size_t id, size_t bytes)
+{
+	if(_files.empty() || !_files.back().runs.count(id))
+		return;
+
+	Run & run = _files.back().runs[id];
+
+	run.bytesReceived += bytes;
+	run.replies++;
+}
+
+void BatchStatistics::finished(size_t id, const std::string & status, long nowMs)
+{
+	if(_files.empty() || !_files.back().runs.count(id))
+		return;
+
+	Run & run = _files.back().runs[id];
+
+	if(_files.back().rewritesStartedAt != -1)
+	{
+		if(run.rewriteSentAt != -1)
+			run.rewriteFinishedAt = nowMs;
+		return; //The status of the run itself is kept, a rewrite only redoes its plots
+	}
+
+	if(run.firstSentAt == -1)
+		return; //The status of an analysis that is only just restored, it wasn't run by us yet
+
+	run.status		= status;
+	run.finishedAt	= nowMs;
+}
+
+void BatchStatistics::rewritesStarted(const std::set<size_t> & inView, long nowMs)
+{
+	if(_files.empty())
+		return;
+
+	_files.back().rewritesStartedAt = nowMs;
+
+	for(auto & idRun : _files.back().runs)
+		idRun.second.inView = inView.count(idRun.first);
+}
+
+bool BatchStatistics::allFinished() const
+{
+	if(_files.empty())
+		return true;
+
+	const bool rewriting = _files.back().rewritesStartedAt != -1;
+
+	for(const auto & idRun : _files.back().runs)
+		if((rewriting ? idRun.second.rewriteFinishedAt : idRun.second.finishedAt) == -1)
+			return false;
+
+	return true;
+}
+
+bool BatchStatistics::inViewRewrittenFirst() const
+{
+	if(_files.empty())
+		return true;
+
+	//Each module has its own engines, so the order only means something within a module
+	std::map<std::string, long>	lastInView,
+								firstOther;
+
+	for(const auto & idRun : _files.back().runs)
+	{
+		const Run & run = idRun.second;
+
+		if(run.rewriteSentAt == -1)
+			continue;
+
+		if(run.inView)									lastInView[run.module] = std::max(lastInView[run.module], run.rewriteSentAt);
+		else if(!firstOther.count(run.module))			firstOther[run.module] = run.rewriteSentAt;
+		else											firstOther[run.module] = std::min(firstOther[run.module], run.rewriteSentAt);
+	}
+
+	for(const auto & moduleSent : lastInView)
+		if(firstOther.count(moduleSent.first) && firstOther.at(moduleSent.first) < moduleSent.second)
+			return false;
+
+	return true;
+}
+
+size_t BatchStatistics::failedFiles() const
+{
+	size_t failed = 0;
+
+	for(const File & file : _files)
+	{
+		bool fine = file.problem.empty();
+
+		for(const auto & idRun : file.runs)
+			if(idRun.second.status != "complete")
+				fine = false;
+
+		if(!fine)
+			failed++;
+	}
+
+	return failed;
+}
+
+Json::Value BatchStatistics::distribution(std::vector<long> values)
+{
+	Json::Value out = Json::objectValue;
+
+	out["count"] = int(values.size());
+
+	if(values.empty())
+		return out;
+
+	std::sort(values.begin(), values.end());
+
+	auto percentile = [&](double p) { return Json::Int64(values[std::min(values.size() - 1, size_t(p * values.size()))]); };
+
+	out["mean"]		= double(std::accumulate(values.begin(), values.end(), 0.0)) / values.size();
+	out["median"]	= percentile(0.5);
+	out["p95"]		= percentile(0.95);
+	out["max"]		= Json::Int64(values.back());
+
+	return out;
+}
+
+Json::Value BatchStatistics::report(int enginePool) const
+{
+	Json::Value			files		= Json::arrayValue;
+	std::vector<long>	allWaits,
+						allRuns;
+	size_t				analyses	= 0,
+						errors		= 0,
+						unfinished	= 0,
+						bytesSent	= 0,
+						bytesRecv	= 0;
+	long				wallMs		= 0;
+
+	for(const File & file : _files)
+	{
+		Json::Value			fileJson		= Json::objectValue,
+							analysesJson	= Json::arrayValue;
+		std::vector<long>	waits,
+							runs,
+							rewrites;
+
+		for(const auto & idRun : file.runs)
+		{
+			const Run	&	run			= idRun.second;
+			Json::Value		runJson		= Json::objectValue,
+							channels	= Json::arrayValue;
+
+			for(int channel : run.channels)
+				channels.append(channel);
+
+			const long	queueWait	= run.firstSentAt	== -1 ? -1 : run.firstSentAt	- run.queuedAt,
+						running		= run.finishedAt	== -1 ? -1 : run.finishedAt		- run.firstSentAt;
+
+			runJson["id"]				= Json::UInt64(idRun.first);
+			runJson["name"]				= run.name;
+			runJson["module"]			= run.module;
+			runJson["status"]			= run.finishedAt == -1 ? "unfinished" : run.status;
+			runJson["queueWaitMs"]		= Json::Int64(queueWait);
+			runJson["runMs"]			= Json::Int64(running);
+			runJson["totalMs"]			= Json::Int64(run.finishedAt == -1 ? -1 : run.finishedAt - run.queuedAt);
+			runJson["runs"]				= run.runs;
+			runJson["engines"]			= channels;
+			runJson["bytesSent"]		= Json::UInt64(run.bytesSent);
+			runJson["bytesReceived"]	= Json::UInt64(run.bytesReceived);
+			runJson["replies"]			= Json::UInt64(run.replies);
+
+			if(file.rewritesStartedAt != -1)
+			{
+				runJson["inView"]			= run.inView;
+				runJson["rewriteWaitMs"]	= Json::Int64(run.rewriteSentAt		== -1 ? -1 : run.rewriteSentAt		- file.rewritesStartedAt);
+				runJson["rewriteMs"]		= Json::Int64(run.rewriteFinishedAt	== -1 ? -1 : run.rewriteFinishedAt	- run.rewriteSentAt);
+
+				if(run.rewriteFinishedAt != -1)
+					rewrites.push_back(run.rewriteFinishedAt - run.rewriteSentAt);
+			}
+
+			analysesJson.append(runJson);
+
+			if(queueWait	!= -1)	waits.push_back(queueWait);
+			if(running		!= -1)	runs.push_back(running);
+
+			if(run.finishedAt == -1)				unfinished++;
+			else if(run.status != "complete")		errors++;
+
+			bytesSent += run.bytesSent;
+			bytesRecv += run.bytesReceived;
+		}
+
+		const long fileMs = file.finishedAt == -1 ? -1 : file.finishedAt - file.startedAt;
+
+		fileJson["file"]				= file.path;
+		fileJson["problem"]				= file.problem;
+		fileJson["wallMs"]				= Json::Int64(fileMs);
+		fileJson["analyses"]			= analysesJson;
+		fileJson["queueWaitMs"]			= distribution(waits);
+		fileJson["runMs"]				= distribution(runs);
+		fileJson["analysesPerMinute"]	= fileMs > 0 ? runs.size() * 60000.0 / fileMs : 0.0;
+
+		if(file.rewritesStartedAt != -1)
+		{
+			fileJson["rewriteMs"]		= distribution(rewrites);
+			fileJson["rewriteWallMs"]	= Json::Int64(file.finishedAt == -1 ? -1 : file.finishedAt - file.rewritesStartedAt);
+		}
+
+		files.append(fileJson);
+
+		analyses += file.runs.size();
+		wallMs	 += std::max(0L, fileMs);
+		allWaits.insert(allWaits.end(),	waits.begin(),	waits.end());
+		allRuns.insert(	allRuns.end(),	runs.begin(),	runs.end());
+	}
+
+	Json::Value totals = Json::objectValue;
+
+	totals["files"]				= Json::UInt64(_files.size());
+	totals["failedFiles"]		= Json::UInt64(failedFiles());
+	totals["analyses"]			= Json::UInt64(analyses);
+	totals["errors"]			= Json::UInt64(errors);
+	totals["unfinished"]		= Json::UInt64(unfinished);
+	totals["wallMs"]			= Json::Int64(wallMs);
+	totals["analysesPerMinute"]	= wallMs > 0 ? allRuns.size() * 60000.0 / wallMs : 0.0;
+	totals["queueWaitMs"]		= distribution(allWaits);
+	totals["runMs"]				= distribution(allRuns);
+	totals["bytesSent"]			= Json::UInt64(bytesSent);
+	totals["bytesReceived"]		= Json::UInt64(bytesRecv);
+
+	Json::Value out = Json::objectValue;
+
+	out["enginePool"]	= enginePool;
+	out["totals"]		= totals;
+	out["files"]		= files;
+
+	return out;
+}
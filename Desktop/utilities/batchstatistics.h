@@ -0,0 +1,64 @@
+#ifndef BATCHSTATISTICS_H
+#define BATCHSTATISTICS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include "json/json.h"
+
+///
+/// Keeps track of how long the analyses of the jasp-files run by BatchRunner waited for an engine, how long they ran and how much went back and forth with the engines.
+/// Files are run one after the other, so there is only ever one file being recorded. Analysis ids only need to be unique within a file.
+/// This knows nothing about Qt, engines or analyses, only about ids and times, so that the bookkeeping can be tested by itself.
+class BatchStatistics
+{
+public:
+	void		fileStarted(	const std::string & path, long nowMs);
+	void		fileFinished(	const std::string & problem, long nowMs);							///< An empty problem means all went fine
+	void		queued(			size_t id, const std::string & name, const std::string & module, long nowMs);
+	void		sent(			size_t id, int channel, size_t bytes, long nowMs);
+	void		received(		size_t id, size_t bytes);
+	void		finished(		size_t id, const std::string & status, long nowMs);
+	void		rewritesStarted(const std::set<size_t> & inView, long nowMs);					///< From now on sent and finished are about rewriting the images of the analyses
+
+	bool		allFinished()			const;
+	bool		inViewRewrittenFirst()	const;													///< Whether every module sent the rewrites of the analyses in view before the others
+	size_t		failedFiles()	const;
+	Json::Value	report(int enginePool)	const;
+
+private:
+	struct Run
+	{
+		std::string			name,
+							module,
+							status;
+		long				queuedAt		= -1,
+							firstSentAt		= -1,
+							finishedAt		= -1;
+		int					runs			= 0;		///< More than one when it was aborted and run again
+		bool				inView			= false;
+		long				rewriteSentAt		= -1,
+							rewriteFinishedAt	= -1;
+		std::vector<int>	channels;
+		size_t				bytesSent		= 0,
+							bytesReceived	= 0,
+							replies			= 0;
+	};
+
+	struct File
+	{
+		std::string					path,
+									problem;
+		long						startedAt			= -1,
+									finishedAt			= -1,
+									rewritesStartedAt	= -1;
+		std::map<size_t, Run>		runs;
+	};
+
+	static Json::Value	distribution(std::vector<long> values);
+
+	std::vector<File>	_files;
+};
+
+#endif // BATCHSTATISTICS_H
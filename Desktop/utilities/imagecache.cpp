@@ -0,0 +1,144 @@
+#include "imagecache.h"
+#include "tempfiles.h"
+#include "log.h"
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+
+ImageCache * ImageCache::cache()
+{
+	static ImageCache cache;
+	return &cache;
+}
+
+QByteArray ImageCache::read(const QString & path)
+{
+	const QString filePath = QDir::cleanPath(path);
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	auto file = _files.find(filePath);
+
+	if(file != _files.end())
+	{
+		auto content = _contents.find(file->second);
+
+		_hits++;
+		_lru.splice(_lru.begin(), _lru, content->second.lruPos);
+		return content->second.bytes;
+	}
+
+	_misses++;
+
+	//Reading and hashing happen without the lock, so that several files can be read at the same time (when saving for instance)
+	lock.unlock();
+
+	QFile readMe(filePath);
+	if(!readMe.open(QIODevice::ReadOnly))
+		return QByteArray();
+
+	QByteArray	bytes	= readMe.readAll(),
+				hash	= QCryptographicHash::hash(bytes, QCryptographicHash::Sha1);
+
+	lock.lock();
+
+	//Someone else might have read it meanwhile
+	file = _files.find(filePath);
+	if(file != _files.end())
+		_release(file);
+
+	_files[filePath] = hash;
+
+	auto content = _contents.find(hash);
+
+	if(content != _contents.end())
+	{
+		//Same image as another file, keep the copy we already have so that they share the memory
+		_deduplicated++;
+		content->second.files.insert(filePath);
+		_lru.splice(_lru.begin(), _lru, content->second.lruPos);
+		return content->second.bytes;
+	}
+
+	_lru.push_front(hash);
+	_contents[hash]	=  { bytes, { filePath }, _lru.begin() };
+	_bytesInUse		+= size_t(bytes.size());
+
+	_evict();
+
+	return bytes;
+}
+
+void ImageCache::_release(std::map<QString, QByteArray>::iterator file)
+{
+	auto content = _contents.find(file->second);
+
+	content->second.files.erase(file->first);
+
+	if(content->second.files.empty())
+	{
+		_bytesInUse -= size_t(content->second.bytes.size());
+		_lru.erase(content->second.lruPos);
+		_contents.erase(content);
+	}
+
+	_files.erase(file);
+}
+
+void ImageCache::_evict()
+{
+	while(_bytesInUse > _budget && _lru.size() > 1)
+	{
+		auto content = _contents.find(_lru.back());
+
+		for(const QString & filePath : content->second.files)
+			_files.erase(filePath);
+
+		_bytesInUse -= size_t(content->second.bytes.size());
+		_contents.erase(content);
+		_lru.pop_back();
+	}
+}
+
+void ImageCache::forget(const QString & directory)
+{
+	const QString prefix = QDir::cleanPath(directory) + "/";
+
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	for(auto file = _files.lower_bound(prefix); file != _files.end() && file->first.startsWith(prefix);)
+		_release(file++);
+}
+
+void ImageCache::forgetAnalysis(size_t id)
+{
+	forget(QString::fromStdString(TempFiles::sessionDirName() + "/resources/" + std::to_string(id)));
+}
+
+void ImageCache::setBudget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_budget = bytes;
+	_evict();
+}
+
+void ImageCache::clear()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	_files.clear();
+	_contents.clear();
+	_lru.clear();
+	_bytesInUse = 0;
+}
+
+void ImageCache::logStatistics()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+
+	size_t requests = _hits + _misses;
+
+	Log::log() << "ImageCache: " << _hits << " hits out of " << requests << " requests (" << (requests ? (100 * _hits) / requests : 0) << "%), "
+			   << _contents.size() << " distinct images in " << _bytesInUse / 1024 << "KB for " << _files.size() << " files, " << _deduplicated << " reads turned out to be duplicates." << std::endl;
+}
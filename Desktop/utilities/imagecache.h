@@ -0,0 +1,64 @@
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include <QByteArray>
+#include <QString>
+#include <list>
+#include <map>
+#include <set>
+#include <mutex>
+
+///
+/// Keeps recently used images (plots from the engines and images from modules) in memory, so that the results page and the exporter don't need to read them from disk over and over.
+/// The bytes are stored by a hash of their content, so identical plots in several analyses take up memory only once, and a plot that is written again with the same pixels stays shared.
+/// A file is read once and then served from memory until it is forgotten. The engines write plots as part of running an analysis, so Analysis forgets its folder whenever results come in,
+/// and when it is refreshed or removed. Size and modification time are not trusted for this, a rewrite can easily keep both.
+/// The total size is bounded, the least recently used contents are dropped first together with the files that pointed to them.
+/// It is used from the scheme handlers in the main thread and from the exporter in the AsyncLoader thread, so everything is behind a mutex.
+///
+class ImageCache
+{
+public:
+	static ImageCache * cache();
+
+	///Returns the contents of filePath, an empty QByteArray if it cannot be read.
+	QByteArray	read(const QString & filePath);
+	void		forget(const QString & directory);		///< Everything in directory will be read again
+	void		forgetAnalysis(size_t id);				///< The plots of analysis id in the session folder
+	void		clear();
+
+	size_t		hits()			const { return _hits;			}
+	size_t		misses()		const { return _misses;			}
+	size_t		files()			const { return _files.size();	}
+	size_t		contents()		const { return _contents.size();}
+	size_t		bytesInUse()	const { return _bytesInUse;		}
+	void		setBudget(size_t bytes);
+	void		logStatistics();
+
+	static bool	isImage(const QString & filePath) { return filePath.endsWith(".png", Qt::CaseInsensitive) || filePath.endsWith(".svg", Qt::CaseInsensitive); }
+
+private:
+	ImageCache() {}
+
+	struct ContentEntry
+	{
+		QByteArray						bytes;
+		std::set<QString>				files;		///< Paths that have these bytes, the content goes once none are left
+		std::list<QByteArray>::iterator	lruPos;
+	};
+
+	void		_evict();
+	void		_release(std::map<QString, QByteArray>::iterator file);
+
+	std::mutex								_mutex;
+	std::map<QString, QByteArray>			_files;				///< Path to the hash of its content
+	std::map<QByteArray, ContentEntry>		_contents;
+	std::list<QByteArray>					_lru;				///< Content hashes, most recently used in front
+	size_t									_bytesInUse	= 0,
+											_budget		= 64 * 1024 * 1024,
+											_hits		= 0,
+											_misses		= 0,
+											_deduplicated	= 0;
+};
+
+#endif // IMAGECACHE_H
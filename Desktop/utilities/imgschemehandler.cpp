@@ -3,9 +3,11 @@
 #include <QQuickWebEngineProfile>
 #include <QWebEngineUrlRequestJob>
 #include <QFile>
+#include <QBuffer>
 #include <QIODevice>
 #include "modules/dynamicmodules.h"
 #include "log.h"
+#include "imagecache.h"
 
 using namespace Modules;
 
@@ -54,12 +56,15 @@ void ImgSchemeHandler::requestStarted(QWebEngineUrlRequestJob *request)
 
 	Log::log() << "Is img from module " << moduleName << " and reconstructed imgpath is: " << filePath << std::endl;
 
-	QFile * img = new QFile(filePath, request);
-	if(!img->exists())
+	QByteArray bytes = ImageCache::cache()->read(filePath);
+	if(bytes.isEmpty())
 		{
 			request->fail(QWebEngineUrlRequestJob::Error::UrlNotFound);
 			return;
 		}
+
+	QBuffer * img = new QBuffer(request);
+	img->setData(bytes);
 	img->open(QIODevice::ReadOnly);
 
 	request->reply(filePath.indexOf(".png") != -1 ? "image/png" : "image/svg", img);
@@ -1,5 +1,7 @@
 #include "plotschemehandler.h"
 #include "tempfiles.h"
+#include "imagecache.h"
+#include <QBuffer>
 
 PlotSchemeHandler::PlotSchemeHandler(QObject *parent) : QWebEngineUrlSchemeHandler(parent)
 {
@@ -26,12 +28,15 @@ void PlotSchemeHandler::requestStarted(QWebEngineUrlRequestJob *request)
 		return;
 	}
 
-	QFile * png = new QFile(filePath, request);
-	if(!png->exists())
+	QByteArray bytes = ImageCache::cache()->read(filePath);
+	if(bytes.isEmpty())
 	{
 		request->fail(QWebEngineUrlRequestJob::Error::UrlNotFound);
 		return;
 	}
+
+	QBuffer * png = new QBuffer(request);
+	png->setData(bytes);
 	png->open(QIODevice::ReadOnly);
 
 	request->reply("image/png", png);
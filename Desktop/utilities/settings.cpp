@@ -68,6 +68,8 @@ const Settings::Setting Settings::Values[] = {
 #endif
 	{"maxEngineCount",				4		}, //In debug always 1
 	{"maxEngineCountAdmin",			0		}, //If set to something >0 it will be the max allowed max engine count. This is here to allow admins to override the number of processes spawned as they might each consume quite some RAM.
+	{"engineMemoryBudget",			0		}, //In MB, how much memory all engines together may use before idle ones are cleaned up or restarted and no new ones are started. 0 means half the memory of the machine.
+	{"preemptBackgroundRuns",		true	}, //Abort analyses nobody is looking at when the user waits for the same engine, they are run again afterwards
 	{"GITHUB_PAT_Custom",			""		},
 	{"GITHUB_PAT_UseDefault",		true	},
 	{"WindowsNoBomNative",			false	}, //false as default because then we keep the behaviour we had before.
@@ -82,6 +84,7 @@ const Settings::Setting Settings::Values[] = {
 	{"dbImportInterval",			0		},
 	{"dbShowWarning",				true	},
 	{"dbRememberMe",				false	},
+	{"dbImportSyncColumn",			""		},
 	{"dataNALabel",					""		},
 	{"guiQtTextRender",				true	},
 	{"showReports",					false	},
@@ -54,6 +54,8 @@ public:
 		RESULT_FONT,
 		MAX_ENGINE_COUNT,
 		MAX_ENGINE_COUNT_ADMIN,
+		ENGINE_MEMORY_BUDGET,
+		PREEMPT_BACKGROUND_RUNS,
 		GITHUB_PAT_CUSTOM,
 		GITHUB_PAT_USE_DEFAULT,
 		WINDOWS_NO_BOM_NATIVE,
@@ -68,6 +70,7 @@ public:
 		DB_IMPORT_INTERVAL,
 		DB_SHOW_WARNING,
 		DB_REMEMBER_ME,
+		DB_IMPORT_SYNC_COLUMN,
 		DATA_LABEL_NA,
 		GUI_USE_QT_TEXTRENDER,
 		REPORT_SHOW,
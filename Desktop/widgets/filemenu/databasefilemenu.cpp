@@ -49,6 +49,7 @@ DatabaseFileMenu::DatabaseFileMenu(FileMenu *parent)
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::resultsOKChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::intervalChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::rememberMeChanged	);
+	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::syncColumnChanged	);
 }
 
 void DatabaseFileMenu::loadFromSettings()
@@ -62,6 +63,7 @@ void DatabaseFileMenu::loadFromSettings()
 	_info._query		=						Settings::value( Settings::DB_IMPORT_QUERY		).toString();
 	_info._interval		=						Settings::value( Settings::DB_IMPORT_INTERVAL	).toInt();
 	_info._rememberMe	=						Settings::value( Settings::DB_REMEMBER_ME		).toBool();
+	_info._syncColumn	=						Settings::value( Settings::DB_IMPORT_SYNC_COLUMN	).toString();
 	
 	emit allChanged();
 }
@@ -346,3 +348,16 @@ void DatabaseFileMenu::setInterval(int newInterval)
 }
 
 
+
+void DatabaseFileMenu::setSyncColumn(const QString & newSyncColumn)
+{
+	if (_info._syncColumn == newSyncColumn)
+		return;
+	
+	_info._syncColumn = newSyncColumn;
+	
+	if(useDataSetPackage())	DataSetPackage::pkg()->setDatabaseJson(_info.toJson());
+	else					Settings::setValue(Settings::DB_IMPORT_SYNC_COLUMN, _info._syncColumn);
+	
+	emit syncColumnChanged();
+}
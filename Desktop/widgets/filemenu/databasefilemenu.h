@@ -26,6 +26,7 @@ class DatabaseFileMenu : public FileMenuObject
 	Q_PROPERTY(int			interval	READ interval		WRITE setInterval		NOTIFY intervalChanged		)
 	Q_PROPERTY(bool			dbMaybeFile	READ dbMaybeFile							NOTIFY dbTypeChanged		)
 	Q_PROPERTY(bool			rememberMe	READ rememberMe		WRITE setRememberMe		NOTIFY rememberMeChanged	)
+	Q_PROPERTY(QString		syncColumn	READ syncColumn		WRITE setSyncColumn		NOTIFY syncColumnChanged	)
 
 public:
 	explicit					DatabaseFileMenu(FileMenu *parent = nullptr);
@@ -50,6 +51,7 @@ public:
 	int							interval()			const { return _info._interval;						}
 	bool						dbMaybeFile()		const { return _info._dbType == DbType::QSQLITE;	}
 	const bool					rememberMe()		const { return _info._rememberMe;					}
+	const QString		&		syncColumn()		const { return _info._syncColumn;					}
 
 	bool						readyForImport()	const;
 
@@ -68,6 +70,7 @@ public:
 	void						setResultsOK(	bool			newResultsOK	);
 	void						setInterval(	int				newInterval		);
 	void						setRememberMe(	bool			rememberMe		);
+	void						setSyncColumn(	const QString &	newSyncColumn	);
 	
 private slots:
 	void						resetEphemeralFields();
@@ -88,6 +91,7 @@ signals:
 	void						resultsOKChanged();
 	void						intervalChanged();
 	void						rememberMeChanged();
+	void						syncColumnChanged();
 	
 private:
 	QString						_runQuery();
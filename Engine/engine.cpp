@@ -84,9 +84,9 @@ Engine::Engine(int slaveNo, unsigned long parentPID)
 	rbridge_setJaspResultsFileSource(	boost::bind(&Engine::provideJaspResultsFileName,	this, _1, _2));
 
 	rbridge_setColumnFunctionSources(	boost::bind(&Engine::getColumnType,					this, _1),
-										boost::bind(&Engine::setColumnDataAsScale,			this, _1, _2),
-										boost::bind(&Engine::setColumnDataAsOrdinal,		this, _1, _2, _3),
-										boost::bind(&Engine::setColumnDataAsNominal,		this, _1, _2, _3),
+										boost::bind(&Engine::setColumnDataAsScale,			this, _1, _2, _3),
+										boost::bind(&Engine::setColumnDataAsOrdinal,		this, _1, _2, _3, _4),
+										boost::bind(&Engine::setColumnDataAsNominal,		this, _1, _2, _3, _4),
 										boost::bind(&Engine::setColumnDataAsNominalText,	this, _1, _2));
 
 	rbridge_setGetDataSetRowCountSource( boost::bind(&Engine::dataSetRowCount, this));
@@ -126,7 +126,7 @@ void Engine::initialize()
 	}
 	catch(std::exception & e)
 	{
-		Log::log() << "Engine::initialize() failed! The exception caught was: '" << e.what() << "'" << std::endl;
+		Log::error() << "Engine::initialize() failed! The exception caught was: '" << e.what() << "'" << std::endl;
 		throw e;
 	}
 }
@@ -262,10 +262,12 @@ bool Engine::receiveMessages(int timeout)
 			case engineState::resuming:				resumeEngine(jsonRequest);					break;
 			case engineState::moduleInstallRequest:
 			case engineState::moduleLoadRequest:	receiveModuleRequestMessage(jsonRequest);	break;
-			case engineState::stopRequested:		stopEngine();								break;
+			case engineState::stopRequested:		stopEngine(jsonRequest);					break;
 			case engineState::logCfg:				receiveLogCfg(jsonRequest);					break;
 			case engineState::settings:				receiveSettings(jsonRequest);				break;
 			case engineState::reloadData:			receiveReloadData();						break;
+			case engineState::cleanMemory:			receiveCleanMemory(jsonRequest);			break;
+			case engineState::saveStates:			receiveSaveStates(jsonRequest);				break;
 			default:								throw std::runtime_error("Engine::receiveMessages begs you to add your new engineState " + engineStateToString(_lastRequest) + " to it!");
 			}
 	}
@@ -444,6 +446,9 @@ void Engine::runComputeColumn(const std::string & computeColumnName, const std::
 		{columnType::nominalText,	".setColumnDataAsNominalText"	}};
 
 	std::string computeColumnCodeComplete	= "local({;calcedVals <- {"+computeColumnCode +"};\n"  "return(toString(" + setColumnFunction.at(computeColumnType) + "('" + computeColumnName +"', calcedVals)));})";
+
+	_lastColumnChanges = ColumnChanges();
+
 	std::string computeColumnResultStr		= rbridge_evalRCodeWhiteListed(computeColumnCodeComplete, false);
 
 	Json::Value computeColumnResponse		= Json::objectValue;
@@ -451,6 +456,7 @@ void Engine::runComputeColumn(const std::string & computeColumnName, const std::
 	computeColumnResponse["result"]			= computeColumnResultStr;
 	computeColumnResponse["error"]			= jaspRCPP_getLastErrorMsg();
 	computeColumnResponse["columnName"]		= computeColumnName;
+	computeColumnResponse["changes"]		= _lastColumnChanges.toJson();
 
 	sendString(computeColumnResponse.toStyledString());
 
@@ -495,6 +501,8 @@ void Engine::receiveAnalysisMessage(const Json::Value & jsonRequest)
 	if(_engineState != engineState::idle && _engineState != engineState::analysis)
 		throw std::runtime_error("Unexpected analysis message, current state is not idle or analysis (" + engineStateToString(_engineState) + ")");
 
+	forgetRemovedAnalyses(jsonRequest);
+
 	int analysisId		= jsonRequest.get("id",			-1).asInt(),
 		analysisRev		= jsonRequest.get("revision",	-1).asInt();
 	performType perform	= performTypeFromString(jsonRequest.get("perform", "run").asString());
@@ -627,6 +635,7 @@ void Engine::runAnalysis()
 			//It needs to be re-run and the tempfiles can be cleared.
 			_analysisStatus = Status::toRun;
 			TempFiles::deleteList(TempFiles::retrieveList(_analysisId));
+			rbridge_forgetAnalysisState(_analysisId);
 			return;
 		
 
@@ -745,6 +754,12 @@ void Engine::sendAnalysisResults()
 	sendString(response.toStyledString());
 }
 
+void Engine::forgetRemovedAnalyses(const Json::Value & jsonRequest)
+{
+	for(const Json::Value & id : jsonRequest.get("removedAnalyses", Json::arrayValue))
+		rbridge_forgetAnalysisState(id.asInt());
+}
+
 void Engine::removeNonKeepFiles(const Json::Value & filesToKeepValue)
 {
 	std::vector<std::string> filesToKeep;
@@ -817,40 +832,17 @@ bool Engine::isColumnNameOk(std::string columnName)
 	}
 }
 
-bool Engine::setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, std::vector<int> & data, const std::map<int, std::string> & levels)
+bool Engine::overwriteColumnData(const std::string & columnName, std::function<ColumnChanges(Column & column)> overwrite)
 {
-	std::map<int, int> uniqueInts;
-
-	for(auto keyval : levels)
-	{
-		size_t convertedChars;
-
-		try {
-			int asInt = std::stoi(keyval.second, &convertedChars);
-
-			if(convertedChars == keyval.second.size()) //It was a number!
-				uniqueInts[keyval.first] = asInt;
-		}
-		catch(std::invalid_argument & e) {}
-	}
+	if(!isColumnNameOk(columnName))
+		return false;
 
-	if(uniqueInts.size() == levels.size()) //everything was an int!
-	{
-		for(auto & dat : data)
-			if(dat != std::numeric_limits<int>::lowest())
-				dat = uniqueInts[dat];
+	_lastColumnChanges = overwrite(provideDataSet()->columns()[columnName]);
 
-		if(isOrdinal)	return	provideDataSet()->columns()[columnName].overwriteDataWithOrdinal(data);
-		else			return	provideDataSet()->columns()[columnName].overwriteDataWithNominal(data);
-	}
-	else
-	{
-		if(isOrdinal)	return	provideDataSet()->columns()[columnName].overwriteDataWithOrdinal(data, levels);
-		else			return	provideDataSet()->columns()[columnName].overwriteDataWithNominal(data, levels);
-	}
+	return _lastColumnChanges.changed();
 }
 
-void Engine::stopEngine()
+void Engine::stopEngine(const Json::Value & jsonRequest)
 {
 	Log::log() << "Engine::stopEngine() received, closing engine." << std::endl;
 
@@ -864,6 +856,8 @@ void Engine::stopEngine()
 
 	_engineState = engineState::stopped;
 
+	forgetRemovedAnalyses(jsonRequest);
+	rbridge_saveAnalysisStates(); //The process might be ended after this, and the states with it
 	freeRBridgeColumns();
 	SharedMemory::unloadDataSet();
 	sendEngineStopped();
@@ -890,6 +884,11 @@ void Engine::pauseEngine(const Json::Value & json)
 
 	_engineState = engineState::paused;
 
+	//Pausing might be followed by a kill or a restart, so the states go to their files. Unloading the data means a file is closed, then the ids of its analyses will be reused and their states should be dropped as well.
+	forgetRemovedAnalyses(json);
+	if(json.get("unloadData", false).asBool())	rbridge_memoryCleaning();
+	else										rbridge_saveAnalysisStates();
+
 	freeRBridgeColumns();
 	if(json.get("unloadData", false).asBool()) //Don't do it too often or otherwise the sharedmemfile might get lost. See https://github.com/jasp-stats/jasp-issues/issues/1302
 		SharedMemory::unloadDataSet();
@@ -919,6 +918,44 @@ void Engine::receiveReloadData()
 	sendString(rCodeResponse.toStyledString());
 }
 
+void Engine::receiveCleanMemory(const Json::Value & jsonRequest)
+{
+	Log::log() << "Engine asked to clean up its memory because the engines use too much of it." << std::endl;
+
+	forgetRemovedAnalyses(jsonRequest);
+	rbridge_memoryCleaning();
+
+	_engineState = engineState::idle;
+
+	Json::Value cleanMemoryResponse		= Json::objectValue;
+	cleanMemoryResponse["typeRequest"]	= engineStateToString(engineState::cleanMemory);
+	sendString(cleanMemoryResponse.toStyledString());
+}
+
+///The states are kept in memory and only written when asked, either listed in "analyses" and handed over to another engine or all of them before the desktop saves a .jasp
+void Engine::receiveSaveStates(const Json::Value & jsonRequest)
+{
+	bool	handOver	= jsonRequest.get("handOver", false).asBool(),
+			saved		= true;
+
+	forgetRemovedAnalyses(jsonRequest);
+
+	if(jsonRequest.get("all", false).asBool())
+		saved = rbridge_saveAnalysisStates();
+	else
+		for(const Json::Value & id : jsonRequest.get("analyses", Json::arrayValue))
+			saved = rbridge_saveAnalysisState(id.asInt(), handOver) && saved;
+
+	if(!saved)
+		Log::log() << "Engine could not write all analysis states to their files." << std::endl;
+
+	_engineState = engineState::idle;
+
+	Json::Value saveStatesResponse		= Json::objectValue;
+	saveStatesResponse["typeRequest"]	= engineStateToString(engineState::saveStates);
+	sendString(saveStatesResponse.toStyledString());
+}
+
 void Engine::sendEnginePaused()
 {
 	Json::Value rCodeResponse		= Json::objectValue;
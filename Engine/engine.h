@@ -24,6 +24,7 @@
 #include "processinfo.h"
 #include <json/json.h>
 #include "columnencoder.h"
+#include <functional>
 
 /// The Engine handles communication between Desktop and R
 /// It can be in a variety of states _currentEngineState and can run analyses, filters, compute columns and Rcode.
@@ -50,15 +51,13 @@ public:
 	int  getColumnType(const std::string & columnName) { return int(!isColumnNameOk(columnName) ? columnType::unknown : provideDataSet()->column(columnName).getColumnType()); }
 
 	//return true if changed:
-	bool setColumnDataAsScale(		const std::string & columnName, const	std::vector<double>			& scalarData)												{	if(!isColumnNameOk(columnName)) return false; return provideDataSet()->columns()[columnName].overwriteDataWithScale(scalarData);				}
-	bool setColumnDataAsOrdinal(	const std::string & columnName,			std::vector<int>			& ordinalData, const std::map<int, std::string> & levels)	{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(true,  columnName, ordinalData, levels);					}
-	bool setColumnDataAsNominal(	const std::string & columnName,			std::vector<int>			& nominalData, const std::map<int, std::string> & levels)	{	if(!isColumnNameOk(columnName)) return false; return setColumnDataAsNominalOrOrdinal(false, columnName, nominalData, levels);					}
-	bool setColumnDataAsNominalText(const std::string & columnName, const	std::vector<std::string>	& nominalData)												{	if(!isColumnNameOk(columnName)) return false; return provideDataSet()->columns()[columnName].overwriteDataWithNominal(nominalData);			}
+	bool setColumnDataAsScale(		const std::string & columnName, const double	* scalarData,	size_t length)												{ return overwriteColumnData(columnName, [&](Column & column) { return column.overwriteDataWithScale(scalarData, length);								}); }
+	bool setColumnDataAsOrdinal(	const std::string & columnName, const int		* ordinalData,	size_t length, const std::map<int, std::string> & levels)	{ return overwriteColumnData(columnName, [&](Column & column) { return column.overwriteDataWithNominalOrOrdinal(ordinalData, length, levels, true);		}); }
+	bool setColumnDataAsNominal(	const std::string & columnName, const int		* nominalData,	size_t length, const std::map<int, std::string> & levels)	{ return overwriteColumnData(columnName, [&](Column & column) { return column.overwriteDataWithNominalOrOrdinal(nominalData, length, levels, false);	}); }
+	bool setColumnDataAsNominalText(const std::string & columnName, const std::vector<std::string> & nominalData)												{ return overwriteColumnData(columnName, [&](Column & column) { return column.overwriteDataWithNominalText(nominalData);								}); }
 
 	bool isColumnNameOk(std::string columnName);
 
-	bool setColumnDataAsNominalOrOrdinal(bool isOrdinal, const std::string & columnName, std::vector<int> & data, const std::map<int, std::string> & levels);
-
 	int dataSetRowCount()	{ return static_cast<int>(provideDataSet()->rowCount()); }
 
 	bool paused() { return _engineState == engineState::paused; }
@@ -75,6 +74,8 @@ private: // Methods:
 	void receiveModuleRequestMessage(	const Json::Value & jsonRequest);
 	void receiveReloadData();
 	void receiveLogCfg(					const Json::Value & jsonRequest);
+	void receiveCleanMemory(			const Json::Value & jsonRequest);
+	void receiveSaveStates(				const Json::Value & jsonRequest);
 	void receiveSettings(				const Json::Value & jsonRequest);
 	void absorbSettings(				const Json::Value & json);
 
@@ -85,7 +86,7 @@ private: // Methods:
 	void runRCodeCommander(		  std::string   rCode																						);
 
 
-	void stopEngine();
+	void stopEngine(	const Json::Value & jsonRequest);
 	void pauseEngine(	const Json::Value & jsonRequest);
 	void resumeEngine(	const Json::Value & jsonRequest); 
 	void sendEnginePaused();
@@ -96,6 +97,7 @@ private: // Methods:
 	void editImage();
 	void rewriteImages();
 	void removeNonKeepFiles(const Json::Value & filesToKeepValue);
+	void forgetRemovedAnalyses(const Json::Value & jsonRequest);
 
 	void sendAnalysisResults();
 	void sendFilterResult(		int filterRequestId,				const std::vector<bool> & filterResult, const std::string & warning = "");
@@ -111,6 +113,8 @@ private: // Methods:
 	void provideSpecificFileName(	const std::string & specificName,	std::string & root,	std::string & relativePath);
 	void reloadColumnNames();
 
+	bool overwriteColumnData(const std::string & columnName, std::function<ColumnChanges(Column & column)> overwrite);
+
 private: // Data:
 	static Engine	*	_EngineInstance;
 	const int			_slaveNo;
@@ -147,6 +151,8 @@ private: // Data:
 	Json::Value			_imageOptions,
 						_analysisResults;
 
+	ColumnChanges		_lastColumnChanges;	///< What the last write to a (computed) column changed, sent along with the reply to computeColumn
+
 	IPCChannel *		_channel = nullptr;
 	
 	ColumnEncoder	*	_extraEncodings = nullptr;
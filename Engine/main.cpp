@@ -102,7 +102,7 @@ int main(int argc, char *argv[])
 		}
 		catch (std::exception & e)
 		{
-			Log::log() << "Engine had an uncaught exception of: " << e.what() << std::endl;;
+			Log::error() << "Engine had an uncaught exception of: " << e.what() << std::endl;;
 			throw e;
 		}
 
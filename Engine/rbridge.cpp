@@ -46,9 +46,9 @@ boost::function<void(const std::string &, std::string &, std::string &)>	rbridge
 boost::function<void(std::string &, std::string &)>							rbridge_stateFileSource			= NULL,
 																			rbridge_jaspResultsFileSource	= NULL;
 
-boost::function<bool(const std::string &, const	std::vector<double>&)											> rbridge_setColumnDataAsScaleEngine		= NULL;
-boost::function<bool(const std::string &,		std::vector<int>&,			const std::map<int, std::string>&)	> rbridge_setColumnDataAsOrdinalEngine		= NULL;
-boost::function<bool(const std::string &,		std::vector<int>&,			const std::map<int, std::string>&)	> rbridge_setColumnDataAsNominalEngine		= NULL;
+boost::function<bool(const std::string &, const	double *,	size_t)											> rbridge_setColumnDataAsScaleEngine		= NULL;
+boost::function<bool(const std::string &, const	int *,		size_t,	const std::map<int, std::string>&)	> rbridge_setColumnDataAsOrdinalEngine		= NULL;
+boost::function<bool(const std::string &, const	int *,		size_t,	const std::map<int, std::string>&)	> rbridge_setColumnDataAsNominalEngine		= NULL;
 boost::function<bool(const std::string &, const	std::vector<std::string>&)										> rbridge_setColumnDataAsNominalTextEngine	= NULL;
 
 char** rbridge_getLabels(const Labels &levels, size_t &nbLevels);
@@ -136,9 +136,9 @@ void rbridge_setStateFileSource(		boost::function<void (std::string &, std::stri
 void rbridge_setJaspResultsFileSource(	boost::function<void (std::string &, std::string &)> source)						{	rbridge_jaspResultsFileSource	= source; }
 
 void rbridge_setColumnFunctionSources(			boost::function<int (const std::string &)																		> getTypeSource,
-												boost::function<bool(const std::string &, const std::vector<double>		&)										> scaleSource,
-												boost::function<bool(const std::string &,		std::vector<int>		&,	const std::map<int, std::string>&)	> ordinalSource,
-												boost::function<bool(const std::string &,		std::vector<int>		&,	const std::map<int, std::string>&)	> nominalSource,
+												boost::function<bool(const std::string &, const double *,	size_t)											> scaleSource,
+												boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&)	> ordinalSource,
+												boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&)	> nominalSource,
 												boost::function<bool(const std::string &, const std::vector<std::string>&)										> nominalTextSource)
 {
 	rbridge_getColumnTypeEngine					= getTypeSource;
@@ -649,35 +649,29 @@ extern "C" bool STDCALL rbridge_setColumnAsScale(const char* columnName, double
 {
 	JASP_COLUMN_DECODE_HERE;
 
-	std::vector<double> scalars(scalarData, scalarData + length);
-
-	return rbridge_setColumnDataAsScaleEngine(colName, scalars);
+	return rbridge_setColumnDataAsScaleEngine(colName, scalarData, length);
 }
 
 extern "C" bool STDCALL rbridge_setColumnAsOrdinal(const char* columnName, int * ordinalData, size_t length, const char ** levels, size_t numLevels)
 {
 	JASP_COLUMN_DECODE_HERE;
 
-	std::vector<int> ordinals(ordinalData, ordinalData + length);
-
 	std::map<int, std::string> labels;
 	for(size_t lvl=0; lvl<numLevels; lvl++)
 		labels[lvl + 1] = levels[lvl];
 
-	return rbridge_setColumnDataAsOrdinalEngine(colName, ordinals, labels);
+	return rbridge_setColumnDataAsOrdinalEngine(colName, ordinalData, length, labels);
 }
 
 extern "C" bool STDCALL rbridge_setColumnAsNominal(const char* columnName, int * nominalData, size_t length, const char ** levels, size_t numLevels)
 {
 	JASP_COLUMN_DECODE_HERE;
 
-	std::vector<int> nominals(nominalData, nominalData + length);
-
 	std::map<int, std::string> labels;
 	for(size_t lvl=0; lvl<numLevels; lvl++)
 		labels[lvl + 1] = levels[lvl];
 
-	return rbridge_setColumnDataAsNominalEngine(colName, nominals, labels);
+	return rbridge_setColumnDataAsNominalEngine(colName, nominalData, length, labels);
 }
 
 extern "C" bool STDCALL rbridge_setColumnAsNominalText(const char* columnName, const char ** nominalData, size_t length)
@@ -700,6 +694,21 @@ void rbridge_memoryCleaning()
 	jaspRCPP_purgeGlobalEnvironment();
 }
 
+void rbridge_forgetAnalysisState(int analysisID)
+{
+	jaspRCPP_forgetState(analysisID);
+}
+
+bool rbridge_saveAnalysisState(int analysisID, bool handOver)
+{
+	return jaspRCPP_saveState(analysisID, handOver);
+}
+
+bool rbridge_saveAnalysisStates()
+{
+	return jaspRCPP_saveAllStates();
+}
+
 void freeRBridgeColumns()
 {
 	if(datasetStatic == nullptr)
@@ -86,13 +86,16 @@ extern "C" {
 	void rbridge_setJaspResultsFileSource(	boost::function<void(std::string &, std::string &)> source);
 	void rbridge_setDataSetSource(			boost::function<DataSet *()> source);
 	void rbridge_memoryCleaning();
+	void rbridge_forgetAnalysisState(int analysisID);
+	bool rbridge_saveAnalysisState(int analysisID, bool handOver);
+	bool rbridge_saveAnalysisStates();
 
 	std::string rbridge_runModuleCall(const std::string &name, const std::string &title, const std::string &moduleCall, const std::string &dataKey, const std::string &options, const std::string &stateKey, int analysisID, int analysisRevision, bool developerMode);
 
 	void rbridge_setColumnFunctionSources(			boost::function<int (const std::string &)																		> getTypeSource,
-													boost::function<bool(const std::string &, const std::vector<double>&)											> scaleSource,
-													boost::function<bool(const std::string &,		std::vector<int>&,			const std::map<int, std::string>&)	> ordinalSource,
-													boost::function<bool(const std::string &,		std::vector<int>&,			const std::map<int, std::string>&)	> nominalSource,
+													boost::function<bool(const std::string &, const double *,	size_t)											> scaleSource,
+													boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&)	> ordinalSource,
+													boost::function<bool(const std::string &, const int *,		size_t,	const std::map<int, std::string>&)	> nominalSource,
 													boost::function<bool(const std::string &, const std::vector<std::string>&)										> nominalTextSource);
 	void rbridge_setGetDataSetRowCountSource(		boost::function<int()> source);
 
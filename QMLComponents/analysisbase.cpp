@@ -1,3 +1,5 @@
+#include <QQmlIncubator>
+#include <QPointer>
 #include "analysisbase.h"
 #include "analysisform.h"
 #include "log.h"
@@ -19,15 +21,33 @@ AnalysisBase::AnalysisBase(QObject* parent, AnalysisBase* duplicateMe)
 {
 }
 
+AnalysisBase::~AnalysisBase()
+{
+	cancelFormCreation();
+}
+
 QQuickItem* AnalysisBase::formItem() const
 {
 	return _analysisForm;
 }
 
+void AnalysisBase::cancelFormCreation()
+{
+	if(!_formIncubator)
+		return;
+
+	Log::log() << "Analysis(" << this << ") was still creating its form, cancelling that." << std::endl;
+
+	_formIncubator->clear();
+	_formIncubator = nullptr;
+}
+
 void AnalysisBase::destroyForm()
 {
 	Log::log() << "Analysis(" << this << ")::destroyForm() called" << std::endl;
 
+	cancelFormCreation();
+
 	if(_analysisForm)
 	{
 		Log::log(false) << " it has a AnalysisForm " << _analysisForm << " so let's destroy it" << std::endl;
@@ -48,6 +68,16 @@ void AnalysisBase::createForm(QQuickItem* parentItem)
 {
 	Log::log() << "Analysis(" << this << ")::createForm() called with parentItem " << parentItem << std::endl;
 
+	if(creatingForm())
+	{
+		Log::log() << "It is still creating its form, so that is left to finish." << std::endl;
+
+		if(parentItem)
+			_formIncubatorParent = _parentItem = parentItem;
+
+		return;
+	}
+
 	setQmlError("");
 	
 	if(parentItem)
@@ -65,24 +95,45 @@ void AnalysisBase::createForm(QQuickItem* parentItem)
 	else if(!parentItem)
 		parentItem = _parentItem;
 
-	try
+	cancelFormCreation();
+
+	_formIncubatorParent = parentItem;
+
+	auto whenCreated = [this](QObject * newForm, const std::string & error)
 	{
-		Log::log()  << std::endl << "Loading QML form from: " << qmlFormPath(false, false) << std::endl;
+		_formIncubator = nullptr;
 
-		QObject * newForm = instantiateQml(QUrl::fromLocalFile(tq(qmlFormPath(false, false))), module(), qmlContext(parentItem));
+		if(error != "")
+		{
+			setQmlError(tq(error));
+			return;
+		}
 
 		Log::log() << "Created a form, got pointer " << newForm << std::endl;
 
 		_analysisForm = qobject_cast<AnalysisForm *>(newForm);
 
 		if(!_analysisForm)
-			throw std::logic_error("QML file '" + qmlFormPath(false, false) + "' didn't spawn into AnalysisForm, but into: " + (newForm ? fq(newForm->objectName()) : "null"));
+		{
+			setQmlError(tq("QML file '" + qmlFormPath(false, false) + "' didn't spawn into AnalysisForm, but into: " + (newForm ? fq(newForm->objectName()) : "null")));
+			delete newForm;
+			return;
+		}
 
 		_analysisForm->setAnalysis(this);
 		_analysisForm->setParent(this);
-		_analysisForm->setParentItem(parentItem);
+		_analysisForm->setParentItem(_formIncubatorParent ? _formIncubatorParent.data() : _parentItem);
 
 		emit formItemChanged();
+
+		formCreated();
+	};
+
+	try
+	{
+		Log::log()  << std::endl << "Loading QML form from: " << qmlFormPath(false, false) << std::endl;
+
+		_formIncubator = instantiateQmlAsync(QUrl::fromLocalFile(tq(qmlFormPath(false, false))), module(), whenCreated, qmlContext(parentItem));
 	}
 	catch(qmlLoadError & e)
 	{
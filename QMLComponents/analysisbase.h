@@ -2,11 +2,13 @@
 #define ANALYSISBASE_H
 
 #include <QObject>
+#include <QPointer>
 #include <json/json.h>
 #include "controls/jaspcontrol.h"
 #include "appinfo.h"
 
 class AnalysisForm;
+class QQmlIncubator;
 
 class AnalysisBase : public QObject
 {
@@ -17,6 +19,7 @@ class AnalysisBase : public QObject
 public:
 	explicit AnalysisBase(QObject *parent = nullptr, Version moduleVersion = AppInfo::version);
 	AnalysisBase(QObject *parent, AnalysisBase* duplicateMe);
+	~AnalysisBase();
 
 	virtual bool isOwnComputedColumn(const std::string &col)				const	{ return false; }
 	virtual void refresh()															{}
@@ -40,8 +43,9 @@ public:
 									bool ignoreReadyForUse = false)			const;
 
 	virtual Q_INVOKABLE	QString	helpFile()									const	{ return ""; }
-	virtual Q_INVOKABLE void	createForm(QQuickItem* parentItem=nullptr);
+	virtual Q_INVOKABLE void	createForm(QQuickItem* parentItem=nullptr);	///< Does nothing but remember parentItem while the form is still being created, starting over would throw away what was incubated so far
 	virtual				void	destroyForm();
+						bool	creatingForm()								const	{ return _formIncubator && !_analysisForm;	}
 
 	const Json::Value&	boundValues()										const	{ return _boundValues;		}
 	const Json::Value&	orgBoundValues()									const	{ return _orgBoundValues;	}
@@ -78,9 +82,15 @@ signals:
 protected:
 	Json::Value&	_getParentBoundValue(const QVector<JASPControl::ParentKey> & parentKeys, QVector<std::string>& parentNames, bool & found, bool createAnyway = false);
 
+	///Called when createForm is done with a new _analysisForm, which can be a few frames after createForm was called because the form is built asynchronously.
+	virtual void	formCreated()																	{}
+			void	cancelFormCreation();
+
 
 	AnalysisForm*	_analysisForm		= nullptr;
 	QQuickItem	*	_parentItem			= nullptr;
+	QQmlIncubator*	_formIncubator		= nullptr;
+	QPointer<QQuickItem>	_formIncubatorParent;	///< Where the form goes once _formIncubator is done
 	QString			_qmlError;
 	Version			_moduleVersion;
 
@@ -52,6 +52,7 @@ SourceItem::SourceItem(
 	_combineWithOtherModels		= map.contains("combineWithOtherModels")	? map["combineWithOtherModels"].toBool()	: false;
 	_nativeModelRole			= map.contains("nativeModelRole")			? map["nativeModelRole"].toInt()			: Qt::DisplayRole;
 	_combineTerms				= map.contains("combineTerms")				? JASPControl::CombinationType(map["combineTerms"].toInt())	: JASPControl::CombinationType::NoCombination;
+	_maxCombinations			= map.contains("maxCombinations")			? size_t(map["maxCombinations"].toLongLong())				: Terms::maxCombinations();
 	if (isInfoProviderModel(_nativeModel))									_isVariableInfoModel = true;
 	if (_modelUse.contains("levels"))										_listControl->setUseSourceLevels(true);
 	if (_listControl->useSourceLevels() && !_modelUse.contains("levels"))	_modelUse.append("levels");
@@ -494,7 +495,14 @@ Terms SourceItem::_readAllTerms()
 	}
 
 	if (_combineTerms != JASPControl::CombinationType::NoCombination)
-		terms = terms.combineTerms(_combineTerms);
+	{
+		size_t allCombinations = terms.combinationsCount(_combineTerms);
+
+		terms = terms.combineTerms(_combineTerms, _maxCombinations);
+
+		if (allCombinations > _maxCombinations)
+			_listControl->addControlWarningTemporary(QObject::tr("These variables have %1 combinations, only the first %2 are shown.").arg(allCombinations).arg(_maxCombinations));
+	}
 
 	if (_onlyTermsWithXComponents > 0)
 	{
@@ -116,6 +116,7 @@ private:
 	QVector<ConditionVariable>		_conditionVariables;
 	bool							_connected					= false;
 	JASPControl::CombinationType	_combineTerms				= JASPControl::CombinationType::NoCombination;
+	size_t							_maxCombinations			= Terms::maxCombinations();
 	int								_onlyTermsWithXComponents	= 0;
 };
 
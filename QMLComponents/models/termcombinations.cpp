@@ -0,0 +1,97 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "termcombinations.h"
+#include "terms.h"
+
+#include <limits>
+
+TermCombinations::TermCombinations(const Terms & terms, size_t minWays, size_t maxWays)
+	: _minWays(minWays), _maxWays(std::min(maxWays, terms.size()))
+{
+	for (const Term & term : terms)
+		_components.append(term.asQString());
+
+	_startWays(minWays);
+}
+
+void TermCombinations::_startWays(size_t ways)
+{
+	_ways	= ways;
+	_atEnd	= _ways > _maxWays;
+
+	_indices.resize(_atEnd ? 0 : _ways);
+
+	for (size_t i = 0; i < _indices.size(); i++)
+		_indices[i] = i;
+}
+
+Term TermCombinations::current() const
+{
+	QStringList combination;
+
+	for (size_t index : _indices)
+		combination.append(_components[int(index)]);
+
+	return Term(combination);
+}
+
+void TermCombinations::next()
+{
+	if (_atEnd)
+		return;
+
+	const size_t n = size_t(_components.size());
+
+	// Find the rightmost position that can still move up, move it and put the ones after it right behind it
+	for (size_t i = _ways; i-- > 0; )
+		if (_indices[i] < n - _ways + i)
+		{
+			_indices[i]++;
+
+			for (size_t j = i + 1; j < _ways; j++)
+				_indices[j] = _indices[j - 1] + 1;
+
+			return;
+		}
+
+	_startWays(_ways + 1);
+}
+
+size_t TermCombinations::count() const
+{
+	const size_t	n		= size_t(_components.size()),
+					noRoom	= std::numeric_limits<size_t>::max();
+	size_t			total	= 0;
+
+	for (size_t ways = _minWays; ways <= _maxWays; ways++)
+	{
+		// n over ways, computed incrementally so that the intermediate results stay exact
+		size_t binomial = 1;
+
+		for (size_t k = 1; k <= ways && binomial != noRoom; k++)
+		{
+			size_t factor = n - ways + k;
+			binomial = binomial > noRoom / factor ? noRoom : binomial * factor / k;
+		}
+
+		total = total > noRoom - binomial ? noRoom : total + binomial;
+	}
+
+	return total;
+}
@@ -0,0 +1,58 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#ifndef TERMCOMBINATIONS_H
+#define TERMCOMBINATIONS_H
+
+#include <vector>
+#include <QStringList>
+
+#include "term.h"
+
+class Terms;
+
+///
+/// Enumerates the combinations of some terms one by one, instead of building all of them at once.
+/// Combinations are generated by increasing number of ways (minWays up to maxWays), and per number of ways in the lexicographic order
+/// of the positions of the terms, which is the order Terms::crossCombinations and Terms::wayCombinations always had.
+/// Each term is used as one component of the combination, as a whole.
+///
+class TermCombinations
+{
+public:
+	TermCombinations(const Terms & terms, size_t minWays, size_t maxWays);
+
+	bool	atEnd()		const { return _atEnd; }
+	Term	current()	const;
+	void	next();
+
+	///Number of combinations enumerated from start to end, saturates at SIZE_MAX
+	size_t	count()		const;
+
+private:
+	void	_startWays(size_t ways);
+
+	QStringList				_components;
+	std::vector<size_t>		_indices;
+	size_t					_minWays,
+							_ways,
+							_maxWays;
+	bool					_atEnd		= false;
+};
+
+#endif // TERMCOMBINATIONS_H
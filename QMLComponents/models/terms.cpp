@@ -17,6 +17,7 @@
 //
 
 #include "terms.h"
+#include "termcombinations.h"
 
 #include <sstream>
 
@@ -24,9 +25,12 @@
 #include <QIODevice>
 #include <QSet>
 #include "utilities/qutils.h"
+#include "log.h"
 
 using namespace std;
 
+size_t Terms::_maxCombinations = 100000;
+
 Terms::Terms(const QList<QList<QString> > &terms, Terms *parent)
 {
 	_parent = parent;
@@ -64,7 +68,7 @@ Terms::Terms(Terms *parent)
 
 void Terms::set(const std::vector<Term> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -72,7 +76,7 @@ void Terms::set(const std::vector<Term> &terms, bool isUnique)
 
 void Terms::set(const std::vector<string> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -80,7 +84,7 @@ void Terms::set(const std::vector<string> &terms, bool isUnique)
 
 void Terms::set(const std::vector<std::vector<string> > &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -88,7 +92,7 @@ void Terms::set(const std::vector<std::vector<string> > &terms, bool isUnique)
 
 void Terms::set(const QList<Term> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const Term &term : terms)
 		add(term, isUnique);
@@ -96,7 +100,7 @@ void Terms::set(const QList<Term> &terms, bool isUnique)
 
 void Terms::set(const Terms &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 	_hasDuplicate = terms.hasDuplicate();
 
 	for(const Term &term : terms)
@@ -105,7 +109,7 @@ void Terms::set(const Terms &terms, bool isUnique)
 
 void Terms::set(const QList<QList<QString> > &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const QList<QString> &term : terms)
 		add(Term(term), isUnique);
@@ -113,7 +117,7 @@ void Terms::set(const QList<QList<QString> > &terms, bool isUnique)
 
 void Terms::set(const QList<QString> &terms, bool isUnique)
 {
-	_terms.clear();
+	clear();
 
 	for(const QString &term : terms)
 		add(Term(term), isUnique);
@@ -134,9 +138,18 @@ void Terms::add(const Term &term, bool isUnique)
 	{
 		if (!_hasDuplicate && contains(term)) _hasDuplicate = true;
 		_terms.push_back(term);
+		indexAdd(term);
 	}
 	else if (_parent != nullptr)
 	{
+		// Terms are kept in the order of the parent, so most of the time (when adding in that order) the new term belongs at the end
+		if (_terms.empty() || termCompare(term, _terms.back()) < 0)
+		{
+			_terms.push_back(term);
+			indexAdd(term);
+			return;
+		}
+
 		vector<Term>::iterator itr = _terms.begin();
 		int result = -1;
 
@@ -148,14 +161,23 @@ void Terms::add(const Term &term, bool isUnique)
 		}
 
 		if (result > 0)
+		{
 			_terms.insert(itr, term);
+			indexAdd(term);
+		}
 		else if (result < 0)
+		{
 			_terms.push_back(term);
+			indexAdd(term);
+		}
 	}
 	else
 	{
 		if ( ! contains(term))
+		{
 			_terms.push_back(term);
+			indexAdd(term);
+		}
 	}
 }
 
@@ -163,12 +185,8 @@ void Terms::insert(int index, const Term &term)
 {
 	if (_parent == nullptr)
 	{
-		vector<Term>::iterator itr = _terms.begin();
-
-		for (int i = 0; i < index; i++)
-			itr++;
-
-		_terms.insert(itr, term);
+		_terms.insert(_terms.begin() + std::min(size_t(std::max(index, 0)), _terms.size()), term);
+		indexAdd(term);
 	}
 	else
 	{
@@ -180,12 +198,10 @@ void Terms::insert(int index, const Terms &terms)
 {
 	if (_parent == nullptr)
 	{
-		vector<Term>::iterator itr = _terms.begin();
-
-		for (int i = 0; i < index; i++)
-			itr++;
+		_terms.insert(_terms.begin() + std::min(size_t(std::max(index, 0)), _terms.size()), terms.begin(), terms.end());
 
-		_terms.insert(itr, terms.begin(), terms.end());
+		for(const Term & term : terms)
+			indexAdd(term);
 	}
 	else
 	{
@@ -208,7 +224,8 @@ const Term& Terms::at(size_t index) const
 
 bool Terms::contains(const Term &term) const
 {
-	return std::find(_terms.begin(), _terms.end(), term) != _terms.end();
+	ensureIndex();
+	return _termCounts.contains(termKey(term));
 }
 
 bool Terms::contains(const std::string & component)
@@ -231,13 +248,8 @@ int Terms::indexOf(const QString &component) const
 
 bool Terms::contains(const QString & component)
 {
-	for(const Term &term : _terms)
-	{
-		if (term.contains(component))
-			return true;
-	}
-
-	return false;
+	ensureIndex();
+	return _componentCounts.contains(component);
 }
 
 vector<string> Terms::asVector() const
@@ -307,75 +319,53 @@ Terms Terms::sortComponents(const Terms &terms) const
 	return Terms(ts);
 }
 
-Terms Terms::crossCombinations() const
+Terms Terms::crossCombinations(size_t limit) const
 {
 	if (_terms.size() <= 1)
 		return Terms(asVector());
 
 	Terms t;
 
-	for (uint r = 1; r <= _terms.size(); r++)
-	{
-		vector<bool> v(_terms.size());
-		fill(v.begin() + r, v.end(), true);
-
-		do {
-
-			vector<string> combination;
-
-			for (uint i = 0; i < _terms.size(); i++) {
-				if (!v[i])
-					combination.push_back(_terms.at(i).asString());
-			}
+	TermCombinations combinations(*this, 1, _terms.size());
 
-			t.add(Term(combination));
+	if (combinations.count() > limit)
+		Log::log() << "Terms::crossCombinations of " << _terms.size() << " terms would give " << combinations.count() << " combinations, only the first " << limit << " are used." << std::endl;
 
-		} while (std::next_permutation(v.begin(), v.end()));
-	}
+	for (; !combinations.atEnd() && t.size() < limit; combinations.next())
+		t.add(combinations.current());
 
 	return t;
 }
 
-Terms Terms::wayCombinations(int ways) const
+Terms Terms::wayCombinations(int ways, size_t limit) const
 {
 	Terms t;
 
-	for (int r = ways; r <= ways; r++)
-	{
-		vector<bool> v(_terms.size());
-		std::fill(v.begin() + r, v.end(), true);
-
-		do {
-
-			vector<string> combination;
+	TermCombinations combinations(*this, size_t(std::max(ways, 0)), size_t(std::max(ways, 0)));
 
-			for (uint i = 0; i < _terms.size(); ++i) {
-				if (!v[i])
-					combination.push_back(_terms.at(i).asString());
-			}
-
-			t.add(Term(combination));
+	if (combinations.count() > limit)
+		Log::log() << "Terms::wayCombinations(" << ways << ") of " << _terms.size() << " terms would give " << combinations.count() << " combinations, only the first " << limit << " are used." << std::endl;
 
-		} while (std::next_permutation(v.begin(), v.end()));
-	}
+	for (; !combinations.atEnd() && t.size() < limit; combinations.next())
+		t.add(combinations.current());
 
 	return t;
 }
 
-Terms Terms::ffCombinations(const Terms &terms)
+Terms Terms::ffCombinations(const Terms &terms, size_t limit)
 {
 	// full factorial combinations
 
-	Terms combos = terms.crossCombinations();
+	Terms combos = terms.crossCombinations(limit);
 
 	Terms newTerms;
 
 	newTerms.add(*this);
 	newTerms.add(combos);
 
-	for (uint i = 0; i < _terms.size(); i++)
+	for (uint i = 0; i < _terms.size() && newTerms.size() < limit; i++)
 	{
-		for (uint j = 0; j < combos.size(); j++)
+		for (uint j = 0; j < combos.size() && newTerms.size() < limit; j++)
 		{
 			QStringList term = _terms.at(i).components();
 			QStringList newTerm = combos.at(j).components();
@@ -390,7 +380,7 @@ Terms Terms::ffCombinations(const Terms &terms)
 	return newTerms;
 }
 
-Terms Terms::combineTerms(JASPControl::CombinationType type)
+Terms Terms::combineTerms(JASPControl::CombinationType type, size_t limit)
 {
 	Terms combinedTerms;
 
@@ -399,22 +389,22 @@ Terms Terms::combineTerms(JASPControl::CombinationType type)
 	switch (type)
 	{
 	case JASPControl::CombinationType::CombinationCross:
-		combinedTerms = crossCombinations();
+		combinedTerms = crossCombinations(limit);
 		break;
 	case JASPControl::CombinationType::CombinationInteraction:
-		combinedTerms = wayCombinations(nbTerms);
+		combinedTerms = wayCombinations(nbTerms, limit);
 		break;
 	case JASPControl::CombinationType::Combination2Way:
-		combinedTerms = nbTerms < 2 ? Terms() : wayCombinations(2);
+		combinedTerms = nbTerms < 2 ? Terms() : wayCombinations(2, limit);
 		break;
 	case JASPControl::CombinationType::Combination3Way:
-		combinedTerms = nbTerms < 3 ? Terms() : wayCombinations(3);
+		combinedTerms = nbTerms < 3 ? Terms() : wayCombinations(3, limit);
 		break;
 	case JASPControl::CombinationType::Combination4Way:
-		combinedTerms = nbTerms < 4 ? Terms() : wayCombinations(4);
+		combinedTerms = nbTerms < 4 ? Terms() : wayCombinations(4, limit);
 		break;
 	case JASPControl::CombinationType::Combination5Way:
-		combinedTerms = nbTerms < 5 ? Terms() : wayCombinations(5);
+		combinedTerms = nbTerms < 5 ? Terms() : wayCombinations(5, limit);
 		break;
 	case JASPControl::CombinationType::NoCombination:
 	default:
@@ -425,6 +415,23 @@ Terms Terms::combineTerms(JASPControl::CombinationType type)
 	return combinedTerms;
 }
 
+size_t Terms::combinationsCount(JASPControl::CombinationType type) const
+{
+	size_t nbTerms = size();
+
+	switch (type)
+	{
+	case JASPControl::CombinationType::CombinationCross:		return nbTerms <= 1 ? nbTerms : TermCombinations(*this, 1, nbTerms).count();
+	case JASPControl::CombinationType::CombinationInteraction:	return TermCombinations(*this, nbTerms, nbTerms).count();
+	case JASPControl::CombinationType::Combination2Way:			return nbTerms < 2 ? 0 : TermCombinations(*this, 2, 2).count();
+	case JASPControl::CombinationType::Combination3Way:			return nbTerms < 3 ? 0 : TermCombinations(*this, 3, 3).count();
+	case JASPControl::CombinationType::Combination4Way:			return nbTerms < 4 ? 0 : TermCombinations(*this, 4, 4).count();
+	case JASPControl::CombinationType::Combination5Way:			return nbTerms < 5 ? 0 : TermCombinations(*this, 5, 5).count();
+	case JASPControl::CombinationType::NoCombination:
+	default:													return nbTerms;
+	}
+}
+
 
 string Terms::asString() const
 {
@@ -483,16 +490,18 @@ int Terms::rankOf(const QString &component) const
 	if (_parent == nullptr)
 		return 0;
 
-	int index = 0;
-
-	for(const Term& compare : _parent->terms())
+	if (!_parent->_ranksValid)
 	{
-		if (compare.asQString() == component)
-			break;
-		index++;
+		_parent->_ranks.clear();
+
+		for(size_t i=0; i<_parent->_terms.size(); i++)
+			if(!_parent->_ranks.contains(_parent->_terms[i].asQString()))
+				_parent->_ranks.insert(_parent->_terms[i].asQString(), int(i));
+
+		_parent->_ranksValid = true;
 	}
 
-	return index;
+	return _parent->_ranks.value(component, int(_parent->_terms.size()));
 }
 
 int Terms::termCompare(const Term &t1, const Term &t2) const
@@ -531,23 +540,40 @@ bool Terms::componentLessThan(const QString &c1, const QString &c2) const
 
 void Terms::remove(const Terms &terms)
 {
+	// Each term in terms removes one occurrence, the first one, just like calling remove(term) for each of them would.
+	QHash<QString, int> toRemove;
+
 	for(const Term &term : terms)
-	{
-		vector<Term>::iterator itr = find(_terms.begin(), _terms.end(), term);
-		if (itr != _terms.end())
-			_terms.erase(itr);
-	}
+		toRemove[termKey(term)]++;
+
+	_terms.erase(
+		std::remove_if(
+			_terms.begin(),
+			_terms.end(),
+			[&](const Term& existingTerm)
+			{
+				auto it = toRemove.find(termKey(existingTerm));
+
+				if (it == toRemove.end() || it.value() == 0)
+					return false;
+
+				it.value()--;
+				indexRemove(existingTerm);
+				return true;
+			}),
+		_terms.end()
+	);
 }
 
 void Terms::remove(size_t pos, size_t n)
 {
-	vector<Term>::iterator itr = _terms.begin();
-
-	for (size_t i = 0; i < pos && itr != _terms.end(); i++)
-		itr++;
+	vector<Term>::iterator itr = _terms.begin() + std::min(pos, _terms.size());
 
 	for (; n > 0 && itr != _terms.end(); n--)
-		_terms.erase(itr);
+	{
+		indexRemove(*itr);
+		itr = _terms.erase(itr);
+	}
 }
 
 void Terms::replace(int pos, const Term &term)
@@ -583,6 +609,9 @@ bool Terms::discardWhatDoesntContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		invalidateIndex();
+
 	return changed;
 }
 
@@ -590,19 +619,23 @@ bool Terms::discardWhatDoesContainTheseComponents(const Terms &terms)
 {
 	bool changed = false;
 
+	QSet<QString> components;
+	for (const Term &term : terms)
+		for (const QString &component : term.components())
+			components.insert(component);
+
 	_terms.erase(
 		std::remove_if(
 			_terms.begin(),
 			_terms.end(),
 			[&](Term& existingTerm)
 			{
-				for (const Term &term : terms)
-					for (const QString &component : term.components())
-						if (existingTerm.contains(component))
-						{
-							changed			= true;
-							return true;
-						}
+				for (const QString &component : existingTerm.components())
+					if (components.contains(component))
+					{
+						changed			= true;
+						return true;
+					}
 
 
 				return false;
@@ -610,6 +643,9 @@ bool Terms::discardWhatDoesContainTheseComponents(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		invalidateIndex();
+
 	return changed;
 }
 
@@ -635,6 +671,9 @@ bool Terms::discardWhatDoesContainTheseTerms(const Terms &terms)
 		_terms.end()
 	);
 
+	if (changed)
+		invalidateIndex();
+
 	return changed;
 }
 
@@ -662,12 +701,19 @@ bool Terms::discardWhatIsntTheseTerms(const Terms &terms, Terms *discarded)
 		_terms.end()
 	);
 
+	if (changed)
+		invalidateIndex();
+
 	return changed;
 }
 
 void Terms::clear()
 {
 	_terms.clear();
+	_termCounts.clear();
+	_componentCounts.clear();
+	_indexValid = true;
+	_ranksValid = false;
 }
 
 size_t Terms::size() const
@@ -692,9 +738,15 @@ Terms::const_iterator Terms::end() const
 
 void Terms::remove(const Term &term)
 {
+	if (!contains(term))
+		return;
+
 	vector<Term>::iterator itr = std::find(_terms.begin(), _terms.end(), term);
 	if (itr != end())
+	{
+		indexRemove(*itr);
 		_terms.erase(itr);
+	}
 }
 
 QSet<int> Terms::replaceVariableName(const std::string & oldName, const std::string & newName)
@@ -709,5 +761,80 @@ QSet<int> Terms::replaceVariableName(const std::string & oldName, const std::str
 		i++;
 	}
 
+	if (!change.isEmpty())
+		invalidateIndex();
+
 	return change;
 }
+
+QString Terms::termKey(const Term &term)
+{
+	// Term::operator== ignores the order of the components, so the key does as well
+	if (term.size() == 1)
+		return term.at(0);
+
+	QStringList components = term.components();
+	components.sort();
+	components.removeDuplicates();
+
+	return QString::number(term.size()) + QChar(0x1F) + components.join(QChar(0x1F));
+}
+
+void Terms::indexAdd(const Term &term) const
+{
+	_ranksValid = false;
+
+	if (!_indexValid)
+		return;
+
+	_termCounts[termKey(term)]++;
+
+	QStringList components = term.components();
+	components.removeDuplicates();
+
+	for (const QString & component : components)
+		_componentCounts[component]++;
+}
+
+void Terms::indexRemove(const Term &term) const
+{
+	_ranksValid = false;
+
+	if (!_indexValid)
+		return;
+
+	auto decrement = [](QHash<QString, int> & counts, const QString & key)
+	{
+		auto it = counts.find(key);
+
+		if (it != counts.end() && --it.value() <= 0)
+			counts.erase(it);
+	};
+
+	decrement(_termCounts, termKey(term));
+
+	QStringList components = term.components();
+	components.removeDuplicates();
+
+	for (const QString & component : components)
+		decrement(_componentCounts, component);
+}
+
+void Terms::invalidateIndex()
+{
+	_indexValid = false;
+	_ranksValid = false;
+}
+
+void Terms::ensureIndex() const
+{
+	if (_indexValid)
+		return;
+
+	_termCounts.clear();
+	_componentCounts.clear();
+	_indexValid = true;
+
+	for (const Term & term : _terms)
+		indexAdd(term);
+}
@@ -22,10 +22,12 @@
 #include <vector>
 #include <string>
 #include <set>
+#include <limits>
 
 #include <QString>
 #include <QList>
 #include <QByteArray>
+#include <QHash>
 
 #include "term.h"
 #include "controls/jaspcontrol.h"
@@ -39,6 +41,9 @@
 /// order as before being set to the assigned list. For this we keep the original terms, and set it as parent of the 'functional' terms of the available list. When a variable
 /// is set back to the available list, we can know with the parent terms where it was before being moved.
 ///
+/// To keep this usable for datasets with thousands of variables the terms and their components are also counted in hash indices,
+/// so that contains() doesn't need to scan the list, and the position of each term is looked up in a hash when Terms is used as a parent.
+///
 class Terms
 {
 public:
@@ -104,10 +109,18 @@ public:
 	Term	sortComponents(const Term &term)	const;
 	Terms	sortComponents(const Terms &terms)	const;
 
-	Terms crossCombinations()					const;
-	Terms wayCombinations(int ways)				const;
-	Terms ffCombinations(const Terms &terms);
-	Terms combineTerms(JASPControl::CombinationType type);
+	static constexpr size_t noLimit = std::numeric_limits<size_t>::max();
+
+	///The combination functions stop after limit terms, by default maxCombinations(), to keep a selection of many factors from exhausting memory.
+	Terms crossCombinations(				size_t limit = maxCombinations())	const;
+	Terms wayCombinations(int ways,			size_t limit = maxCombinations())	const;
+	Terms ffCombinations(const Terms &terms,	size_t limit = maxCombinations());
+	Terms combineTerms(JASPControl::CombinationType type, size_t limit = maxCombinations());
+	///How many terms combineTerms(type) gives without a limit, without building them. Saturates at noLimit.
+	size_t combinationsCount(JASPControl::CombinationType type) const;
+
+	static size_t	maxCombinations()					{ return _maxCombinations; }
+	static void		setMaxCombinations(size_t limit)	{ _maxCombinations = limit; }
 
 	std::string asString() const;
 	bool hasDuplicate() const	{ return _hasDuplicate; }
@@ -123,9 +136,23 @@ private:
 	bool	termLessThan(const Term &t1, const Term &t2)			const;
 	bool	componentLessThan(const QString &c1, const QString &c2)	const;
 
+	static QString	termKey(const Term & term);
+	void			indexAdd(		const Term & term)						const;
+	void			indexRemove(	const Term & term)						const;
+	void			invalidateIndex();
+	void			ensureIndex()											const;
+
+	static size_t			_maxCombinations;
+
 	const Terms			*	_parent;
 	std::vector<Term>		_terms;
-	bool					_hasDuplicate = false;
+	bool					_hasDuplicate	= false;
+
+	mutable QHash<QString, int>	_termCounts,					///< termKey -> how often it occurs in _terms
+								_componentCounts,				///< component -> in how many terms it occurs
+								_ranks;							///< asQString -> first position in _terms, used by children for rankOf
+	mutable bool				_indexValid		= true,
+								_ranksValid		= false;
 };
 
 #endif // TERMS_H
@@ -0,0 +1,92 @@
+#include <QFile>
+#include <QQmlEngine>
+#include <QElapsedTimer>
+#include "qmlcomponentcache.h"
+#include "qmlutils.h"
+#include "qutils.h"
+#include "log.h"
+#include <algorithm>
+
+QMap<QQmlEngine*, QmlComponentCache*> QmlComponentCache::_caches;
+
+QmlComponentCache * QmlComponentCache::cache(QQmlEngine * engine)
+{
+	if(!_caches.contains(engine))
+		_caches[engine] = new QmlComponentCache(engine);
+
+	return _caches[engine];
+}
+
+QmlComponentCache::QmlComponentCache(QQmlEngine * engine)
+	: QObject(engine), _engine(engine)
+{
+	connect(engine, &QObject::destroyed, [engine]() { _caches.remove(engine); });
+}
+
+QQmlComponent * QmlComponentCache::component(const QFileInfo & file, const std::string & moduleName)
+{
+	const QString path = file.absoluteFilePath();
+
+	if(_entries.contains(path))
+	{
+		const Entry & entry = _entries[path];
+
+		if(entry.modified == file.lastModified() && entry.size == file.size())
+		{
+			_statistics.hits++;
+			return entry.component;
+		}
+
+		//The file changed, objects still being created from the old component keep it alive until they are done
+		entry.component->deleteLater();
+		_entries.remove(path);
+	}
+
+	_statistics.misses++;
+
+	QElapsedTimer compiling;
+	compiling.start();
+
+	QFile qmlFile(path);
+	qmlFile.open(QIODevice::ReadOnly);
+
+	QQmlComponent * qmlComp = new QQmlComponent(_engine, this);
+
+	qmlComp->setData(qmlFile.readAll(), QUrl::fromLocalFile(path));
+
+	try
+	{
+		throwOnQmlErrors(qmlComp->isError(), qmlComp->errors(), moduleName, fq(file.fileName()));
+
+		if(!qmlComp->isReady())
+			throw qmlLoadError(fq(path) + " Component is not ready!");
+	}
+	catch(qmlLoadError &)
+	{
+		delete qmlComp; //Not cached, so that a fixed file is compiled again even if its timestamp didn't change
+		throw;
+	}
+
+	_statistics.compileMs += compiling.nsecsElapsed() / 1000000.0;
+
+	_entries[path] = { qmlComp, file.lastModified(), file.size() };
+
+	return qmlComp;
+}
+
+void QmlComponentCache::clear()
+{
+	Log::log() << "QmlComponentCache::clear() forgets " << _entries.size() << " components, it had " << _statistics.hits << " hits and " << _statistics.misses << " misses." << std::endl;
+
+	for(const Entry & entry : _entries)
+		entry.component->deleteLater();
+
+	_entries.clear();
+}
+
+void QmlComponentCache::addCreation(double milliseconds)
+{
+	_statistics.created++;
+	_statistics.createMs		+= milliseconds;
+	_statistics.slowestCreateMs	=  std::max(_statistics.slowestCreateMs, milliseconds);
+}
@@ -0,0 +1,59 @@
+#ifndef QMLCOMPONENTCACHE_H
+#define QMLCOMPONENTCACHE_H
+
+#include <QObject>
+#include <QMap>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QQmlComponent>
+
+///
+/// The compiled QQmlComponents of the qml files that instantiateQml loads, one cache per QQmlEngine.
+/// A component is reused for as long as its file keeps the same modification time and size, so opening a project with many analyses, or switching between them, doesn't compile the same form over and over.
+/// It also counts how often that happened and how long it took to create objects from them, see statistics().
+///
+class QmlComponentCache : public QObject
+{
+	Q_OBJECT
+
+public:
+	struct Statistics
+	{
+		size_t	hits			= 0,
+				misses			= 0,
+				created			= 0;
+		double	compileMs		= 0,	///< Total time spent compiling the components that weren't cached
+				createMs		= 0,	///< Total time between starting to create an object and it being ready, which spans several frames when it is created asynchronously
+				slowestCreateMs	= 0;
+	};
+
+	static QmlComponentCache	*	cache(QQmlEngine * engine);
+
+	///Returns a ready component for file, compiling it only if it wasn't cached yet or the file changed since. Throws qmlLoadError if it has errors.
+	QQmlComponent				*	component(const QFileInfo & file, const std::string & moduleName);
+
+	///Forgets all components, for instance because the engine cleared its own cache and an imported qml file might have changed.
+	void							clear();
+
+	void							addCreation(double milliseconds);
+	const Statistics			&	statistics()		const	{ return _statistics;			}
+	void							resetStatistics()			{ _statistics = Statistics();	}
+
+private:
+	explicit QmlComponentCache(QQmlEngine * engine);
+
+	struct Entry
+	{
+		QQmlComponent	*	component	= nullptr;
+		QDateTime			modified;
+		qint64				size		= -1;
+	};
+
+	static QMap<QQmlEngine*, QmlComponentCache*>	_caches;
+
+	QQmlEngine			*	_engine;
+	QMap<QString, Entry>	_entries;
+	Statistics				_statistics;
+};
+
+#endif // QMLCOMPONENTCACHE_H
@@ -1,7 +1,11 @@
 #include <QQmlIncubator>
 #include <QQmlContext>
+#include <QQmlEngine>
 #include <QFileInfo>
+#include <QElapsedTimer>
+#include <QTimer>
 #include "qmlutils.h"
+#include "qmlcomponentcache.h"
 #include "qutils.h"
 #include "log.h"
 #include "columnencoder.h"
@@ -49,6 +53,22 @@ QJSValue	QmlUtils::decodeJson(const QJSValue	& val, QQuickItem * caller)
 	return tqj(v, caller);
 }
 
+void throwOnQmlErrors(bool isError, const QList<QQmlError> & errors, const std::string & moduleName, const std::string & filename)
+{
+	if(!isError) return;
+
+	std::stringstream out;
+
+	out << "Loading " << filename << " for module " << moduleName << " had errors:\n";
+
+	for(const QQmlError & error : errors)
+		out << error.toString() << "\n";
+
+	Log::log() << out.str() << std::flush;
+
+	throw qmlLoadError("There were errors loading " + filename + ":\n" + out.str());
+}
+
 //Turning QMLENGINE_DOES_ALL_THE_WORK on also works fine, but has slightly less transparent errormsgs so isn't recommended
 //#define QMLENGINE_DOES_ALL_THE_WORK
 
@@ -71,24 +91,7 @@ QObject * instantiateQml(const QString & qmlTxt, const QUrl & url, const std::st
 	if(qmlComp.isLoading())
 		Log::log() << whatAmILoading << " for module " << moduleName << " is still loading, make sure you load a local file and that Windows doesn't mess this up for you..." << std::endl;
 
-
-	auto errorLogger =[&](bool isError, QList<QQmlError> errors)
-	{
-		if(!isError) return;
-
-		std::stringstream out;
-
-		out << "Loading " << filename << " for module " << moduleName << " had errors:\n";
-
-		for(const QQmlError & error : errors)
-			out << error.toString() << "\n";
-
-		Log::log() << out.str() << std::flush;
-
-		throw qmlLoadError("There were errors loading " + filename + ":\n" + out.str());
-	};
-
-	errorLogger(qmlComp.isError(), qmlComp.errors());
+	throwOnQmlErrors(qmlComp.isError(), qmlComp.errors(), moduleName, filename);
 
 	if(!qmlComp.isReady())
 		throw qmlLoadError(whatAmILoading + " Component is not ready!");
@@ -98,7 +101,7 @@ QObject * instantiateQml(const QString & qmlTxt, const QUrl & url, const std::st
 
 	qmlComp.create(localIncubator);
 
-	errorLogger(localIncubator.isError(), localIncubator.errors());
+	throwOnQmlErrors(localIncubator.isError(), localIncubator.errors(), moduleName, filename);
 
 	obj = localIncubator.object();
 
@@ -107,7 +110,7 @@ QObject * instantiateQml(const QString & qmlTxt, const QUrl & url, const std::st
 	return obj;
 }
 
-QObject * instantiateQml(const QUrl & filePath, const std::string & moduleName, QQmlContext * ctxt)
+static QFileInfo localQmlFile(const QUrl & filePath)
 {
 	if(!filePath.isLocalFile())
 		throw std::runtime_error(fq(filePath.toLocalFile()) + " is not a local file...");
@@ -117,15 +120,86 @@ QObject * instantiateQml(const QUrl & filePath, const std::string & moduleName,
 	if(!qmlFileInfo.exists())
 		throw std::runtime_error(fq(qmlFileInfo.absoluteFilePath()) + " does not exist...");
 
-	QString 	qmlTxt;
-	QFile		qmlFile(qmlFileInfo.absoluteFilePath());
+	return qmlFileInfo;
+}
+
+QObject * instantiateQml(const QUrl & filePath, const std::string & moduleName, QQmlContext * ctxt)
+{
+	QFileInfo			qmlFileInfo	= localQmlFile(filePath);
+	QmlComponentCache *	cache		= QmlComponentCache::cache(ctxt->engine());
+	QQmlComponent	*	qmlComp		= cache->component(qmlFileInfo, moduleName);
+
+	QElapsedTimer creating;
+	creating.start();
+
+	QQmlIncubator localIncubator(QQmlIncubator::Synchronous);
+
+	qmlComp->create(localIncubator);
+
+	throwOnQmlErrors(localIncubator.isError(), localIncubator.errors(), moduleName, fq(qmlFileInfo.fileName()));
+
+	cache->addCreation(creating.nsecsElapsed() / 1000000.0);
+
+	return localIncubator.object();
+}
+
+///Hands the result of an asynchronous instantiateQml to its callback and deletes itself afterwards
+class CallbackIncubator : public QQmlIncubator
+{
+public:
+	CallbackIncubator(IncubationMode mode, QmlComponentCache * cache, const std::string & moduleName, const std::string & filename, qmlCreatedCallback created)
+		: QQmlIncubator(mode), _cache(cache), _moduleName(moduleName), _filename(filename), _created(created)
+	{
+		_creating.start();
+	}
+
+protected:
+	void statusChanged(Status status) override
+	{
+		if(status == Loading || _finished)
+			return;
+
+		_finished = true;
+
+		if(status == Ready)
+		{
+			_cache->addCreation(_creating.nsecsElapsed() / 1000000.0);
+			_created(object(), "");
+		}
+		else if(status == Error)
+		{
+			try							{ throwOnQmlErrors(true, errors(), _moduleName, _filename); }
+			catch(qmlLoadError & e)		{ _created(nullptr, e.what()); }
+		}
+		//Null means it was cleared, which cancels it so we don't call anyone
+
+		//Deleting ourselves right here would pull the rug from under QQmlIncubator
+		QTimer::singleShot(0, [this]() { delete this; });
+	}
+
+private:
+	QmlComponentCache	*	_cache;
+	std::string				_moduleName,
+							_filename;
+	qmlCreatedCallback		_created;
+	QElapsedTimer			_creating;
+	bool					_finished = false;
+};
+
+QQmlIncubator * instantiateQmlAsync(const QUrl & filePath, const std::string & moduleName, qmlCreatedCallback created, QQmlContext * ctxt)
+{
+	QFileInfo			qmlFileInfo	= localQmlFile(filePath);
+	QmlComponentCache *	cache		= QmlComponentCache::cache(ctxt->engine());
+	QQmlComponent	*	qmlComp		= cache->component(qmlFileInfo, moduleName);
+
+	//Without an incubation controller nobody would ever give the incubator time to work
+	QQmlIncubator::IncubationMode mode = ctxt->engine()->incubationController() ? QQmlIncubator::Asynchronous : QQmlIncubator::Synchronous;
 
-				qmlFile.open(QIODevice::ReadOnly);
-	qmlTxt =	qmlFile.readAll();
-				qmlFile.close();
+	QQmlIncubator * incubator = new CallbackIncubator(mode, cache, moduleName, fq(qmlFileInfo.fileName()), created);
 
-	return instantiateQml(qmlTxt, filePath, moduleName, fq(qmlFileInfo.absoluteFilePath()), fq(qmlFileInfo.fileName()),  ctxt);
+	qmlComp->create(*incubator);
 
+	return incubator->isLoading() ? incubator : nullptr;
 }
 
 
@@ -5,6 +5,9 @@
 #include <QJSValue>
 #include <QQuickItem>
 #include <QDir>
+#include <QQmlError>
+#include <QQmlIncubator>
+#include <functional>
 
 struct qmlLoadError  : public std::runtime_error
 {
@@ -36,8 +39,18 @@ public slots:
 
 };
 
-QObject * instantiateQml(							const QUrl 	& filePath, const std::string & moduleName,																		QQmlContext * ctxt = nullptr);
-QObject * instantiateQml(const QString 	& qmlTxt, 	const QUrl & url, 		const std::string & moduleName, const std::string & whatAmILoading, const std::string & filename, 	QQmlContext * ctxt = nullptr);
+///Gets called with the created object, or with nullptr and what went wrong.
+typedef std::function<void(QObject * object, const std::string & error)> qmlCreatedCallback;
+
+QObject * 		instantiateQml(							const QUrl 	& filePath, const std::string & moduleName,																		QQmlContext * ctxt = nullptr);
+QObject * 		instantiateQml(const QString 	& qmlTxt, 	const QUrl & url, 		const std::string & moduleName, const std::string & whatAmILoading, const std::string & filename, 	QQmlContext * ctxt = nullptr);
+
+///Like instantiateQml but lets the incubation controller of the engine spread creating the object over several frames so the UI stays responsive, created is called once it is done.
+///Without an incubation controller the object is created before this returns, and then nullptr is returned. Otherwise clear() on the returned incubator cancels it, it deletes itself once done so don't keep it around after created was called.
+QQmlIncubator *	instantiateQmlAsync(					const QUrl	& filePath,	const std::string & moduleName,		qmlCreatedCallback created,													QQmlContext * ctxt = nullptr);
+
+///Logs the errors and throws them as qmlLoadError if isError
+void			throwOnQmlErrors(bool isError, const QList<QQmlError> & errors, const std::string & moduleName, const std::string & filename);
 
 
 #endif // QMLUTILS_H
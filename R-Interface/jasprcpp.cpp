@@ -16,6 +16,7 @@
 //
 
 #include "jasprcpp.h"
+#include "jaspstatestore.h"
 #include <fstream>
 #include "tempfiles.h"
 
@@ -57,6 +58,8 @@ static sendFuncDef				_sendToDesktop			= nullptr;
 static systemDef				_systemFunc				= nullptr;
 static libraryFixerDef			_libraryFixerFunc		= nullptr;
 static std::string				_R_HOME = "";
+static int						_currentAnalysisID			= -1,
+								_currentAnalysisRevision	= -1;
 
 bool shouldCrashSoon = false; //Simply here to allow a developer to force a crash
 
@@ -140,6 +143,8 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	rInside[".requestTempRootNameNative"]		= Rcpp::InternalFunction(&jaspRCPP_requestTempRootNameSEXP);
 	rInside[".setColumnDataAsNominalText"]		= Rcpp::InternalFunction(&jaspRCPP_setColumnDataAsNominalText);
 	rInside[".requestStateFileNameNative"]		= Rcpp::InternalFunction(&jaspRCPP_requestStateFileNameSEXP);
+	rInside[".retrieveStateNative"]				= Rcpp::InternalFunction(&jaspRCPP_retrieveStateSEXP);
+	rInside[".storeStateNative"]				= Rcpp::InternalFunction(&jaspRCPP_storeStateSEXP);
 	rInside[".readFullFilteredDatasetToEnd"]	= Rcpp::InternalFunction(&jaspRCPP_readFullFilteredDataSet);
 	rInside[".requestSpecificFileNameNative"]	= Rcpp::InternalFunction(&jaspRCPP_requestSpecificFileNameSEXP);
 	
@@ -197,6 +202,29 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	jaspRCPP_parseEvalQNT("library(methods)");
 	jaspRCPP_parseEvalQNT("library(jaspBase)");
 
+	//jaspBase saves and loads the state of an analysis through these two, they now go to JaspStateStore and only to the file when there is nowhere to keep it
+	jaspRCPP_logString("Routing analysis state through JaspStateStore.\n");
+	std::string stateRouted = jaspRCPP_parseEvalStringReturn(
+		"local({\n"
+		"	ns <- asNamespace('jaspBase')\n"
+		"	if (!exists('.retrieveState', envir = ns, inherits = FALSE) || !exists('.saveState', envir = ns, inherits = FALSE))\n"
+		"		return('missing')\n"
+		"	retrieveFromFile	<- get('.retrieveState',	envir = ns)\n"
+		"	saveToFile			<- get('.saveState',		envir = ns)\n"
+		"	jaspBase:::assignFunctionInPackage(function() {\n"
+		"		state <- .retrieveStateNative()\n"
+		"		if (is.null(state)) retrieveFromFile() else state\n"
+		"	}, '.retrieveState', 'jaspBase')\n"
+		"	jaspBase:::assignFunctionInPackage(function(state) {\n"
+		"		location <- .storeStateNative(state)\n"
+		"		if (is.null(location)) saveToFile(state) else location\n"
+		"	}, '.saveState', 'jaspBase')\n"
+		"	'routed'\n"
+		"})");
+
+	if(stateRouted != "routed")
+		jaspRCPP_logString("Warning: jaspBase has no .retrieveState or .saveState, so analysis state is not kept in memory and is loaded from its file on every run.\n");
+
 //	if we have a separate engine for each module then we should move these kind of hacks to the .onAttach() of each module (instead of loading BayesFactor when Descriptives is requested).
 //	jaspRCPP_logString("initEnvironment().\n");
 //	jaspRCPP_parseEvalQNT("initEnvironment()");
@@ -223,13 +251,32 @@ void STDCALL jaspRCPP_junctionHelper(bool collectNotRestore, const char * folder
 	else					rinside->parseEvalQNT("restoreModulesIfNeeded(  symFolder)");
 }
 
+void STDCALL jaspRCPP_forgetState(int analysisID)
+{
+	JaspStateStore::store()->forget(analysisID);
+}
+
+bool STDCALL jaspRCPP_saveState(int analysisID, bool handOver)
+{
+	return handOver ? JaspStateStore::store()->handOver(analysisID) : JaspStateStore::store()->save(analysisID);
+}
+
+bool STDCALL jaspRCPP_saveAllStates()
+{
+	return JaspStateStore::store()->saveAll();
+}
+
 void STDCALL jaspRCPP_purgeGlobalEnvironment()
 {
+	JaspStateStore::store()->clear();
 	jaspRCPP_parseEvalQNT("jaspBase:::.cleanEngineMemory()", false);
 }
 
 void _setJaspResultsInfo(int analysisID, int analysisRevision, bool developerMode)
 {
+	_currentAnalysisID			= analysisID;
+	_currentAnalysisRevision	= analysisRevision;
+
 	jaspRCPP_parseEvalQNT(
 		"jaspBase:::setResponseData(" + std::to_string(analysisID) +", " + std::to_string(analysisRevision) + ");\n" +
 		"jaspBase:::setDeveloperMode(" + (developerMode ? "TRUE" : "FALSE") + ")"
@@ -619,6 +666,28 @@ SEXP jaspRCPP_requestStateFileNameSEXP()
 	return paths;
 }
 
+SEXP jaspRCPP_retrieveStateSEXP()
+{
+	return JaspStateStore::store()->retrieve(_currentAnalysisID, _currentAnalysisRevision);
+}
+
+///Returns what jaspBase's .saveState would, without writing the file yet, or NULL if there is no file to write it to later
+SEXP jaspRCPP_storeStateSEXP(SEXP state)
+{
+	const char* root;
+	const char* relativePath;
+
+	if (!requestStateFileSourceCB(&root, &relativePath))
+		return R_NilValue;
+
+	JaspStateStore::store()->store(_currentAnalysisID, _currentAnalysisRevision, state, std::string(root) + "/" + relativePath);
+
+	Rcpp::List location;
+	location["relativePath"] = relativePath;
+
+	return location;
+}
+
 
 SEXP jaspRCPP_callbackSEXP(SEXP in, SEXP progress)
 {
@@ -39,6 +39,8 @@ SEXP jaspRCPP_requestSpecificFileNameSEXP(SEXP extension);
 SEXP jaspRCPP_requestTempFileNameSEXP(SEXP extension);
 SEXP jaspRCPP_requestTempRootNameSEXP();
 SEXP jaspRCPP_requestStateFileNameSEXP();
+SEXP jaspRCPP_retrieveStateSEXP();
+SEXP jaspRCPP_storeStateSEXP(SEXP state);
 SEXP jaspRCPP_allColumnNamesDataset();
 SEXP jaspRCPP_RunSeparateR(SEXP code);
 
@@ -143,6 +143,9 @@ RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_getLastErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_resetErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_setErrorMsg(const char* msg);
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_purgeGlobalEnvironment();
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_forgetState(int analysisID); ///< Drops the in-memory state of analysisID, if any.
+RBRIDGE_TO_JASP_INTERFACE bool			STDCALL jaspRCPP_saveState(int analysisID, bool handOver); ///< Writes the in-memory state of analysisID to its file, and forgets it when handing it over to another engine.
+RBRIDGE_TO_JASP_INTERFACE bool			STDCALL jaspRCPP_saveAllStates();
 
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_junctionHelper(bool collectNotRestore, const char * folder);
 
@@ -0,0 +1,163 @@
+//
+// Copyright (C) 2013-2024 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#include "jaspstatestore.h"
+
+JaspStateStore * JaspStateStore::_singleton = nullptr;
+
+JaspStateStore * JaspStateStore::store()
+{
+	if(!_singleton)
+		_singleton = new JaspStateStore();
+
+	return _singleton;
+}
+
+SEXP JaspStateStore::retrieve(int analysisID, int analysisRevision)
+{
+	auto it = _entries.find(analysisID);
+
+	if(it == _entries.end())
+		return R_NilValue;
+
+	if(it->second.revision > analysisRevision) //An older revision is running for some reason, the state we have is not for it
+		return R_NilValue;
+
+	_lru.splice(_lru.begin(), _lru, it->second.lruPos);
+
+	return it->second.state;
+}
+
+void JaspStateStore::store(int analysisID, int analysisRevision, SEXP state, const std::string & stateFile)
+{
+	forget(analysisID);
+
+	if(Rf_isNull(state))
+		return;
+
+	size_t bytes = _objectSize(state);
+
+	R_PreserveObject(state);
+	_lru.push_front(analysisID);
+	_entries[analysisID] = { state, analysisRevision, bytes, stateFile, true, _lru.begin() };
+	_inUse += bytes;
+
+	_evictUntilWithinBudget();
+}
+
+void JaspStateStore::forget(int analysisID)
+{
+	auto it = _entries.find(analysisID);
+
+	if(it != _entries.end())
+		_release(it);
+}
+
+bool JaspStateStore::save(int analysisID)
+{
+	auto it = _entries.find(analysisID);
+
+	return it == _entries.end() || _save(it->second);
+}
+
+bool JaspStateStore::handOver(int analysisID)
+{
+	bool saved = save(analysisID);
+
+	forget(analysisID);
+
+	return saved;
+}
+
+bool JaspStateStore::saveAll()
+{
+	bool allSaved = true;
+
+	for(auto & idEntry : _entries)
+		allSaved = _save(idEntry.second) && allSaved;
+
+	return allSaved;
+}
+
+void JaspStateStore::clear()
+{
+	saveAll();
+
+	while(!_entries.empty())
+		_release(_entries.begin());
+}
+
+void JaspStateStore::setBudget(size_t bytes)
+{
+	_budget = bytes;
+	_evictUntilWithinBudget();
+}
+
+void JaspStateStore::_release(std::map<int, Entry>::iterator it)
+{
+	R_ReleaseObject(it->second.state);
+	_inUse -= it->second.bytes;
+	_lru.erase(it->second.lruPos);
+	_entries.erase(it);
+}
+
+void JaspStateStore::_evictUntilWithinBudget()
+{
+	//The most recently stored state is never evicted, even if it alone is over budget, because it is the one that is about to be needed
+	while(_inUse > _budget && _lru.size() > 1)
+	{
+		auto it = _entries.find(_lru.back());
+
+		_save(it->second);
+		_release(it);
+	}
+}
+
+///Writes it like jaspBase's .saveState does, with save(state, file = ...), so that .retrieveState can load() it
+bool JaspStateStore::_save(Entry & entry)
+{
+	if(!entry.unsaved)
+		return true;
+
+	if(entry.stateFile.empty())
+		return false;
+
+	static Rcpp::Function save = Rcpp::Environment::base_env()["save"];
+
+	try
+	{
+		Rcpp::Environment env = Rcpp::Environment::base_env().new_child(false);
+		env.assign("state", entry.state);
+
+		save(Rcpp::Named("list") = "state", Rcpp::Named("file") = entry.stateFile, Rcpp::Named("envir") = env);
+	}
+	catch(std::exception &)
+	{
+		return false;
+	}
+
+	entry.unsaved = false;
+
+	return true;
+}
+
+size_t JaspStateStore::_objectSize(SEXP state)
+{
+	static Rcpp::Function objectSize = Rcpp::Environment::namespace_env("utils")["object.size"];
+
+	return static_cast<size_t>(Rcpp::as<double>(objectSize(state)));
+}
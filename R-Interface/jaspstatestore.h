@@ -0,0 +1,80 @@
+//
+// Copyright (C) 2013-2024 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//
+
+#ifndef JASPSTATESTORE_H
+#define JASPSTATESTORE_H
+
+#include <Rcpp.h>
+#include <list>
+#include <map>
+#include <string>
+
+/// Keeps the state objects of analyses alive in the R session of the engine, so that a re-run doesn't need to load the state file again.
+/// A state is only written to its file, the same way jaspBase's own save(state) does it, when that file is needed:
+/// when the state is evicted or the memory cleaned, before the desktop archives the session into a .jasp and when another engine is going to run the analysis.
+/// For that last one the desktop asks this engine to hand the state over, which also forgets it, so a newer state from the other engine is never shadowed by this one.
+/// The store is bounded by a memory budget, when that is exceeded the least recently used states are written and dropped and jaspBase falls back to the file.
+class JaspStateStore
+{
+public:
+	static JaspStateStore * store();
+
+	///Returns the state of analysisID if it is still in memory, otherwise R_NilValue
+	SEXP	retrieve(int analysisID, int analysisRevision);
+	///Keeps the state of analysisID, it is written to stateFile once that is needed
+	void	store(int analysisID, int analysisRevision, SEXP state, const std::string & stateFile);
+	///Drops the state of analysisID without writing it, for when it isn't wanted anymore
+	void	forget(int analysisID);
+	///Writes the state of analysisID to its file if it hasn't been yet, returns false if that failed
+	bool	save(int analysisID);
+	///Writes the state of analysisID and forgets it, because another engine is going to run it
+	bool	handOver(int analysisID);
+	bool	saveAll();
+	///Writes all states that weren't yet and drops them
+	void	clear();
+
+	size_t	budget()		const	{ return _budget;	}
+	size_t	bytesInUse()	const	{ return _inUse;	}
+	void	setBudget(size_t bytes);
+
+private:
+	JaspStateStore() {}
+
+	struct Entry
+	{
+		SEXP							state;
+		int								revision;
+		size_t							bytes;
+		std::string						stateFile;
+		bool							unsaved;
+		std::list<int>::iterator		lruPos;
+	};
+
+	static size_t							_objectSize(SEXP state);
+	static bool								_save(Entry & entry);
+	void									_evictUntilWithinBudget();
+	void									_release(std::map<int, Entry>::iterator it);
+
+	static JaspStateStore	*	_singleton;
+
+	std::map<int, Entry>		_entries;
+	std::list<int>				_lru;								///< Most recently used in front
+	size_t						_inUse	= 0,
+								_budget	= 256 * 1024 * 1024;
+};
+
+#endif // JASPSTATESTORE_H
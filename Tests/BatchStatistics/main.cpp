@@ -0,0 +1,166 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "batchstatistics.h"
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static const Json::Value & analysis(const Json::Value & file, int id)
+{
+	static const Json::Value none;
+
+	for(const Json::Value & a : file["analyses"])
+		if(a["id"].asInt() == id)
+			return a;
+
+	return none;
+}
+
+int main(int, char **)
+{
+	BatchStatistics stats;
+
+	//The first file has two analyses of one module, run side by side on two engines, and one that was preempted once
+	stats.fileStarted("first.jasp", 1000);
+	stats.queued(1, "Descriptives",	"jaspDescriptives",	1000);
+	stats.queued(2, "TTest",		"jaspTTests",		1000);
+	stats.queued(3, "Anova",		"jaspAnova",		1000);
+
+	stats.finished(1, "complete", 1001);
+	check(!stats.allFinished(),										"a status from before it was sent is not the end of a run");
+
+	stats.sent(1, 0, 500, 1100);
+	stats.sent(2, 1, 700, 1300);
+	stats.sent(3, 0, 300, 1600);
+	stats.received(1, 2000);
+	stats.received(1, 5000);
+	stats.finished(1, "complete", 1500);
+	stats.sent(3, 1, 300, 2000); //Aborted and run again on another engine
+	stats.received(2, 1000);
+	stats.finished(2, "validationError", 2500);
+	check(!stats.allFinished(),										"not done while one still runs");
+	stats.received(3, 4000);
+	stats.finished(3, "complete", 4000);
+	check(stats.allFinished(),										"done once all have finished");
+
+	stats.sent(42, 0, 10, 4000);
+	stats.received(42, 10);
+	stats.fileFinished("", 5000);
+
+	//The second one timed out with an analysis still running
+	stats.fileStarted("second.jasp", 6000);
+	stats.queued(1, "Regression",	"jaspRegression",	6000);
+	stats.sent(1, 2, 100, 6500);
+	stats.fileFinished("timed out", 66000);
+
+	Json::Value report	= stats.report(3);
+	Json::Value first	= report["files"][0],
+				second	= report["files"][1];
+
+	check(report["enginePool"].asInt() == 3,							"the pool size is reported");
+	check(report["files"].size() == 2,									"every file is reported");
+	check(first["analyses"].size() == 3,								"analyses that aren't ours are left out");
+
+	const Json::Value & one = analysis(first, 1), & two = analysis(first, 2), & three = analysis(first, 3);
+
+	check(one["queueWaitMs"].asInt() == 100 && one["runMs"].asInt() == 400 && one["totalMs"].asInt() == 500,	"queue wait and run time are split at sending");
+	check(one["bytesSent"].asInt() == 500 && one["bytesReceived"].asInt() == 7000 && one["replies"].asInt() == 2,	"traffic is summed over all replies");
+	check(two["status"].asString() == "validationError",				"the final status is kept");
+	check(three["runs"].asInt() == 2 && three["engines"].size() == 2 && three["bytesSent"].asInt() == 600,		"a rerun counts as another run on another engine");
+	check(three["queueWaitMs"].asInt() == 600 && three["runMs"].asInt() == 2400,								"a rerun doesn't reset the clock");
+	check(first["wallMs"].asInt() == 4000,								"the wall time of a file runs from loading to the end");
+	check(first["runMs"]["count"].asInt() == 3 && first["runMs"]["max"].asInt() == 2400,						"run times are summarized per file");
+
+	check(analysis(second, 1)["status"].asString() == "unfinished" && analysis(second, 1)["runMs"].asInt() == -1,	"an analysis that never finished says so");
+	check(second["problem"].asString() == "timed out",					"the reason a file failed is kept");
+
+	check(report["totals"]["analyses"].asInt() == 4,					"all analyses are totalled");
+	check(report["totals"]["errors"].asInt() == 1 && report["totals"]["unfinished"].asInt() == 1,			"errors and unfinished analyses are counted apart");
+	check(report["totals"]["failedFiles"].asInt() == 2 && stats.failedFiles() == 2,							"a file with an error or a problem failed");
+	check(report["totals"]["wallMs"].asInt() == 64000,					"the total wall time is that of all files");
+	check(report["totals"]["queueWaitMs"]["count"].asInt() == 4,		"the queue waits of all files are summarized");
+
+	//The third has its plots rewritten afterwards, analysis 2 is in view and should go before 1 and 3 of the same module
+	BatchStatistics rewriting;
+
+	rewriting.fileStarted("third.jasp", 0);
+	rewriting.queued(1, "Descriptives",	"jaspDescriptives",	0);
+	rewriting.queued(2, "Descriptives",	"jaspDescriptives",	0);
+	rewriting.queued(3, "Descriptives",	"jaspDescriptives",	0);
+	rewriting.queued(4, "Anova",		"jaspAnova",		0);
+
+	for(size_t id=1; id<=4; id++)
+	{
+		rewriting.sent(id, 0, 100, 10);
+		rewriting.finished(id, id == 4 ? "fatalError" : "complete", 100);
+	}
+
+	check(rewriting.allFinished(),										"the runs are done before rewriting");
+
+	rewriting.rewritesStarted({ 2 }, 1000);
+	check(!rewriting.allFinished(),										"once rewriting starts it waits for the rewrites");
+
+	rewriting.sent(4, 3, 50, 1005); //Another module, it doesn't have to wait for what is in view
+	rewriting.sent(2, 0, 50, 1010);
+	rewriting.sent(1, 1, 50, 1020);
+	rewriting.sent(3, 2, 50, 1020);
+	check(rewriting.inViewRewrittenFirst(),								"the analysis in view was sent first within its module");
+
+	rewriting.finished(2, "complete", 1200);
+	rewriting.finished(1, "complete", 1300);
+	rewriting.finished(3, "complete", 1400);
+	check(!rewriting.allFinished(),										"not done while one still rewrites");
+	rewriting.finished(4, "complete", 1500);
+	check(rewriting.allFinished(),										"done once all are rewritten");
+	rewriting.fileFinished("", 1500);
+
+	Json::Value third = rewriting.report(4)["files"][0];
+
+	check(analysis(third, 2)["inView"].asBool() && !analysis(third, 1)["inView"].asBool(),					"whether an analysis was in view is reported");
+	check(analysis(third, 2)["rewriteWaitMs"].asInt() == 10 && analysis(third, 2)["rewriteMs"].asInt() == 190,	"rewrite wait and time are split at sending");
+	check(analysis(third, 1)["runMs"].asInt() == 90,					"the run itself is kept apart from the rewrite");
+	check(analysis(third, 4)["status"].asString() == "fatalError" && rewriting.failedFiles() == 1,			"a rewrite doesn't hide that the run failed");
+	check(third["rewriteWallMs"].asInt() == 500 && third["rewriteMs"]["count"].asInt() == 4,				"rewrites are summarized per file");
+
+	BatchStatistics outOfOrder;
+
+	outOfOrder.fileStarted("fourth.jasp", 0);
+	outOfOrder.queued(1, "Descriptives",	"jaspDescriptives",	0);
+	outOfOrder.queued(2, "Descriptives",	"jaspDescriptives",	0);
+	outOfOrder.rewritesStarted({ 2 }, 0);
+	outOfOrder.sent(1, 0, 50, 10);
+	outOfOrder.sent(2, 1, 50, 20);
+	check(!outOfOrder.inViewRewrittenFirst(),							"an analysis out of view sent before one in view is noticed");
+
+	if(failures == 0)
+		std::cout << "Queue waits, run times, rewrites, engines and traffic of every analysis in a batch are reported, and errors, reruns, time outs and rewrites out of order are counted." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,183 @@
+#include "benchmarks.h"
+#include "archivereader.h"
+#include "columnutils.h"
+#include "zipwriter.h"
+#include <archive.h>
+#include <archive_entry.h>
+#include <filesystem>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <future>
+
+typedef DataSetGenerator::dataShape			dataShape;
+typedef DataSetGenerator::GeneratedData		GeneratedData;
+typedef DataSetGenerator::GeneratedColumn	GeneratedColumn;
+
+///The columns of a generated dataset as JASPExporter would put them in data.bin: ints or doubles, one column after another
+static std::vector<std::string> columnBytes(const GeneratedData & data)
+{
+	std::vector<std::string> bytes;
+
+	for(const GeneratedColumn & column : data)
+	{
+		std::string out;
+
+		for(const std::string & value : column.values)
+			if(column.type == columnType::scale)
+			{
+				double number;
+				if(!ColumnUtils::convertValueToDoubleForImport(value, number))
+					number = NAN;
+				out.append(reinterpret_cast<const char*>(&number), sizeof(double));
+			}
+			else
+			{
+				int number = int(ColumnUtils::hashBytes(value.data(), value.size()) % 5000); //Stand-in for the label key of text columns
+				if(column.type != columnType::nominalText && !ColumnUtils::convertValueToIntForImport(value, number))
+					number = std::numeric_limits<int>::lowest();
+				out.append(reinterpret_cast<const char*>(&number), sizeof(int));
+			}
+
+		bytes.push_back(std::move(out));
+	}
+
+	return bytes;
+}
+
+static void writeDataBin(const std::string & path, const std::vector<std::string> & columns)
+{
+	size_t size = 0;
+	for(const std::string & column : columns)
+		size += column.size();
+
+	archive * a = archive_write_new();
+	archive_write_set_format_zip(a);
+
+	if(archive_write_open_filename(a, path.c_str()) != ARCHIVE_OK)
+		throw std::runtime_error("Cannot open '" + path + "' for writing");
+
+	archive_entry * entry = archive_entry_new();
+	archive_entry_set_pathname(	entry,	"data.bin");
+	archive_entry_set_size(		entry,	la_int64_t(size));
+	archive_entry_set_filetype(	entry,	AE_IFREG);
+	archive_entry_set_perm(		entry,	0644);
+	archive_write_header(a, entry);
+	archive_entry_free(entry);
+
+	for(const std::string & column : columns)
+		if(archive_write_data(a, column.data(), column.size()) != la_ssize_t(column.size()))
+			throw std::runtime_error("Writing data.bin failed");
+
+	archive_write_close(a);
+	archive_write_free(a);
+}
+
+///Stand-ins for the states and results of some analyses, json-like and about as compressible
+static std::vector<std::string> analysisFiles(const GeneratedData & data)
+{
+	std::vector<std::string> files;
+
+	for(size_t f=0; f<16; f++)
+	{
+		std::string file = "{\n";
+
+		for(size_t row=0; file.size() < 256 * 1024; row++)
+			for(const GeneratedColumn & column : data)
+				file += "\t\"" + column.name + "\": \"" + column.values[(row * 7 + f) % column.values.size()] + "\",\n";
+
+		files.push_back(file + "}\n");
+	}
+
+	return files;
+}
+
+///Saves data.bin and the analysis files like JASPExporter does through ZipWriter. threads is what data.bin is deflated on, more than 1 also prepares the other entries on threads of their own.
+static size_t saveArchive(const std::string & path, const std::vector<std::string> & columns, const std::vector<std::string> & files, size_t threads, const std::string & previousPath = "")
+{
+	ZipWriter						zip(path, previousPath);
+	std::vector<ZipWriter::Piece>	pieces;
+
+	for(const std::string & column : columns)
+		pieces.push_back({ column.data(), column.size() });
+
+	std::vector<std::future<ZipWriter::Entry>> entries;
+
+	for(size_t f=0; f<files.size(); f++)
+		entries.push_back(std::async(threads == 1 ? std::launch::deferred : std::launch::async, [&, f]() { return zip.prepare("analyses/" + std::to_string(f) + "/state.json", files[f]); }));
+
+	zip.write(zip.prepare("data.bin", pieces, true, threads));
+
+	for(auto & entry : entries)
+		zip.write(entry.get());
+
+	zip.close();
+
+	return zip.entriesCopied();
+}
+
+void addArchiveBenchmarks(BenchmarkRunner & runner, const DataSetGenerator & generator, double scale)
+{
+	for(dataShape shape : { dataShape::wide, dataShape::tall })
+	{
+		const GeneratedData	data	= generator.generate(shape, scale);
+		const size_t		cells	= DataSetGenerator::cellCount(data);
+		const std::string	name	= DataSetGenerator::shapeName(shape),
+							path	= (std::filesystem::temp_directory_path() / ("jasp-benchmark-" + name + ".zip")).string();
+
+		auto columns = std::make_shared<std::vector<std::string>>(columnBytes(data));
+
+		runner.add("Archive/writeDataBin/" + name, "macro", cells, [path, columns]()
+		{
+			writeDataBin(path, *columns);
+		});
+
+		runner.add("Archive/readDataBin/" + name, "macro", cells, [path, columns]()
+		{
+			ArchiveReader	dataEntry(path, "data.bin");
+			int				errorCode = 0;
+
+			for(const std::string & column : *columns)
+			{
+				std::string bytes(column.size(), '\0');
+
+				for(size_t read = 0; read < bytes.size();)
+				{
+					int size = dataEntry.readData(bytes.data() + read, int(bytes.size() - read), errorCode);
+
+					if(errorCode != 0 || size <= 0)
+						throw std::runtime_error("Reading data.bin failed");
+
+					read += size;
+				}
+			}
+		},
+		[path, columns]() { if(!std::filesystem::exists(path)) writeDataBin(path, *columns); });
+
+		auto			files		= std::make_shared<std::vector<std::string>>(analysisFiles(data));
+		const size_t	entries		= files->size() + 1;
+		const std::string
+						savePath	= (std::filesystem::temp_directory_path() / ("jasp-benchmark-save-" + name + ".jasp")).string(),
+						resavePath	= savePath + ".tmp";
+
+		runner.add("Archive/save/" + name + "/singleThread", "macro", cells, [savePath, columns, files]()
+		{
+			saveArchive(savePath, *columns, *files, 1);
+		});
+
+		runner.add("Archive/save/" + name + "/parallel", "macro", cells, [savePath, columns, files]()
+		{
+			saveArchive(savePath, *columns, *files, 0);
+		});
+
+		//Saving over the file again without changes, as after a second save, so every entry is hashed and copied instead of deflated
+		runner.add("Archive/save/" + name + "/unchanged", "macro", cells, [savePath, resavePath, columns, files, entries]()
+		{
+			if(saveArchive(resavePath, *columns, *files, 0, savePath) != entries)
+				throw std::runtime_error("Not every unchanged entry was copied from the previous save");
+		},
+		[savePath, columns, files]() { if(!std::filesystem::exists(savePath)) saveArchive(savePath, *columns, *files, 0); });
+	}
+}
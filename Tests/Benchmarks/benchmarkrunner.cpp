@@ -0,0 +1,103 @@
+#include "benchmarkrunner.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <map>
+#include <iomanip>
+
+void BenchmarkRunner::add(const std::string & name, const std::string & kind, size_t items, Body body, Body setup)
+{
+	_benchmarks.push_back({ name, kind, items, body, setup });
+}
+
+Json::Value BenchmarkRunner::run()
+{
+	Json::Value benchmarks = Json::arrayValue;
+
+	for(const Benchmark & benchmark : _benchmarks)
+	{
+		if(_filter != "" && benchmark.name.find(_filter) == std::string::npos)
+			continue;
+
+		if(_progress)
+			(*_progress) << benchmark.name << "..." << std::flush;
+
+		std::vector<double> nanoseconds;
+
+		//One extra repetition that isn't counted, to get caches and allocators warmed up
+		for(size_t rep = 0; rep <= _repetitions; rep++)
+		{
+			if(benchmark.setup)
+				benchmark.setup();
+
+			auto start = std::chrono::steady_clock::now();
+			benchmark.body();
+			auto end = std::chrono::steady_clock::now();
+
+			if(rep > 0)
+				nanoseconds.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+		}
+
+		std::sort(nanoseconds.begin(), nanoseconds.end());
+
+		double	median	= nanoseconds[nanoseconds.size() / 2],
+				mean	= 0;
+
+		for(double ns : nanoseconds)
+			mean += ns / nanoseconds.size();
+
+		Json::Value result			= Json::objectValue;
+		result["name"]				= benchmark.name;
+		result["kind"]				= benchmark.kind;
+		result["items"]				= Json::UInt64(benchmark.items);
+		result["repetitions"]		= Json::UInt64(_repetitions);
+		result["minNs"]				= nanoseconds.front();
+		result["medianNs"]			= median;
+		result["meanNs"]			= mean;
+		result["itemsPerSecond"]	= median > 0 ? benchmark.items / (median / 1e9) : 0.0;
+
+		benchmarks.append(result);
+
+		if(_progress)
+			(*_progress) << " " << std::fixed << std::setprecision(3) << median / 1e6 << "ms" << std::endl;
+	}
+
+	Json::Value results				= Json::objectValue;
+	results["format"]				= 1;
+	results["hardwareConcurrency"]	= std::thread::hardware_concurrency();
+	results["benchmarks"]			= benchmarks;
+
+	return results;
+}
+
+int BenchmarkRunner::compare(const Json::Value & results, const Json::Value & baseline, double tolerance, std::ostream & out)
+{
+	std::map<std::string, double> baselineMedians;
+
+	for(const Json::Value & benchmark : baseline.get("benchmarks", Json::arrayValue))
+		baselineMedians[benchmark["name"].asString()] = benchmark["medianNs"].asDouble();
+
+	int regressions = 0;
+
+	for(const Json::Value & benchmark : results.get("benchmarks", Json::arrayValue))
+	{
+		const std::string	name	= benchmark["name"].asString();
+		const double		median	= benchmark["medianNs"].asDouble();
+
+		if(baselineMedians.count(name) == 0 || baselineMedians[name] <= 0)
+		{
+			out << name << ": not in baseline" << std::endl;
+			continue;
+		}
+
+		double	ratio		= median / baselineMedians[name];
+		bool	regressed	= ratio > 1.0 + tolerance;
+
+		out << name << ": " << std::fixed << std::setprecision(2) << ratio << "x baseline" << (regressed ? " REGRESSION" : "") << std::endl;
+
+		if(regressed)
+			regressions++;
+	}
+
+	return regressions;
+}
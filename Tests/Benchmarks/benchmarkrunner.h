@@ -0,0 +1,47 @@
+#ifndef BENCHMARKRUNNER_H
+#define BENCHMARKRUNNER_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+#include <json/json.h>
+
+///
+/// Runs the registered benchmarks a number of times and reports the timings as json, so that a run can be stored and later runs compared to it.
+/// Each benchmark has an optional setup that runs before every repetition without being timed, for instance to get a fresh dataset to fill.
+/// "items" is whatever a benchmark processes (rows, values, messages), it is only used to report a throughput.
+class BenchmarkRunner
+{
+public:
+	typedef std::function<void()> Body;
+
+	struct Benchmark
+	{
+		std::string	name,
+					kind;	///< "micro" or "macro"
+		size_t		items;
+		Body		body,
+					setup;
+	};
+
+	void		add(const std::string & name, const std::string & kind, size_t items, Body body, Body setup = nullptr);
+
+	void		setRepetitions(size_t repetitions)		{ _repetitions	= repetitions;	}
+	void		setFilter(const std::string & filter)	{ _filter		= filter;		}
+	void		setProgress(std::ostream * progress)	{ _progress		= progress;		}
+
+	///Runs everything that matches the filter and returns the results as json
+	Json::Value	run();
+
+	///Writes a comparison of results against baseline to out and returns the number of benchmarks that got slower by more than tolerance (0.1 being 10%)
+	static int	compare(const Json::Value & results, const Json::Value & baseline, double tolerance, std::ostream & out);
+
+private:
+	std::vector<Benchmark>	_benchmarks;
+	size_t					_repetitions	= 5;
+	std::string				_filter;
+	std::ostream		*	_progress		= nullptr;
+};
+
+#endif // BENCHMARKRUNNER_H
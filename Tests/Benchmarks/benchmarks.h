@@ -0,0 +1,24 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include "benchmarkrunner.h"
+#include "datasetgenerator.h"
+
+///Column, Labels, ColumnEmptyValues, ColumnUtils and ColumnEncoder, on a dataset in shared memory like the one the engines read
+void addDataBenchmarks(		BenchmarkRunner & runner, const DataSetGenerator & generator, double scale);
+
+///Messages going back and forth over a pair of IPCChannels, as between Desktop and an engine
+void addIPCBenchmarks(		BenchmarkRunner & runner);
+
+///Writing and reading the data.bin of a .jasp archive, and saving one through ZipWriter on one thread, on all of them and over an unchanged previous save
+void addArchiveBenchmarks(	BenchmarkRunner & runner, const DataSetGenerator & generator, double scale);
+
+///Lines logged from one and from many threads through LogWriter, dropped lines included
+void addLogBenchmarks(		BenchmarkRunner & runner);
+
+#ifdef JASP_BENCHMARK_TERMS
+///Terms as the variables lists of a form use them, at sizes up to 50k variables
+void addTermsBenchmarks(	BenchmarkRunner & runner, double scale);
+#endif
+
+#endif // BENCHMARKS_H
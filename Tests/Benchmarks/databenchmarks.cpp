@@ -0,0 +1,259 @@
+#include "benchmarks.h"
+#include "sharedmemory.h"
+#include "dataset.h"
+#include "columnutils.h"
+#include "columnencoder.h"
+#include <memory>
+#include <limits>
+#include <cmath>
+#include <map>
+
+typedef DataSetGenerator::dataShape			dataShape;
+typedef DataSetGenerator::GeneratedData		GeneratedData;
+typedef DataSetGenerator::GeneratedColumn	GeneratedColumn;
+
+///
+/// The dataset in shared memory that the macro benchmarks work on, it remembers which shape it holds so that benchmarks that only read it don't have to fill it again each repetition.
+struct SharedDataSet
+{
+	DataSet				*	dataSet		= nullptr;
+	int						filledWith	= -1;
+	DataSet::emptyValsType	emptyValues;
+
+	///Same as DataSetPackage::enlargeDataSetIfNecessary, anything that allocates in shared memory might need a bigger segment
+	void enlarging(std::function<void()> tryThis)
+	{
+		while(true)
+			try	{ tryThis(); return; }
+			catch (boost::interprocess::bad_alloc &) { dataSet = SharedMemory::enlargeDataSet(dataSet); }
+	}
+
+	void recreate()
+	{
+		if(dataSet)
+			SharedMemory::deleteDataSet(dataSet);
+
+		dataSet		= SharedMemory::createDataSet();
+		filledWith	= -1;
+		emptyValues.clear();
+	}
+
+	void fill(const GeneratedData & data, int shape)
+	{
+		size_t rows = data.empty() ? 0 : data[0].values.size();
+
+		enlarging([&]() { dataSet->setColumnCount(data.size()); dataSet->setRowCount(rows); });
+
+		for(size_t c=0; c<data.size(); c++)
+		{
+			const GeneratedColumn & generated = data[c];
+
+			if(generated.type == columnType::nominalText)
+			{
+				enlarging([&]()
+				{
+					Column & column = dataSet->column(c);
+					column.setName(generated.name);
+					emptyValues[generated.name] = column.setColumnAsNominalText(generated.values);
+				});
+				continue;
+			}
+
+			//What the importer would have done to get to the numbers, including remembering the original text of the missing values
+			ColumnEmptyValues	originals;
+			std::vector<int>	ints;
+			std::vector<double>	doubles;
+
+			for(size_t r=0; r<rows; r++)
+			{
+				const std::string & value = generated.values[r];
+
+				if(generated.type == columnType::scale)
+				{
+					double number;
+					if(!ColumnUtils::convertValueToDoubleForImport(value, number))
+						number = NAN;
+					if(std::isnan(number) && value != "")
+						originals.insert(r, value);
+					doubles.push_back(number);
+				}
+				else
+				{
+					int number;
+					if(!ColumnUtils::convertValueToIntForImport(value, number))
+						number = std::numeric_limits<int>::lowest();
+					if(number == std::numeric_limits<int>::lowest() && value != "")
+						originals.insert(r, value);
+					ints.push_back(number);
+				}
+			}
+
+			enlarging([&]()
+			{
+				Column & column = dataSet->column(c);
+				column.setName(generated.name);
+
+				if(generated.type == columnType::scale)	column.setColumnAsScale(doubles);
+				else									column.setColumnAsNominalOrOrdinal(ints, generated.type == columnType::ordinal);
+			});
+
+			emptyValues[generated.name] = std::move(originals);
+		}
+
+		filledWith = shape;
+	}
+};
+
+void addDataBenchmarks(BenchmarkRunner & runner, const DataSetGenerator & generator, double scale)
+{
+	auto shared	= std::make_shared<SharedDataSet>();
+	auto data	= std::make_shared<std::map<int, GeneratedData>>();
+
+	for(dataShape shape : DataSetGenerator::allShapes())
+		(*data)[int(shape)] = generator.generate(shape, scale);
+
+	auto fillOnce = [shared, data](dataShape shape)
+	{
+		return [shared, data, shape]()
+		{
+			if(shared->filledWith == int(shape))
+				return;
+
+			shared->recreate();
+			shared->fill(data->at(int(shape)), int(shape));
+		};
+	};
+
+	//Micro:
+	{
+		const size_t rows = data->at(int(dataShape::tall))[0].values.size();
+
+		runner.add("ColumnUtils/convertValueToDoubleForImport", "micro", rows, [data]()
+		{
+			double number;
+			for(const std::string & value : data->at(int(dataShape::tall))[0].values)
+				ColumnUtils::convertValueToDoubleForImport(value, number);
+		});
+
+		runner.add("ColumnUtils/fingerprint", "micro", rows, [data]()
+		{
+			ColumnUtils::fingerprint(data->at(int(dataShape::tall))[0].values);
+		});
+	}
+
+	{
+		const GeneratedData & missing	= data->at(int(dataShape::missingHeavy));
+		size_t				missingCount	= 0;
+
+		for(const GeneratedColumn & column : missing)
+			for(const std::string & value : column.values)
+				if(ColumnUtils::isEmptyValue(value))
+					missingCount++;
+
+		runner.add("ColumnEmptyValues/insert", "micro", missingCount, [data]()
+		{
+			for(const GeneratedColumn & column : data->at(int(dataShape::missingHeavy)))
+			{
+				ColumnEmptyValues emptyValues;
+
+				for(size_t r=0; r<column.values.size(); r++)
+					if(ColumnUtils::isEmptyValue(column.values[r]))
+						emptyValues.insert(r, column.values[r]);
+			}
+		});
+	}
+
+	{
+		const GeneratedData & wide = data->at(int(dataShape::wide));
+
+		std::vector<std::string> names;
+		for(const GeneratedColumn & column : wide)
+			names.push_back(column.name);
+
+		std::string script;
+		for(size_t i=0; i<names.size(); i+=4)
+			script += "mean(" + names[i] + ") + sd(data$" + names[(i * 7) % names.size()] + ")\n";
+
+		runner.add("ColumnEncoder/encodeRScript", "micro", names.size() / 2, [names, script]()
+		{
+			ColumnEncoder::setCurrentColumnNames(names);
+			ColumnEncoder::columnEncoder()->encodeRScript(script);
+		});
+	}
+
+	//Macro:
+	for(dataShape shape : DataSetGenerator::allShapes())
+	{
+		const std::string	name	= DataSetGenerator::shapeName(shape);
+		const size_t		cells	= DataSetGenerator::cellCount(data->at(int(shape)));
+
+		runner.add("DataSet/fill/" + name, "macro", cells, [shared, data, shape]()
+		{
+			shared->fill(data->at(int(shape)), int(shape));
+		},
+		[shared]() { shared->recreate(); });
+
+		runner.add("DataSet/readValues/" + name, "macro", cells, [shared]()
+		{
+			double sum = 0;
+
+			for(Column & column : shared->dataSet->columns())
+				if(column.getColumnType() == columnType::scale)	for(double value : column.AsDoubles)	sum += value;
+				else											for(int    value : column.AsInts)		sum += value;
+
+			volatile double keep = sum; (void)keep;
+		},
+		fillOnce(shape));
+	}
+
+	{
+		const dataShape tall	= dataShape::tall;
+		const size_t	cells	= DataSetGenerator::cellCount(data->at(int(tall)));
+
+		runner.add("Column/stringValues/tall", "macro", cells, [shared]()
+		{
+			size_t length = 0;
+
+			for(Column & column : shared->dataSet->columns())
+				for(size_t r=0; r<column.rowCount(); r++)
+					length += column[r].size();
+
+			volatile size_t keep = length; (void)keep;
+		},
+		fillOnce(tall));
+
+		runner.add("Column/changeColumnType/tall", "macro", cells, [shared]()
+		{
+			for(size_t c=0; c<shared->dataSet->columnCount(); c++)
+				shared->enlarging([&]()
+				{
+					Column & column = shared->dataSet->column(c);
+
+					if(column.getColumnType() == columnType::ordinal)
+					{
+						column.changeColumnType(columnType::scale);
+						column.changeColumnType(columnType::ordinal);
+					}
+				});
+		},
+		fillOnce(tall));
+	}
+
+	{
+		const dataShape missing = dataShape::missingHeavy;
+
+		//Alternates between the default empty values and the same without "NA", so each repetition turns values into missing or back
+		auto withoutNA = std::make_shared<bool>(false);
+
+		runner.add("DataSet/resetEmptyValues/missingHeavy", "macro", DataSetGenerator::cellCount(data->at(int(missing))), [shared, withoutNA]()
+		{
+			*withoutNA = !*withoutNA;
+
+			if(*withoutNA)	ColumnUtils::setEmptyValues({"NaN", "nan", "."});
+			else			ColumnUtils::setEmptyValues(ColumnUtils::getDefaultEmptyValues());
+
+			shared->enlarging([&]() { shared->dataSet->resetEmptyValues(shared->emptyValues); });
+		},
+		fillOnce(missing));
+	}
+}
@@ -0,0 +1,119 @@
+#include "datasetgenerator.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+//The distributions of <random> differ between standard libraries, the engine itself doesn't, so only its raw output is used to keep the data the same everywhere
+static double	uniform(std::mt19937_64 & random)			{ return (random() >> 11) * 0x1.0p-53;	}
+static size_t	below(std::mt19937_64 & random, size_t n)	{ return random() % n;					}
+
+const std::vector<DataSetGenerator::dataShape> & DataSetGenerator::allShapes()
+{
+	static const std::vector<dataShape> shapes = { dataShape::wide, dataShape::tall, dataShape::labelHeavy, dataShape::missingHeavy };
+	return shapes;
+}
+
+std::string DataSetGenerator::shapeName(dataShape shape)
+{
+	switch(shape)
+	{
+	case dataShape::wide:			return "wide";
+	case dataShape::tall:			return "tall";
+	case dataShape::labelHeavy:		return "labelHeavy";
+	case dataShape::missingHeavy:	return "missingHeavy";
+	}
+
+	return "unknown";
+}
+
+DataSetGenerator::GeneratedData DataSetGenerator::generate(dataShape shape, double scale) const
+{
+	std::mt19937_64	random(_seed + size_t(shape));
+	GeneratedData	data;
+
+	auto rows = [&](size_t fullRows) { return std::max<size_t>(1, size_t(fullRows * scale)); };
+
+	static const std::vector<columnType> mixed = { columnType::scale, columnType::ordinal, columnType::nominalText, columnType::scale, columnType::nominal };
+
+	switch(shape)
+	{
+	case dataShape::wide:
+		for(size_t c=0; c<2000; c++)
+			data.push_back(column(random, "wide_" + std::to_string(c), mixed[c % mixed.size()], rows(200), 8, 0.02));
+		break;
+
+	case dataShape::tall:
+		for(size_t c=0; c<10; c++)
+			data.push_back(column(random, "tall_" + std::to_string(c), mixed[c % mixed.size()], rows(200000), 8, 0.02));
+		break;
+
+	case dataShape::labelHeavy:
+		for(size_t c=0; c<20; c++)
+			data.push_back(column(random, "labels_" + std::to_string(c), columnType::nominalText, rows(20000), 5000, 0.02));
+		break;
+
+	case dataShape::missingHeavy:
+		for(size_t c=0; c<20; c++)
+			data.push_back(column(random, "missing_" + std::to_string(c), mixed[c % mixed.size()], rows(20000), 8, 0.7));
+		break;
+	}
+
+	return data;
+}
+
+DataSetGenerator::GeneratedColumn DataSetGenerator::column(std::mt19937_64 & random, const std::string & name, columnType type, size_t rows, size_t labels, double missingFraction) const
+{
+	static const std::vector<std::string> missingTokens = { "", "NA", "NaN", "." };
+
+	GeneratedColumn column{ name, type, std::vector<std::string>(rows) };
+
+	for(std::string & value : column.values)
+	{
+		if(uniform(random) < missingFraction)
+		{
+			value = missingTokens[below(random, missingTokens.size())];
+			continue;
+		}
+
+		switch(type)
+		{
+		case columnType::scale:			value = std::to_string(uniform(random) * 200.0 - 100.0);		break;
+		case columnType::ordinal:
+		case columnType::nominal:		value = std::to_string(1 + below(random, labels));			break;
+		default:						value = "level_" + std::to_string(below(random, labels));	break;
+		}
+	}
+
+	return column;
+}
+
+size_t DataSetGenerator::cellCount(const GeneratedData & data)
+{
+	size_t cells = 0;
+
+	for(const GeneratedColumn & column : data)
+		cells += column.values.size();
+
+	return cells;
+}
+
+void DataSetGenerator::writeCSV(const GeneratedData & data, const std::string & path)
+{
+	std::ofstream csv(path, std::ios::binary);
+
+	if(!csv)
+		throw std::runtime_error("Cannot write generated data to '" + path + "'");
+
+	for(size_t c=0; c<data.size(); c++)
+		csv << (c ? "," : "") << data[c].name;
+	csv << "\n";
+
+	size_t rows = data.empty() ? 0 : data[0].values.size();
+
+	for(size_t r=0; r<rows; r++)
+	{
+		for(size_t c=0; c<data.size(); c++)
+			csv << (c ? "," : "") << data[c].values[r];
+		csv << "\n";
+	}
+}
@@ -0,0 +1,48 @@
+#ifndef DATASETGENERATOR_H
+#define DATASETGENERATOR_H
+
+#include <string>
+#include <vector>
+#include <random>
+#include "columntype.h"
+
+///
+/// Generates datasets as an importer would see them: columns of strings with the type we expect them to end up as.
+/// The same seed always gives the same data, so timings of different runs are about the same work.
+///
+/// wide:			many short columns of mixed types
+/// tall:			few long columns of mixed types
+/// labelHeavy:		text columns with thousands of distinct labels
+/// missingHeavy:	mostly empty values, written in the different ways files tend to contain them
+class DataSetGenerator
+{
+public:
+	enum class dataShape { wide, tall, labelHeavy, missingHeavy };
+
+	static const std::vector<dataShape> & allShapes();
+	static std::string shapeName(dataShape shape);
+
+	struct GeneratedColumn
+	{
+		std::string					name;
+		columnType					type;
+		std::vector<std::string>	values;
+	};
+
+	typedef std::vector<GeneratedColumn> GeneratedData;
+
+	DataSetGenerator(uint64_t seed = 1234) : _seed(seed) {}
+
+	///scale multiplies the number of rows, 1 is what a full benchmark run uses
+	GeneratedData	generate(dataShape shape, double scale = 1) const;
+
+	static size_t	cellCount(const GeneratedData & data);
+	static void		writeCSV(const GeneratedData & data, const std::string & path);
+
+private:
+	GeneratedColumn	column(std::mt19937_64 & random, const std::string & name, columnType type, size_t rows, size_t labels, double missingFraction) const;
+
+	uint64_t _seed;
+};
+
+#endif // DATASETGENERATOR_H
@@ -0,0 +1,55 @@
+#include "benchmarks.h"
+#include "ipcchannel.h"
+#include "processinfo.h"
+#include <memory>
+#include <stdexcept>
+
+void addIPCBenchmarks(BenchmarkRunner & runner)
+{
+	//Master and slave live in the same process here, the engine would otherwise be the slave
+	struct Channels
+	{
+		std::unique_ptr<IPCChannel>	master,
+									slave;
+	};
+
+	auto channels = std::make_shared<Channels>();
+
+	auto open = [channels]()
+	{
+		if(channels->master)
+			return;
+
+		const std::string name = "JASP-Benchmark-IPC-" + std::to_string(ProcessInfo::currentPID());
+
+		channels->master	= std::make_unique<IPCChannel>(name, 0, false);
+		channels->slave		= std::make_unique<IPCChannel>(name, 0, true);
+	};
+
+	const std::vector<std::pair<std::string, size_t>> sizes = { { "1KB", 1024 }, { "64KB", 64 * 1024 }, { "16MB", 16 * 1024 * 1024 } };
+
+	for(const auto & nameSize : sizes)
+	{
+		const size_t messages = nameSize.second >= 1024 * 1024 ? 4 : 1000;
+
+		runner.add("IPCChannel/roundTrip/" + nameSize.first, "micro", messages, [channels, messages, size = nameSize.second]()
+		{
+			std::string message(size, 'x'),
+						received;
+
+			for(size_t m=0; m<messages; m++)
+			{
+				channels->master->send(message);
+
+				if(!channels->slave->receive(received, 10000))
+					throw std::runtime_error("IPCChannel benchmark: slave did not receive the message");
+
+				channels->slave->send(received);
+
+				if(!channels->master->receive(received, 10000))
+					throw std::runtime_error("IPCChannel benchmark: master did not receive the reply");
+			}
+		},
+		open);
+	}
+}
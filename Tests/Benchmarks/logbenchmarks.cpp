@@ -0,0 +1,45 @@
+#include "benchmarks.h"
+#include "logwriter.h"
+#include <ostream>
+#include <thread>
+
+///Takes whatever the LogWriter writes and throws it away, so only the logging itself is timed
+class DiscardingStreamBuf : public std::streambuf
+{
+protected:
+	int_type		overflow(int_type ch)						override { return traits_type::not_eof(ch);	}
+	std::streamsize	xsputn(const char *, std::streamsize n)	override { return n;							}
+};
+
+void addLogBenchmarks(BenchmarkRunner & runner)
+{
+	static DiscardingStreamBuf	discarding;
+	static std::ostream			discarded(&discarding);
+
+	const size_t linesPerThread = 100000;
+
+	for(size_t threadCount : { size_t(1), size_t(8) })
+		runner.add("LogWriter/lines/" + std::to_string(threadCount) + "threads", "micro", threadCount * linesPerThread, [threadCount, linesPerThread]()
+		{
+			LogWriter::writer()->setDestination(&discarded);
+
+			std::vector<std::thread> threads;
+
+			//The same per thread LogStreamBuf that Log::log() uses, without the timestamp
+			for(size_t t=0; t<threadCount; t++)
+				threads.emplace_back([t, linesPerThread]()
+				{
+					LogStreamBuf	buffer;
+					std::ostream	log(&buffer);
+
+					for(size_t i=0; i<linesPerThread; i++)
+						log << "Benchmark line " << i << " of thread " << t << " with a value of " << i * 0.5 << std::endl;
+				});
+
+			for(std::thread & thread : threads)
+				thread.join();
+
+			LogWriter::writer()->flush();
+			LogWriter::writer()->setDestination(nullptr);
+		});
+}
@@ -0,0 +1,120 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "benchmarks.h"
+#include "sharedmemory.h"
+#include "log.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cstring>
+
+static void usage()
+{
+	std::cerr	<< "Usage: JASPBenchmarks [options]\n"
+				<< "  --out <file.json>        write the results there instead of to stdout\n"
+				<< "  --baseline <file.json>   compare against an earlier run, exits with 1 if anything got slower than the tolerance\n"
+				<< "  --tolerance <fraction>   allowed slowdown compared to the baseline, default 0.10\n"
+				<< "  --filter <text>          only run benchmarks with text in their name\n"
+				<< "  --repetitions <n>        timed repetitions per benchmark, default 5\n"
+				<< "  --scale <factor>         multiplies the number of rows of the generated datasets, default 1\n"
+				<< "  --quick                  same as --scale 0.1 --repetitions 2\n"
+				<< "  --seed <n>               seed for the generated datasets, default 1234\n"
+				<< "  --write-csv <directory>  also writes the generated datasets as csv, to use in load tests of the application\n"
+				<< "  --verbose                show the log\n";
+}
+
+int main(int argc, char * argv[])
+{
+	std::string	out,
+				baseline,
+				filter,
+				csvDir;
+	double		tolerance	= 0.10,
+				scale		= 1;
+	size_t		repetitions	= 5;
+	uint64_t	seed		= 1234;
+	bool		verbose		= false;
+
+	for(int i=1; i<argc; i++)
+	{
+		const std::string	arg		= argv[i];
+		auto				next	= [&]() -> std::string
+		{
+			if(i + 1 >= argc) { usage(); exit(2); }
+			return argv[++i];
+		};
+
+		if		(arg == "--out")			out			= next();
+		else if	(arg == "--baseline")		baseline	= next();
+		else if	(arg == "--tolerance")		tolerance	= std::stod(next());
+		else if	(arg == "--filter")			filter		= next();
+		else if	(arg == "--repetitions")	repetitions	= std::stoul(next());
+		else if	(arg == "--scale")			scale		= std::stod(next());
+		else if	(arg == "--seed")			seed		= std::stoull(next());
+		else if	(arg == "--write-csv")		csvDir		= next();
+		else if	(arg == "--verbose")		verbose		= true;
+		else if	(arg == "--quick")			{ scale = 0.1; repetitions = 2; }
+		else								{ usage(); return 2; }
+	}
+
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(verbose ? logType::cout : logType::null);
+
+	DataSetGenerator generator(seed);
+
+	if(csvDir != "")
+		for(DataSetGenerator::dataShape shape : DataSetGenerator::allShapes())
+			DataSetGenerator::writeCSV(generator.generate(shape, scale), (std::filesystem::path(csvDir) / (DataSetGenerator::shapeName(shape) + ".csv")).string());
+
+	BenchmarkRunner runner;
+	runner.setRepetitions(std::max<size_t>(1, repetitions));
+	runner.setFilter(filter);
+	runner.setProgress(&std::cerr);
+
+	addDataBenchmarks(		runner, generator, scale);
+	addIPCBenchmarks(		runner);
+	addArchiveBenchmarks(	runner, generator, scale);
+	addLogBenchmarks(		runner);
+#ifdef JASP_BENCHMARK_TERMS
+	addTermsBenchmarks(		runner, scale);
+#endif
+
+	Json::Value results = runner.run();
+
+	SharedMemory::unloadDataSet(true);
+
+	if(out == "")	std::cout << results.toStyledString();
+	else			std::ofstream(out) << results.toStyledString();
+
+	if(baseline == "")
+		return 0;
+
+	std::ifstream	baselineFile(baseline);
+	Json::Value		baselineJson;
+
+	if(!baselineFile || !Json::Reader().parse(baselineFile, baselineJson))
+	{
+		std::cerr << "Could not read baseline '" << baseline << "'" << std::endl;
+		return 2;
+	}
+
+	return BenchmarkRunner::compare(results, baselineJson, tolerance, std::cerr) > 0 ? 1 : 0;
+}
@@ -0,0 +1,70 @@
+#include "benchmarks.h"
+#include "models/terms.h"
+#include <stdexcept>
+
+static std::vector<std::string> variableNames(size_t count)
+{
+	std::vector<std::string> names;
+	names.reserve(count);
+
+	for(size_t i=0; i<count; i++)
+		names.push_back("variable_" + std::to_string(i));
+
+	return names;
+}
+
+void addTermsBenchmarks(BenchmarkRunner & runner, double scale)
+{
+	//The same work at each size, so the throughput shows whether it scales linearly up to forms over 50k variables
+	for(size_t size : { size_t(1000), size_t(10000), size_t(50000) })
+	{
+		const size_t					count	= std::max<size_t>(100, size * scale);
+		const std::string				suffix	= "/" + std::to_string(size);
+		const std::vector<std::string>	names	= variableNames(count);
+		const std::vector<std::string>	half(names.begin(), names.begin() + count / 2);
+
+		runner.add("Terms/add" + suffix, "micro", count, [names]()
+		{
+			Terms terms;
+
+			for(const std::string & name : names)
+				terms.add(Term(name));
+		});
+
+		runner.add("Terms/contains" + suffix, "micro", count, [names]()
+		{
+			Terms	terms(names);
+			size_t	found = 0;
+
+			for(const std::string & name : names)
+				found += terms.contains(Term(name));
+
+			if(found != names.size())
+				throw std::runtime_error("Terms benchmark: not every term was found");
+		});
+
+		//Like "select all" in a form: everything moves from the available list to an assigned one and back, the available list sorts by its parent
+		runner.add("Terms/assignAndUnassign" + suffix, "macro", count, [names, half]()
+		{
+			Terms	all(names),
+					available(names, &all),
+					assigned;
+
+			assigned.add(Terms(half));
+			available.remove(Terms(half));
+
+			available.add(assigned);
+			assigned.clear();
+
+			if(available.size() != names.size())
+				throw std::runtime_error("Terms benchmark: terms got lost while assigning");
+		});
+	}
+
+	//Interactions of 14 factors, the most a form builds is capped by Terms::maxCombinations
+	runner.add("Terms/crossCombinations/14", "macro", (size_t(1) << 14) - 1, []()
+	{
+		Terms factors(variableNames(14));
+		factors.crossCombinations(Terms::noLimit);
+	});
+}
@@ -0,0 +1,169 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "sharedmemory.h"
+#include "log.h"
+#include "json/json.h"
+#include <iostream>
+#include <sstream>
+#include <limits>
+#include <cmath>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static std::string runsToString(const std::vector<ChangedRows::Run> & runs)
+{
+	std::stringstream out;
+
+	for(const ChangedRows::Run & run : runs)
+		out << "[" << run.first << ", " << run.count << ")";
+
+	return out.str();
+}
+
+static void checkChanges(const ColumnChanges & changes, const std::vector<ChangedRows::Run> & runs, const std::set<int> & labels, bool type, const std::string & what)
+{
+	size_t rows = 0;
+	for(const ChangedRows::Run & run : runs)
+		rows += run.count;
+
+	bool sameRuns = changes.rows.runs.size() == runs.size();
+	for(size_t i=0; sameRuns && i<runs.size(); i++)
+		sameRuns = changes.rows.runs[i].first == runs[i].first && changes.rows.runs[i].count == runs[i].count;
+
+	check(changes.rows.rows == rows,							what + ": expected " + std::to_string(rows) + " changed rows but got " + std::to_string(changes.rows.rows));
+	check(sameRuns,												what + ": expected runs " + runsToString(runs) + " but got " + runsToString(changes.rows.runs));
+	check(changes.labels == labels,								what + ": expected " + std::to_string(labels.size()) + " changed labels but got " + std::to_string(changes.labels.size()));
+	check(changes.type == type,									what + ": type changed should be " + (type ? "true" : "false"));
+	check(changes.changed() == (rows > 0 || labels.size() || type),	what + ": changed() does not match");
+
+	ColumnChanges sent = ColumnChanges::fromJson(changes.toJson());
+	check(sent.rows.rows == changes.rows.rows && runsToString(sent.rows.runs) == runsToString(changes.rows.runs) && sent.labels == changes.labels && sent.type == changes.type && !sent.allRows,
+																what + ": not the same after sending it as json");
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const size_t	rows	= 2000; //Spans several DataBlocks
+	const int		missing	= std::numeric_limits<int>::lowest();
+	DataSet		*	dataSet	= SharedMemory::createDataSet();
+
+	dataSet->setColumnCount(1);
+	dataSet->setRowCount(rows);
+
+	Column & column = dataSet->column(0);
+	column.setName("computed");
+
+	std::vector<double> doubles(rows);
+	for(size_t r=0; r<rows; r++)
+		doubles[r] = r % 7 == 0 ? NAN : r * 0.5;
+
+	column.changeColumnType(columnType::nominal);
+
+	check(column.overwriteDataWithScale(doubles.data(), rows).type,											"scale, first time");
+	checkChanges(column.overwriteDataWithScale(doubles.data(), rows),	{},				{},	false,	"scale, same values again");
+
+	doubles[1234] = -1;
+	doubles[1235] = -2;
+	doubles[1500] = -3;
+	checkChanges(column.overwriteDataWithScale(doubles.data(), rows),	{{1234, 2}, {1500, 1}},	{},	false,	"scale, a few values");
+
+	std::vector<ChangedRows::Run> becomeMissing;
+	for(size_t r=1000; r<rows; r++)
+		if(!std::isnan(doubles[r]))
+		{
+			if(becomeMissing.size() && becomeMissing.back().first + becomeMissing.back().count == r)	becomeMissing.back().count++;
+			else																					becomeMissing.push_back({r, 1});
+		}
+
+	checkChanges(column.overwriteDataWithScale(doubles.data(), 1000),	becomeMissing,	{},	false,	"scale, shorter than the column");
+	doubles.resize(1000);
+
+	std::vector<int>			ints(rows);
+	std::map<int, std::string>	levels		= { {1, "a"}, {2, "b"}, {3, "c"} },
+								intLevels	= { {1, "10"}, {2, "20"}, {3, "30"} };
+
+	for(size_t r=0; r<rows; r++)
+		ints[r] = r % 11 == 0 ? missing : 1 + r % 3;
+
+	ColumnChanges changes = column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, false);
+	check(changes.type && changes.labels == std::set<int>({1, 2, 3}),										"nominal, first time");
+	checkChanges(column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, false),	{},			{},		false,	"nominal, same values again");
+	checkChanges(column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, true),	{},			{},		true,	"ordinal, same values as nominal");
+
+	levels[3] = "C";
+	checkChanges(column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, true),	{},			{3},	false,	"ordinal, one level renamed");
+
+	ints[5] = 1;
+	checkChanges(column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, true),	{{5, 1}},	{},		false,	"ordinal, one value");
+
+	changes = column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, intLevels, true);
+	check(column.AsInts[5] == 10 && column.AsInts[0] == missing,											"ordinal, levels that are integers are stored as those integers");
+	check(changes.labels == std::set<int>({1, 2, 3, 10, 20, 30}),											"ordinal, levels that are integers replace the keys of the labels");
+	checkChanges(column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, intLevels, true),	{},			{},		false,	"ordinal with integer levels, same values again");
+
+	std::vector<std::string> texts(rows);
+	for(size_t r=0; r<rows; r++)
+		texts[r] = r % 13 == 0 ? "" : std::string(1, char('a' + r % 5));
+
+	changes = column.overwriteDataWithNominalText(texts);
+	check(changes.type && changes.labels.size(),															"nominal text, first time");
+	checkChanges(column.overwriteDataWithNominalText(texts),									{},				{},		false,	"nominal text, same values again");
+
+	texts[1999] = "b";
+	checkChanges(column.overwriteDataWithNominalText(texts),									{{1999, 1}},	{},		false,	"nominal text, one value");
+
+	for(size_t r=0; r<rows; r++)
+		if(texts[r] == "e")
+			texts[r] = "f";
+	changes = column.overwriteDataWithNominalText(texts);
+	check(changes.labels == std::set<int>({5}) && !changes.rows.changed(),									"nominal text, a value replaced by a new one keeps its key, so only that label changed");
+
+	std::vector<double> alternating(rows);
+	for(size_t r=0; r<rows; r++)
+		alternating[r] = r % 2;
+
+	column.overwriteDataWithScale(alternating.data(), rows);
+	for(size_t r=0; r<rows; r+=2)
+		alternating[r] = -1;
+
+	changes = column.overwriteDataWithScale(alternating.data(), rows);
+	check(changes.rows.runs.size() == rows / 2 && ColumnChanges::fromJson(changes.toJson()).allRows,			"too many runs are sent as all rows");
+
+	check(column.overwriteDataWithScale(doubles) && !column.overwriteDataWithScale(doubles),				"the bool overload reports the same as changed()");
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout << "Writing the same data twice leaves a column unchanged, and changes are reported as runs of rows, label keys and type." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
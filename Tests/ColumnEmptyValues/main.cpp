@@ -0,0 +1,161 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "sharedmemory.h"
+#include "columnutils.h"
+#include "columnemptyvalues.h"
+#include "json/json.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <random>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static DataSet * dataSet = nullptr;
+
+static void enlarging(std::function<void()> tryThis)
+{
+	while(true)
+		try	{ tryThis(); return; }
+		catch (boost::interprocess::bad_alloc &) { dataSet = SharedMemory::enlargeDataSet(dataSet); }
+}
+
+///{ "row": original, ... } as data archives before 1.1.0 have it, JASP only reads that anymore
+static Json::Value legacyJson(const ColumnEmptyValues & emptyValues)
+{
+	Json::Value json = Json::objectValue;
+
+	emptyValues.forEach([&](size_t row, const std::string & original) { json[std::to_string(row)] = original; });
+
+	return json;
+}
+
+///Writes and parses the JSON as text, like it goes through the data archive
+static DataSet::emptyValsType saveAndLoad(const DataSet::emptyValsType & emptyValuesPerColumn, bool legacy)
+{
+	Json::Value dataSetJson = Json::objectValue;
+
+	for (const auto & [colName, emptyValues] : emptyValuesPerColumn)
+		if (!emptyValues.empty())
+			dataSetJson[legacy ? "emptyValuesMap" : "emptyValuesPerColumn"][colName] = legacy ? legacyJson(emptyValues) : emptyValues.toJson();
+
+	Json::Value		loaded;
+	Json::Reader	jsonReader;
+	if(!jsonReader.parse(dataSetJson.toStyledString(), loaded))
+		return {};
+
+	DataSet::emptyValsType	result;
+	const Json::Value	&	columnsJson = loaded[legacy ? "emptyValuesMap" : "emptyValuesPerColumn"];
+
+	for (Json::Value::const_iterator iter = columnsJson.begin(); iter != columnsJson.end(); ++iter)
+		result[iter.key().asString()] = legacy ? ColumnEmptyValues::fromLegacyJson(*iter) : ColumnEmptyValues::fromJson(*iter);
+
+	return result;
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const size_t	rows		= 20000,
+					columns		= 6;
+	std::mt19937	random(37);
+
+	const std::vector<std::string> empties = { "", "NA", ".", "-999", "n/a", "missing" };
+	ColumnUtils::setEmptyValues({ "", "NA", ".", "-999", "n/a", "missing" });
+
+	dataSet = SharedMemory::createDataSet();
+	enlarging([&](){ dataSet->setColumnCount(columns); dataSet->setRowCount(rows); });
+
+	//Columns with originals in stretches, scattered ones, rows past 9 so that the legacy keys sort differently as text, and columns without any
+	DataSet::emptyValsType emptyValuesPerColumn;
+
+	for(size_t c=0; c<columns; c++)
+	{
+		std::vector<std::string> values(rows);
+
+		for(size_t r=0; r<rows; r++)
+			switch(c)
+			{
+			case 0:		values[r] = (r / 100) % 3 == 0	? empties[(r / 100) % empties.size()]	: "text " + std::to_string(r % 7);	break;
+			case 1:		values[r] = random() % 10 == 0	? empties[random() % empties.size()]	: std::to_string(r % 13);			break;
+			case 2:		values[r] = r == 2 || r == 10	? "NA"									: std::to_string(r) + ".5";			break;
+			default:	values[r] = "never empty " + std::to_string(r % (c * 3));												break;
+			}
+
+		enlarging([&]()
+		{
+			dataSet->column(c).setName("column " + std::to_string(c));
+			ColumnEmptyValues emptyValues = dataSet->column(c).setColumnAsNominalText(values);
+
+			if(!emptyValues.empty())
+				emptyValuesPerColumn[dataSet->column(c).name()] = std::move(emptyValues);
+		});
+	}
+
+	check(emptyValuesPerColumn.size() == 3,																		"only the columns with empty values have originals");
+
+	DataSet::emptyValsType	loaded			= saveAndLoad(emptyValuesPerColumn, false),
+							loadedLegacy	= saveAndLoad(emptyValuesPerColumn, true);
+
+	check(loaded == emptyValuesPerColumn,																		"the originals come back after saving and loading");
+	check(loadedLegacy == emptyValuesPerColumn,																	"the originals come back from the form data archives before 1.1.0 have");
+	check(loadedLegacy["column 2"].size() == 2 && loadedLegacy["column 2"].at(10) == "NA",						"rows past 9 come back from the legacy form in order");
+
+	//Nothing is considered empty anymore, all originals go back into the columns
+	std::vector<std::string> changed;
+
+	ColumnUtils::setEmptyValues({ "" });
+	enlarging([&](){ changed = dataSet->resetEmptyValues(loaded); });
+	check(changed.size() == 3,																					"only the columns with originals other than \"\" change when fewer values are empty");
+	bool noneEmpty = !loaded.count("column 2") && !loaded.count("column 3");
+	for(const auto & [colName, emptyValues] : loaded)
+		noneEmpty = noneEmpty && !emptyValues.empty();
+	check(noneEmpty,																							"columns without originals get no entry and lose it when they have none left");
+
+	//And back again, the columns without originals still don't get an entry
+	ColumnUtils::setEmptyValues(empties);
+	enlarging([&](){ changed = dataSet->resetEmptyValues(loaded); });
+	check(changed.size() == 3,																					"the same columns change back");
+	check(loaded.size() == 3 && !loaded.count("column 3") && !loaded.count("column 4"),							"only the columns with empty values get their originals back");
+	check(saveAndLoad(loaded, false) == loaded,																	"the originals after resetting survive saving and loading");
+
+	size_t originals = 0;
+	for(const auto & [colName, emptyValues] : loaded)
+		originals += emptyValues.size();
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout	<< originals << " original values of empty cells in " << loaded.size() << " of " << columns << " columns survive saving and loading, and are read from the form of data archives before 1.1.0." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,250 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "sharedmemory.h"
+#include "columnutils.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static DataSet * dataSet = nullptr;
+
+///Same as DataSetPackage::enlargeDataSetIfNecessary
+static void enlarging(std::function<void()> tryThis)
+{
+	while(true)
+		try	{ tryThis(); return; }
+		catch (boost::interprocess::bad_alloc &) { dataSet = SharedMemory::enlargeDataSet(dataSet); }
+}
+
+typedef std::vector<std::vector<std::string>> Table; ///< columns of values, as CSV hands them to the importer
+
+static std::string toCsv(const Table & table)
+{
+	std::ostringstream csv;
+
+	for(size_t c=0; c<table.size(); c++)
+		csv << (c ? "," : "") << "col" << c;
+	csv << "\n";
+
+	for(size_t r=0; r<table[0].size(); r++)
+	{
+		for(size_t c=0; c<table.size(); c++)
+			csv << (c ? "," : "") << table[c][r];
+		csv << "\n";
+	}
+
+	return csv.str();
+}
+
+///The generated files have no quotes or escaped delimiters, so splitting is all the reading they need
+static Table fromCsv(const std::string & text)
+{
+	std::istringstream	csv(text);
+	std::string			line;
+	Table				table;
+
+	std::getline(csv, line);
+	table.resize(std::count(line.begin(), line.end(), ',') + 1);
+
+	while(std::getline(csv, line))
+	{
+		std::istringstream	fields(line);
+		std::string			field;
+
+		for(size_t c=0; c<table.size(); c++)
+		{
+			field.clear();
+			std::getline(fields, field, ',');
+			table[c].push_back(field);
+		}
+	}
+
+	return table;
+}
+
+static Table generate(std::mt19937 & random, size_t columns, size_t rows)
+{
+	std::uniform_int_distribution<int> value(0, 50);
+	Table table(columns);
+
+	for(size_t c=0; c<columns; c++)
+		for(size_t r=0; r<rows; r++)
+			switch(c % 3)
+			{
+			case 0:		table[c].push_back(std::to_string(value(random)) + ".5");				break;
+			case 1:		table[c].push_back("level" + std::to_string(value(random) % 7));			break;
+			default:	table[c].push_back(value(random) == 0 ? "" : "text" + std::to_string(value(random)));	break;
+			}
+
+	return table;
+}
+
+///What the importer does with a column: scale if it parses, text otherwise
+static void setColumn(Column & column, const std::vector<std::string> & values)
+{
+	std::vector<double> doubles;
+
+	for(const std::string & v : values)
+		if(!ColumnUtils::isEmptyValue(v))
+		{
+			double d;
+			if(!ColumnUtils::getDoubleValue(v, d))
+				break;
+			doubles.push_back(d);
+		}
+		else
+			doubles.push_back(NAN);
+
+	if(doubles.size() == values.size())	column.setColumnAsScale(doubles);
+	else								column.setColumnAsNominalText(values);
+}
+
+///Asking for the non-const labels clears what Column keeps, so this is the fingerprint computed from scratch
+static uint64_t freshFingerprint(Column & column)
+{
+	column.labels();
+	return column.valuesFingerprint();
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	std::mt19937	random(2023);
+	const size_t	columns	= 6,
+					rows	= 3000,
+					pairs	= 20;
+
+	dataSet = SharedMemory::createDataSet();
+	enlarging([&](){ dataSet->setColumnCount(columns); });
+
+	size_t skipped = 0, synced = 0;
+
+	for(size_t pair=0; pair<pairs; pair++)
+	{
+		//Same as DataSetPackage::storeColumnFingerprint, (import fingerprint, column fingerprint)
+		std::vector<std::pair<uint64_t, uint64_t>> stored(columns);
+
+		const Table before	= fromCsv(toCsv(generate(random, columns, rows)));
+		Table		after	= before;
+
+		switch(pair % 4)
+		{
+		case 0:																											break; //the same file
+		case 1:	after[pair % columns][random() % rows] = "edited";														break;
+		case 2:	for(auto & column : after) column.push_back(column.back());												break;
+		case 3:	after[pair % columns][random() % rows] = ""; after[(pair + 1) % columns][0] = after[(pair + 1) % columns][1];	break;
+		}
+
+		after = fromCsv(toCsv(after));
+
+		enlarging([&](){ dataSet->setRowCount(rows); });
+
+		for(size_t c=0; c<columns; c++)
+		{
+			enlarging([&](){ setColumn(dataSet->column(c), before[c]); });
+			stored[c] = std::make_pair(ColumnUtils::fingerprint(before[c]), dataSet->column(c).valuesFingerprint());
+		}
+
+		enlarging([&](){ dataSet->setRowCount(after[0].size()); });
+
+		for(size_t c=0; c<columns; c++)
+		{
+			Column		&	column		= dataSet->column(c);
+			const bool		matches		= stored[c].first == ColumnUtils::fingerprint(after[c]) && stored[c].second == column.valuesFingerprint(),
+							same		= before[c] == after[c];
+
+			check(matches == same,																	"pair " + std::to_string(pair) + " column " + std::to_string(c) + (same ? " is unchanged but was synced" : " changed but was skipped"));
+			check(column.valuesFingerprint() == freshFingerprint(column),							"pair " + std::to_string(pair) + " column " + std::to_string(c) + " keeps an up to date fingerprint");
+
+			if(matches)
+				skipped++;
+			else
+			{
+				enlarging([&](){ setColumn(column, after[c]); });
+				synced++;
+			}
+		}
+	}
+
+	check(skipped > 0 && synced > 0,																"the pairs have both unchanged and changed columns");
+
+	//Every edit has to clear the fingerprint the column keeps
+	enlarging([&](){ dataSet->setRowCount(rows); });
+	enlarging([&](){ setColumn(dataSet->column(0), generate(random, 1, rows)[0]); });	//scale
+	enlarging([&](){ setColumn(dataSet->column(1), generate(random, 2, rows)[1]); });	//text
+
+	//Enlarging the segment moves the dataset, so the columns are looked up again every time
+	auto column = [&](size_t c) -> Column & { return dataSet->column(c); };
+
+	auto edited = [&](size_t c, std::function<void()> edit, const std::string & what)
+	{
+		const uint64_t kept = column(c).valuesFingerprint();
+		enlarging(edit);
+		check(column(c).valuesFingerprint() != kept,												what + " changes the fingerprint");
+		check(column(c).valuesFingerprint() == freshFingerprint(column(c)),							what + " leaves no stale fingerprint");
+	};
+
+	edited(0,	[&](){ column(0).setValue(10, 1234.5);													}, "setting a value");
+	edited(0,	[&](){ column(0).setValues(size_t(20), std::vector<double>({ 1.25, 2.25 }));			}, "setting values");
+	edited(1,	[&](){ column(1).setValue(10, column(1).AsInts[11] == column(1).AsInts[10] ? column(1).AsInts[12] : column(1).AsInts[11]); }, "setting a key");
+	edited(1,	[&](){ column(1).setValues(size_t(0), std::vector<std::string>({ "brand new" }));		}, "setting a new text");
+	edited(0,	[&](){ column(0).changeColumnType(columnType::nominal);									}, "changing the type");
+	edited(1,	[&](){ dataSet->setRowCount(rows + 1);													}, "adding a row");
+
+	//Asking again without changes should not go through the whole column
+	const size_t bigRows = 200000;
+	enlarging([&](){ dataSet->setColumnCount(2); dataSet->setRowCount(bigRows); });
+	enlarging([&](){ setColumn(column(1), generate(random, 2, bigRows)[1]); });
+
+	auto		start		= std::chrono::steady_clock::now();
+	uint64_t	first		= column(1).valuesFingerprint();
+	auto		middle		= std::chrono::steady_clock::now();
+	uint64_t	second		= column(1).valuesFingerprint();
+	auto		end			= std::chrono::steady_clock::now();
+
+	check(first == second,																			"an unchanged column keeps its fingerprint");
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout	<< "Column fingerprints skip exactly the unchanged columns of " << pairs << " csv pairs (" << skipped << " skipped, " << synced << " synced), "
+					<< "fingerprinting " << bigRows << " rows took " << std::chrono::duration<double, std::milli>(middle - start).count() << "ms and asking again "
+					<< std::chrono::duration<double, std::milli>(end - middle).count() << "ms." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
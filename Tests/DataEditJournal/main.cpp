@@ -0,0 +1,197 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "dataeditjournal.h"
+#include "sharedmemory.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+#include <cmath>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+///Everything about a column the data editor can change, to compare with after undoing and redoing
+struct Snapshot
+{
+	columnType					type;
+	std::vector<int>			ints;
+	std::vector<double>			doubles;
+	std::vector<std::string>	labels;
+
+	Snapshot(Column & column) : type(column.getColumnType())
+	{
+		if(type == columnType::scale)	doubles.assign(column.AsDoubles.begin(),	column.AsDoubles.end());
+		else							ints.assign(	column.AsInts.begin(),		column.AsInts.end());
+
+		for(const Label & label : column.labels())
+			labels.push_back(std::to_string(label.value()) + "|" + label.text() + "|" + label.originalText() + "|" + (label.filterAllows() ? "y" : "n"));
+	}
+
+	bool operator==(const Snapshot & other) const
+	{
+		return type == other.type && ints == other.ints && labels == other.labels && doubles.size() == other.doubles.size()
+			&& std::equal(doubles.begin(), doubles.end(), other.doubles.begin(), [](double l, double r) { return l == r || (std::isnan(l) && std::isnan(r)); });
+	}
+};
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	std::mt19937	random(2023);
+	const size_t	rows	= 1500,
+					steps	= 3000;
+	const int		missing	= std::numeric_limits<int>::lowest();
+	DataSet		*	dataSet	= SharedMemory::createDataSet();
+
+	dataSet->setColumnCount(1);
+	dataSet->setRowCount(rows);
+
+	Column & column = dataSet->column(0);
+	column.setName("edited");
+
+	std::vector<int>			ints(rows);
+	std::map<int, std::string>	levels = { {1, "1"}, {2, "2"}, {3, "3"}, {4, "4"}, {5, "5"} };
+
+	for(size_t r=0; r<rows; r++)
+		ints[r] = r % 17 == 0 ? missing : 1 + random() % 5;
+
+	column.overwriteDataWithNominalOrOrdinal(ints.data(), rows, levels, false);
+
+	DataEditJournal			journal;
+	std::vector<Snapshot>	history		= { Snapshot(column) };
+	size_t					at			= 0,
+							edits		= 0,
+							undos		= 0,
+							redos		= 0;
+	const columnType		types[]		= { columnType::nominal, columnType::ordinal, columnType::scale, columnType::nominalText };
+
+	//Edits the way DataSetPackage does them, and keeps what the column should look like after each of them
+	auto edited = [&]()
+	{
+		history.resize(at + 1, history.front());
+		history.push_back(Snapshot(column));
+		at++;
+		edits++;
+	};
+
+	for(size_t step=0; step<steps; step++)
+	{
+		Labels & labels = column.labels();
+
+		switch(random() % 6)
+		{
+		case 0:
+			if(labels.size() > 0)
+			{
+				size_t		row		= random() % labels.size();
+				std::string	before	= labels.getLabelFromRow(row);
+
+				if(labels.setLabelFromRow(row, "label " + std::to_string(random() % 50)))
+				{
+					journal.recordLabelText(column.name(), row, before, labels.getLabelFromRow(row));
+					edited();
+				}
+			}
+			break;
+
+		case 1:
+			if(labels.size() > 1)
+			{
+				std::vector<Label>	before(labels.begin(), labels.end()),
+									after(before);
+
+				if(random() % 2)	std::reverse(after.begin(), after.end());
+				else				{ size_t row = random() % (after.size() - 1); std::iter_swap(after.begin() + row, after.begin() + row + 1); }
+
+				journal.recordLabelOrder(column.name(), before, after);
+				labels.set(after);
+				edited();
+			}
+			break;
+
+		case 2:
+		{
+			columnType						newType	= types[random() % 4];
+			DataEditJournal::ColumnState	before	= DataEditJournal::captureColumn(column);
+
+			if(newType != column.getColumnType() && column.changeColumnType(newType) == columnTypeChangeResult::changed)
+			{
+				journal.recordColumnType(column.name(), std::move(before), newType);
+				edited();
+			}
+			break;
+		}
+
+		case 3:
+		case 4:
+			if(journal.canUndo())
+			{
+				check(DataEditJournal::apply(column, journal.takeUndo(), true),				"undoing step " + std::to_string(step) + " changes the column");
+				at--;
+				undos++;
+				check(Snapshot(column) == history[at],										"undoing step " + std::to_string(step) + " puts back the column as it was");
+			}
+			break;
+
+		case 5:
+			if(journal.canRedo())
+			{
+				check(DataEditJournal::apply(column, journal.takeRedo(), false),			"redoing step " + std::to_string(step) + " changes the column");
+				at++;
+				redos++;
+				check(Snapshot(column) == history[at],										"redoing step " + std::to_string(step) + " gives the column as it was edited");
+			}
+			break;
+		}
+
+		check(journal.canUndo() == (at > 0) && journal.canRedo() == (at + 1 < history.size()),	"undo and redo are possible exactly when there is something to go back or forward to at step " + std::to_string(step));
+
+		if(failures > 10)
+			break;
+	}
+
+	check(edits > 100 && undos > 100 && redos > 50,		"enough edits, undos and redos were tried");
+
+	//Undoing everything gives back the column as it was loaded
+	while(journal.canUndo())
+		DataEditJournal::apply(column, journal.takeUndo(), true);
+
+	check(Snapshot(column) == history.front(),				"undoing all edits gives back the original column");
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout << "After " << edits << " random label edits, reorders and columntype changes, " << undos << " undos and " << redos << " redos each gave exactly the column as it was at that point." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,166 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "databaseconnectioninfo.h"
+#include "importers/database/databaseimportcolumn.h"
+#include "sharedmemory.h"
+#include "log.h"
+#include <QCoreApplication>
+#include <QTemporaryDir>
+#include <QSqlDatabase>
+#include <QSqlRecord>
+#include <QSqlField>
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <limits>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static DataSet * dataSet = nullptr;
+
+///Same as DataSetPackage::enlargeDataSetIfNecessary
+static void enlarging(std::function<void()> tryThis)
+{
+	while(true)
+		try	{ tryThis(); return; }
+		catch (boost::interprocess::bad_alloc &) { dataSet = SharedMemory::enlargeDataSet(dataSet); }
+}
+
+static void insertIds(int from, int to)
+{
+	QSqlQuery insert;
+	insert.prepare("INSERT INTO items (id, name) VALUES (:id, :name)");
+
+	for(int id=from; id<=to; id++)
+	{
+		insert.bindValue(":id",		QString::number(id));
+		insert.bindValue(":name",	QString("item %1").arg(id));
+		insert.exec();
+	}
+}
+
+static void checkLastSyncValue()
+{
+	QVariant numeric = DatabaseConnectionInfo::lastSyncValueOf({ "1", "9", "", "10", "2" });
+	check(numeric.typeId() == QMetaType::Double && numeric.toDouble() == 10,						"ids stored as text have 10 as maximum, not 9");
+
+	QVariant stamps = DatabaseConnectionInfo::lastSyncValueOf({ "2023-01-09 10:00", "2023-01-10 09:00" });
+	check(stamps.typeId() == QMetaType::QString && stamps.toString() == "2023-01-10 09:00",			"timestamps are still compared as text");
+
+	check(!DatabaseConnectionInfo::lastSyncValueOf({ "", "" }).isValid(),							"only empty values give nothing to sync after");
+}
+
+static void checkQueryAfter(const QString & file)
+{
+	DatabaseConnectionInfo info;
+	info._dbType		= DbType::QSQLITE;
+	info._database		= file;
+	info._query			= "SELECT id, name FROM items;";
+	info._syncColumn	= "id";
+
+	check(info.connect(),																			"the SQLite file can be opened");
+
+	QSqlQuery("CREATE TABLE items (id TEXT, name TEXT)").exec();
+	insertIds(1, 10);
+
+	QSqlQuery all = info.runQuery();
+	QStringList ids;
+	while(all.next())
+		ids.push_back(all.value(0).toString());
+
+	check(DatabaseImportColumn::storageForType(all.record().field(0).metaType()) == DatabaseImportColumn::storageType::strings, "the ids arrive as text");
+
+	const QVariant last = DatabaseConnectionInfo::lastSyncValueOf(ids);
+	check(last.toDouble() == 10,																	"the last synced id is 10");
+
+	insertIds(11, 12);
+
+	QSqlQuery after = info.runQueryAfter(last);
+	QStringList newIds;
+	while(after.next())
+		newIds.push_back(after.value(0).toString());
+
+	check(newIds == QStringList({ "11", "12" }),													"only the rows after id 10 are fetched, in order, got: " + newIds.join(",").toStdString());
+
+	info.close();
+}
+
+static void checkAppend()
+{
+	const int missing = std::numeric_limits<int>::lowest();
+
+	dataSet = SharedMemory::createDataSet();
+
+	enlarging([&](){ dataSet->setColumnCount(3); dataSet->setRowCount(3); });
+	enlarging([&](){ dataSet->column(0).setColumnAsNominalText({ "a", "b", "a" });			});
+	enlarging([&](){ dataSet->column(1).setColumnAsNominalOrOrdinal({ 1, 2, 1 });			});
+	enlarging([&](){ dataSet->column(2).setColumnAsScale({ 0.5, 1.5, 2.5 });					});
+
+	Column	& texts		= dataSet->column(0),
+			& ints		= dataSet->column(1),
+			& doubles	= dataSet->column(2);
+
+	const std::vector<int> textsBefore = { texts.AsInts[0], texts.AsInts[1], texts.AsInts[2] };
+
+	enlarging([&](){ dataSet->setRowCount(6); });
+
+	bool textLabelsAdded = false, intLabelsAdded = false;
+
+	enlarging([&](){ textLabelsAdded	= texts.setValues(3, std::vector<std::string>({ "b", "c", "" }));	});
+	enlarging([&](){ intLabelsAdded		= ints.setValues(3, std::vector<int>({ 2, 3, missing }));			});
+	enlarging([&](){ doubles.setValues(3, std::vector<double>({ 3.5, 4.5, 5.5 }));						});
+
+	check(texts.AsInts[0] == textsBefore[0] && texts.AsInts[1] == textsBefore[1] && texts.AsInts[2] == textsBefore[2], "the rows that were there keep their values");
+	check(textLabelsAdded && texts.labels().size() == 3,											"a new text gets a label and a known one does not");
+	check(texts.labels().getValueFromKey(texts.AsInts[3]) == "b" && texts.labels().getValueFromKey(texts.AsInts[4]) == "c", "appended texts come back");
+	check(texts.AsInts[5] == missing,																"an appended empty text is missing");
+	check(intLabelsAdded && ints.labels().size() == 3 && ints.AsInts[4] == 3 && ints.AsInts[5] == missing, "appended ints get their labels");
+	check(doubles.AsDoubles[2] == 2.5 && doubles.AsDoubles[5] == 5.5,								"appended doubles land after the old ones");
+
+	SharedMemory::unloadDataSet(true);
+}
+
+int main(int argc, char ** argv)
+{
+	QCoreApplication app(argc, argv);
+
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	QTemporaryDir dir;
+
+	checkLastSyncValue();
+	checkQueryAfter(dir.filePath("sync.sqlite"));
+	checkAppend();
+
+	if(failures == 0)
+		std::cout << "Incremental database sync compares ids numerically and appends only the new rows." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
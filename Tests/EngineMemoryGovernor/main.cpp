@@ -0,0 +1,140 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "enginememorygovernor.h"
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static const size_t MB = EngineMemoryGovernor::MB;
+
+///Memory numbers the test makes up, the governor doesn't own this one so the test can keep changing them
+class FakeMemorySource : public EngineMemorySource
+{
+public:
+	size_t	residentBytes(long pid)	override	{ return resident.count(pid) ? resident[pid] : 0;	}
+	size_t	availableBytes()		override	{ return available;									}
+	size_t	totalBytes()			override	{ return total;										}
+
+	std::map<long, size_t>	resident;
+	size_t					available	= 8000 * MB,
+							total		= 16000 * MB;
+};
+
+class ForwardingSource : public EngineMemorySource
+{
+public:
+	ForwardingSource(FakeMemorySource & fake) : _fake(fake) {}
+
+	size_t	residentBytes(long pid)	override	{ return _fake.residentBytes(pid);	}
+	size_t	availableBytes()		override	{ return _fake.availableBytes();	}
+	size_t	totalBytes()			override	{ return _fake.totalBytes();		}
+
+private:
+	FakeMemorySource & _fake;
+};
+
+static size_t count(const std::vector<EngineMemoryGovernor::Advice> & advice, EngineMemoryGovernor::action what)
+{
+	size_t n = 0;
+	for(const auto & a : advice)
+		if(a.what == what)
+			n++;
+	return n;
+}
+
+int main(int, char **)
+{
+	using action = EngineMemoryGovernor::action;
+
+	FakeMemorySource		fake;
+	EngineMemoryGovernor	governor(new ForwardingSource(fake));
+
+	governor.setBudget(2000 * MB);
+
+	fake.resident = { {101, 400 * MB}, {102, 900 * MB}, {103, 500 * MB} };
+
+	std::vector<EngineMemoryGovernor::Sample> engines = { {0, 101, true}, {1, 102, true}, {2, 103, false} };
+
+	governor.measure(engines);
+	check(governor.enginesResident() == 1800 * MB,							"resident memory of all engines is summed");
+	check(!governor.underPressure(),										"under the budget with plenty available is no pressure");
+	check(governor.advise(engines, 0).empty(),								"no advice without pressure");
+
+	fake.resident[103] = 1400 * MB;
+	governor.measure(engines);
+	check(governor.underPressure(),											"over the budget is pressure");
+
+	auto advice = governor.advise(engines, 1000);
+	check(advice.size() == 2,												"both idle engines are asked to clean up");
+	check(advice.size() == 2 && advice[0].channel == 1 && advice[1].channel == 0,	"the biggest idle engine is cleaned first");
+	check(count(advice, action::restart) == 0,								"nothing is restarted before cleaning had a chance");
+
+	for(const auto & a : advice)
+		check(a.channel != 2,												"a busy engine is never advised");
+
+	check(governor.advise(engines, 3000).empty(),							"cleaned engines get time to settle before anything else happens");
+
+	advice = governor.advise(engines, 7000);
+	check(advice.size() == 1 && advice[0].channel == 1 && advice[0].what == action::restart,	"the biggest idle engine that is still big after cleaning is restarted");
+
+	check(count(governor.advise(engines, 9000), action::restart) == 0,		"at most one restart per cooldown");
+
+	engines[1].pid		= 104; //The restarted engine comes back as a new process
+	fake.resident[104]	= 250 * MB;
+	fake.resident.erase(102);
+	governor.measure(engines);
+	check(governor.underPressure(),											"still over the budget");
+	advice = governor.advise(engines, 10000);
+	check(advice.size() == 1 && advice[0].channel == 1 && advice[0].what == action::cleanMemory,	"a new process on the same channel may be cleaned right away");
+
+	check(!governor.mayStartEngine(3),										"no extra engine over the budget");
+	check(governor.mayStartEngine(0),										"the first engine may always start");
+
+	fake.resident		= { {101, 300 * MB}, {104, 250 * MB}, {103, 300 * MB} };
+	governor.measure(engines);
+	check(!governor.underPressure() && governor.advise(engines, 100000).empty(),	"no advice once the pressure is gone");
+	check(governor.mayStartEngine(3),										"extra engines may start when there is room");
+
+	fake.available		= 1000 * MB;
+	governor.measure(engines);
+	check(governor.underPressure(),											"a machine that runs low is pressure even in budget");
+	check(!governor.mayStartEngine(3),										"no extra engine when the machine runs low");
+
+	fake.total			= 0;
+	fake.available		= 0;
+	fake.resident.clear();
+	governor.setBudget(0);
+	governor.measure(engines);
+	check(!governor.underPressure() && governor.mayStartEngine(3),			"when nothing is known the governor stays out of the way");
+
+	if(failures == 0)
+		std::cout << "Idle engines are cleaned up biggest first and restarted one at a time, busy ones are left alone and no engines are started over the budget." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+# Writes a csv-file to OUTPUT with ROWS rows of a sorted, a noisy and a nominal
+# column, so that filters on them change blocks of rows as well as scattered ones.
+#
+# cmake -DOUTPUT=filterchanges.csv -DROWS=5000 -P generatecsv.cmake
+
+if(NOT DEFINED OUTPUT OR NOT DEFINED ROWS)
+  message(FATAL_ERROR "generatecsv.cmake needs OUTPUT and ROWS")
+endif()
+
+set(CSV "sorted,noisy,group\n")
+set(NOISE 12345)
+
+math(EXPR LAST "${ROWS} - 1")
+foreach(ROW RANGE ${LAST})
+  math(EXPR NOISE "(${NOISE} * 1103515245 + 12345) % 2147483648")
+  math(EXPR NOISY "${NOISE} % 1000")
+  math(EXPR GROUP "${ROW} % 5")
+  string(APPEND CSV "${ROW},${NOISY},group${GROUP}\n")
+endforeach()
+
+file(WRITE ${OUTPUT} "${CSV}")
@@ -0,0 +1,148 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "sharedmemory.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <algorithm>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+///DataSetPackage::setFilterData only tells the views about the rows in these runs, so they must cover every row whose filter changed and nothing else
+static bool runsCoverChanges(const ChangedRows & changed, const std::vector<bool> & before, const std::vector<bool> & after)
+{
+	std::vector<bool>	inRun(after.size(), false);
+	size_t				rows		= 0,
+						previousEnd	= 0;
+
+	for(const ChangedRows::Run & run : changed.runs)
+	{
+		if(run.count == 0 || run.first < previousEnd || run.first + run.count > after.size() || (previousEnd > 0 && run.first == previousEnd))
+			return false; //Runs are sorted, not empty and never touch, otherwise they would have been one
+
+		for(size_t r=run.first; r<run.first + run.count; r++)
+			inRun[r] = true;
+
+		rows		+= run.count;
+		previousEnd  = run.first + run.count;
+	}
+
+	for(size_t r=0; r<after.size(); r++)
+		if(inRun[r] != (before[r] != after[r]))
+			return false;
+
+	return rows == changed.rows;
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const size_t	rows	= 5000;
+	DataSet		*	dataSet	= SharedMemory::createDataSet();
+
+	dataSet->setColumnCount(1);
+	dataSet->setRowCount(rows);
+
+	std::vector<bool> filter(rows, true);
+
+	filter[10] = filter[11] = filter[12] = false;
+	filter[100] = false;
+
+	ChangedRows changed = dataSet->setFilterVector(filter);
+	check(changed.rows == 4 && changed.runs.size() == 2,									"consecutive changed rows form a single run");
+	check(changed.runs.size() == 2 && changed.runs[0].first == 10 && changed.runs[0].count == 3 && changed.runs[1].first == 100 && changed.runs[1].count == 1,	"runs start at the first changed row and count the rows");
+	check(dataSet->filteredRowCount() == int(rows - 4),										"the filtered row count follows");
+	check(!dataSet->setFilterVector(filter).changed(),										"the same filter again changes nothing");
+	check(!changed.tooScattered(rows),														"a few runs are not scattered");
+
+	std::mt19937	random(1234);
+	auto			chance		= [&](double p)					{ return std::uniform_real_distribution<double>(0, 1)(random) < p;	};
+	auto			between		= [&](size_t lo, size_t hi)		{ return std::uniform_int_distribution<size_t>(lo, hi)(random);		};
+	size_t			scattered	= 0;
+
+	for(size_t step=0; step<200; step++)
+	{
+		const std::vector<bool> before = filter;
+
+		switch(step % 4)
+		{
+		case 0: //Some block of rows is toggled, like a filter on a range of values of a sorted column
+		{
+			size_t from = between(0, rows - 1), to = std::min(rows, from + between(1, rows / 10));
+			for(size_t r=from; r<to; r++)
+				filter[r] = !filter[r];
+			break;
+		}
+
+		case 1: //A handful of random rows
+			for(size_t i=0; i<10; i++)
+			{
+				size_t r	= between(0, rows - 1);
+				filter[r]	= !filter[r];
+			}
+			break;
+
+		case 2: //Every row has a chance, which is what a filter on a noisy column does
+			for(size_t r=0; r<rows; r++)
+				if(chance(0.3))
+					filter[r] = !filter[r];
+			break;
+
+		case 3: //The filter is undone, sometimes it was already
+			if(chance(0.5))
+				filter.assign(rows, true);
+			break;
+		}
+
+		changed = dataSet->setFilterVector(filter);
+
+		check(changed.changed() == (before != filter),										"a change is reported exactly when the filter differs at step " + std::to_string(step));
+		check(runsCoverChanges(changed, before, filter),									"the runs cover exactly the changed rows at step " + std::to_string(step));
+		check(dataSet->filteredRowCount() == int(std::count(filter.begin(), filter.end(), true)),	"the filtered row count follows at step " + std::to_string(step));
+
+		if(step % 4 == 0)
+			check(!changed.tooScattered(rows),												"a toggled block is not scattered at step " + std::to_string(step));
+
+		if(changed.tooScattered(rows))
+			scattered++;
+	}
+
+	check(scattered > 0,																	"a noisy filter is too scattered to report per run");
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout << "Filter changes are reported as runs covering exactly the changed rows over 200 random filters, " << scattered << " of them too scattered to be worth it." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+
+#include "imagecache.h"
+#include "log.h"
+#include <QTemporaryDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <archive.h>
+#include <archive_entry.h>
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static QByteArray randomImage(std::mt19937 & random, int size)
+{
+	QByteArray bytes(size, 0);
+
+	for(char & byte : bytes)
+		byte = char(random() & 0xff);
+
+	return bytes;
+}
+
+static void writeFile(const QString & path, const QByteArray & bytes)
+{
+	QDir().mkpath(QFileInfo(path).absolutePath());
+
+	QFile file(path);
+	file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	file.write(bytes);
+}
+
+static QByteArray readFile(const QString & path)
+{
+	QFile file(path);
+	return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+///Writes the files the way JASPExporter::saveJASPArchive does, with their contents from readContents
+template<typename READ>
+static void writeArchive(const QString & archivePath, const QString & root, const std::vector<QString> & relativePaths, READ readContents)
+{
+	archive * a = archive_write_new();
+	archive_write_set_format_zip(a);
+	archive_write_open_filename(a, archivePath.toStdString().c_str());
+
+	for(const QString & relativePath : relativePaths)
+	{
+		QByteArray contents = readContents(root + "/" + relativePath);
+
+		archive_write_set_format_option(a, "zip", "compression", relativePath.endsWith(".png") ? "store" : "deflate");
+
+		archive_entry * entry = archive_entry_new();
+		archive_entry_set_pathname(	entry,	relativePath.toStdString().c_str());
+		archive_entry_set_size(		entry,	contents.size());
+		archive_entry_set_filetype(	entry,	AE_IFREG);
+		archive_entry_set_perm(		entry,	0644);
+		archive_write_header(		a,		entry);
+		archive_entry_free(entry);
+
+		archive_write_data(a, contents.constData(), size_t(contents.size()));
+	}
+
+	archive_write_close(a);
+	archive_write_free(a);
+}
+
+///What is in the archive, by path
+static std::map<QString, QByteArray> readArchive(const QString & archivePath)
+{
+	std::map<QString, QByteArray>	entries;
+	archive						*	a		= archive_read_new();
+	archive_entry				*	entry;
+
+	archive_read_support_format_zip(a);
+
+	if(archive_read_open_filename(a, archivePath.toStdString().c_str(), 10240) == ARCHIVE_OK)
+		while(archive_read_next_header(a, &entry) == ARCHIVE_OK)
+		{
+			QByteArray contents(int(archive_entry_size(entry)), 0);
+			archive_read_data(a, contents.data(), size_t(contents.size()));
+			entries[QString::fromUtf8(archive_entry_pathname(entry))] = contents;
+		}
+
+	archive_read_free(a);
+
+	return entries;
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	QTemporaryDir	session;
+	std::mt19937	random(2023);
+	ImageCache	*	cache	= ImageCache::cache();
+	const QString	root	= session.path();
+
+	//Three analyses with some plots, the second has a plot identical to one of the first
+	const QByteArray	shared	= randomImage(random, 20000);
+	std::vector<QString>	paths;
+
+	for(int analysis=1; analysis<=3; analysis++)
+		for(int plot=0; plot<4; plot++)
+		{
+			QString path = "resources/" + QString::number(analysis) + "/_" + QString::number(plot) + (plot == 3 ? ".svg" : ".png");
+			writeFile(root + "/" + path, plot == 0 && analysis < 3 ? shared : randomImage(random, 10000 + 1000 * plot));
+			paths.push_back(path);
+		}
+
+	writeFile(root + "/resources/1/jaspResults.json", "{ \"some\": \"state\" }");
+	paths.push_back("resources/1/jaspResults.json");
+
+	bool allRead = true;
+	for(const QString & path : paths)
+		if(cache->isImage(path) && cache->read(root + "/" + path) != readFile(root + "/" + path))
+			allRead = false;
+
+	check(allRead,													"an image is read as it is on disk");
+	check(cache->files() == 12 && cache->contents() == 11,			"identical plots are kept once");
+	check(cache->read(root + "//resources/2/_0.png") == shared && cache->files() == 12,	"a path is the same file however it is written");
+
+	//The archive made from the cache has to be exactly the one made from the files
+	const QString	fromDisk	= root + "/fromDisk.jasp",
+					fromCache	= root + "/fromCache.jasp";
+
+	writeArchive(fromDisk,	root, paths, readFile);
+	writeArchive(fromCache,	root, paths, [&](const QString & path) { return ImageCache::isImage(path) ? cache->read(path) : readFile(path); });
+
+	check(readFile(fromDisk) == readFile(fromCache),				"an archive with images from the cache is byte for byte the one from disk");
+
+	std::map<QString, QByteArray> archived = readArchive(fromCache);
+
+	bool allArchived = archived.size() == paths.size();
+	for(const QString & path : paths)
+		if(archived[path] != readFile(root + "/" + path))
+			allArchived = false;
+
+	check(allArchived,												"every file comes out of the archive as it went in");
+
+	//A rewrite of the same size within the same second is invisible to size and modification time, the analysis getting its results forgets the files
+	const QString		rewritten	= root + "/resources/3/_1.png";
+	const QDateTime		modified	= QFileInfo(rewritten).lastModified();
+	const QByteArray	newPlot		= randomImage(random, int(QFileInfo(rewritten).size()));
+
+	writeFile(rewritten, newPlot);
+
+	QFile touched(rewritten);
+	touched.open(QIODevice::ReadWrite);
+	touched.setFileTime(modified, QFileDevice::FileModificationTime);
+	touched.close();
+
+	cache->forget(root + "/resources/3");
+	check(cache->files() == 8 && cache->contents() == 7,			"forgetting an analysis drops its files and what only they used");
+	check(cache->read(rewritten) == newPlot,						"a forgotten file is read again");
+
+	writeArchive(fromCache,	root, paths, [&](const QString & path) { return ImageCache::isImage(path) ? cache->read(path) : readFile(path); });
+	writeArchive(fromDisk,	root, paths, readFile);
+	check(readFile(fromDisk) == readFile(fromCache),				"the archive has the rewritten plot");
+
+	//The shared plot stays as long as one of the analyses that has it is there
+	cache->forget(root + "/resources/1");
+	check(cache->read(root + "/resources/2/_0.png") == shared && cache->misses() == 16,	"a plot another analysis still has is kept");
+	cache->forget(root + "/resources/2");
+	check(cache->files() == 4 && cache->contents() == 4,			"the shared plot goes with the last analysis that had it");
+
+	//Writing the same pixels again keeps them shared
+	writeFile(root + "/resources/2/_0.png", shared);
+	writeFile(root + "/resources/2/_1.png", shared);
+	cache->read(root + "/resources/2/_0.png");
+	cache->read(root + "/resources/2/_1.png");
+	check(cache->files() == 6 && cache->contents() == 5,			"a plot written again with the same content is shared");
+
+	//When the budget is exceeded the files of dropped contents go too, so nothing points at an image that isn't there
+	cache->setBudget(25000);
+	check(cache->bytesInUse() <= 25000 && cache->files() == cache->contents() + 1,	"the files of evicted contents are dropped");
+	check(cache->read(root + "/resources/3/_0.png") == readFile(root + "/resources/3/_0.png"),	"an evicted file is read again");
+
+	cache->clear();
+	check(cache->files() == 0 && cache->contents() == 0 && cache->bytesInUse() == 0,	"clearing drops everything");
+
+	if(failures == 0)
+		std::cout << "Images come out of the cache and into an archive exactly as on disk, are read again once forgotten and shared contents live as long as a file uses them." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+//
+// Copyright (C) 2013-2024 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include <RInside.h>
+#include "jaspstatestore.h"
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+static int			failures	= 0;
+static RInside	*	R			= nullptr;
+static std::string	stateRoot;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+///Does what jaspBase does around an analysis: load the state, only compute what isn't in it and hand it to the store, which writes it to the file once that is needed
+static SEXP runAnalysis(int id, int revision, bool & warm)
+{
+	const std::string stateFile = stateRoot + std::to_string(id);
+
+	Rcpp::RObject state = JaspStateStore::store()->retrieve(id, revision);
+
+	warm				= !state.isNULL();
+	(*R)["stateFile"]	= stateFile;
+
+	if(!warm)
+	{
+		R->parseEvalQ("state <- NULL; if (file.exists(stateFile)) load(stateFile)");
+		state = R->parseEval("if (is.null(state)) list(fit = summary(lm(dist ~ poly(speed, 3), data = cars))$coefficients, draws = replicate(200, mean(sample(cars$dist, replace = TRUE)))) else state");
+	}
+
+	JaspStateStore::store()->store(id, revision, state, stateFile);
+
+	return state;
+}
+
+static bool identical(SEXP a, SEXP b)
+{
+	return R_compute_identical(a, b, 16);
+}
+
+static bool fileExists(int id)
+{
+	return std::filesystem::exists(stateRoot + std::to_string(id));
+}
+
+///What jaspBase's own .retrieveState would find in the file
+static SEXP loadFromFile(int id)
+{
+	(*R)["stateFile"] = stateRoot + std::to_string(id);
+	return R->parseEval("local({ state <- NULL; load(stateFile); state })");
+}
+
+static void removeFiles()
+{
+	std::remove((stateRoot + "1").c_str());
+	std::remove((stateRoot + "2").c_str());
+}
+
+int main(int argc, char ** argv)
+{
+	if(argc < 2)
+	{
+		std::cerr << "Usage: JaspStateStoreTest <state file>" << std::endl;
+		return 1;
+	}
+
+	stateRoot = argv[1];
+	removeFiles();
+
+	R = new RInside();
+	R->parseEvalQ("set.seed(1)");
+
+	JaspStateStore	*	store	= JaspStateStore::store();
+	bool				warm	= false;
+
+	Rcpp::RObject first		= runAnalysis(1, 1, warm);
+	check(!warm,																"the first run has no state to start from");
+	check(!fileExists(1),														"storing a state doesn't write its file yet");
+
+	Rcpp::RObject second	= runAnalysis(1, 2, warm);
+	check(warm,																	"the second run gets its state from the store");
+	check(identical(first, second),												"both runs give identical results");
+
+	check(store->save(1) && fileExists(1),										"saving writes the file");
+	check(identical(loadFromFile(1), second),									"what the store has is what jaspBase would load from the file");
+	check(!Rf_isNull(store->retrieve(1, 2)),									"and keeps the state in memory");
+
+	check(Rf_isNull(store->retrieve(1, 1)),										"an older revision doesn't get the state of a newer one");
+
+	//Another engine is going to run it
+	runAnalysis(1, 3, warm);
+	removeFiles();
+	check(store->handOver(1) && fileExists(1),									"handing a state over writes it");
+	check(Rf_isNull(store->retrieve(1, 4)) && store->bytesInUse() == 0,			"and forgets it, so it never shadows what the other engine saves");
+
+	Rcpp::RObject handedOver = runAnalysis(1, 4, warm);
+	check(!warm && identical(handedOver, second),								"the next run gets the handed over state from the file");
+
+	removeFiles();
+	store->forget(1);
+	check(Rf_isNull(store->retrieve(1, 5)) && !fileExists(1),					"a removed analysis is forgotten without writing it");
+
+	runAnalysis(1, 5, warm);
+	runAnalysis(2, 1, warm);
+	store->clear();
+	check(Rf_isNull(store->retrieve(1, 6)) && Rf_isNull(store->retrieve(2, 2)),	"cleaning memory clears everything");
+	check(store->bytesInUse() == 0,												"and frees all of it");
+	check(fileExists(1) && fileExists(2),										"but writes the states first");
+
+	removeFiles();
+	store->setBudget(1);
+	Rcpp::RObject evicted	= runAnalysis(1, 6, warm);
+	runAnalysis(2, 2, warm);
+	check(Rf_isNull(store->retrieve(1, 7)) && fileExists(1),					"over budget the least recently used state is written and dropped");
+	check(!Rf_isNull(store->retrieve(2, 3)) && !fileExists(2),					"but never the one just stored");
+
+	Rcpp::RObject cold		= runAnalysis(1, 7, warm);
+	check(!warm && identical(cold, evicted),									"a dropped state comes back from the file unchanged");
+
+	store->forget(1);
+	store->forget(2);
+	removeFiles();
+
+	if(failures == 0)
+		std::cout << "JaspStateStore: two runs of an analysis gave identical results and states were only written to their files when needed" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,227 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "sharedmemory.h"
+#include "labelstrings.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <functional>
+#include <limits>
+#include <map>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static DataSet * dataSet = nullptr;
+
+///Same as DataSetPackage::enlargeDataSetIfNecessary, anything that allocates in shared memory might need a bigger segment
+static size_t enlarging(std::function<void()> tryThis)
+{
+	size_t enlarged = 0;
+
+	while(true)
+		try	{ tryThis(); return enlarged; }
+		catch (boost::interprocess::bad_alloc &) { dataSet = SharedMemory::enlargeDataSet(dataSet); enlarged++; }
+}
+
+static bool rowsMatch(Column & column, const std::vector<std::string> & values)
+{
+	//getValueFromKey looks through all labels, which takes too long for every row of a column with a label per row
+	std::map<int, std::string> valueOfKey = { { std::numeric_limits<int>::lowest(), "" } };
+
+	for(size_t l=0; l<column.labels().size(); l++)
+		valueOfKey[column.labels()[l].value()] = column.labels().getValueFromRow(l);
+
+	for(size_t r=0; r<values.size(); r++)
+		if(!valueOfKey.count(column.AsInts[r]) || values[r] != valueOfKey[column.AsInts[r]])
+			return false;
+
+	return true;
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const size_t	rows		= 200000,
+					oldLabel	= 4 + 4 + 128 + 4 + 4; //What a Label was when it had a char[128] for its text
+	const int		missing		= std::numeric_limits<int>::lowest();
+
+	dataSet = SharedMemory::createDataSet();
+
+	LabelStrings * strings = LabelStrings::labelStrings();
+	check(strings && strings->count() == 0,																"a new dataset comes with empty label strings");
+
+	const size_t	hello	= strings->add("hello"),
+					world	= strings->add("world");
+	check(strings->add("hello") == hello && hello != world && strings->count() == 2,					"adding a text twice stores it once");
+	check(strings->text(hello, 5) == "hello" && strings->text(world, 5) == "world",						"texts come back from their offset");
+	check(strings->add("") == 0 && strings->text(0, 0) == "" && strings->count() == 2,					"the empty text is not stored");
+	check(strings->text(strings->charsUsed() + 10, 5) == "",											"an offset past what is stored gives nothing");
+
+	//Labels that only differ after 128 characters used to become the same label
+	const std::string	prefix(200, 'x'),
+						longA		= prefix + "A",
+						longB		= prefix + "B",
+						huge		= std::string(100000, 'h') + " and the end";
+
+	std::vector<std::string> longValues(rows);
+	for(size_t r=0; r<rows; r++)
+		switch(r % 5)
+		{
+		case 0:		longValues[r] = longA;	break;
+		case 1:		longValues[r] = longB;	break;
+		case 2:		longValues[r] = huge;	break;
+		case 3:		longValues[r] = "short"; break;
+		default:	longValues[r] = "";		break;
+		}
+
+	enlarging([&](){ dataSet->setColumnCount(3); dataSet->setRowCount(rows); });
+	enlarging([&](){ dataSet->column(0).setName("long"); dataSet->column(0).setColumnAsNominalText(longValues); });
+
+	{
+		Column & column = dataSet->column(0);
+
+		check(column.labels().size() == 4,																"labels that only differ after 128 characters stay apart");
+		check(rowsMatch(column, longValues),															"every row gets its long value back in full");
+		check(column.AsInts[4] == missing,																"an empty text is still missing");
+
+		bool hugeFound = false;
+		for(const Label & label : column.labels())
+			hugeFound = hugeFound || label.text() == huge;
+		check(hugeFound,																				"a label of a hundred thousand characters is not cut off");
+
+		//Renaming keeps the original text, which is what the values still refer to
+		int row = -1;
+		for(size_t l=0; l<column.labels().size(); l++)
+			if(column.labels().getValueFromRow(l) == longB)
+				row = l;
+
+		check(row != -1 && column.labels().setLabelFromRow(row, "b, but shorter"),						"a long label can be renamed");
+		check(column.labels().getLabelFromRow(row) == "b, but shorter",									"the renamed label shows its new text");
+		check(column.labels().getValueFromRow(row) == longB,											"the renamed label keeps its original text");
+		check(rowsMatch(column, longValues),															"the values are still the original texts after renaming");
+
+		std::map<int, std::string> orgs = column.labels().getOrgStringValues();
+		check(orgs.size() == 1 && orgs.begin()->second == longB,										"the original texts of renamed labels are found for saving");
+
+		//Copies, as the undo journal makes them, can be put back
+		std::vector<Label> copied(column.labels().begin(), column.labels().end());
+		enlarging([&](){ dataSet->column(0).labels().setLabelFromRow(row, "something else entirely"); });
+		enlarging([&](){ dataSet->column(0).labels().set(copied); });
+		check(dataSet->column(0).labels().getLabelFromRow(row) == "b, but shorter" && dataSet->column(0).labels().getValueFromRow(row) == longB,	"copied labels come back with their texts and original texts");
+	}
+
+	//The same texts in another column don't take any more room
+	const size_t stored = LabelStrings::labelStrings()->count();
+	enlarging([&](){ dataSet->column(1).setName("long again"); dataSet->column(1).setColumnAsNominalText(longValues); });
+	check(LabelStrings::labelStrings()->count() == stored,												"the same texts in another column are stored once");
+
+	//A text column where nearly every row is different, like ids or free text answers
+	std::vector<std::string> distinctValues(rows);
+	size_t distinctChars = 0;
+	for(size_t r=0; r<rows; r++)
+	{
+		distinctValues[r]	 = "participant-" + std::to_string(r * 7919 % rows);
+		distinctChars		+= distinctValues[r].size();
+	}
+
+	const size_t	bytesBefore	= LabelStrings::labelStrings()->bytesUsed(),
+					enlarged	= enlarging([&](){ dataSet->column(2).setName("distinct"); dataSet->column(2).setColumnAsNominalText(distinctValues); });
+	const size_t	poolBytes	= LabelStrings::labelStrings()->bytesUsed() - bytesBefore,
+					labelBytes	= dataSet->column(2).labels().size() * sizeof(Label),
+					perLabel	= (poolBytes + labelBytes) / rows,
+					perLabelOld	= oldLabel;
+
+	check(dataSet->column(2).labels().size() == rows,													"every distinct text gets a label");
+	check(rowsMatch(dataSet->column(2), distinctValues),												"the distinct texts all come back");
+	check(rowsMatch(dataSet->column(0), longValues),													"the long texts survive enlarging the segment");
+	check(enlarged > 0,																					"the segment had to be enlarged, so texts were found back after remapping");
+	check(perLabel < perLabelOld,																		"a short distinct label costs less than the fixed 128 characters did, " + std::to_string(perLabel) + " bytes");
+
+	//Renaming labels twice leaves the first names to nobody, until they are compacted away
+	std::vector<Label> journalCopy(dataSet->column(0).labels().begin(), dataSet->column(0).labels().end());
+	size_t firstNameChars = 0;
+
+	for(const char * name : { "first-", "second-" })
+		for(size_t l=0; l<dataSet->column(2).labels().size(); l++)
+		{
+			const std::string label = name + std::to_string(l);
+			firstNameChars += std::string(name) == "first-" ? label.size() : 0;
+			enlarging([&](){ dataSet->column(2).labels().setLabelFromRow(l, label); });
+		}
+
+	strings = LabelStrings::labelStrings();
+
+	const size_t	charsBeforeCompacting	= strings->charsUsed(),
+					bytesBeforeCompacting	= strings->bytesUsed();
+	check(strings->worthCompacting(),																	"a pool that only grew is worth compacting");
+
+	strings->compact([&](const LabelStrings::TextVisitor & visit)
+	{
+		dataSet->visitLabelTexts(visit);
+
+		for(Label & label : journalCopy)
+			label.visitTexts(visit);
+	});
+
+	size_t keptChars = longA.size() + longB.size() + huge.size() + std::string("short").size() + std::string("b, but shorter").size();
+	for(size_t l=0; l<dataSet->column(2).labels().size(); l++)
+		keptChars += dataSet->column(2).labels()[l].text().size() + dataSet->column(2).labels()[l].originalText().size();
+
+	check(strings->count() == 5 + 2 * rows,																"only the texts still in use are kept");
+	check(strings->charsUsed() < charsBeforeCompacting - firstNameChars / 2 && strings->charsUsed() >= keptChars,	"compacting gives back the characters of texts that are gone");
+	check(dataSet->column(2).labels().getLabelFromRow(17) == "second-17",								"renamed labels keep their latest name");
+	check(strings->bytesUsed() < bytesBeforeCompacting,													"compacting frees the chunks that became empty");
+	check(!strings->worthCompacting(),																	"a freshly compacted pool is not worth compacting again");
+	check(rowsMatch(dataSet->column(0), longValues) && rowsMatch(dataSet->column(1), longValues) && rowsMatch(dataSet->column(2), distinctValues),	"every column still has its texts after compacting");
+
+	enlarging([&](){ dataSet->column(0).labels().set(journalCopy); });
+
+	int renamedRow = -1;
+	for(size_t l=0; l<dataSet->column(0).labels().size(); l++)
+		if(dataSet->column(0).labels().getLabelFromRow(l) == "b, but shorter" && dataSet->column(0).labels().getValueFromRow(l) == longB)
+			renamedRow = l;
+	check(renamedRow != -1,																				"copies outside of shared memory get their texts moved along");
+
+	const size_t countAfter = strings->count();
+	check(strings->text(strings->add(huge), huge.size()) == huge && strings->text(strings->add(distinctValues[17]), distinctValues[17].size()) == distinctValues[17] && strings->count() == countAfter,	"texts that were kept are still found when added again");
+	check(strings->text(strings->add("new after compacting"), 20) == "new after compacting" && strings->count() == countAfter + 1,	"new texts can be added after compacting");
+
+	const size_t charsAfterCompacting = strings->charsUsed();
+
+	SharedMemory::unloadDataSet(true);
+
+	if(failures == 0)
+		std::cout	<< "Labels of up to " << huge.size() << " characters are stored in full. "
+					<< rows << " distinct texts of on average " << (distinctChars / rows) << " characters take " << perLabel << " bytes per label in shared memory (" << poolBytes / rows << " for text and index), where the fixed char[128] took " << perLabelOld << ". "
+					<< "Compacting after renaming every label of a column twice kept " << countAfter << " texts and went from " << charsBeforeCompacting << " to " << charsAfterCompacting << " characters." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+//
+// Copyright (C) 2013-2024 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "log.h"
+#include "logwriter.h"
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+int main(int, char **)
+{
+	check(LogWriter::writer()->destination() == &std::cout,	"before Log::init the log goes to std::cout");
+
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::cout);
+
+	std::ostringstream collected;
+	LogWriter::writer()->setDestination(&collected);
+
+	const size_t threadCount	= 8,
+				 linesPerThread	= 20000;
+
+	std::vector<std::thread> threads;
+
+	for(size_t t=0; t<threadCount; t++)
+		threads.emplace_back([t]()
+		{
+			for(size_t i=0; i<linesPerThread; i++)
+				Log::log() << "thread " << t << " line " << i << std::endl;
+
+			Log::log() << "thread " << t << " ends without a flush\n";
+		});
+
+	for(std::thread & thread : threads)
+		thread.join();
+
+	Log::flush();
+	Log::log() << "end" << std::endl; //Once this is written the writer also reported what it dropped before
+	Log::flush();
+
+	std::istringstream			lines(collected.str());
+	std::string					line;
+	std::vector<long>			lastLine(threadCount, -1);
+	size_t						written		= 0,
+								unflushed	= 0;
+	bool						whole		= true,
+								ordered		= true;
+
+	while(std::getline(lines, line))
+	{
+		if(line.rfind("LogWriter dropped ", 0) == 0 || line == "Desktop:\tend")
+			continue;
+
+		size_t t, i;
+		char   rest[64] = "";
+
+		if(std::sscanf(line.c_str(), "Desktop:\tthread %zu line %zu%63s", &t, &i, rest) == 2 && t < threadCount)
+		{
+			ordered			= ordered && long(i) > lastLine[t];
+			lastLine[t]		= long(i);
+			written++;
+		}
+		else if(line.find("ends without a flush") != std::string::npos)
+			unflushed++;
+		else
+			whole = false;
+	}
+
+	check(whole,																			"every line arrives whole, never mixed with another thread's");
+	check(ordered,																			"the lines of one thread stay in order");
+	check(written + unflushed + LogWriter::writer()->dropped() == threadCount * (linesPerThread + 1),	"every line is either written or counted as dropped");
+	check(LogWriter::writer()->dropped() > 0 || unflushed == threadCount,					"what a thread didn't flush is written when it ends");
+
+	const std::string urgent = "this is written before Log::error returns";
+	Log::error() << urgent << std::endl;
+	check(collected.str().find(urgent) != std::string::npos,								"Log::error waits for the writer");
+
+	LogWriter::writer()->setDestination(nullptr);
+
+	if(failures == 0)
+		std::cout << "LogWriter: " << written << " lines from " << threadCount << " threads arrived whole and in order, " << LogWriter::writer()->dropped() << " were dropped" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,205 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "ods/odsxmlcontentshandler.h"
+#include "ods/odsimportcolumn.h"
+#include "log.h"
+#include <QXmlSimpleReader>
+#include <QXmlInputSource>
+#include <iostream>
+#include <sstream>
+#include <random>
+
+using namespace ods;
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+typedef std::vector<std::vector<std::string>> Table; ///< [column][row]
+
+///Writes a content.xml for a sheet and keeps the plain expansion of it, cell by cell, to compare the import with
+class Sheet
+{
+public:
+	Sheet(size_t columns) : _table(columns)
+	{
+		_xml << R"(<?xml version="1.0" encoding="UTF-8"?>)"
+			 << R"(<office:document-content xmlns:office="urn:oasis:names:tc:opendocument:xmlns:office:1.0" xmlns:table="urn:oasis:names:tc:opendocument:xmlns:table:1.0" xmlns:text="urn:oasis:names:tc:opendocument:xmlns:text:1.0">)"
+			 << "<office:body><office:spreadsheet><table:table><table:table-row>";
+
+		for(size_t c=0; c<columns; c++)
+			_xml << cellXml("col" + std::to_string(c), 1, true);
+
+		_xml << "</table:table-row>";
+	}
+
+	struct Cell
+	{
+		std::string value;	///< empty for an empty cell
+		size_t		repeat;
+		bool		isText;
+	};
+
+	void addRow(const std::vector<Cell> & cells, size_t rowRepeat)
+	{
+		_xml << "<table:table-row" << (rowRepeat > 1 ? " table:number-rows-repeated=\"" + std::to_string(rowRepeat) + "\"" : "") << ">";
+
+		size_t column = 0;
+
+		for(const Cell & cell : cells)
+		{
+			_xml << cellXml(cell.value, cell.repeat, cell.isText);
+
+			if(!cell.value.empty())
+				_storedAtMost += cell.value.size();
+
+			for(size_t i=0; i<cell.repeat; i++, column++)
+				for(size_t r=0; r<rowRepeat; r++)
+					_table[column].push_back(cell.value);
+		}
+
+		for(; column<_table.size(); column++)
+			for(size_t r=0; r<rowRepeat; r++)
+				_table[column].push_back("");
+
+		_xml << "</table:table-row>";
+	}
+
+	std::string		xml()			const { return _xml.str() + "</table:table></office:spreadsheet></office:body></office:document-content>"; }
+	const Table &	table()			const { return _table; }
+	size_t			storedAtMost()	const { return _storedAtMost; } ///< Every cell element stores its value once at most, however many columns it spans
+
+private:
+	static std::string cellXml(const std::string & value, size_t repeat, bool isText)
+	{
+		std::string xml = "<table:table-cell";
+
+		if(repeat > 1)
+			xml += " table:number-columns-repeated=\"" + std::to_string(repeat) + "\"";
+
+		if(value.empty())			return xml + "/>";
+		else if(isText)				return xml + " office:value-type=\"string\"><text:p>" + value + "</text:p></table:table-cell>";
+		else						return xml + " office:value-type=\"float\" office:value=\"" + value + "\"><text:p>" + value + "</text:p></table:table-cell>";
+	}
+
+	std::ostringstream	_xml;
+	Table				_table;
+	size_t				_storedAtMost = 0;
+};
+
+///Rows always have a value somewhere, empty rows are not what this is about
+static Sheet generate(std::mt19937 & random, size_t columns, size_t rows)
+{
+	Sheet sheet(columns);
+
+	std::uniform_int_distribution<size_t>	repeat(1, 6),
+											value(0, 9);
+
+	for(size_t r=0; r<rows; r++)
+	{
+		std::vector<Sheet::Cell>	cells;
+		size_t						column	= 0;
+		bool						filled	= false;
+
+		while(column < columns)
+		{
+			const size_t	span	= std::min(columns - column, repeat(random));
+			const size_t	kind	= value(random);
+			std::string		content	= kind < 3 ? "" : kind < 6 ? std::to_string(kind * 1.5) : "level" + std::to_string(kind);
+
+			if(column + span == columns && !filled && content.empty())
+				content = "last";
+
+			filled	 = filled || !content.empty();
+			column	+= span;
+
+			cells.push_back({ content, span, kind >= 6 || content == "last" });
+		}
+
+		sheet.addRow(cells, value(random) < 2 ? repeat(random) : 1);
+	}
+
+	return sheet;
+}
+
+static void import(const Sheet & sheet, const std::string & name, size_t * arenaSize = nullptr)
+{
+	ODSImportDataSet	data(nullptr);
+	XmlContentsHandler	handler(&data);
+	QXmlInputSource		source;
+	QXmlSimpleReader	reader;
+
+	source.setData(QString::fromStdString(sheet.xml()));
+	reader.setContentHandler(&handler);
+	reader.setErrorHandler(&handler);
+
+	check(reader.parse(source),																		name + " parses");
+
+	data.postLoadProcess();
+
+	const Table & expected = sheet.table();
+
+	check(size_t(data.columnCount()) == expected.size(),											name + " has all columns");
+
+	for(size_t c=0; c<expected.size() && c<size_t(data.columnCount()); c++)
+	{
+		check(data[c].name() == "col" + std::to_string(c),											name + " column " + std::to_string(c) + " has its header as name");
+		check(data[c].getData() == expected[c],														name + " column " + std::to_string(c) + " has the same values as the plain expansion");
+	}
+
+	check(data.arenaSize() <= sheet.storedAtMost(),													name + " stores a cell that spans several columns only once");
+
+	if(arenaSize)
+		*arenaSize = data.arenaSize();
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	std::mt19937 random(2017);
+
+	for(size_t sheet=0; sheet<40; sheet++)
+		import(generate(random, 1 + sheet % 9, 1 + sheet * 3), "sheet " + std::to_string(sheet));
+
+	//One value over a thousand columns, as a spreadsheet that filled a whole row with it gives
+	const size_t	wide		= 1000;
+	Sheet			sheet(wide);
+	size_t			arenaSize	= 0;
+
+	sheet.addRow({ { "repeated value", wide, true } }, 3);
+	sheet.addRow({ { "1.5", 1, false }, { "", wide - 2, false }, { "end", 1, true } }, 1);
+
+	import(sheet, "a row of a thousand repeated columns", &arenaSize);
+	check(arenaSize == std::string("repeated value1.5end").size(),									"the thousand columns share one stored value");
+
+	if(failures == 0)
+		std::cout << "ODS sheets with repeated cells and rows import the same as their plain expansion and store repeated values once." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
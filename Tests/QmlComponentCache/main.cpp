@@ -0,0 +1,228 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlContext>
+#include <QQmlIncubationController>
+#include <QTemporaryDir>
+#include <QEventLoop>
+#include <QTimer>
+#include <QFile>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "utilities/qmlutils.h"
+#include "utilities/qmlcomponentcache.h"
+#include "log.h"
+#include <json/json.h>
+
+///Gives the incubators a few milliseconds every frame, like a QQuickWindow does while it renders
+class FrameIncubationController : public QObject, public QQmlIncubationController
+{
+public:
+	FrameIncubationController()
+	{
+		connect(&_frameTimer, &QTimer::timeout, [this]() { _frames++; incubateFor(5); });
+		_frameTimer.start(16);
+	}
+
+	size_t frames() const { return _frames; }
+
+private:
+	QTimer	_frameTimer;
+	size_t	_frames = 0;
+};
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string & what)
+{
+	if(ok)
+		return;
+
+	std::cerr << "Failed: " << what << std::endl;
+	failures++;
+}
+
+///A form that takes a while to build, items is the number of rows in it
+static void writeForm(const QString & path, int items)
+{
+	QFile form(path);
+	form.open(QIODevice::WriteOnly | QIODevice::Truncate);
+	form.write(QString(
+		"import QtQuick\n"
+		"Column {\n"
+		"	Repeater {\n"
+		"		model: %1\n"
+		"		Row { Rectangle { width: index % 7; height: 2 } Text { text: \"row \" + index } }\n"
+		"	}\n"
+		"}\n").arg(items).toUtf8());
+}
+
+static Json::Value statisticsJson(const QmlComponentCache::Statistics & statistics)
+{
+	Json::Value json(Json::objectValue);
+
+	json["hits"]			= Json::UInt64(statistics.hits);
+	json["misses"]			= Json::UInt64(statistics.misses);
+	json["created"]			= Json::UInt64(statistics.created);
+	json["compileMs"]		= statistics.compileMs;
+	json["createMs"]		= statistics.createMs;
+	json["meanCreateMs"]	= statistics.created ? statistics.createMs / statistics.created : 0.0;
+	json["slowestCreateMs"]	= statistics.slowestCreateMs;
+
+	return json;
+}
+
+int main(int argc, char * argv[])
+{
+	std::string	out;
+	int			repetitions	= 20,
+				items		= 2000;
+	bool		verbose		= false;
+
+	for(int i=1; i<argc; i++)
+	{
+		const std::string arg = argv[i];
+
+		if		(arg == "--out"			&& i + 1 < argc)	out			= argv[++i];
+		else if	(arg == "--repetitions"	&& i + 1 < argc)	repetitions	= std::stoi(argv[++i]);
+		else if	(arg == "--items"		&& i + 1 < argc)	items		= std::stoi(argv[++i]);
+		else if	(arg == "--verbose")						verbose		= true;
+		else
+		{
+			std::cerr << "Usage: QmlComponentCacheTest [--out <file.json>] [--repetitions <n>] [--items <n>] [--verbose]" << std::endl;
+			return 2;
+		}
+	}
+
+	if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QGuiApplication app(argc, argv);
+
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(verbose ? logType::cout : logType::null);
+
+	QTemporaryDir	dir;
+	const QString	formPath	= dir.filePath("Form.qml"),
+					brokenPath	= dir.filePath("Broken.qml");
+	const QUrl		formUrl		= QUrl::fromLocalFile(formPath);
+
+	writeForm(formPath, items);
+
+	QQmlEngine			engine;
+	QQmlContext		*	context	= engine.rootContext();
+	QmlComponentCache *	cache	= QmlComponentCache::cache(&engine);
+	Json::Value			results(Json::objectValue);
+
+	//Synchronously, only the first one should compile
+	for(int r=0; r<repetitions; r++)
+		delete instantiateQml(formUrl, "Test", context);
+
+	expect(cache->statistics().misses	== 1,						"the form should be compiled once");
+	expect(cache->statistics().hits		== size_t(repetitions - 1),	"all later creations should use the cached component");
+	expect(cache->statistics().created	== size_t(repetitions),		"every creation should be counted");
+
+	results["synchronous"] = statisticsJson(cache->statistics());
+	cache->resetStatistics();
+
+	//A changed file must be compiled again
+	writeForm(formPath, items + 1);
+	QFile(formPath).setFileTime(QDateTime::currentDateTime().addSecs(10), QFileDevice::FileModificationTime);
+
+	QObject * changed = instantiateQml(formUrl, "Test", context);
+	expect(changed && changed->findChildren<QObject*>().size() > 0,	"the changed form should be created");
+	expect(cache->statistics().misses == 1,							"a changed file should not come from the cache");
+	delete changed;
+
+	//Errors are thrown and not cached
+	QFile broken(brokenPath);
+	broken.open(QIODevice::WriteOnly);
+	broken.write("import QtQuick\nItem { this is not qml }\n");
+	broken.close();
+
+	for(int r=0; r<2; r++)
+		try
+		{
+			delete instantiateQml(QUrl::fromLocalFile(brokenPath), "Test", context);
+			expect(false, "a broken qml file should throw");
+		}
+		catch(qmlLoadError &) {}
+
+	expect(cache->statistics().misses == 3, "a broken file should be compiled each time");
+	cache->resetStatistics();
+
+	//Asynchronously, with something that gives the incubators time like a window would
+	FrameIncubationController controller;
+	engine.setIncubationController(&controller);
+
+	Json::Value asyncFrames(Json::arrayValue);
+
+	for(int r=0; r<repetitions; r++)
+	{
+		QEventLoop	loop;
+		QObject	*	created			= nullptr;
+		bool		done			= false;
+		size_t		framesBefore	= controller.frames();
+
+		QQmlIncubator * incubator = instantiateQmlAsync(formUrl, "Test", [&](QObject * object, const std::string & error)
+		{
+			expect(error == "", "asynchronous creation failed: " + error);
+			created = object;
+			done	= true;
+			loop.quit();
+		}, context);
+
+		if(incubator)
+			loop.exec();
+
+		expect(done && created, "asynchronous creation should give an object");
+		asyncFrames.append(Json::UInt64(controller.frames() - framesBefore));
+		delete created;
+	}
+
+	expect(cache->statistics().misses == 0, "asynchronous creation should use the cached component");
+
+	results["asynchronous"]				= statisticsJson(cache->statistics());
+	results["asynchronous"]["frames"]	= asyncFrames;
+
+	//And cancelled, which should never call back
+	bool			calledBack	= false;
+	QQmlIncubator *	cancelled	= instantiateQmlAsync(formUrl, "Test", [&](QObject * object, const std::string &) { calledBack = true; delete object; }, context);
+
+	if(cancelled)
+		cancelled->clear();
+
+	QEventLoop waitAFewFrames;
+	QTimer::singleShot(100, &waitAFewFrames, &QEventLoop::quit);
+	waitAFewFrames.exec();
+
+	expect(!cancelled || !calledBack, "a cancelled creation should not call back");
+
+	engine.setIncubationController(nullptr);
+
+	results["failures"] = failures;
+
+	if(out == "")	std::cout << results.toStyledString();
+	else			std::ofstream(out) << results.toStyledString();
+
+	return failures == 0 ? 0 : 1;
+}
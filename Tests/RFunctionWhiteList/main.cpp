@@ -0,0 +1,152 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "r_functionwhitelist.h"
+#include "regexwhitelist.h"
+#include "stringutils.h"
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <vector>
+
+///The message scriptIsSafe throws for script, or "" if it is safe
+static std::string verdict(const std::string & script)
+{
+	try						{ R_FunctionWhiteList::scriptIsSafe(script); }
+	catch(filterException & e)	{ return e.what(); }
+	return "";
+}
+
+static std::vector<std::string> readCorpus(const std::string & path)
+{
+	std::ifstream				file(path);
+	std::vector<std::string>	scripts;
+	std::string					line,
+								script;
+
+	if(!file)
+		throw std::runtime_error("Cannot read corpus '" + path + "'");
+
+	while(std::getline(file, line))
+		if(line.rfind("#---", 0) == 0)
+		{
+			if(script != "")
+				scripts.push_back(script);
+			script = "";
+		}
+		else
+			script += (script == "" ? "" : "\n") + line;
+
+	if(script != "")
+		scripts.push_back(script);
+
+	scripts.erase(scripts.begin()); //The header explaining the file
+
+	return scripts;
+}
+
+///Filters like LabelFilterGenerator writes them
+static std::vector<std::string> labelFilters(std::mt19937 & random)
+{
+	std::vector<std::string> filters;
+
+	for(size_t f=0; f<50; f++)
+	{
+		std::string filter = "generatedFilter <- (";
+
+		for(size_t c=0, columns = 1 + random() % 5; c<columns; c++)
+		{
+			filter += (c ? " & " : "") + std::string("(");
+
+			for(size_t l=0, labels = 1 + random() % 4; l<labels; l++)
+				filter += (l ? " | " : "") + std::string("col") + std::to_string(c) + " == \"label" + std::to_string(random() % 20) + "\"";
+
+			filter += ")";
+		}
+
+		filters.push_back(filter + ")");
+	}
+
+	return filters;
+}
+
+///Token soup that hits the corners of the syntax the whitelist looks at: calls, assignments both ways, backticks, namespaces, strings and comments
+static std::vector<std::string> generatedScripts(std::mt19937 & random, size_t count)
+{
+	static const std::vector<std::string> tokens = {
+		"mean", "sd", "system", "Sys.time", ".hidden", ".5", "x", "x1", "_x", "1x", "a.b", "a::b", "stats::sd", "a:::b", "a:b", "a$b", "$", "::", ":",
+		"(", ")", "[", "]", "{", "}", ";", ",", "\"", "'", "#", "\n", "\r", "\t", " ", "  ", "\v",
+		"<-", "<<-", "=", "==", "->", "->>", "-", ">", "<", "+", "*", "/", "%", "%%", "%in%", "^", "!", "!=", "&", "&&", "|", "||", "~", "@",
+		"`", "`+`", "`%in%`", "`<-`", "`->>`", "`$`", "`mean`", "`x y`", "\xc3\xa9" };
+
+	std::vector<std::string> scripts;
+
+	for(size_t s=0; s<count; s++)
+	{
+		std::string script;
+
+		for(size_t t=0, length = random() % 25; t<length; t++)
+			script += tokens[random() % tokens.size()];
+
+		scripts.push_back(script);
+	}
+
+	return scripts;
+}
+
+int main(int argc, char * argv[])
+{
+	if(argc != 2)
+	{
+		std::cerr << "Usage: RFunctionWhiteListTest <filters.R>" << std::endl;
+		return 2;
+	}
+
+	std::mt19937				random(1234);
+	std::vector<std::string>	scripts		= readCorpus(argv[1]),
+								labels		= labelFilters(random),
+								generated	= generatedScripts(random, 20000);
+
+	scripts.insert(scripts.end(), labels.begin(),		labels.end());
+	scripts.insert(scripts.end(), generated.begin(),	generated.end());
+
+	size_t differences = 0, unsafe = 0;
+
+	for(const std::string & script : scripts)
+	{
+		const std::string	expected	= RegexWhiteList::verdict(script),
+							found		= verdict(script),
+							cached		= verdict(script);
+
+		if(expected != "")
+			unsafe++;
+
+		//The verdict stops at the first problem, so the aliases are compared separately too
+		const std::string commentFree = stringUtils::stripRComments(script);
+
+		if(found != expected || cached != expected || R_FunctionWhiteList::findIllegalFunctionsAliases(commentFree) != RegexWhiteList::findIllegalFunctionsAliases(commentFree))
+		{
+			if(differences++ < 20)
+				std::cerr << "Different verdict for script:\n" << script << "\nregex: " << expected << "\nscanner: " << found << "\ncached: " << cached << std::endl;
+		}
+	}
+
+	std::cout << "Compared " << scripts.size() << " scripts, " << unsafe << " of which unsafe, and found " << differences << " differences" << std::endl;
+
+	return differences == 0 ? 0 : 1;
+}
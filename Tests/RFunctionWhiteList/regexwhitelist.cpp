@@ -0,0 +1,114 @@
+#include "regexwhitelist.h"
+#include "r_functionwhitelist.h"
+#include "stringutils.h"
+#include <regex>
+#include <sstream>
+
+namespace RegexWhiteList
+{
+
+static const std::set<std::string> & functionWhiteList()
+{
+	static std::set<std::string> whiteList;
+
+	if(whiteList.empty())
+	{
+		std::stringstream	ordered(R_FunctionWhiteList::returnOrderedWhiteList());
+		std::string			line;
+
+		while(std::getline(ordered, line))
+			if(line.size() > 3) //Each line looks like: "name",
+				whiteList.insert(line.substr(1, line.size() - 3));
+	}
+
+	return whiteList;
+}
+
+static const std::string	functionStartDelimit("(?:[;\\s\\(\"\\[\\+\\-\\=\\*\\%\\/\\{\\|&!]|^)");
+static const std::string	functionNameStart("(?:\\.?[[:alpha:]])");
+static const std::string	functionNameBody("(?:\\w|\\.|::)+");
+static const std::regex		functionNameMatcher(functionStartDelimit + "(" + functionNameStart + functionNameBody + ")(?=[\\t \\r]*\\()");
+
+std::set<std::string> findIllegalFunctions(std::string const & script)
+{
+	std::set<std::string> blackListedFunctionsFound;
+
+	auto foundFunctionsBegin	= std::sregex_iterator(script.begin(), script.end(), functionNameMatcher);
+	auto foundFunctionsEnd		= std::sregex_iterator();
+
+	for(auto foundFunctionIter = foundFunctionsBegin; foundFunctionIter != foundFunctionsEnd; foundFunctionIter++ )
+	{
+		std::string foundFunction((*foundFunctionIter)[1].str());
+
+		if(functionWhiteList().count(foundFunction) == 0)
+			blackListedFunctionsFound.insert(foundFunction);
+	}
+
+	return blackListedFunctionsFound;
+}
+
+static const std::string	operatorsR("`(?:\\+|-|\\*|/|%(?:/|\\*|in)?%|\\^|<=?|>=?|==?|!=?|<?<-|->>?|\\|\\|?|&&?|:|\\$)`");
+
+static const std::regex		assignmentWhiteListedRightMatcher(	"(" +				functionNameStart + functionNameBody +	")\\s*(?:<?<-|=)");
+static const std::regex		assignmentWhiteListedLeftMatcher(	"(?:->>?)\\s*(" +	functionNameStart + functionNameBody +	")");
+static const std::regex		assignmentOperatorRightMatcher(		"(" +				operatorsR +							")\\s*(?:<?<-|=)");
+static const std::regex		assignmentOperatorLeftMatcher(		"(?:->>?)\\s*(" +	operatorsR +							")");
+
+std::set<std::string> findIllegalFunctionsAliases(std::string const & script)
+{
+	std::set<std::string> illegalAliasesFound;
+
+	auto aliasSearcher = [&illegalAliasesFound, &script](const std::regex & aliasAssignmentMatcher, bool operators)
+	{
+		auto foundAliasesBegin	= std::sregex_iterator(script.begin(), script.end(), aliasAssignmentMatcher);
+		auto foundAliasesEnd	= std::sregex_iterator();
+
+		for(auto foundAliasesIter = foundAliasesBegin; foundAliasesIter != foundAliasesEnd; foundAliasesIter++ )
+		{
+			std::string foundAlias((*foundAliasesIter)[1].str());
+
+			if(operators || functionWhiteList().count(foundAlias) > 0)
+				illegalAliasesFound.insert(foundAlias);
+		}
+	};
+
+	aliasSearcher(assignmentOperatorLeftMatcher,		true);
+	aliasSearcher(assignmentOperatorRightMatcher,		true);
+	aliasSearcher(assignmentWhiteListedLeftMatcher,		false);
+	aliasSearcher(assignmentWhiteListedRightMatcher,	false);
+
+	return illegalAliasesFound;
+}
+
+std::string verdict(const std::string & script)
+{
+	std::string commentFree = stringUtils::stripRComments(script);
+
+	std::set<std::string> blackListedFunctions = findIllegalFunctions(commentFree);
+
+	if(blackListedFunctions.size() > 0)
+	{
+		bool moreThanOne = blackListedFunctions.size() > 1;
+		std::stringstream ssm;
+		ssm << "Non-whitelisted function" << (moreThanOne ? "s" : "") << " used:" << (moreThanOne ? "\n" : " ");
+		for(auto & black : blackListedFunctions)
+			ssm << black << "\n";
+		return ssm.str();
+	}
+
+	std::set<std::string> illegalAliasesFound = findIllegalFunctionsAliases(commentFree);
+
+	if(illegalAliasesFound.size() > 0)
+	{
+		bool moreThanOne = illegalAliasesFound.size() > 1;
+		std::stringstream ssm;
+		ssm << "Illegal assignment to " << (moreThanOne ? "operators or whitelisted functions" : "an operator or whitelisted function") << " used:" << (moreThanOne ? "\n" : " ");
+		for(auto & alias : illegalAliasesFound)
+			ssm << alias << "\n";
+		return ssm.str();
+	}
+
+	return "";
+}
+
+}
@@ -0,0 +1,19 @@
+#ifndef REGEXWHITELIST_H
+#define REGEXWHITELIST_H
+
+#include <set>
+#include <string>
+
+///
+/// The std::regex based checks R_FunctionWhiteList used before it got its own scanner, kept here to compare the verdicts of both.
+/// The whitelist itself is taken from R_FunctionWhiteList::returnOrderedWhiteList so that only the way of searching differs.
+namespace RegexWhiteList
+{
+	std::set<std::string>	findIllegalFunctions(			const std::string & script);
+	std::set<std::string>	findIllegalFunctionsAliases(	const std::string & script);
+
+	///The message R_FunctionWhiteList::scriptIsSafe used to throw for script, or "" if it was deemed safe
+	std::string				verdict(const std::string & script);
+}
+
+#endif // REGEXWHITELIST_H
@@ -0,0 +1,238 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "readstat/readstatimportdataset.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static ssize_t writeToFile(const void * bytes, size_t length, void * ctx)
+{
+	return fwrite(bytes, 1, length, static_cast<FILE*>(ctx));
+}
+
+///An SPSS file with labelled and unlabelled numbers and with text columns of which half only hold whole numbers, those are the ones tryNominalMinusText converts
+static bool writeSav(const std::string & path, size_t rows, size_t textColumns)
+{
+	FILE * file = fopen(path.c_str(), "wb");
+
+	if(!file)
+		return false;
+
+	readstat_writer_t		*	writer	= readstat_writer_init();
+	readstat_set_data_writer(writer, &writeToFile);
+
+	readstat_label_set_t	*	levels	= readstat_add_label_set(writer, READSTAT_TYPE_DOUBLE, "levels");
+	readstat_label_double_value(levels, 1, "low");
+	readstat_label_double_value(levels, 2, "mid");
+	readstat_label_double_value(levels, 3, "high");
+
+	readstat_variable_t		*	score	= readstat_add_variable(writer, "score",	READSTAT_TYPE_DOUBLE, 0),
+							*	group	= readstat_add_variable(writer, "group",	READSTAT_TYPE_DOUBLE, 0);
+
+	readstat_variable_set_measure(	score, READSTAT_MEASURE_SCALE);
+	readstat_variable_set_measure(	group, READSTAT_MEASURE_ORDINAL);
+	readstat_variable_set_label_set(group, levels);
+
+	std::vector<readstat_variable_t*> texts;
+	for(size_t t=0; t<textColumns; t++)
+	{
+		texts.push_back(readstat_add_variable(writer, ("text" + std::to_string(t)).c_str(), READSTAT_TYPE_STRING, 16));
+		readstat_variable_set_measure(texts.back(), READSTAT_MEASURE_NOMINAL);
+	}
+
+	readstat_begin_writing_sav(writer, file, rows);
+
+	for(size_t r=0; r<rows; r++)
+	{
+		readstat_begin_row(writer);
+
+		if(r % 17 == 0)	readstat_insert_missing_value(writer, score);
+		else			readstat_insert_double_value(writer, score, r * 0.25);
+
+		readstat_insert_double_value(writer, group, 1 + r % 3);
+
+		for(size_t t=0; t<textColumns; t++)
+		{
+			const std::string value = t % 2 == 0 ? std::to_string((r * (t + 1)) % 97) : "word" + std::to_string((r + t) % 13);
+			readstat_insert_string_value(writer, texts[t], r % 23 == t ? "" : value.c_str());
+		}
+
+		readstat_end_row(writer);
+	}
+
+	readstat_end_writing(writer);
+	readstat_writer_free(writer);
+	fclose(file);
+
+	return true;
+}
+
+static ReadStatImportDataSet * import(const std::string & path, size_t threads)
+{
+	ReadStatImportDataSet * data = new ReadStatImportDataSet(nullptr, [](int){});
+
+	check(data->parse("sav", path, threads) == READSTAT_OK,											"the generated file can be parsed");
+
+	data->setLabelsToColumns();
+	data->tryNominalMinusText(threads);
+
+	return data;
+}
+
+///What AsyncLoader::progressHandler throws when the user cancels
+struct Cancelled {};
+
+///Cancels the way a user would, partway through the rows, and checks that the exception comes out of parse instead of unwinding through readstat
+static bool cancelHalfway(const std::string & path, size_t threads, int & cancelledAt)
+{
+	ReadStatImportDataSet * data = new ReadStatImportDataSet(nullptr, [&](int progress) { if(progress >= 30) throw Cancelled(); cancelledAt = progress; });
+	bool					cancelled = false;
+
+	try						{ data->parse("sav", path, threads); }
+	catch(Cancelled &)		{ cancelled = true; }
+
+	delete data;
+
+	return cancelled;
+}
+
+typedef std::chrono::steady_clock clock_type;
+
+static double perSecond(size_t count, clock_type::time_point start, clock_type::time_point end)
+{
+	return count / std::max(1e-6, std::chrono::duration<double>(end - start).count());
+}
+
+static bool sameDoubles(const std::vector<double> & a, const std::vector<double> & b)
+{
+	if(a.size() != b.size())
+		return false;
+
+	for(size_t i=0; i<a.size(); i++)
+		if(!(a[i] == b[i] || (std::isnan(a[i]) && std::isnan(b[i]))))
+			return false;
+
+	return true;
+}
+
+int main(int argc, char ** argv)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const std::string	path		= argc > 1 ? argv[1] : "readstatimport.sav";
+	const size_t		rows		= 5000,
+						textColumns	= 12;
+
+	check(writeSav(path, rows, textColumns),														"the SPSS file can be written");
+
+	//4 and not 0 threads, so that the rows are parsed in ranges even where the hardware has a single thread
+	ReadStatImportDataSet	*	single		= import(path, 1),
+							*	parallel	= import(path, 4);
+
+	check(single->columnCount() == 2 + textColumns && parallel->columnCount() == single->columnCount(),	"all columns are imported");
+	check(single->rowCount() == rows && parallel->rowCount() == rows,								"all rows are imported");
+
+	size_t converted = 0;
+
+	for(int c=0; c<int(single->columnCount()); c++)
+	{
+		ReadStatImportColumn	*	one		= single->column(c),
+								*	many	= parallel->column(c);
+		const std::string			what	= "column " + one->name();
+
+		check(one->name() == many->name(),															what + " has the same name");
+		check(one->getColumnType() == many->getColumnType(),										what + " has the same type");
+		check(one->ints() == many->ints(),															what + " has the same ints");
+		check(sameDoubles(one->doubles(), many->doubles()),											what + " has the same doubles");
+		check(one->strings() == many->strings(),													what + " has the same strings");
+		check(one->intLabels() == many->intLabels() && one->strLabels() == many->strLabels(),		what + " has the same labels");
+
+		if(c >= 2 && one->getColumnType() == columnType::nominal)
+			converted++;
+	}
+
+	check(converted > 0,																			"some text columns with whole numbers became nominal, so the threads had something to check");
+
+	delete single;
+	delete parallel;
+
+	for(size_t threads : {1, 4})
+	{
+		const std::string	how			= threads == 1 ? " parsing serially" : " parsing row ranges";
+		int					cancelledAt = -1;
+
+		check(cancelHalfway(path, threads, cancelledAt),											"cancelling from the progress callback comes out of parse as the exception that was thrown," + how);
+		check(cancelledAt < 30 && (threads > 1 || cancelledAt >= 0),								"the rows before cancelling were reported," + how); //Row ranges only report progress every 50ms, so a small file might be parsed before the first report
+	}
+
+	ReadStatImportDataSet * again = import(path, 4);
+	check(again->rowCount() == rows,																"the file can be imported again after a cancelled import");
+	delete again;
+
+	std::remove(path.c_str());
+
+	//The stages of loading a bigger file, timed separately so their throughput can be compared between runs
+	const size_t	bigRows		= 100000;
+	check(writeSav(path, bigRows, textColumns),														"the bigger SPSS file can be written");
+
+	ReadStatImportDataSet * serial		= new ReadStatImportDataSet(nullptr, [](int){});
+	clock_type::time_point	serialStart	= clock_type::now();
+	check(serial->parse("sav", path, 1) == READSTAT_OK,												"the bigger file can be parsed serially");
+	clock_type::time_point	serialEnd	= clock_type::now();
+	delete serial;
+
+	ReadStatImportDataSet * big			= new ReadStatImportDataSet(nullptr, [](int){});
+	clock_type::time_point	parseStart	= clock_type::now();
+	check(big->parse("sav", path) == READSTAT_OK,													"the bigger file can be parsed in row ranges");
+	clock_type::time_point	labelsStart	= clock_type::now();
+	big->setLabelsToColumns();
+	clock_type::time_point	typesStart	= clock_type::now();
+	big->tryNominalMinusText();
+	clock_type::time_point	typesEnd	= clock_type::now();
+
+	check(big->rowCount() == bigRows,																"all rows of the bigger file are imported");
+
+	const size_t values = bigRows * (2 + textColumns);
+
+	delete big;
+	std::remove(path.c_str());
+
+	if(failures == 0)
+		std::cout	<< "Importing " << rows << " rows from SPSS gives the same columns parsed serially as parsed in row ranges on several threads, and can be cancelled halfway either way. "
+					<< "Loading " << bigRows << " rows: parsing serially " << size_t(perSecond(values, serialStart, serialEnd)) << " values/s, in row ranges " << size_t(perSecond(values, parseStart, labelsStart)) << " values/s, labelling " << size_t(perSecond(2 + textColumns, labelsStart, typesStart)) << " columns/s, "
+					<< "checking text columns " << size_t(perSecond(bigRows * textColumns, typesStart, typesEnd)) << " values/s." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,67 @@
+# Generates a jasp-file with many analyses out of one from the data library:
+# every analysis in SOURCE is repeated COPIES times with a new id and title, and
+# the result is written to OUTPUT. Run as a script:
+#
+#   cmake -DSOURCE=Sleep.jasp -DOUTPUT=generated.jasp -DCOPIES=10 -P generateproject.cmake
+#
+foreach(REQUIRED SOURCE OUTPUT COPIES)
+  if(NOT DEFINED ${REQUIRED})
+    message(FATAL_ERROR "generateproject.cmake needs -D${REQUIRED}=...")
+  endif()
+endforeach()
+
+get_filename_component(WORK_DIR "${OUTPUT}.contents" ABSOLUTE)
+get_filename_component(OUTPUT "${OUTPUT}" ABSOLUTE)
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(ARCHIVE_EXTRACT INPUT "${SOURCE}" DESTINATION "${WORK_DIR}")
+file(READ "${WORK_DIR}/analyses.json" ANALYSES_JSON)
+
+string(JSON ORIGINAL_COUNT LENGTH "${ANALYSES_JSON}" analyses)
+math(EXPR LAST_ORIGINAL "${ORIGINAL_COUNT} - 1")
+
+# Ids of the copies start after the highest original id, so they never collide
+set(ID_RANGE 0)
+foreach(ANALYSIS RANGE ${LAST_ORIGINAL})
+  string(JSON ID GET "${ANALYSES_JSON}" analyses ${ANALYSIS} id)
+  if(ID GREATER_EQUAL ID_RANGE)
+    math(EXPR ID_RANGE "${ID} + 1")
+  endif()
+endforeach()
+
+set(NEXT_INDEX ${ORIGINAL_COUNT})
+foreach(COPY RANGE 1 ${COPIES})
+  if(COPY EQUAL COPIES)
+    break()
+  endif()
+
+  foreach(ANALYSIS RANGE ${LAST_ORIGINAL})
+    string(JSON COPIED GET "${ANALYSES_JSON}" analyses ${ANALYSIS})
+    string(JSON ID GET "${COPIED}" id)
+    string(JSON TITLE GET "${COPIED}" title)
+    math(EXPR NEW_ID "${ID} + ${COPY} * ${ID_RANGE}")
+
+    string(JSON COPIED SET "${COPIED}" id ${NEW_ID})
+    string(JSON COPIED SET "${COPIED}" title "\"${TITLE} ${COPY}\"")
+    string(JSON ANALYSES_JSON SET "${ANALYSES_JSON}" analyses ${NEXT_INDEX} "${COPIED}")
+
+    math(EXPR NEXT_INDEX "${NEXT_INDEX} + 1")
+  endforeach()
+endforeach()
+
+file(WRITE "${WORK_DIR}/analyses.json" "${ANALYSES_JSON}")
+
+# The entries have to be relative to the root of the archive, which is where the paths given to ARCHIVE_CREATE are taken from
+file(GLOB ENTRIES LIST_DIRECTORIES false RELATIVE "${WORK_DIR}" "${WORK_DIR}/*" "${WORK_DIR}/*/*" "${WORK_DIR}/*/*/*" "${WORK_DIR}/*/*/*/*")
+file(REMOVE "${OUTPUT}")
+execute_process(
+  COMMAND ${CMAKE_COMMAND} -E tar cf "${OUTPUT}" --format=zip -- ${ENTRIES}
+  WORKING_DIRECTORY "${WORK_DIR}"
+  RESULT_VARIABLE ZIP_RESULT)
+
+if(NOT ZIP_RESULT EQUAL 0)
+  message(FATAL_ERROR "Could not write ${OUTPUT}")
+endif()
+
+file(REMOVE_RECURSE "${WORK_DIR}")
+message(STATUS "Wrote ${NEXT_INDEX} analyses to ${OUTPUT}")
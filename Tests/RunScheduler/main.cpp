@@ -0,0 +1,110 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "runscheduler.h"
+#include <iostream>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+static std::string str(const std::vector<size_t> & ids)
+{
+	std::string out;
+	for(size_t id : ids)
+		out += (out.empty() ? "" : ",") + std::to_string(id);
+	return out;
+}
+
+int main(int, char **)
+{
+	using prio = RunScheduler::runPriority;
+
+	RunScheduler scheduler;
+	scheduler.setAgingMs(1000);
+
+	//A bulk refresh: everything waits in the background, except the one being edited and one in view
+	std::vector<RunScheduler::Request> waiting = { {1, prio::background}, {2, prio::background}, {3, prio::visible}, {4, prio::imageRewrite}, {5, prio::interactive} };
+
+	check(str(scheduler.schedule(waiting, {}, 0)) == "5,3,4,1,2",			"most urgent class first, same class in the order given");
+
+	waiting.push_back({6, prio::interactive});
+	check(str(scheduler.schedule(waiting, {}, 500)) == "5,6,3,4,1,2",		"within a class who waited longest goes first");
+
+	check(scheduler.effectivePriority({1, prio::background}, 2500) == prio::visible,	"waiting makes a request more urgent");
+
+	waiting = { {1, prio::background}, {7, prio::visible} };
+	check(str(scheduler.schedule(waiting, {}, 2500)) == "1,7",				"an aged background request goes before a newer visible one");
+
+	check(str(scheduler.schedule(waiting, {}, 100000)).size() && scheduler.effectivePriority({1, prio::background}, 100000) == prio::visible,	"aging stops at visible");
+
+	//A bulk refresh with the default aging has been waiting for 20 seconds when the user edits an analysis
+	RunScheduler bulk;
+	std::vector<RunScheduler::Request> refresh;
+
+	for(size_t id=100; id<150; id++)
+		refresh.push_back({id, prio::background});
+
+	bulk.schedule(refresh, {}, 0);
+	refresh.push_back({99, prio::interactive});
+
+	check(bulk.schedule(refresh, {}, 20000).front() == 99,					"the analysis just edited goes before a bulk refresh that waited long");
+	check(bulk.effectivePriority({100, prio::background}, 20000) == prio::visible,		"while the refresh has aged as far as it goes");
+
+	//Preemption
+	RunScheduler preempter;
+	preempter.setAgingMs(1000);
+
+	preempter.schedule({ {20, prio::interactive} }, { 10 }, 0);
+
+	check(!preempter.shouldPreempt({10, prio::visible},		{20, prio::interactive}),	"runs the user can see are not preempted");
+	check(!preempter.shouldPreempt({10, prio::background},	{21, prio::visible}),		"only the user waiting is reason to preempt");
+	check( preempter.shouldPreempt({10, prio::background},	{20, prio::interactive}),	"a background run is preempted for the analysis being edited");
+	check( preempter.shouldPreempt({10, prio::background},	prio::rCode),					"and for R code a form waits on");
+	check(!preempter.shouldPreempt({10, prio::background},	{20, prio::interactive}),	"but not more often than a couple of times");
+	check(preempter.preemptions(10) == 2,													"preemptions are counted");
+
+	//A background request that waited long enough to be ranked with what is visible still isn't the user waiting
+	preempter.schedule({ {30, prio::background} }, { 12 }, 0);
+	preempter.schedule({ {30, prio::background} }, { 12 }, 4000);
+	check(preempter.effectivePriority({30, prio::background}, 4000) == prio::visible,			"the waiting background request has aged to visible");
+	check(!preempter.shouldPreempt({12, prio::background},	{30, prio::background}),		"but an aged background request does not preempt a running background run");
+	check(preempter.preemptions(12) == 0,													"and that isn't counted as a preemption");
+
+	preempter.schedule({}, { 10 }, 5000);
+	check(preempter.preemptions(10) == 2,													"the count survives while the analysis is restarted");
+
+	preempter.schedule({}, {}, 20000);
+	check(preempter.preemptions(10) == 0,													"and is forgotten once it is long gone");
+
+	preempter.setPreemption(false);
+	check(!preempter.shouldPreempt({11, prio::background},	{20, prio::interactive}),	"preemption can be switched off");
+
+	if(failures == 0)
+		std::cout << "The analysis being edited goes first, waiting makes anything but the user more urgent and background runs are preempted only for the user and only a few times." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
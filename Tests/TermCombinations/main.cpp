@@ -0,0 +1,132 @@
+//
+// Copyright (C) 2013-2024 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "models/terms.h"
+#include "log.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+///The eager enumeration Terms::wayCombinations used to do, from ways up to maxWays
+static std::vector<Term> eagerCombinations(const Terms & terms, size_t ways, size_t maxWays)
+{
+	std::vector<Term> result;
+
+	for (size_t r = ways; r <= maxWays; r++)
+	{
+		std::vector<bool> v(terms.size());
+		std::fill(v.begin() + r, v.end(), true);
+
+		do {
+			std::vector<std::string> combination;
+
+			for (size_t i = 0; i < terms.size(); i++)
+				if (!v[i])
+					combination.push_back(terms.at(i).asString());
+
+			result.push_back(Term(combination));
+
+		} while (std::next_permutation(v.begin(), v.end()));
+	}
+
+	return result;
+}
+
+static bool samePrefix(const Terms & lazy, const std::vector<Term> & eager, size_t limit)
+{
+	if (lazy.size() != std::min(limit, eager.size()))
+		return false;
+
+	for (size_t i = 0; i < lazy.size(); i++)
+		if (lazy.at(i) != eager[i])
+			return false;
+
+	return true;
+}
+
+static Terms someTerms(size_t count, bool withInteractions)
+{
+	std::vector<std::vector<std::string>> terms;
+
+	for (size_t i = 0; i < count; i++)
+		if (withInteractions && i % 3 == 2)	terms.push_back({ "factor" + std::to_string(i), "covariate" + std::to_string(i) });
+		else								terms.push_back({ "factor" + std::to_string(i) });
+
+	return Terms(terms);
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	for (bool withInteractions : { false, true })
+		for (size_t n = 2; n <= 8; n++)
+		{
+			const Terms			terms	= someTerms(n, withInteractions);
+			const std::string	which	= std::to_string(n) + (withInteractions ? " terms with interactions" : " terms");
+			const auto			cross	= eagerCombinations(terms, 1, n);
+
+			check(samePrefix(terms.crossCombinations(Terms::noLimit), cross, Terms::noLimit),			"crossCombinations of " + which + " in the same order as before");
+			check(terms.combinationsCount(JASPControl::CombinationType::CombinationCross) == cross.size(),	"combinationsCount of the cross of " + which);
+
+			for (size_t limit : { size_t(1), size_t(3), cross.size() - 1, cross.size(), cross.size() + 1 })
+				check(samePrefix(terms.crossCombinations(limit), cross, limit),							"crossCombinations of " + which + " limited to " + std::to_string(limit) + " are the first ones");
+
+			for (size_t ways = 1; ways <= n; ways++)
+			{
+				const auto eager = eagerCombinations(terms, ways, ways);
+
+				check(samePrefix(terms.wayCombinations(int(ways), Terms::noLimit), eager, Terms::noLimit),	"wayCombinations(" + std::to_string(ways) + ") of " + which);
+				check(samePrefix(terms.wayCombinations(int(ways), 2), eager, 2),							"wayCombinations(" + std::to_string(ways) + ") of " + which + " limited to 2");
+			}
+
+			Terms interactions = terms;
+			check(samePrefix(interactions.combineTerms(JASPControl::CombinationType::Combination2Way, Terms::noLimit), eagerCombinations(terms, 2, 2), Terms::noLimit), "combineTerms 2 way of " + which);
+			check(terms.combinationsCount(JASPControl::CombinationType::Combination3Way) == (n < 3 ? 0 : eagerCombinations(terms, 3, 3).size()), "combinationsCount 3 way of " + which);
+		}
+
+	//ffCombinations adds the cross of the new terms and then each existing term crossed with those, like it did before it got a limit
+	Terms	existing	= someTerms(3, false),
+			added		(std::vector<std::string>{ "new1", "new2" });
+	Terms	unlimited	= Terms(existing).ffCombinations(added, Terms::noLimit),
+			limited		= Terms(existing).ffCombinations(added, 5);
+
+	check(unlimited.size() == 3 + 3 + 3 * 3,	"ffCombinations of 3 existing and 2 new terms");
+	check(limited.size() >= 5 && std::equal(limited.begin(), limited.begin() + 5, unlimited.begin()), "a limited ffCombinations starts like the unlimited one");
+
+	//20 factors are far too many to build, but they can be counted
+	check(someTerms(20, false).combinationsCount(JASPControl::CombinationType::CombinationCross) == (size_t(1) << 20) - 1, "the cross of 20 factors is counted without building it");
+
+	if(failures == 0)
+		std::cout << "TermCombinations: the lazy combinations match the eager ones, in the same order" << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,162 @@
+//
+// Copyright (C) 2013-2023 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "zipwriter.h"
+#include "archivereader.h"
+#include "log.h"
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <random>
+#include <map>
+
+static int failures = 0;
+
+static void check(bool ok, const std::string & what)
+{
+	if(!ok)
+	{
+		std::cerr << "FAILED: " << what << std::endl;
+		failures++;
+	}
+}
+
+///Through ArchiveReader, as JASPImporter reads a .jasp
+static std::string readEntry(const std::string & archivePath, const std::string & entryPath)
+{
+	ArchiveReader	entry(archivePath, entryPath);
+	std::string		bytes(entry.exists() ? entry.size() : 0, '\0');
+	int				errorCode = 0;
+
+	for(size_t read = 0; read < bytes.size();)
+	{
+		int size = entry.readData(bytes.data() + read, int(bytes.size() - read), errorCode);
+
+		if(errorCode != 0 || size <= 0)
+			return "<cannot be read>";
+
+		read += size;
+	}
+
+	return bytes;
+}
+
+typedef std::map<std::string, std::string> Contents;
+
+static size_t save(const std::string & path, const Contents & contents, const std::vector<std::string> & columns, const std::string & previousPath = "")
+{
+	ZipWriter						zip(path, previousPath);
+	std::vector<ZipWriter::Piece>	pieces;
+
+	for(const std::string & column : columns)
+		pieces.push_back({ column.data(), column.size() });
+
+	for(const auto & [entryPath, bytes] : contents)
+		zip.write(zip.prepare(entryPath, bytes, entryPath.find(".png") == std::string::npos));
+
+	zip.write(zip.prepare("data.bin", pieces, true, 0));
+	zip.close();
+
+	return zip.entriesCopied();
+}
+
+int main(int, char **)
+{
+	static std::ostringstream nullstream;
+	Log::init(&nullstream);
+	Log::setWhere(logType::null);
+
+	const std::filesystem::path	dir			= std::filesystem::temp_directory_path();
+	const std::string			first		= (dir / "jasp-zipwriter-test.jasp").string(),
+								second		= first + ".tmp",
+								notAZip		= (dir / "jasp-zipwriter-test.txt").string();
+
+	std::mt19937	generator(7);
+	std::string		noise(300 * 1000, '\0'),
+					text;
+
+	for(char & c : noise)
+		c = char(generator());
+
+	for(size_t row=0; text.size() < 3 * 1024 * 1024; row++)
+		text += "{ \"row\": " + std::to_string(row) + ", \"value\": " + std::to_string(row % 31) + " }\n";
+
+	//Columns of different lengths, so the 1MB blocks data.bin is deflated in start and end halfway through them
+	std::vector<std::string> columns;
+	for(size_t c=0; c<5; c++)
+		columns.push_back(text.substr(c * 100000, 700000 + c * 1234));
+
+	std::string data;
+	for(const std::string & column : columns)
+		data += column;
+
+	Contents contents = {
+		{ "META-INF/MANIFEST.MF",			"Manifest-Version: 1.0\n"	},
+		{ "empty.json",						""							},
+		{ "index.html",						text						},
+		{ "analyses/1/plot.png",			noise						},
+		{ "analyses/1/random.state",		noise						}};
+
+	check(save(first, contents, columns) == 0,																"nothing is copied without a previous archive");
+
+	for(const auto & [entryPath, bytes] : contents)
+		check(readEntry(first, entryPath) == bytes,															entryPath + " reads back the same");
+
+	check(readEntry(first, "data.bin") == data,																"data.bin, made of several pieces and deflated in blocks on several threads, reads back the same");
+
+	{
+		ZipWriter						zip((dir / "jasp-zipwriter-threads.zip").string());
+		std::vector<ZipWriter::Piece>	pieces;
+
+		for(const std::string & column : columns)
+			pieces.push_back({ column.data(), column.size() });
+
+		ZipWriter::Entry	one		= zip.prepare("data.bin", pieces, true, 1),
+							four	= zip.prepare("data.bin", pieces, true, 4),
+							whole	= zip.prepare("data.bin", data);
+
+		check(one.data == four.data && one.data == whole.data,												"deflating on one or four threads, or from one piece, gives the same bytes");
+		check(one.crc == four.crc && one.hash == four.hash && one.hash == whole.hash,						"and the same crc and hash");
+		check(one.deflated && one.data.size() < data.size(),												"data.bin got deflated");
+		check(!zip.prepare("noise", noise).deflated,														"what deflate cannot make smaller is stored");
+	}
+
+	contents["index.html"] = text + "edited";
+
+	check(save(second, contents, columns, first) == contents.size(),										"every entry but the edited one is copied from the previous archive");
+
+	for(const auto & [entryPath, bytes] : contents)
+		check(readEntry(second, entryPath) == bytes,														entryPath + " reads back the same after saving over the previous archive");
+
+	check(readEntry(second, "data.bin") == data,															"the copied data.bin reads back the same");
+
+	std::ofstream(notAZip) << "not a zip at all";
+	check(save(second, contents, columns, notAZip) == 0,													"nothing is copied from a previous file that isn't a zip");
+	check(readEntry(second, "data.bin") == data,															"and the archive is still complete");
+
+	std::filesystem::remove(first);
+	std::filesystem::remove(second);
+	std::filesystem::remove(notAZip);
+	std::filesystem::remove(dir / "jasp-zipwriter-threads.zip");
+
+	if(failures == 0)
+		std::cout << "ZipWriter archives read back the same through ArchiveReader, deflate the same on any number of threads and copy exactly the unchanged entries when saving over a previous archive." << std::endl;
+
+	return failures == 0 ? 0 : 1;
+}